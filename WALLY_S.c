@@ -15,10 +15,28 @@
 #include "config.h"
 #include "magnetometer.h"
 #include "gps.h"
+#include "gps_aid.h"
 #include "bluetooth.h"
 #include "motors.h"
 #include "pid.h"
+#include "route.h"
+#include "geofence.h"
+#include "follow.h"
+#include "link.h"
+#include "telemetry.h"
+#include "upload.h"
+#include "tune.h"
+#include "schedule.h"
+#include "mpc.h"
+#include "battery.h"
+#include "fault.h"
+#include "memory.h"
+#include "timebase.h"
+#include "trace.h"
+#include "bus.h"
+#include "pool.h"
 #include <stdio.h>
+#include <string.h>
 
 /// @defgroup TEST_MODES Modos de prueba disponibles
 /// @{
@@ -41,6 +59,54 @@
 /// @brief Modo de integración completa
 #define TEST_INTEGRATION 6
 
+/// @brief Modo de prueba del seguidor de ruta (simulación)
+#define TEST_ROUTE 7
+
+/// @brief Modo de prueba de la geocerca
+#define TEST_GEOFENCE 8
+
+/// @brief Modo de prueba del Follow Me (simulación)
+#define TEST_FOLLOW 9
+
+/// @brief Modo de prueba de la supervisión del enlace (simulación)
+#define TEST_LINK 10
+
+/// @brief Modo de prueba de la telemetría por suscripción (simulación)
+#define TEST_TELEMETRY 11
+
+/// @brief Modo de prueba de la carga confiable (simulación)
+#define TEST_UPLOAD 12
+
+/// @brief Modo de prueba del ajuste PID en vivo (simulación)
+#define TEST_TUNE 13
+
+/// @brief Modo de prueba de la programación de ganancias (simulación)
+#define TEST_SCHEDULE 14
+
+/// @brief Modo de prueba del control predictivo de trayectoria (simulación)
+#define TEST_MPC 15
+
+/// @brief Modo de prueba del monitoreo de batería
+#define TEST_BATTERY 16
+
+/// @brief Modo de prueba del gestor de fallas
+#define TEST_FAULT 17
+
+/// @brief Modo de prueba del diagnóstico de memoria
+#define TEST_MEMORY 18
+
+/// @brief Modo de prueba de la base de tiempo por PPS
+#define TEST_TIMEBASE 19
+
+/// @brief Modo de prueba de la traza binaria por USB
+#define TEST_TRACE 20
+
+/// @brief Modo de prueba del bus de mensajes
+#define TEST_BUS 21
+
+/// @brief Modo de prueba de los bloques de memoria de tamaño fijo
+#define TEST_POOL 22
+
 /// @}
 
 /// @brief Controladores PID globales
@@ -48,6 +114,9 @@ static pid_controller_t heading_pid;
 static pid_controller_t speed_pid_a;
 static pid_controller_t speed_pid_b;
 
+/// @brief Causa del último reinicio (fault_init)
+static fault_reason_t reset_reason = FAULT_NONE;
+
 /**
  * @brief Muestra el menú principal de opciones.
  */
@@ -59,7 +128,95 @@ void print_menu(void) {
     printf("4. Probar Motores y Encoders\n");
     printf("5. Probar Controlador PID\n");
     printf("6. Integración completa\n");
-    printf("Selecciona una opción (1-6): ");
+    printf("7. Probar seguimiento de ruta (simulación)\n");
+    printf("8. Probar geocerca\n");
+    printf("9. Probar Follow Me (simulación)\n");
+    printf("10. Probar supervisión del enlace (simulación)\n");
+    printf("11. Probar telemetría por suscripción (simulación)\n");
+    printf("12. Probar carga confiable de rutas (simulación)\n");
+    printf("13. Probar ajuste PID en vivo (simulación)\n");
+    printf("14. Probar programación de ganancias (simulación)\n");
+    printf("15. Probar control predictivo de trayectoria (simulación)\n");
+    printf("16. Probar monitoreo de batería\n");
+    printf("17. Probar gestor de fallas (reinicia el robot)\n");
+    printf("18. Probar diagnóstico de memoria\n");
+    printf("19. Probar base de tiempo (PPS del GPS)\n");
+    printf("20. Probar traza binaria por USB\n");
+    printf("21. Probar bus de mensajes entre módulos\n");
+    printf("22. Probar bloques de memoria de tamaño fijo\n");
+    printf("Selecciona una opción (1-22): ");
+}
+
+/**
+ * @brief Aplica una corrección diferencial a las velocidades base y mueve los motores.
+ * 
+ * La salida se escala con la tensión de la batería para que la velocidad
+ * no dependa de la carga.
+ * 
+ * @param base_a Velocidad base del motor A
+ * @param base_b Velocidad base del motor B
+ * @param correction Corrección de rumbo (se resta en A y se suma en B)
+ * @param[out] speed_a Velocidad final aplicada al motor A
+ * @param[out] speed_b Velocidad final aplicada al motor B
+ */
+static void drive_differential(double base_a, double base_b, double correction,
+                               int* speed_a, int* speed_b) {
+    *speed_a = (int)battery_compensate(base_a - correction);
+    *speed_b = (int)battery_compensate(base_b + correction);
+    
+    // Limitar velocidades
+    *speed_a = (*speed_a < MIN_SPEED) ? MIN_SPEED : 
+              (*speed_a > MAX_SPEED) ? MAX_SPEED : *speed_a;
+    *speed_b = (*speed_b < MIN_SPEED) ? MIN_SPEED : 
+              (*speed_b > MAX_SPEED) ? MAX_SPEED : *speed_b;
+    
+    motors_set_both_motors(MOTOR_FORWARD, *speed_a, MOTOR_FORWARD, *speed_b);
+}
+
+/**
+ * @brief Escribe en la traza USB el estado de una iteración del bucle de control.
+ * 
+ * @param heading Rumbo medido
+ * @param speed_a PWM pedido al motor A
+ * @param speed_b PWM pedido al motor B
+ * @param gps_data Último dato del GPS
+ * @param mode Modo de navegación (trace_mode_t)
+ * @param holding true si la navegación espera por la calidad del GPS
+ * @param work_us Duración del trabajo de la iteración
+ */
+static void trace_loop(double heading, int speed_a, int speed_b, const gps_data_t* gps_data,
+                       trace_mode_t mode, bool holding, uint32_t work_us) {
+    if (!trace_connected()) return;
+    
+    trace_loop_t loop = {
+        .heading = (float)heading,
+        .setpoint = (float)heading_pid.setpoint,
+        .speed_a = (int16_t)speed_a,
+        .speed_b = (int16_t)speed_b,
+        .lat_e7 = (int32_t)(gps_data->latitude * 1e7),
+        .lng_e7 = (int32_t)(gps_data->longitude * 1e7),
+        .hdop = (float)gps_data->hdop,
+        .fix = gps_data->fix_valid,
+        .satellites = (uint8_t)gps_data->satellites,
+        .mode = (uint8_t)mode,
+        .flags = (timebase_get_status().locked ? 0x01 : 0) | (holding ? 0x02 : 0),
+        .work_us = work_us
+    };
+    trace_write(TRACE_LOOP, &loop, sizeof(loop));
+    
+    motor_status_t a = motors_get_status(MOTOR_A);
+    motor_status_t b = motors_get_status(MOTOR_B);
+    trace_motors_t motors = {
+        .rpm_a = (float)a.rpm,
+        .rpm_b = (float)b.rpm,
+        .current_a = (float)a.current,
+        .current_b = (float)b.current,
+        .pwm_a = (int16_t)a.speed,
+        .pwm_b = (int16_t)b.speed,
+        .pulses_a = a.pulses,
+        .pulses_b = b.pulses
+    };
+    trace_write(TRACE_MOTORS, &motors, sizeof(motors));
 }
 
 /**
@@ -83,7 +240,8 @@ void integration_test(void) {
     printf("Estado de inicialización:\n");
     printf("  Magnetómetro: %s\n", mag_ok ? "✓ OK" : "✗ ERROR");
     printf("  GPS: %s\n", gps_ok ? "✓ OK" : "✗ ERROR");
-    printf("  Bluetooth: %s\n", bt_ok ? "✓ OK" : "✗ ERROR");
+    printf("  Bluetooth: %s (%lu baudios)\n", bt_ok ? "✓ OK" : "✗ ERROR",
+           (unsigned long)bluetooth_get_baud());
     printf("  Motores: %s\n", motors_ok ? "✓ OK" : "✗ ERROR");
     
     if (!mag_ok || !gps_ok || !bt_ok || !motors_ok) {
@@ -91,60 +249,433 @@ void integration_test(void) {
         return;
     }
     
+    // Efemérides, almanaque y posición guardados: arranque caliente o tibio del GPS
+    gps_start_t gps_start = gps_aid_init();
+    printf("  Asistencia GPS: arranque %s (%d efemérides)\n",
+           gps_aid_start_name(gps_start), gps_aid_get_status().ephemerides);
+    
+    // Cargar geocerca guardada en flash
+    if (geofence_init()) {
+        printf("  Geocerca: %d polígono(s) activos\n", geofence_get_polygon_count());
+    } else {
+        printf("  Geocerca: sin configurar\n");
+    }
+    
+    // Medición continua de la batería (la carga inicial se toma en vacío)
+    if (battery_init()) {
+        battery_update(to_ms_since_boot(get_absolute_time()), 0, 0);
+        battery_status_t battery = battery_get_status();
+        if (battery.valid) {
+            printf("  Batería: %.2f V (%.0f%%)\n", battery.voltage, battery.soc);
+        } else {
+            printf("  Batería: sin medición (alimentación USB)\n");
+        }
+    } else {
+        printf("  Batería: ✗ sin canal DMA\n");
+    }
+    
+    // Cargar ruta guardada en flash
+    if (route_load()) {
+        printf("  Ruta: %d punto(s) guardados\n", route_get_count());
+    }
+    
     // Inicializar controladores PID
-    pid_init(&heading_pid, KP_DIR, KI_DIR, KD_DIR, -50.0, 50.0);
+    pid_init_angular(&heading_pid, KP_DIR, KI_DIR, KD_DIR, -50.0, 50.0);
+    pid_set_derivative_filter(&heading_pid, PID_DIR_D_FILTER_TAU);
+    pid_set_setpoint_weights(&heading_pid, PID_DIR_WEIGHT_P, PID_DIR_WEIGHT_D);
     pid_init(&speed_pid_a, KP_RPM, KI_RPM, KD_RPM, MIN_SPEED, MAX_SPEED);
     pid_init(&speed_pid_b, KP_RPM, KI_RPM, KD_RPM, MIN_SPEED, MAX_SPEED);
     
     pid_set_setpoint(&speed_pid_a, BASE_SPEED_A);
     pid_set_setpoint(&speed_pid_b, BASE_SPEED_B);
     
+    // Controladores ajustables desde la app
+    tune_register("HDG", &heading_pid);
+    tune_register("SPA", &speed_pid_a);
+    tune_register("SPB", &speed_pid_b);
+    
+    // Ganancias del rumbo según velocidad y distancia al objetivo
+    schedule_init(&heading_pid);
+    
     printf("\nSistema inicializado correctamente\n");
     printf("Enviando datos por Bluetooth cada segundo...\n");
     printf("Comandos disponibles por Bluetooth:\n");
     printf("  - 'LAT,LNG' para establecer objetivo\n");
     printf("  - 'STOP' para detener navegación\n");
+    printf("  - 'ROUTE_CLEAR' para borrar la ruta\n");
+    printf("  - 'WP,LAT,LNG[,VEL]' para agregar un punto de ruta\n");
+    printf("  - 'ROUTE_GO' para iniciar la ruta cargada, 'ROUTE_SAVE' para guardarla\n");
+    printf("  - 'UPLOAD,ROUTE|FENCE,BYTES,CRC32' para carga por fragmentos\n");
+    printf("  - 'FENCE_CLEAR', 'FENCE_NEW,IN|OUT', 'FENCE_PT,LAT,LNG', 'FENCE_SAVE' para la geocerca\n");
+    printf("  - 'FOLLOW_ON' / 'FOLLOW_OFF' y 'F,LAT,LNG[,T_MS]' para el modo Follow Me\n");
+    printf("  - 'SUB,POSE|NAV|MOT|PERF|EV|BAT,HZ' y 'SUB?' para la telemetría\n");
+    printf("  - 'TUNE,PID,KP,KI,KD', 'TUNE?' y 'STEP,HDG,GRADOS,MS' para ajustar los PID\n");
+    printf("  - 'SCHED,ON|OFF' y 'SCHED?' para la programación de ganancias (OFF antes de TUNE,HDG)\n");
+    printf("  - 'FAULT?' y 'FAULT_CLEAR' para la última falla registrada\n");
+    printf("  - 'MEM?' para el uso de pila por núcleo y de RAM\n");
+    printf("  - 'BT?' para las líneas recibidas y los bytes perdidos del enlace\n");
+    printf("  - 'BUS?' para la frecuencia y los suscriptores de cada tópico del bus\n");
+    printf("  - 'POOL?' para el uso y los agotamientos de los bloques de memoria\n");
+    printf("  - 'TIME,UNIX_S' con la hora del teléfono y 'GPS_AID?' para la asistencia del GPS\n");
     
     // Configurar LED de estado
     gpio_init(LED_PIN);
     gpio_set_dir(LED_PIN, GPIO_OUT);
     
-    char bt_buffer[128];
+    char bt_buffer[BT_LINE_MAX];
     int loop_counter = 0;
     bool navigation_active = false;
+    follow_state_t last_follow_state = FOLLOW_WAITING;
+    bool gps_holding = false;
+    uint64_t last_course_us = 0;
+    
+    // Fix del GPS sin copia: gps_update() lo publica y se lee en su ranura
+    static bus_subscriber_t gps_subscriber;
+    bus_subscribe(&gps_subscriber, BUS_GPS);
+    
+    link_init(to_ms_since_boot(get_absolute_time()));
+    telemetry_init();
+    if (reset_reason != FAULT_NONE) {
+        char event[32];
+        snprintf(event, sizeof(event), "RESET,%s", fault_reason_name(reset_reason));
+        telemetry_event(event);
+    }
+    
+    // Tareas supervisadas: si alguna se cuelga se apagan los motores y se reinicia
+    int task_sensors = fault_register_task("SENS", FAULT_TASK_DEADLINE_MS);
+    int task_bluetooth = fault_register_task("BT", FAULT_TASK_DEADLINE_MS);
+    int task_control = fault_register_task("CTRL", FAULT_TASK_DEADLINE_MS);
     
     while (true) {
+        uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+        uint32_t loop_start_us = time_us_32();
+        int speed_a = 0, speed_b = 0;
+        
         // Leer sensores
         double heading = magnetometer_get_filtered_heading();
         gps_update();
-        gps_data_t gps_data = gps_get_data();
+        const gps_data_t* gps_data = bus_read_gps(&gps_subscriber);
+        gps_quality_t gps_quality = gps_get_quality();
+        // Con geometría pobre se avanza más despacio: cada fix desvía menos el rumbo
+        double fix_scale = GPS_MIN_SPEED_SCALE + (1.0 - GPS_MIN_SPEED_SCALE) * gps_quality.weight;
+        if (gps_data->course_valid && gps_data->course_timestamp_us != last_course_us) {
+            last_course_us = gps_data->course_timestamp_us;
+            magnetometer_learn_bias(gps_data->course_deg, gps_data->speed_mps);
+        }
+        if (gps_aid_update(now_ms)) {
+            char event[40];
+            snprintf(event, sizeof(event), "GPS_TTFF,%.1f,%s\n",
+                     gps_aid_get_status().ttff_ms / 1000.0, gps_aid_start_name(gps_start));
+            bluetooth_send_string(event);
+            telemetry_event(event);
+            printf("Primer fix GPS: %s", event);
+        }
+        fault_checkin(task_sensors);
         
-        // Procesar comandos Bluetooth
-        int bt_bytes = bluetooth_read_line(bt_buffer, sizeof(bt_buffer));
-        if (bt_bytes > 0) {
+        // Procesar comandos Bluetooth (varias líneas por iteración)
+        int bt_lines = 0;
+        while (bt_lines++ < BT_MAX_LINES_PER_LOOP &&
+               bluetooth_read_line(bt_buffer, sizeof(bt_buffer)) > 0) {
+            if (link_handle_line(bt_buffer, now_ms) ||
+                telemetry_handle_command(bt_buffer) ||
+                upload_handle_line(bt_buffer, now_ms) ||
+                tune_handle_command(bt_buffer) ||
+                schedule_handle_command(bt_buffer) ||
+                gps_aid_handle_command(bt_buffer) ||
+                fault_handle_command(bt_buffer) ||
+                memory_handle_command(bt_buffer) ||
+                bluetooth_handle_command(bt_buffer) ||
+                bus_handle_command(bt_buffer) ||
+                pool_handle_command(bt_buffer)) {
+                continue;
+            }
+            
             printf("BT << %s\n", bt_buffer);
             
             if (strcmp(bt_buffer, "STOP") == 0) {
                 navigation_active = false;
+                route_stop();
+                follow_stop();
+                tune_step_abort();
                 motors_stop_all();
                 bluetooth_send_string("Navegación detenida\n");
                 printf("Navegación manual detenida\n");
+            } else if (strcmp(bt_buffer, "ROUTE_CLEAR") == 0) {
+                route_clear();
+                bluetooth_send_string("Ruta borrada\n");
+            } else if (strncmp(bt_buffer, "WP,", 3) == 0) {
+                double lat, lng, speed;
+                if (!bluetooth_parse_waypoint(bt_buffer, &lat, &lng, &speed)) {
+                    bluetooth_send_string("Formato inválido. Usar: WP,LAT,LNG[,VEL]\n");
+                } else if (!geofence_contains(lat, lng)) {
+                    bluetooth_send_string("Punto fuera de la geocerca\n");
+                } else if (route_add_waypoint(lat, lng, speed)) {
+                    char reply[48];
+                    snprintf(reply, sizeof(reply), "Punto %d/%d agregado\n",
+                             route_get_count(), ROUTE_MAX_WAYPOINTS);
+                    bluetooth_send_string(reply);
+                } else {
+                    bluetooth_send_string("Ruta llena\n");
+                }
+            } else if (strcmp(bt_buffer, "ROUTE_SAVE") == 0) {
+                bluetooth_send_string(route_save() ? "Ruta guardada\n" : "Error al guardar la ruta\n");
+            } else if (strcmp(bt_buffer, "ROUTE_GO") == 0) {
+                if (!route_within_fence()) {
+                    bluetooth_send_string("Ruta fuera de la geocerca\n");
+                } else if (gps_data->fix_valid && route_start(gps_data->latitude, gps_data->longitude)) {
+                    follow_stop();
+                    navigation_active = true;
+                    pid_reset(&heading_pid);
+                    mpc_reset();
+                    printf("Ruta iniciada con %d puntos\n", route_get_count());
+                    bluetooth_send_string("Ruta iniciada\n");
+                } else {
+                    bluetooth_send_string("Sin fix GPS o ruta vacía\n");
+                }
+            } else if (strcmp(bt_buffer, "FOLLOW_ON") == 0) {
+                route_stop();
+                follow_start();
+                navigation_active = true;
+                last_follow_state = FOLLOW_WAITING;
+                pid_reset(&heading_pid);
+                printf("Modo Follow Me activado\n");
+                bluetooth_send_string("Follow Me activado\n");
+            } else if (strcmp(bt_buffer, "FOLLOW_OFF") == 0) {
+                follow_stop();
+                navigation_active = false;
+                motors_stop_all();
+                bluetooth_send_string("Follow Me desactivado\n");
+            } else if (strncmp(bt_buffer, "F,", 2) == 0) {
+                double lat, lng;
+                uint32_t phone_ms;
+                if (bluetooth_parse_follow(bt_buffer, &lat, &lng, &phone_ms)) {
+                    follow_feed(lat, lng, phone_ms, now_ms);
+                }
+            } else if (strcmp(bt_buffer, "FENCE_CLEAR") == 0) {
+                geofence_clear();
+                bluetooth_send_string("Geocerca en edición borrada\n");
+            } else if (strncmp(bt_buffer, "FENCE_NEW,", 10) == 0) {
+                bool keep_out = (strcmp(bt_buffer + 10, "OUT") == 0);
+                bluetooth_send_string(geofence_begin_polygon(keep_out) ?
+                                      "Polígono iniciado\n" : "Máximo de polígonos alcanzado\n");
+            } else if (strncmp(bt_buffer, "FENCE_PT,", 9) == 0) {
+                double lat, lng;
+                bool ok = bluetooth_parse_coordinates(bt_buffer + 9, &lat, &lng) &&
+                          geofence_add_point(lat, lng);
+                bluetooth_send_string(ok ? "Vértice agregado\n" : "Vértice inválido\n");
+            } else if (strcmp(bt_buffer, "FENCE_SAVE") == 0) {
+                if (geofence_save()) {
+                    printf("Geocerca guardada: %d polígono(s)\n", geofence_get_polygon_count());
+                    bluetooth_send_string("Geocerca guardada\n");
+                } else {
+                    bluetooth_send_string("Geocerca inválida\n");
+                }
             } else {
                 double lat, lng;
-                if (bluetooth_parse_coordinates(bt_buffer, &lat, &lng)) {
+                if (!bluetooth_parse_coordinates(bt_buffer, &lat, &lng)) {
+                    bluetooth_send_string("Formato inválido. Usar: LAT,LNG\n");
+                } else if (!geofence_contains(lat, lng)) {
+                    printf("Objetivo rechazado (fuera de geocerca): %.6f, %.6f\n", lat, lng);
+                    bluetooth_send_string("Objetivo fuera de la geocerca\n");
+                } else {
+                    route_stop();
+                    follow_stop();
                     gps_set_target(lat, lng);
                     navigation_active = true;
                     pid_reset(&heading_pid);
                     printf("Nuevo objetivo: %.6f, %.6f\n", lat, lng);
                     bluetooth_send_string("Objetivo establecido\n");
-                } else {
-                    bluetooth_send_string("Formato inválido. Usar: LAT,LNG\n");
                 }
             }
         }
+        fault_checkin(task_bluetooth);
+        
+        // Confirmación acumulada de la carga en curso
+        upload_update(now_ms);
+        
+        // La asistencia GPS y el desvío de la brújula se escriben en flash solo con el robot detenido
+        if (!navigation_active && !follow_is_active() && !tune_step_controller()) {
+            if (!gps_aid_save()) magnetometer_save_bias();
+        }
+        
+        // La prueba de escalón solo se ejecuta sobre el rumbo con el robot libre
+        pid_controller_t* step_pid = tune_step_controller();
+        if (step_pid && step_pid != &heading_pid) {
+            tune_step_abort();
+            bluetooth_send_string("STEPERR,SIN_MEDICION\n");
+        } else if (step_pid && navigation_active) {
+            tune_step_abort();
+            bluetooth_send_string("STEPERR,NAVEGANDO\n");
+        }
+        
+        // Parada de seguridad por pérdida del enlace Bluetooth
+        if (link_update(now_ms)) {
+            printf("Enlace Bluetooth perdido (%d s sin señal)\n", LINK_TIMEOUT_MS / 1000);
+            telemetry_event("LINK_LOST");
+            
+            if (tune_step_controller()) {
+                tune_step_abort();
+                motors_stop_all();
+            }
+            
+            if (navigation_active && (follow_is_active() || LINK_FAILSAFE_AUTONOMOUS)) {
+                navigation_active = false;
+                route_stop();
+                follow_stop();
+                motors_stop_all();
+                printf("Parada de seguridad: navegación detenida\n");
+            }
+        }
+        
+        // Parada controlada si el robot sale de la geocerca
+        if (navigation_active && gps_data->fix_valid &&
+            !geofence_contains(gps_data->latitude, gps_data->longitude)) {
+            navigation_active = false;
+            route_stop();
+            follow_stop();
+            motors_stop_all();
+            bluetooth_send_string("GEOFENCE: fuera de zona, navegación detenida\n");
+            telemetry_event("GEOFENCE_EXIT");
+            printf("¡Salida de la geocerca! Posición: %.6f, %.6f\n",
+                   gps_data->latitude, gps_data->longitude);
+        }
+        
+        // Rueda bloqueada (bordillo u obstáculo): el motor ya quedó recortado
+        uint8_t stalled = motors_update(now_ms);
+        if (stalled) {
+            char reply[32];
+            snprintf(reply, sizeof(reply), "OBSTACULO,%s%s\n",
+                     (stalled & 1) ? "A" : "", (stalled & 2) ? "B" : "");
+            bluetooth_send_string(reply);
+            telemetry_event(reply);
+            printf("¡Rueda bloqueada! %s", reply);
+            
+            if (navigation_active || tune_step_controller()) {
+                navigation_active = false;
+                route_stop();
+                follow_stop();
+                tune_step_abort();
+                motors_stop_all();
+                bluetooth_send_string("Destino inalcanzable: navegación detenida\n");
+            }
+        }
+        
+        // Parada por batería baja (requisito: no navegar bajo BATTERY_STOP_SOC)
+        if (navigation_active && battery_is_low()) {
+            navigation_active = false;
+            route_stop();
+            follow_stop();
+            motors_stop_all();
+            bluetooth_send_string("BATERIA: carga baja, navegación detenida\n");
+            telemetry_event("BATTERY_LOW");
+            printf("¡Batería baja! %.2f V\n", battery_get_status().voltage);
+        }
+        
+        // Datos de navegación por defecto: objetivo único (si existe)
+        target_data_t target = gps_get_target();
+        telemetry_set_nav(target.target_set, target.latitude, target.longitude,
+                          gps_distance_to_target(), gps_bearing_to_target());
         
         // Control de navegación autónoma
-        if (navigation_active && gps_data.fix_valid && gps_has_target()) {
+        bool was_holding = gps_holding;
+        gps_holding = false;
+        if (tune_step_controller() == &heading_pid) {
+            double setpoint = tune_step_setpoint(heading);
+            pid_set_setpoint(&heading_pid, setpoint);
+            double heading_correction = pid_compute(&heading_pid, heading);
+            
+            drive_differential(BASE_SPEED_A, BASE_SPEED_B, heading_correction,
+                               &speed_a, &speed_b);
+            
+            if (!tune_step_record(setpoint, heading, heading_correction, time_us_32())) {
+                motors_stop_all();
+                speed_a = speed_b = 0;
+                printf("Prueba de escalón completada\n");
+            }
+        } else if (navigation_active && follow_is_active()) {
+            follow_command_t follow_cmd = { .state = last_follow_state };
+            
+            if (gps_data->fix_valid) {
+                follow_update(gps_data->latitude, gps_data->longitude, now_ms, &follow_cmd);
+            }
+            
+            // Notificar cambios de estado (usuario alcanzado, señal perdida...)
+            if (follow_cmd.state != last_follow_state) {
+                char reply[48];
+                snprintf(reply, sizeof(reply), "FOLLOW,%s\n", follow_state_name(follow_cmd.state));
+                bluetooth_send_string(reply);
+                telemetry_event(reply);
+                printf("Follow Me: %s\n", follow_state_name(follow_cmd.state));
+                last_follow_state = follow_cmd.state;
+            }
+            
+            if (follow_cmd.drive) {
+                schedule_update(follow_cmd.distance);
+                pid_set_setpoint(&heading_pid, follow_cmd.bearing);
+                double heading_correction = pid_compute(&heading_pid, heading);
+                
+                drive_differential(BASE_SPEED_A * follow_cmd.speed_scale,
+                                   BASE_SPEED_B * follow_cmd.speed_scale,
+                                   heading_correction, &speed_a, &speed_b);
+                
+                printf("Follow: H=%.1f° T=%.1f° D=%.1fm V=%.2fm/s SpA=%d SpB=%d\n",
+                       heading, follow_cmd.bearing, follow_cmd.distance,
+                       follow_cmd.user_speed, speed_a, speed_b);
+            } else {
+                motors_stop_all();
+            }
+        } else if (navigation_active && gps_data->fix_valid && gps_quality.hold &&
+                   (route_is_active() || gps_has_target())) {
+            // Geometría demasiado pobre: esperar quieto en lugar de perseguir el ruido
+            motors_stop_all();
+            gps_holding = true;
+            if (!was_holding) {
+                char reply[40];
+                snprintf(reply, sizeof(reply), "GPS_HOLD,%.1f\n", gps_quality.error_m);
+                bluetooth_send_string(reply);
+                telemetry_event(reply);
+                printf("GPS con error de %.1f m: navegación en espera\n", gps_quality.error_m);
+            }
+        } else if (navigation_active && gps_data->fix_valid && route_is_active()) {
+            route_command_t route_cmd;
+            route_update(gps_data->latitude, gps_data->longitude, heading, &route_cmd);
+            
+            if (route_cmd.finished) {
+                navigation_active = false;
+                motors_stop_all();
+                bluetooth_send_string("Ruta completada!\n");
+                telemetry_event("ROUTE_DONE");
+                printf("¡Ruta completada!\n");
+            } else {
+                route_cmd.speed_scale *= fix_scale;
+                double base_a = BASE_SPEED_A * route_cmd.speed_scale;
+                double base_b = BASE_SPEED_B * route_cmd.speed_scale;
+#if NAV_USE_MPC
+                // MPC: rumbo de la trayectoria a lo largo del horizonte
+                double speed_mps = NOMINAL_SPEED_MPS * route_cmd.speed_scale;
+                double path_headings[MPC_HORIZON + 1];
+                route_preview(speed_mps * MPC_STEP_S, MPC_HORIZON + 1, path_headings);
+                double heading_correction = mpc_compute(route_cmd.cross_track, heading,
+                                                        speed_mps, path_headings);
+#else
+                // Pure pursuit: curvatura -> diferencia de velocidad entre ruedas
+                double heading_correction = route_cmd.curvature * (WHEEL_TRACK_M / 2.0) *
+                                            (base_a + base_b) / 2.0;
+#endif
+                
+                drive_differential(base_a, base_b, heading_correction, &speed_a, &speed_b);
+                
+                route_waypoint_t destination;
+                if (route_get_waypoint(route_get_count() - 1, &destination)) {
+                    telemetry_set_nav(true, destination.latitude, destination.longitude,
+                                      route_cmd.distance_to_end, route_cmd.lookahead_bearing);
+                }
+                
+                printf("Ruta: H=%.1f° L=%.1f° Seg=%d D=%.1fm SpA=%d SpB=%d\n", 
+                       heading, route_cmd.lookahead_bearing, route_cmd.segment,
+                       route_cmd.distance_to_end, speed_a, speed_b);
+            }
+        } else if (navigation_active && gps_data->fix_valid && gps_has_target()) {
             double target_bearing = gps_bearing_to_target();
             double distance = gps_distance_to_target();
             
@@ -152,53 +683,62 @@ void integration_test(void) {
                 navigation_active = false;
                 motors_stop_all();
                 bluetooth_send_string("Objetivo alcanzado!\n");
+                telemetry_event("TARGET_REACHED");
                 printf("¡Objetivo alcanzado!\n");
+            } else if (gps_target_holding()) {
+                // Dentro del radio de llegada: confirmar quieto, sin rodear el objetivo
+                motors_stop_all();
             } else {
                 // Calcular corrección de rumbo
+                schedule_update(distance);
                 pid_set_setpoint(&heading_pid, target_bearing);
                 double heading_correction = pid_compute(&heading_pid, heading);
                 
                 // Aplicar corrección diferencial a los motores
-                int speed_a = BASE_SPEED_A - (int)heading_correction;
-                int speed_b = BASE_SPEED_B + (int)heading_correction;
-                
-                // Limitar velocidades
-                speed_a = (speed_a < MIN_SPEED) ? MIN_SPEED : 
-                         (speed_a > MAX_SPEED) ? MAX_SPEED : speed_a;
-                speed_b = (speed_b < MIN_SPEED) ? MIN_SPEED : 
-                         (speed_b > MAX_SPEED) ? MAX_SPEED : speed_b;
-                
-                motors_set_both_motors(MOTOR_FORWARD, speed_a, MOTOR_FORWARD, speed_b);
+                drive_differential(BASE_SPEED_A * fix_scale, BASE_SPEED_B * fix_scale,
+                                   (int)heading_correction, &speed_a, &speed_b);
                 
                 printf("Nav: H=%.1f° T=%.1f° D=%.1fm SpA=%d SpB=%d\n", 
                        heading, target_bearing, distance, speed_a, speed_b);
             }
         }
         
-        // Enviar estado por Bluetooth (cada segundo)
+        // Telemetría según las suscripciones de la app
+        telemetry_set_pose(gps_data->latitude, gps_data->longitude, heading,
+                           gps_data->fix_valid, gps_data->satellites);
+        telemetry_set_motors(speed_a, speed_b);
+        battery_update(now_ms, speed_a, speed_b);
+        battery_status_t battery = battery_get_status();
+        telemetry_set_battery(battery.valid, battery.voltage, battery.soc, battery.runtime_min);
+        telemetry_update(now_ms);
+        tune_update();
+        
+        // Estado local (cada segundo)
         if (++loop_counter >= 20) { // 50ms * 20 = 1 segundo
             gpio_put(LED_PIN, !gpio_get(LED_PIN)); // Parpadear LED
             
-            if (gps_has_target() && gps_data.fix_valid) {
-                double distance = gps_distance_to_target();
-                double bearing = gps_bearing_to_target();
-                
-                bluetooth_send_navigation_info(
-                    gps_data.latitude, gps_data.longitude,
-                    0, 0, // Las coordenadas objetivo se guardarían por separado
-                    distance, bearing
-                );
-            } else {
-                bluetooth_send_status(heading, 0, 0, gps_data.fix_valid);
-            }
+            link_send_report(now_ms);
+            link_stats_t link = link_get_stats(now_ms);
             
-            printf("Estado: H=%.1f° GPS=%s Sats=%d Nav=%s\n",
-                   heading, gps_data.fix_valid ? "OK" : "NO", 
-                   gps_data.satellites, navigation_active ? "SI" : "NO");
+            printf("Estado: H=%.1f° GPS=%s Sats=%d HDOP=%.1f PPS=%s Nav=%s BT=%s RTT=%lums Bat=%.1fV/%.0f%%\n",
+                   heading, gps_data->fix_valid ? "OK" : "NO", 
+                   gps_data->satellites, gps_data->hdop, timebase_get_status().locked ? "OK" : "NO",
+                   navigation_active ? "SI" : "NO",
+                   link.alive ? "OK" : "NO", (unsigned long)link.srtt_ms,
+                   battery.voltage, battery.soc);
             
             loop_counter = 0;
         }
         
+        trace_mode_t trace_mode = (tune_step_controller() == &heading_pid) ? TRACE_MODE_STEP :
+                                  !navigation_active ? TRACE_MODE_IDLE :
+                                  follow_is_active() ? TRACE_MODE_FOLLOW :
+                                  route_is_active() ? TRACE_MODE_ROUTE : TRACE_MODE_TARGET;
+        trace_loop(heading, speed_a, speed_b, gps_data, trace_mode, gps_holding,
+                   time_us_32() - loop_start_us);
+        
+        telemetry_record_loop(time_us_32() - loop_start_us);
+        fault_checkin(task_control);
         sleep_ms(LOOP_INTERVAL_MS);
     }
 }
@@ -212,8 +752,15 @@ void integration_test(void) {
  * @return 0 si el programa termina correctamente
  */
 int main(void) {
-    // Inicializar comunicación serie
+    // Motores apagados y watchdog en marcha antes de cualquier espera
+    reset_reason = fault_init();
+    memory_init();
+    bus_init();
+    pool_init();
+    
+    // Inicializar comunicación serie (printf y scanf por la traza USB)
     stdio_init_all();
+    trace_init();
     
     // Esperar conexión serial
     sleep_ms(2000);
@@ -223,6 +770,14 @@ int main(void) {
     printf("  Raspberry Pi Pico - Versión 1.0   \n");
     printf("=====================================\n");
     
+    if (reset_reason != FAULT_NONE) {
+        fault_record_t record;
+        fault_get_last(&record);
+        printf("⚠️  Reinicio por falla: %s%s%s (FAULT? para el detalle)\n",
+               fault_reason_name(reset_reason),
+               record.task[0] ? ", tarea " : "", record.task);
+    }
+    
     while (true) {
         print_menu();
         
@@ -257,8 +812,72 @@ int main(void) {
                 integration_test();
                 break;
                 
+            case TEST_ROUTE:
+                route_test();
+                break;
+                
+            case TEST_GEOFENCE:
+                geofence_test();
+                break;
+                
+            case TEST_FOLLOW:
+                follow_test();
+                break;
+                
+            case TEST_LINK:
+                link_test();
+                break;
+                
+            case TEST_TELEMETRY:
+                telemetry_test();
+                break;
+                
+            case TEST_UPLOAD:
+                upload_test();
+                break;
+                
+            case TEST_TUNE:
+                tune_test();
+                break;
+                
+            case TEST_SCHEDULE:
+                schedule_test();
+                break;
+                
+            case TEST_MPC:
+                mpc_test();
+                break;
+                
+            case TEST_BATTERY:
+                battery_test();
+                break;
+                
+            case TEST_FAULT:
+                fault_test();
+                break;
+                
+            case TEST_MEMORY:
+                memory_test();
+                break;
+                
+            case TEST_TIMEBASE:
+                timebase_test();
+                break;
+                
+            case TEST_TRACE:
+                trace_test();
+                break;
+                
+            case TEST_BUS:
+                bus_test();
+                break;
+                
+            case TEST_POOL:
+                pool_test();
+                break;
+                
             default:
-                printf("⚠️  Opción inválida. Selecciona 1-6.\n");
+                printf("⚠️  Opción inválida. Selecciona 1-22.\n");
                 break;
         }
         
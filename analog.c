@@ -0,0 +1,117 @@
+/**
+ * @file analog.c
+ * @brief Implementación del muestreo analógico sincronizado con el PWM.
+ *
+ * Canal de disparo: pacing por la señal de fin de ciclo (wrap) del slice
+ * PWM de los motores; en cada ciclo escribe START_ONCE en el alias de
+ * escritura con bits en 1 del registro CS del ADC, que conserva la
+ * selección de entrada y deja avanzar la rueda. Con el PWM en fase
+ * correcta el fin de ciclo es el centro del pulso, así que la corriente se
+ * mide con el transistor conduciendo y lejos de las conmutaciones.
+ *
+ * Canal de captura: pacing por el FIFO del ADC, escritura en anillo sobre
+ * un buffer alineado a su tamaño. Como ANALOG_DMA_SAMPLES es múltiplo de
+ * ANALOG_INPUTS cada posición del buffer corresponde siempre a la misma
+ * entrada.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "analog.h"
+#include "config.h"
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+#include "hardware/pwm.h"
+
+/// @brief Buffer circular de muestras que llena el DMA
+static uint16_t samples[ANALOG_DMA_SAMPLES]
+    __attribute__((aligned(ANALOG_DMA_SAMPLES * sizeof(uint16_t))));
+
+/// @brief Valor escrito en ADC CS en cada ciclo del PWM
+static const uint32_t start_command = ADC_CS_START_ONCE_BITS;
+
+/// @brief Canales DMA de disparo y captura (-1 sin inicializar)
+static int trigger_channel = -1;
+static int capture_channel = -1;
+
+/**
+ * @brief Mantiene un canal DMA en marcha (el conteo de transferencias es finito).
+ */
+static void keep_running(int channel) {
+    if (!dma_channel_is_busy(channel)) {
+        dma_channel_set_trans_count(channel, UINT32_MAX, true);
+    }
+}
+
+bool analog_init(void) {
+    if (capture_channel >= 0) return true;
+
+    trigger_channel = dma_claim_unused_channel(false);
+    capture_channel = dma_claim_unused_channel(false);
+    if (trigger_channel < 0 || capture_channel < 0) {
+        if (trigger_channel >= 0) dma_channel_unclaim(trigger_channel);
+        if (capture_channel >= 0) dma_channel_unclaim(capture_channel);
+        trigger_channel = capture_channel = -1;
+        return false;
+    }
+
+    adc_init();
+    adc_gpio_init(BATTERY_ADC_PIN);
+    adc_gpio_init(MOTOR_SENSE_A_PIN);
+    adc_gpio_init(MOTOR_SENSE_B_PIN);
+    adc_select_input(0);
+    adc_set_round_robin((1u << ANALOG_INPUTS) - 1);
+    adc_fifo_setup(true, true, 1, false, false);
+    adc_fifo_drain();
+
+    // Captura: FIFO del ADC -> buffer en anillo (log2 de bytes)
+    uint ring_bits = 0;
+    while ((1u << ring_bits) < sizeof(samples)) ring_bits++;
+
+    dma_channel_config config = dma_channel_get_default_config(capture_channel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_16);
+    channel_config_set_read_increment(&config, false);
+    channel_config_set_write_increment(&config, true);
+    channel_config_set_ring(&config, true, ring_bits);
+    channel_config_set_dreq(&config, DREQ_ADC);
+    dma_channel_configure(capture_channel, &config, samples, &adc_hw->fifo, UINT32_MAX, true);
+
+    // Disparo: fin de ciclo del PWM de los motores -> START_ONCE
+    config = dma_channel_get_default_config(trigger_channel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_32);
+    channel_config_set_read_increment(&config, false);
+    channel_config_set_write_increment(&config, false);
+    channel_config_set_dreq(&config, pwm_get_dreq(pwm_gpio_to_slice_num(MOTOR_ENA_PIN)));
+    dma_channel_configure(trigger_channel, &config, hw_set_alias(&adc_hw->cs),
+                          &start_command, UINT32_MAX, true);
+
+    return true;
+}
+
+double analog_read(uint input, int count) {
+    if (capture_channel < 0 || input >= ANALOG_INPUTS) return 0.0;
+
+    keep_running(trigger_channel);
+    keep_running(capture_channel);
+
+    if (count <= 0 || count > ANALOG_DMA_SAMPLES / ANALOG_INPUTS) {
+        count = ANALOG_DMA_SAMPLES / ANALOG_INPUTS;
+    }
+
+    // Última muestra escrita y, hacia atrás, la última de esta entrada
+    uintptr_t write_addr = dma_channel_hw_addr(capture_channel)->write_addr;
+    int newest = ((int)((write_addr - (uintptr_t)samples) / sizeof(uint16_t)) - 1) &
+                 (ANALOG_DMA_SAMPLES - 1);
+    int index = (newest - ((newest - (int)input) & (ANALOG_INPUTS - 1))) &
+                (ANALOG_DMA_SAMPLES - 1);
+
+    uint32_t sum = 0;
+    for (int i = 0; i < count; i++) {
+        sum += samples[index] & 0x0FFF;
+        index = (index - ANALOG_INPUTS) & (ANALOG_DMA_SAMPLES - 1);
+    }
+
+    return sum / (double)count * ANALOG_VREF / 4096.0;
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+/**
+ * @file analog.h
+ * @brief Header del muestreo analógico sincronizado con el PWM.
+ *
+ * El ADC recorre en rueda las entradas 0 a ANALOG_INPUTS-1 (batería y
+ * corriente de cada motor) y cada conversión la dispara el final de un
+ * ciclo del PWM de los motores, por DMA y sin intervención de la CPU.
+ * Otro canal DMA copia los resultados a un buffer circular, donde la
+ * muestra i corresponde a la entrada i % ANALOG_INPUTS.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef ANALOG_H
+#define ANALOG_H
+
+#include "pico/stdlib.h"
+#include <stdint.h>
+
+/// @defgroup ANALOG_FUNCTIONS Funciones del muestreo analógico
+/// @{
+
+/**
+ * @brief Configura el ADC y los dos canales DMA.
+ *
+ * Las conversiones empiezan cuando el PWM de los motores está en marcha
+ * (motors_init()). Llamadas repetidas no hacen nada.
+ *
+ * @return true si se pudieron reservar los canales DMA
+ */
+bool analog_init(void);
+
+/**
+ * @brief Promedia las muestras más recientes de una entrada.
+ *
+ * @param input Entrada del ADC (0 a ANALOG_INPUTS-1)
+ * @param count Muestras a promediar (0 = todas las del buffer)
+ * @return Tensión en el pin en voltios (0 sin inicializar)
+ */
+double analog_read(uint input, int count);
+
+/// @}
+
+#endif // ANALOG_H
\ No newline at end of file
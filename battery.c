@@ -0,0 +1,260 @@
+/**
+ * @file battery.c
+ * @brief Implementación del monitoreo de la batería.
+ *
+ * La tensión se toma del muestreo sincronizado con el PWM (analog.c):
+ * promediar todas las muestras de la entrada de batería en el buffer
+ * reduce el ruido de conmutación de los motores y agrega resolución por
+ * sobremuestreo.
+ *
+ * El estado de carga se integra con la corriente estimada (conteo de
+ * carga) y se corrige lentamente hacia el valor de la curva de tensión en
+ * vacío, compensando la caída en la resistencia interna. Solo con la
+ * tensión, la carga leída bajaría con cada aceleración; solo con el
+ * conteo, el error del modelo de corriente se acumularía.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "battery.h"
+#include "analog.h"
+#include "motors.h"
+#include "config.h"
+#include <stdio.h>
+#include <math.h>
+
+/// @brief Constante de tiempo del filtro de tensión en segundos
+#define VOLTAGE_TAU_S 0.5
+
+/// @brief Constante de tiempo del promedio de corriente para el tiempo restante
+#define CURRENT_TAU_S 120.0
+
+/// @brief Tensión por celda por debajo de la cual no hay batería conectada
+#define CELL_MIN_PRESENT_V 2.5
+
+/// @brief Puntos de la curva de descarga
+#define OCV_POINTS 11
+
+/// @brief Tensión en vacío por celda LiPo cada 10% de carga (0% a 100%)
+static const double ocv_table[OCV_POINTS] = {
+    3.27, 3.69, 3.73, 3.77, 3.80, 3.84, 3.87, 3.95, 4.02, 4.11, 4.20
+};
+
+/// @brief true si el muestreo analógico está configurado
+static bool sampling = false;
+
+/// @brief Estado estimado y momento de la última actualización
+static battery_status_t status;
+static uint32_t last_update_ms = 0;
+
+/**
+ * @brief Estado de carga según la tensión en vacío de una celda.
+ *
+ * @param cell_voltage Tensión por celda en V
+ * @return Carga en % (0-100)
+ */
+static double ocv_to_soc(double cell_voltage) {
+    if (cell_voltage <= ocv_table[0]) return 0.0;
+    if (cell_voltage >= ocv_table[OCV_POINTS - 1]) return 100.0;
+
+    int i = 0;
+    while (cell_voltage > ocv_table[i + 1]) i++;
+
+    double fraction = (cell_voltage - ocv_table[i]) / (ocv_table[i + 1] - ocv_table[i]);
+    return (i + fraction) * 100.0 / (OCV_POINTS - 1);
+}
+
+/**
+ * @brief Tensión en vacío de una celda para un estado de carga.
+ *
+ * Inversa de ocv_to_soc(); la usa el modelo de la prueba.
+ */
+static double soc_to_ocv(double soc) {
+    double position = soc / 100.0 * (OCV_POINTS - 1);
+    if (position <= 0.0) return ocv_table[0];
+    if (position >= OCV_POINTS - 1) return ocv_table[OCV_POINTS - 1];
+
+    int i = (int)position;
+    return ocv_table[i] + (position - i) * (ocv_table[i + 1] - ocv_table[i]);
+}
+
+/**
+ * @brief Estado de carga según la tensión en bornes y la corriente.
+ */
+static double voltage_soc(double voltage, double current) {
+    return ocv_to_soc((voltage + current * BATTERY_INTERNAL_RESISTANCE) / BATTERY_CELLS);
+}
+
+/**
+ * @brief Factor de compensación del PWM para una tensión.
+ */
+static double compensation_factor(double voltage) {
+    double factor = BATTERY_NOMINAL_V / voltage;
+    if (factor < BATTERY_COMP_MIN) return BATTERY_COMP_MIN;
+    if (factor > BATTERY_COMP_MAX) return BATTERY_COMP_MAX;
+    return factor;
+}
+
+/**
+ * @brief Avanza el estimador con una medición.
+ *
+ * @param state Estado a actualizar
+ * @param voltage Tensión en bornes en V
+ * @param current Corriente estimada en A
+ * @param dt_s Tiempo desde la medición anterior en segundos
+ */
+static void battery_estimate(battery_status_t* state, double voltage, double current, double dt_s) {
+    if (!state->valid) {
+        state->voltage = voltage;
+        state->current = current;
+        state->soc = voltage_soc(voltage, current);
+        state->valid = true;
+    } else if (dt_s > 0.0) {
+        state->voltage += (voltage - state->voltage) * dt_s / (VOLTAGE_TAU_S + dt_s);
+        state->current += (current - state->current) * dt_s / (CURRENT_TAU_S + dt_s);
+
+        // Conteo de carga
+        state->soc -= current * dt_s / 3600.0 / (BATTERY_CAPACITY_MAH / 1000.0) * 100.0;
+
+        // Corrección lenta hacia la curva de tensión en vacío
+        double gain = BATTERY_VOLTAGE_GAIN * dt_s;
+        if (gain > 1.0) gain = 1.0;
+        state->soc += (voltage_soc(voltage, current) - state->soc) * gain;
+    }
+
+    if (state->soc < 0.0) state->soc = 0.0;
+    if (state->soc > 100.0) state->soc = 100.0;
+
+    double usable_ah = (state->soc - BATTERY_STOP_SOC) / 100.0 * (BATTERY_CAPACITY_MAH / 1000.0);
+    state->runtime_min = (usable_ah > 0.0 && state->current > 0.0)
+        ? usable_ah / state->current * 60.0 : 0.0;
+
+    if (state->soc < BATTERY_STOP_SOC) {
+        state->low = true;
+    }
+}
+
+bool battery_init(void) {
+    status = (battery_status_t){0};
+
+    sampling = analog_init();
+    if (!sampling) return false;
+
+    // Esperar a que el buffer tenga una vuelta completa de muestras
+    sleep_ms(ANALOG_DMA_SAMPLES * 1000 / MOTOR_PWM_FREQ_HZ + 1);
+    return true;
+}
+
+void battery_update(uint32_t now_ms, int speed_a, int speed_b) {
+    if (!sampling) return;
+
+    double voltage = analog_read(BATTERY_ADC_INPUT, 0) * BATTERY_DIVIDER_RATIO;
+
+    // Alimentado por USB: sin batería no hay estimación ni parada
+    if (voltage < BATTERY_CELLS * CELL_MIN_PRESENT_V) {
+        status.valid = false;
+        status.voltage = voltage;
+        return;
+    }
+
+    double duty = (speed_a + speed_b) / (2.0 * MAX_SPEED);
+    double current = BATTERY_IDLE_CURRENT_A + BATTERY_MOTOR_CURRENT_A * duty;
+    double dt_s = status.valid ? (now_ms - last_update_ms) / 1000.0 : 0.0;
+    last_update_ms = now_ms;
+
+    battery_estimate(&status, voltage, current, dt_s);
+}
+
+battery_status_t battery_get_status(void) {
+    return status;
+}
+
+bool battery_is_low(void) {
+    return status.valid && status.low;
+}
+
+double battery_compensate(double pwm) {
+    return status.valid ? pwm * compensation_factor(status.voltage) : pwm;
+}
+
+void battery_test(void) {
+    printf("=== PRUEBA BATERÍA ===\n");
+
+    // Las conversiones las dispara el PWM de los motores (detenidos)
+    if (motors_init() && battery_init()) {
+        battery_update(to_ms_since_boot(get_absolute_time()), 0, 0);
+        if (status.valid) {
+            printf("Medición: %.2f V, carga %.0f%%\n", status.voltage, status.soc);
+        } else {
+            printf("Medición: %.2f V (sin batería, alimentación USB)\n", status.voltage);
+        }
+    } else {
+        printf("ERROR: no se pudo iniciar el muestreo\n");
+    }
+
+    // Descarga simulada: 3 min de marcha y 1 min detenido. El paquete real
+    // tiene 5% menos capacidad y los motores consumen 15% más que el modelo.
+    printf("\nDescarga simulada (marcha 3 min / parada 1 min, PWM medio 70%%)\n");
+    printf("t[min]\tV\tReal\tSolo V\tEstim.\tRestante\n");
+
+    battery_status_t estimate = {0};
+    const double true_capacity_ah = BATTERY_CAPACITY_MAH / 1000.0 * 0.95;
+    double true_soc = 95.0;
+    double naive_soc = 100.0;
+    uint32_t seed = 12345;
+    int true_low_s = -1, estimate_low_s = -1, naive_low_s = -1;
+    double predicted_min = -1.0;
+    int half_s = -1;
+
+    for (int t = 0; t < 4 * 3600 && true_low_s < 0; t++) {
+        bool driving = (t % 240) < 180;
+        double duty = driving ? 0.7 : 0.0;
+        double model_current = BATTERY_IDLE_CURRENT_A + BATTERY_MOTOR_CURRENT_A * duty;
+        double true_current = BATTERY_IDLE_CURRENT_A + BATTERY_MOTOR_CURRENT_A * 1.15 * duty;
+
+        true_soc -= true_current / 3600.0 / true_capacity_ah * 100.0;
+
+        // Tensión en bornes con ruido de conmutación de +-30 mV
+        seed = seed * 1664525u + 1013904223u;
+        double noise = ((seed >> 8) / 16777216.0 - 0.5) * 0.06;
+        double voltage = soc_to_ocv(true_soc) * BATTERY_CELLS -
+                         true_current * BATTERY_INTERNAL_RESISTANCE + noise;
+
+        battery_estimate(&estimate, voltage, model_current, 1.0);
+        naive_soc += (ocv_to_soc(voltage / BATTERY_CELLS) - naive_soc) / 10.0;
+
+        if (half_s < 0 && estimate.soc <= 50.0) {
+            half_s = t;
+            predicted_min = estimate.runtime_min;
+        }
+        if (naive_low_s < 0 && naive_soc < BATTERY_STOP_SOC) naive_low_s = t;
+        if (estimate_low_s < 0 && estimate.low) estimate_low_s = t;
+        if (true_soc < BATTERY_STOP_SOC) true_low_s = t;
+
+        if (t % 900 == 0) {
+            printf("%d\t%.2f\t%.1f%%\t%.1f%%\t%.1f%%\t%.0f min\n", t / 60, voltage,
+                   true_soc, naive_soc, estimate.soc, estimate.runtime_min);
+        }
+    }
+
+    printf("\nCarga real bajo %.0f%%: %.1f min\n", BATTERY_STOP_SOC, true_low_s / 60.0);
+    printf("  Estimador (conteo + tensión): %.1f min\n", estimate_low_s / 60.0);
+    printf("  Solo tensión: %.1f min\n", naive_low_s / 60.0);
+    printf("Al 50%% estimado (%.1f min): restante estimado %.0f min, real %.0f min\n",
+           half_s / 60.0, predicted_min, (true_low_s - half_s) / 60.0);
+
+    // Velocidad relativa de la rueda (PWM * tensión) con y sin compensación
+    printf("\nCompensación del PWM (BASE_SPEED_A = %d)\n", BASE_SPEED_A);
+    printf("V\tPWM\tVel. sin comp.\tVel. con comp.\n");
+    const double test_voltages[] = {12.6, 11.4, 10.5};
+    for (int i = 0; i < 3; i++) {
+        double pwm = BASE_SPEED_A * compensation_factor(test_voltages[i]);
+        printf("%.1f\t%.0f\t%.0f%%\t\t%.0f%%\n", test_voltages[i], pwm,
+               test_voltages[i] / BATTERY_NOMINAL_V * 100.0,
+               pwm * test_voltages[i] / (BASE_SPEED_A * BATTERY_NOMINAL_V) * 100.0);
+    }
+
+    printf("Prueba de batería completada\n");
+}
\ No newline at end of file
@@ -0,0 +1,103 @@
+/**
+ * @file battery.h
+ * @brief Header del monitoreo de la batería.
+ *
+ * Mide la tensión del paquete LiPo 3S por un divisor resistivo con el
+ * muestreo analógico que dispara el PWM de los motores (analog.h); la
+ * lectura promedia todas las muestras de la batería en el buffer.
+ * Con esa tensión y la corriente estimada por el PWM de los motores se
+ * calcula el estado de carga (conteo de carga corregido por la tensión en
+ * vacío), el tiempo restante y un factor para compensar el PWM de los
+ * motores a medida que la tensión cae.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef BATTERY_H
+#define BATTERY_H
+
+#include "pico/stdlib.h"
+#include <stdint.h>
+
+/// @defgroup BATTERY_STRUCTURES Estructuras de la batería
+/// @{
+
+/**
+ * @brief Estado estimado de la batería.
+ */
+typedef struct {
+    double voltage;      ///< Tensión en bornes del paquete en V
+    double current;      ///< Corriente estimada en A (promedio)
+    double soc;          ///< Estado de carga en % (0-100)
+    double runtime_min;  ///< Minutos restantes hasta BATTERY_STOP_SOC al consumo actual
+    bool valid;          ///< true si ya hay mediciones
+    bool low;            ///< true si la carga bajó de BATTERY_STOP_SOC (se mantiene)
+} battery_status_t;
+
+/// @}
+
+/// @defgroup BATTERY_FUNCTIONS Funciones de la batería
+/// @{
+
+/**
+ * @brief Inicializa el muestreo analógico y espera un buffer completo.
+ *
+ * Requiere el PWM de los motores en marcha (motors_init()). El estado de
+ * carga inicial se toma de la tensión en vacío en la primera llamada a
+ * battery_update(), con los motores detenidos.
+ *
+ * @return true si se pudo iniciar el muestreo
+ */
+bool battery_init(void);
+
+/**
+ * @brief Actualiza la estimación con el promedio del buffer de muestras.
+ *
+ * Debe llamarse una vez por iteración del bucle principal.
+ *
+ * @param now_ms Tiempo actual en ms
+ * @param speed_a PWM aplicado al motor A (0 si detenido)
+ * @param speed_b PWM aplicado al motor B (0 si detenido)
+ */
+void battery_update(uint32_t now_ms, int speed_a, int speed_b);
+
+/**
+ * @brief Obtiene el estado estimado de la batería.
+ *
+ * @return Copia del estado
+ */
+battery_status_t battery_get_status(void);
+
+/**
+ * @brief Verifica si la carga está por debajo del mínimo para navegar.
+ *
+ * @return true si la batería está baja
+ */
+bool battery_is_low(void);
+
+/**
+ * @brief Escala un PWM para que el motor reciba la tensión nominal.
+ *
+ * La tensión media en el motor es proporcional a PWM * tensión de batería,
+ * así que el PWM se multiplica por BATTERY_NOMINAL_V / tensión (limitado a
+ * BATTERY_COMP_MIN..BATTERY_COMP_MAX). Sin mediciones devuelve el mismo PWM.
+ *
+ * @param pwm PWM calculado para la tensión nominal
+ * @return PWM compensado
+ */
+double battery_compensate(double pwm);
+
+/**
+ * @brief Función de prueba de la batería.
+ *
+ * Muestra la lectura real del ADC y simula una descarga completa con
+ * perfil de marcha y paradas, comparando la estimación por tensión sola
+ * con el conteo de carga corregido.
+ */
+void battery_test(void);
+
+/// @}
+
+#endif // BATTERY_H
\ No newline at end of file
@@ -11,13 +11,84 @@
  */
 
 #include "bluetooth.h"
+#include "timebase.h"
 #include "config.h"
+#include "hardware/irq.h"
 #include <string.h>
 #include <stdlib.h>
 
 /// @brief Estado de inicialización del Bluetooth
 static bool initialized = false;
 
+/// @brief Velocidad actual de la UART
+static uint32_t current_baud = BT_BAUD_RATE;
+
+/// @brief Buffer circular de recepción llenado por la interrupción de la UART
+static volatile uint8_t rx_buffer[BT_RX_BUFFER_SIZE];
+static volatile uint32_t rx_head = 0;
+static volatile uint32_t rx_tail = 0;
+
+/// @brief Bytes descartados por buffer lleno
+static volatile uint32_t rx_overflows = 0;
+
+/// @brief Líneas entregadas por bluetooth_read_line() y cortadas por BT_LINE_MAX
+static uint32_t lines_read = 0;
+static uint32_t lines_truncated = 0;
+
+/// @brief Terminadores de línea pendientes de leer con sello de llegada
+#define LINE_STAMPS 8
+
+/**
+ * @brief Llegada de un terminador de línea, capturada en la interrupción.
+ */
+typedef struct {
+    uint32_t position;   ///< Posición del terminador en rx_buffer
+    uint64_t local_us;   ///< time_us_64() al recibirlo
+} line_stamp_t;
+
+/// @brief Cola de sellos de terminadores (llenada por la interrupción)
+static volatile line_stamp_t line_stamps[LINE_STAMPS];
+static volatile uint32_t stamp_head = 0;
+static volatile uint32_t stamp_tail = 0;
+
+/// @brief Sello de la última línea devuelta por bluetooth_read_line()
+static uint64_t line_time_us = 0;
+
+/// @brief Línea en construcción entre llamadas a bluetooth_read_line()
+static char line_buffer[BT_LINE_MAX];
+static int line_length = 0;
+
+/// @brief Velocidades probadas al buscar el módulo (la deseada primero)
+static const uint32_t baud_candidates[] = {
+    BT_TARGET_BAUD, 9600, 38400, 115200, 57600, 19200, 230400
+};
+
+/**
+ * @brief Interrupción de recepción: vacía la FIFO en el buffer circular.
+ */
+static void on_uart_rx(void) {
+    while (uart_is_readable(BT_UART_ID)) {
+        uint8_t c = (uint8_t)uart_getc(BT_UART_ID);
+        uint32_t next = (rx_head + 1) & (BT_RX_BUFFER_SIZE - 1);
+        
+        if (next == rx_tail) {
+            rx_overflows++;
+        } else {
+            rx_buffer[rx_head] = c;
+            
+            // El comando se considera capturado al llegar su terminador
+            uint32_t next_stamp = (stamp_head + 1) % LINE_STAMPS;
+            if ((c == '\n' || c == '\r') && next_stamp != stamp_tail) {
+                line_stamps[stamp_head].position = rx_head;
+                line_stamps[stamp_head].local_us = time_us_64();
+                stamp_head = next_stamp;
+            }
+            
+            rx_head = next;
+        }
+    }
+}
+
 bool bluetooth_init(void) {
     // Inicializar UART para Bluetooth
     uart_init(BT_UART_ID, BT_BAUD_RATE);
@@ -29,10 +100,195 @@ bool bluetooth_init(void) {
     uart_set_hw_flow(BT_UART_ID, false, false);
     uart_set_fifo_enabled(BT_UART_ID, false);
     
+    // Pin KEY en bajo: modo de datos
+    gpio_init(BT_KEY_PIN);
+    gpio_set_dir(BT_KEY_PIN, GPIO_OUT);
+    gpio_put(BT_KEY_PIN, 0);
+    
+    current_baud = BT_BAUD_RATE;
     initialized = true;
+    
+#if BT_AUTO_CONFIG
+    if (bluetooth_auto_configure()) {
+        printf("Bluetooth configurado a %lu baudios\n", (unsigned long)current_baud);
+    } else {
+        printf("Bluetooth sin configurar, usando %lu baudios\n", (unsigned long)current_baud);
+    }
+#endif
+    
+    // Recepción por interrupción. Durante un borrado de flash (~45 ms por sector,
+    // interrupciones detenidas) la FIFO de 32 bytes solo cubre ~2.8 ms a 115200:
+    // los bytes que lleguen se pierden. La carga por fragmentos los recupera con
+    // sus confirmaciones; un comando de texto cortado puede quedar unido al siguiente.
+    rx_head = rx_tail = 0;
+    stamp_head = stamp_tail = 0;
+    line_length = 0;
+    uart_set_fifo_enabled(BT_UART_ID, true);
+    
+    int irq = (uart_get_index(BT_UART_ID) == 0) ? UART0_IRQ : UART1_IRQ;
+    irq_set_exclusive_handler(irq, on_uart_rx);
+    irq_set_enabled(irq, true);
+    uart_set_irq_enables(BT_UART_ID, true, false);
+    
     return true;
 }
 
+/**
+ * @brief Cambia la velocidad de la UART y descarta bytes pendientes.
+ */
+static void set_uart_baud(uint32_t baud) {
+    uart_set_baudrate(BT_UART_ID, baud);
+    current_baud = baud;
+    
+    sleep_ms(5);
+    while (uart_is_readable(BT_UART_ID)) {
+        uart_getc(BT_UART_ID);
+    }
+}
+
+/**
+ * @brief Envía un comando AT y espera "OK" o "ERROR".
+ * 
+ * @param command Comando sin terminador
+ * @param[out] reply Respuesta completa (puede ser NULL)
+ * @param reply_size Tamaño del buffer de respuesta
+ * @return true si el módulo respondió "OK"
+ */
+static bool at_command(const char* command, char* reply, size_t reply_size) {
+    char buffer[64];
+    size_t index = 0;
+    
+    while (uart_is_readable(BT_UART_ID)) {
+        uart_getc(BT_UART_ID);
+    }
+    
+    uart_puts(BT_UART_ID, command);
+    uart_puts(BT_UART_ID, "\r\n");
+    
+    bool ok = false;
+    absolute_time_t timeout = make_timeout_time_ms(BT_AT_TIMEOUT_MS);
+    
+    while (!time_reached(timeout)) {
+        if (!uart_is_readable(BT_UART_ID)) continue;
+        
+        char c = uart_getc(BT_UART_ID);
+        if (index < sizeof(buffer) - 1) {
+            buffer[index++] = c;
+            buffer[index] = '\0';
+        }
+        
+        if (c == '\n') {
+            if (strstr(buffer, "OK")) {
+                ok = true;
+                break;
+            }
+            if (strstr(buffer, "ERROR") || strstr(buffer, "FAIL")) {
+                break;
+            }
+        }
+    }
+    buffer[index] = '\0';
+    
+    if (reply && reply_size > 0) {
+        strncpy(reply, buffer, reply_size - 1);
+        reply[reply_size - 1] = '\0';
+    }
+    
+    return ok;
+}
+
+/**
+ * @brief Busca la velocidad a la que responde el módulo en modo AT.
+ * 
+ * @return Velocidad encontrada, 0 si el módulo no responde
+ */
+static uint32_t detect_baud(void) {
+    for (size_t i = 0; i < sizeof(baud_candidates) / sizeof(baud_candidates[0]); i++) {
+        set_uart_baud(baud_candidates[i]);
+        
+        // Dos intentos: el primer "AT" puede llegar con basura previa
+        if (at_command("AT", NULL, 0) || at_command("AT", NULL, 0)) {
+            return baud_candidates[i];
+        }
+    }
+    
+    return 0;
+}
+
+bool bluetooth_auto_configure(void) {
+    if (!initialized) return false;
+    
+    char command[48];
+    char reply[64];
+    
+    // Modo AT reducido: KEY en alto con el módulo ya encendido
+    gpio_put(BT_KEY_PIN, 1);
+    sleep_ms(100);
+    
+    uint32_t detected = detect_baud();
+    if (detected == 0) {
+        gpio_put(BT_KEY_PIN, 0);
+        set_uart_baud(BT_BAUD_RATE);
+        return false;
+    }
+    
+    if (detected == BT_TARGET_BAUD) {
+        // Ya configurado: no reescribir la memoria del módulo en cada arranque
+        gpio_put(BT_KEY_PIN, 0);
+        return true;
+    }
+    
+    snprintf(command, sizeof(command), "AT+NAME=%s", BT_DEVICE_NAME);
+    bool ok = at_command(command, NULL, 0);
+    
+    // El formato del PIN cambia entre versiones de firmware
+    snprintf(command, sizeof(command), "AT+PSWD=%s", BT_PIN_CODE);
+    if (!at_command(command, NULL, 0)) {
+        snprintf(command, sizeof(command), "AT+PSWD=\"%s\"", BT_PIN_CODE);
+        ok = at_command(command, NULL, 0) && ok;
+    }
+    
+    char expected[24];
+    snprintf(expected, sizeof(expected), "+UART:%lu,0,0", (unsigned long)BT_TARGET_BAUD);
+    snprintf(command, sizeof(command), "AT+UART=%lu,0,0", (unsigned long)BT_TARGET_BAUD);
+    
+    if (!at_command(command, NULL, 0) ||
+        !at_command("AT+UART?", reply, sizeof(reply)) || !strstr(reply, expected)) {
+        // El módulo sigue a la velocidad detectada
+        gpio_put(BT_KEY_PIN, 0);
+        return false;
+    }
+    
+    if (!ok) {
+        printf("Bluetooth: nombre o PIN no aceptados\n");
+    }
+    
+    // Reiniciar con KEY en bajo para volver al modo de datos a la nueva velocidad
+    at_command("AT+RESET", NULL, 0);
+    gpio_put(BT_KEY_PIN, 0);
+    sleep_ms(1000);
+    
+    // Verificar la nueva velocidad; si no responde, volver a la anterior
+    gpio_put(BT_KEY_PIN, 1);
+    sleep_ms(100);
+    set_uart_baud(BT_TARGET_BAUD);
+    bool verified = at_command("AT", NULL, 0) || at_command("AT", NULL, 0);
+    
+    if (!verified) {
+        set_uart_baud(detected);
+        if (!at_command("AT", NULL, 0)) {
+            set_uart_baud(BT_BAUD_RATE);
+        }
+    }
+    
+    gpio_put(BT_KEY_PIN, 0);
+    return verified;
+}
+
+uint32_t bluetooth_get_baud(void) {
+    return current_baud;
+}
+
 bool bluetooth_send_string(const char* str) {
     if (!initialized || !str) return false;
     
@@ -48,38 +304,70 @@ bool bluetooth_send_data(const uint8_t* data, size_t length) {
 }
 
 bool bluetooth_available(void) {
-    return initialized && uart_is_readable(BT_UART_ID);
+    return initialized && rx_head != rx_tail;
 }
 
 int bluetooth_read_line(char* buffer, int max_length) {
     if (!initialized || !buffer || max_length <= 0) return -1;
     
-    int index = 0;
-    absolute_time_t timeout = make_timeout_time_ms(100); // 100ms timeout
+    int limit = (max_length < BT_LINE_MAX) ? max_length - 1 : BT_LINE_MAX - 1;
     
-    while (index < max_length - 1 && !time_reached(timeout)) {
-        if (uart_is_readable(BT_UART_ID)) {
-            char c = uart_getc(BT_UART_ID);
-            
-            if (c == '\n' || c == '\r') {
-                if (index > 0) {
-                    buffer[index] = '\0';
-                    return index;
-                }
-            } else if (c >= ' ' && c <= '~') { // Solo caracteres imprimibles
-                buffer[index++] = c;
+    while (rx_tail != rx_head) {
+        char c = (char)rx_buffer[rx_tail];
+        uint32_t position = rx_tail;
+        rx_tail = (rx_tail + 1) & (BT_RX_BUFFER_SIZE - 1);
+        
+        if (c == '\n' || c == '\r') {
+            // Sello del terminador; sin sello (cola llena) se usa el momento de lectura
+            uint64_t local_us = time_us_64();
+            if (stamp_tail != stamp_head && line_stamps[stamp_tail].position == position) {
+                local_us = line_stamps[stamp_tail].local_us;
+                stamp_tail = (stamp_tail + 1) % LINE_STAMPS;
             }
+            if (line_length == 0) continue;
+            line_time_us = timebase_from_local(local_us);
+        } else if (c >= ' ' && c <= '~') { // Solo caracteres imprimibles
+            line_buffer[line_length++] = c;
+            if (line_length < limit) continue;
+            line_time_us = timebase_now_us();
+            lines_truncated++;
+        } else {
+            continue;
         }
-    }
-    
-    if (index > 0) {
-        buffer[index] = '\0';
-        return index;
+        
+        // Línea completa (o buffer lleno)
+        memcpy(buffer, line_buffer, line_length);
+        buffer[line_length] = '\0';
+        int length = line_length;
+        line_length = 0;
+        lines_read++;
+        return length;
     }
     
     return 0;
 }
 
+uint32_t bluetooth_get_rx_overflows(void) {
+    return rx_overflows;
+}
+
+uint64_t bluetooth_get_line_timestamp(void) {
+    return line_time_us;
+}
+
+bool bluetooth_handle_command(const char* line) {
+    if (!line || strcmp(line, "BT?") != 0) return false;
+    
+    // La línea BT? ya está contada: la diferencia entre dos consultas
+    // incluye la segunda y no la primera
+    char reply[64];
+    snprintf(reply, sizeof(reply), "BT,%lu,%lu,%lu,%lu\n",
+             (unsigned long)lines_read, (unsigned long)lines_truncated,
+             (unsigned long)rx_overflows, (unsigned long)current_baud);
+    bluetooth_send_string(reply);
+    return true;
+}
+
 bool bluetooth_parse_coordinates(const char* command, double* lat, double* lng) {
     if (!command || !lat || !lng) return false;
     
@@ -105,6 +393,50 @@ bool bluetooth_parse_coordinates(const char* command, double* lat, double* lng)
     return (*lat >= -90.0 && *lat <= 90.0 && *lng >= -180.0 && *lng <= 180.0);
 }
 
+bool bluetooth_parse_waypoint(const char* command, double* lat, double* lng, double* speed) {
+    if (!command || !lat || !lng || !speed) return false;
+    if (strncmp(command, "WP,", 3) != 0) return false;
+    
+    // Separar velocidad opcional (tercer campo)
+    char coords[64];
+    strncpy(coords, command + 3, sizeof(coords) - 1);
+    coords[sizeof(coords) - 1] = '\0';
+    
+    *speed = 0.0;
+    char* first_comma = strchr(coords, ',');
+    if (!first_comma) return false;
+    
+    char* second_comma = strchr(first_comma + 1, ',');
+    if (second_comma) {
+        *second_comma = '\0';
+        *speed = atof(second_comma + 1);
+    }
+    
+    return bluetooth_parse_coordinates(coords, lat, lng);
+}
+
+bool bluetooth_parse_follow(const char* command, double* lat, double* lng, uint32_t* timestamp_ms) {
+    if (!command || !lat || !lng || !timestamp_ms) return false;
+    if (strncmp(command, "F,", 2) != 0) return false;
+    
+    // Separar sello de tiempo opcional (tercer campo)
+    char coords[64];
+    strncpy(coords, command + 2, sizeof(coords) - 1);
+    coords[sizeof(coords) - 1] = '\0';
+    
+    *timestamp_ms = 0;
+    char* first_comma = strchr(coords, ',');
+    if (!first_comma) return false;
+    
+    char* second_comma = strchr(first_comma + 1, ',');
+    if (second_comma) {
+        *second_comma = '\0';
+        *timestamp_ms = (uint32_t)strtoul(second_comma + 1, NULL, 10);
+    }
+    
+    return bluetooth_parse_coordinates(coords, lat, lng);
+}
+
 void bluetooth_send_status(double heading, double target_heading, double distance, bool gps_fix) {
     if (!initialized) return;
     
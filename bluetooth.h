@@ -0,0 +1,194 @@
+/**
+ * @file bluetooth.h
+ * @brief Header del driver para Bluetooth HC-05.
+ *
+ * Define las funciones para comunicación UART con el módulo Bluetooth,
+ * incluyendo envío y recepción de datos, y parsing de comandos.
+ * 
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef BLUETOOTH_H
+#define BLUETOOTH_H
+
+#include "pico/stdlib.h"
+#include <stdint.h>
+
+/// @defgroup BT_FUNCTIONS Funciones de Bluetooth
+/// @{
+
+/**
+ * @brief Inicializa la comunicación UART con el módulo Bluetooth.
+ * 
+ * Configura los pines UART, velocidad de comunicación y formato
+ * para comunicarse con el módulo HC-05.
+ * 
+ * @return true si la inicialización fue exitosa
+ */
+bool bluetooth_init(void);
+
+/**
+ * @brief Reconfigura el HC-05 a BT_TARGET_BAUD mediante comandos AT.
+ * 
+ * Activa el pin KEY, busca la velocidad actual del módulo probando
+ * velocidades conocidas, programa nombre, PIN y velocidad, reinicia el
+ * módulo y verifica que responda a la nueva velocidad. Si el módulo ya
+ * está a BT_TARGET_BAUD no se reescribe nada. Si no hay respuesta (KEY
+ * sin conectar o teléfono ya conectado), la UART queda en la última
+ * velocidad en la que el módulo respondió o en BT_BAUD_RATE.
+ * 
+ * @return true si el módulo quedó verificado a BT_TARGET_BAUD
+ */
+bool bluetooth_auto_configure(void);
+
+/**
+ * @brief Obtiene la velocidad actual de la UART del Bluetooth.
+ * 
+ * @return Velocidad en baudios
+ */
+uint32_t bluetooth_get_baud(void);
+
+/**
+ * @brief Envía una cadena de texto por Bluetooth.
+ * 
+ * @param str Cadena terminada en null a enviar
+ * @return true si se envió correctamente
+ */
+bool bluetooth_send_string(const char* str);
+
+/**
+ * @brief Envía datos binarios por Bluetooth.
+ * 
+ * @param data Puntero a los datos a enviar
+ * @param length Número de bytes a enviar
+ * @return true si se envió correctamente
+ */
+bool bluetooth_send_data(const uint8_t* data, size_t length);
+
+/**
+ * @brief Verifica si hay datos disponibles para leer.
+ * 
+ * @return true si hay datos disponibles en el buffer UART
+ */
+bool bluetooth_available(void);
+
+/**
+ * @brief Lee una línea completa desde Bluetooth.
+ * 
+ * Consume los bytes recibidos por interrupción hasta encontrar un salto
+ * de línea o alcanzar el límite del buffer. No bloquea: si la línea aún
+ * no está completa se conserva y se continúa en la siguiente llamada.
+ * 
+ * @param[out] buffer Buffer donde almacenar la línea leída
+ * @param max_length Tamaño máximo del buffer
+ * @return Número de caracteres leídos, 0 si no hay línea completa, -1 si error
+ */
+int bluetooth_read_line(char* buffer, int max_length);
+
+/**
+ * @brief Obtiene el número de bytes perdidos por buffer de recepción lleno.
+ * 
+ * @return Bytes descartados desde el arranque
+ */
+uint32_t bluetooth_get_rx_overflows(void);
+
+/**
+ * @brief Atiende la consulta "BT?" de contadores del enlace.
+ * 
+ * Responde "BT,<líneas>,<cortadas>,<bytes_perdidos>,<baudios>": líneas
+ * entregadas por bluetooth_read_line(), líneas partidas por BT_LINE_MAX y
+ * bytes descartados con el buffer de recepción lleno, desde el arranque.
+ * Con ellas una herramienta del computador cuenta los comandos perdidos.
+ * 
+ * @param line Línea recibida por Bluetooth
+ * @return true si era la consulta y ya se respondió
+ */
+bool bluetooth_handle_command(const char* line);
+
+/**
+ * @brief Obtiene el sello de la última línea leída.
+ * 
+ * Es el momento en que la interrupción recibió el terminador, no el de la
+ * lectura: descuenta la espera en el buffer.
+ * 
+ * @return Llegada de la línea en la base de tiempo (0 sin líneas)
+ */
+uint64_t bluetooth_get_line_timestamp(void);
+
+/**
+ * @brief Procesa un comando para extraer coordenadas.
+ * 
+ * Espera formato "latitud,longitud" y valida que sean coordenadas válidas.
+ * 
+ * @param command Comando recibido
+ * @param[out] lat Puntero donde almacenar la latitud
+ * @param[out] lng Puntero donde almacenar la longitud
+ * @return true si las coordenadas son válidas
+ */
+bool bluetooth_parse_coordinates(const char* command, double* lat, double* lng);
+
+/**
+ * @brief Procesa un comando de punto de ruta.
+ * 
+ * Espera formato "WP,latitud,longitud[,velocidad]" con la velocidad
+ * máxima opcional en m/s (0 si no se indica).
+ * 
+ * @param command Comando recibido
+ * @param[out] lat Puntero donde almacenar la latitud
+ * @param[out] lng Puntero donde almacenar la longitud
+ * @param[out] speed Puntero donde almacenar la velocidad máxima
+ * @return true si el comando y las coordenadas son válidos
+ */
+bool bluetooth_parse_waypoint(const char* command, double* lat, double* lng, double* speed);
+
+/**
+ * @brief Procesa un comando de posición del usuario para el modo Follow Me.
+ * 
+ * Espera formato "F,latitud,longitud[,tiempo_ms]" donde tiempo_ms es el
+ * sello de tiempo del teléfono al obtener la posición (0 si no se indica).
+ * 
+ * @param command Comando recibido
+ * @param[out] lat Puntero donde almacenar la latitud
+ * @param[out] lng Puntero donde almacenar la longitud
+ * @param[out] timestamp_ms Puntero donde almacenar el sello de tiempo
+ * @return true si el comando y las coordenadas son válidos
+ */
+bool bluetooth_parse_follow(const char* command, double* lat, double* lng, uint32_t* timestamp_ms);
+
+/**
+ * @brief Envía el estado actual del sistema por Bluetooth.
+ * 
+ * @param heading Rumbo actual en grados
+ * @param target_heading Rumbo objetivo en grados
+ * @param distance Distancia al objetivo en metros
+ * @param gps_fix true si hay fix GPS válido
+ */
+void bluetooth_send_status(double heading, double target_heading, double distance, bool gps_fix);
+
+/**
+ * @brief Envía información de navegación completa.
+ * 
+ * @param current_lat Latitud actual
+ * @param current_lng Longitud actual
+ * @param target_lat Latitud objetivo
+ * @param target_lng Longitud objetivo
+ * @param distance Distancia al objetivo en metros
+ * @param bearing Rumbo al objetivo en grados
+ */
+void bluetooth_send_navigation_info(double current_lat, double current_lng, 
+                                   double target_lat, double target_lng, 
+                                   double distance, double bearing);
+
+/**
+ * @brief Función de prueba independiente del Bluetooth.
+ * 
+ * Ejecuta comandos de prueba como encender/apagar LED y
+ * procesar coordenadas enviadas desde la app móvil.
+ */
+void bluetooth_test(void);
+
+/// @}
+
+#endif // BLUETOOTH_H
\ No newline at end of file
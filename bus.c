@@ -0,0 +1,424 @@
+/**
+ * @file bus.c
+ * @brief Implementación del bus de mensajes entre módulos.
+ *
+ * Cada tópico tiene su arreglo estático de ranuras, generado desde
+ * BUS_TOPICS. El spinlock protege solo los índices (ranura publicada,
+ * ranura en escritura, retenciones y posiciones de los suscriptores); los
+ * mensajes se escriben y se leen fuera de él, en ranuras que nadie más
+ * toca en ese momento.
+ *
+ * Último valor: el publicador escribe en una ranura que no es la publicada
+ * ni está retenida por un lector. Con BUS_MAX_SUBSCRIBERS + 2 ranuras
+ * siempre hay una libre (cada suscriptor retiene a lo sumo una).
+ *
+ * Cola: el mensaje número n va en la ranura n % profundidad. El publicador
+ * no avanza más de una profundidad por delante del suscriptor más atrasado,
+ * cuya ranura retenida (la que está leyendo) no se libera hasta la lectura
+ * siguiente.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "bus.h"
+#include "bluetooth.h"
+#include "config.h"
+#include "hardware/sync.h"
+#include <stdio.h>
+#include <string.h>
+
+/// @brief Ranuras de un tópico según su semántica
+#define BUS_SLOTS(kind, depth) ((kind) == BUS_LATEST ? BUS_MAX_SUBSCRIBERS + 2 : (depth))
+
+/// @brief Máximo de ranuras de cualquier tópico
+#define BUS_MAX_SLOTS 32
+
+/// @brief Iteraciones de la medición de la prueba
+#define TEST_ITERATIONS 10000
+
+/// @brief Ranuras de cada tópico
+#define BUS_STORAGE(id, name, type, kind, depth) \
+    static type storage_##name[BUS_SLOTS(kind, depth)]; \
+    _Static_assert(BUS_SLOTS(kind, depth) > 0 && BUS_SLOTS(kind, depth) <= BUS_MAX_SLOTS, \
+                   "Profundidad inválida para el tópico " #name);
+BUS_TOPICS(BUS_STORAGE)
+#undef BUS_STORAGE
+
+/**
+ * @brief Descripción fija de un tópico.
+ */
+typedef struct {
+    const char* name;    ///< Nombre
+    uint8_t* data;       ///< Primera ranura
+    uint16_t size;       ///< Tamaño del mensaje
+    bus_kind_t kind;     ///< Semántica
+    uint8_t slots;       ///< Número de ranuras
+} bus_descriptor_t;
+
+/// @brief Descripción de cada tópico, en el orden de bus_topic_t
+#define BUS_DESCRIPTOR(id, name, type, kind, depth) \
+    [id] = { #name, (uint8_t*)storage_##name, sizeof(type), kind, BUS_SLOTS(kind, depth) },
+static const bus_descriptor_t descriptors[BUS_TOPIC_COUNT] = {
+    BUS_TOPICS(BUS_DESCRIPTOR)
+};
+#undef BUS_DESCRIPTOR
+
+/**
+ * @brief Estado de un tópico (protegido por el spinlock).
+ */
+typedef struct {
+    int8_t latest;                      ///< Último valor: ranura publicada (-1 ninguna)
+    int8_t writing;                     ///< Ranura entregada al publicador (-1 ninguna)
+    uint8_t holds[BUS_MAX_SLOTS];       ///< Último valor: lectores que retienen cada ranura
+    uint32_t head;                      ///< Mensajes publicados (número del próximo en una cola)
+    uint32_t dropped;                   ///< Publicaciones descartadas
+    bus_subscriber_t* subscribers[BUS_MAX_SUBSCRIBERS];
+    uint8_t subscriber_count;
+    uint32_t window_start_us;           ///< Inicio de la ventana de frecuencia
+    uint32_t window_count;              ///< Publicaciones en la ventana
+    float rate_hz;                      ///< Frecuencia de la última ventana completa
+} bus_state_t;
+
+/// @brief Estado de inicialización
+static bool initialized = false;
+
+/// @brief Protege el estado de todos los tópicos
+static spin_lock_t* lock = NULL;
+
+/// @brief Estado de cada tópico
+static bus_state_t states[BUS_TOPIC_COUNT];
+
+/**
+ * @brief Dirección de una ranura.
+ */
+static inline uint8_t* slot_data(bus_topic_t topic, int slot) {
+    return descriptors[topic].data + (size_t)slot * descriptors[topic].size;
+}
+
+/**
+ * @brief Suelta la ranura retenida por un suscriptor (con el spinlock tomado).
+ */
+static void release_locked(bus_subscriber_t* subscriber) {
+    if (subscriber->slot < 0) return;
+
+    bus_state_t* state = &states[subscriber->topic];
+    if (descriptors[subscriber->topic].kind == BUS_LATEST) {
+        state->holds[subscriber->slot]--;
+    } else {
+        subscriber->sequence++;
+    }
+    subscriber->slot = -1;
+}
+
+/**
+ * @brief Mensajes de la cola que el suscriptor más atrasado aún no terminó.
+ */
+static uint32_t queue_backlog(const bus_state_t* state) {
+    uint32_t backlog = 0;
+    for (int i = 0; i < state->subscriber_count; i++) {
+        uint32_t pending = state->head - state->subscribers[i]->sequence;
+        if (pending > backlog) backlog = pending;
+    }
+    return backlog;
+}
+
+/**
+ * @brief Cuenta una publicación y cierra la ventana de frecuencia.
+ */
+static void count_publish(bus_state_t* state) {
+    uint32_t now_us = time_us_32();
+    uint32_t elapsed_us = now_us - state->window_start_us;
+
+    state->head++;
+    state->window_count++;
+    if (elapsed_us >= BUS_RATE_WINDOW_MS * 1000u) {
+        state->rate_hz = state->window_count * 1e6f / elapsed_us;
+        state->window_start_us = now_us;
+        state->window_count = 0;
+    }
+}
+
+void bus_init(void) {
+    if (initialized) return;
+
+    lock = spin_lock_instance((uint)spin_lock_claim_unused(true));
+    memset(states, 0, sizeof(states));
+    for (int i = 0; i < BUS_TOPIC_COUNT; i++) {
+        states[i].latest = -1;
+        states[i].writing = -1;
+        states[i].window_start_us = time_us_32();
+    }
+    initialized = true;
+}
+
+bool bus_subscribe(bus_subscriber_t* subscriber, bus_topic_t topic) {
+    if (!initialized || !subscriber || topic >= BUS_TOPIC_COUNT) return false;
+
+    bus_state_t* state = &states[topic];
+    uint32_t irq = spin_lock_blocking(lock);
+
+    // El mismo suscriptor vuelve a empezar en lugar de ocupar otro lugar
+    int index = 0;
+    while (index < state->subscriber_count && state->subscribers[index] != subscriber) {
+        index++;
+    }
+    bool ok = index < state->subscriber_count || state->subscriber_count < BUS_MAX_SUBSCRIBERS;
+    if (ok) {
+        if (index < state->subscriber_count) {
+            release_locked(subscriber);
+        } else {
+            state->subscribers[state->subscriber_count++] = subscriber;
+        }
+        subscriber->topic = topic;
+        subscriber->slot = -1;
+        subscriber->sequence = (descriptors[topic].kind == BUS_QUEUE) ? state->head : 0;
+    }
+
+    spin_unlock(lock, irq);
+    return ok;
+}
+
+void bus_unsubscribe(bus_subscriber_t* subscriber) {
+    if (!initialized || !subscriber || subscriber->topic >= BUS_TOPIC_COUNT) return;
+
+    bus_state_t* state = &states[subscriber->topic];
+    uint32_t irq = spin_lock_blocking(lock);
+
+    for (int i = 0; i < state->subscriber_count; i++) {
+        if (state->subscribers[i] == subscriber) {
+            release_locked(subscriber);
+            state->subscribers[i] = state->subscribers[--state->subscriber_count];
+            break;
+        }
+    }
+
+    spin_unlock(lock, irq);
+}
+
+void* bus_claim(bus_topic_t topic) {
+    if (!initialized || topic >= BUS_TOPIC_COUNT) return NULL;
+
+    const bus_descriptor_t* descriptor = &descriptors[topic];
+    bus_state_t* state = &states[topic];
+    uint32_t irq = spin_lock_blocking(lock);
+
+    if (state->writing < 0) {
+        if (descriptor->kind == BUS_LATEST) {
+            for (int slot = 0; slot < descriptor->slots; slot++) {
+                if (slot != state->latest && state->holds[slot] == 0) {
+                    state->writing = (int8_t)slot;
+                    break;
+                }
+            }
+        } else if (queue_backlog(state) < descriptor->slots) {
+            state->writing = (int8_t)(state->head % descriptor->slots);
+        }
+        if (state->writing < 0) state->dropped++;
+    }
+    int slot = state->writing;
+
+    spin_unlock(lock, irq);
+    return slot < 0 ? NULL : slot_data(topic, slot);
+}
+
+void bus_publish(bus_topic_t topic) {
+    if (!initialized || topic >= BUS_TOPIC_COUNT) return;
+
+    bus_state_t* state = &states[topic];
+    uint32_t irq = spin_lock_blocking(lock);
+
+    if (state->writing >= 0) {
+        state->latest = state->writing;
+        state->writing = -1;
+        count_publish(state);
+    }
+
+    spin_unlock(lock, irq);
+}
+
+bool bus_write(bus_topic_t topic, const void* message) {
+    if (!message) return false;
+
+    void* slot = bus_claim(topic);
+    if (!slot) return false;
+
+    memcpy(slot, message, descriptors[topic].size);
+    bus_publish(topic);
+    return true;
+}
+
+const void* bus_read(bus_subscriber_t* subscriber) {
+    if (!initialized || !subscriber || subscriber->topic >= BUS_TOPIC_COUNT) return NULL;
+
+    bus_topic_t topic = subscriber->topic;
+    bus_state_t* state = &states[topic];
+    uint32_t irq = spin_lock_blocking(lock);
+
+    release_locked(subscriber);
+    if (descriptors[topic].kind == BUS_LATEST) {
+        if (state->latest >= 0) {
+            subscriber->slot = state->latest;
+            subscriber->sequence = state->head;
+            state->holds[subscriber->slot]++;
+        }
+    } else if (subscriber->sequence != state->head) {
+        subscriber->slot = (int8_t)(subscriber->sequence % descriptors[topic].slots);
+    }
+    int slot = subscriber->slot;
+
+    spin_unlock(lock, irq);
+    return slot < 0 ? NULL : slot_data(topic, slot);
+}
+
+void bus_release(bus_subscriber_t* subscriber) {
+    if (!initialized || !subscriber || subscriber->topic >= BUS_TOPIC_COUNT) return;
+
+    uint32_t irq = spin_lock_blocking(lock);
+    release_locked(subscriber);
+    spin_unlock(lock, irq);
+}
+
+bool bus_updated(const bus_subscriber_t* subscriber) {
+    if (!initialized || !subscriber || subscriber->topic >= BUS_TOPIC_COUNT) return false;
+
+    // Lectura de una palabra: no necesita el spinlock
+    uint32_t head = states[subscriber->topic].head;
+    if (descriptors[subscriber->topic].kind == BUS_LATEST) {
+        return head != subscriber->sequence;
+    }
+    return head - subscriber->sequence > (subscriber->slot >= 0 ? 1u : 0u);
+}
+
+bus_topic_info_t bus_get_info(bus_topic_t topic) {
+    bus_topic_info_t info = {0};
+    if (!initialized || topic >= BUS_TOPIC_COUNT) return info;
+
+    const bus_descriptor_t* descriptor = &descriptors[topic];
+    bus_state_t* state = &states[topic];
+    info.name = descriptor->name;
+    info.kind = descriptor->kind;
+    info.size = descriptor->size;
+    info.slots = descriptor->slots;
+
+    uint32_t irq = spin_lock_blocking(lock);
+    info.subscribers = state->subscriber_count;
+    info.published = state->head;
+    info.dropped = state->dropped;
+    // Sin publicaciones durante dos ventanas la frecuencia es cero
+    uint32_t idle_us = time_us_32() - state->window_start_us;
+    info.rate_hz = (idle_us >= 2u * BUS_RATE_WINDOW_MS * 1000u) ?
+                   state->window_count * 1e6f / idle_us : state->rate_hz;
+    spin_unlock(lock, irq);
+
+    return info;
+}
+
+bool bus_handle_command(const char* line) {
+    if (!line || strcmp(line, "BUS?") != 0) return false;
+
+    for (int i = 0; i < BUS_TOPIC_COUNT; i++) {
+        bus_topic_info_t info = bus_get_info((bus_topic_t)i);
+        char reply[80];
+        snprintf(reply, sizeof(reply), "BUS,%s,%.1f,%u,%lu,%lu\n",
+                 info.name ? info.name : "?", info.rate_hz, info.subscribers,
+                 (unsigned long)info.published, (unsigned long)info.dropped);
+        bluetooth_send_string(reply);
+    }
+    return true;
+}
+
+/**
+ * @brief Muestra la tabla de tópicos.
+ */
+static void print_topics(void) {
+    printf("  %-8s %-8s %5s %6s %5s %10s %10s %8s\n",
+           "Tópico", "Tipo", "Bytes", "Ranur.", "Subs", "Publicados", "Descartes", "Hz");
+    for (int i = 0; i < BUS_TOPIC_COUNT; i++) {
+        bus_topic_info_t info = bus_get_info((bus_topic_t)i);
+        printf("  %-8s %-8s %5u %6u %5u %10lu %10lu %8.1f\n",
+               info.name, info.kind == BUS_LATEST ? "último" : "cola",
+               info.size, info.slots, info.subscribers,
+               (unsigned long)info.published, (unsigned long)info.dropped, info.rate_hz);
+    }
+}
+
+void bus_test(void) {
+    printf("=== PRUEBA BUS DE MENSAJES ===\n");
+
+    bus_init();
+    printf("Tópicos declarados:\n");
+    print_topics();
+
+    // Último valor: una lectura retenida no cambia aunque se publique encima
+    static bus_subscriber_t slow;
+    static bus_subscriber_t fast;
+    bool ok = bus_subscribe(&slow, BUS_GPS) && bus_subscribe(&fast, BUS_GPS);
+
+    gps_data_t fix = {0};
+    fix.satellites = 1;
+    ok = ok && bus_write_gps(&fix);
+    const gps_data_t* held = bus_read_gps(&slow);
+    ok = ok && held && held->satellites == 1;
+
+    uint32_t dropped_before = bus_get_info(BUS_GPS).dropped;
+    for (int i = 2; i <= 1000 && ok; i++) {
+        gps_data_t* slot = bus_claim_gps();
+        if (!slot) {
+            ok = false;
+            break;
+        }
+        *slot = fix;
+        slot->satellites = i;
+        bus_publish(BUS_GPS);
+
+        const gps_data_t* latest = bus_read_gps(&fast);
+        ok = latest && latest->satellites == i && held->satellites == 1;
+    }
+    ok = ok && bus_get_info(BUS_GPS).dropped == dropped_before;
+    printf("Último valor: lectura retenida intacta tras 999 publicaciones: %s\n", ok ? "OK" : "FALLA");
+    bus_unsubscribe(&slow);
+    bus_unsubscribe(&fast);
+
+    // Cola: entrega en orden y descarta con la cola llena (un suscriptor
+    // que no lee, como la telemetría tras su prueba, deja menos lugar)
+    static bus_subscriber_t reader;
+    bool queue_ok = bus_subscribe(&reader, BUS_EVENT);
+    bus_topic_info_t events = bus_get_info(BUS_EVENT);
+    int accepted = 0;
+    for (int i = 0; i < events.slots + 3; i++) {
+        telemetry_event_t event = { .time_ms = (uint32_t)i };
+        snprintf(event.text, sizeof(event.text), "PRUEBA_%d", i);
+        if (bus_write_event(&event)) accepted++;
+    }
+    const telemetry_event_t* event;
+    int expected = 0;
+    while ((event = bus_read_event(&reader)) != NULL) {
+        queue_ok = queue_ok && event->time_ms == (uint32_t)expected;
+        expected++;
+    }
+    queue_ok = queue_ok && accepted > 0 && expected == accepted &&
+               bus_get_info(BUS_EVENT).dropped - events.dropped == (uint32_t)(events.slots + 3 - accepted);
+    printf("Cola: %d de %d aceptados, %d leídos en orden: %s\n",
+           accepted, events.slots + 3, expected, queue_ok ? "OK" : "FALLA");
+
+    // Costo de publicar y leer un mensaje de la cola
+    uint32_t start_us = time_us_32();
+    for (int i = 0; i < TEST_ITERATIONS; i++) {
+        telemetry_event_t* slot = bus_claim_event();
+        if (slot) {
+            slot->time_ms = (uint32_t)i;
+            bus_publish(BUS_EVENT);
+        }
+        bus_read_event(&reader);
+    }
+    bus_release(&reader);
+    uint32_t elapsed_us = time_us_32() - start_us;
+    printf("Publicar y leer sin copia: %.2f us por mensaje\n", (double)elapsed_us / TEST_ITERATIONS);
+    bus_unsubscribe(&reader);
+
+    printf("\nEstado final:\n");
+    print_topics();
+    printf("\nResultado: %s\n", (ok && queue_ok) ? "OK" : "FALLA");
+}
\ No newline at end of file
@@ -0,0 +1,232 @@
+/**
+ * @file bus.h
+ * @brief Header del bus de mensajes entre módulos (publicación/suscripción).
+ *
+ * Los tópicos se declaran en compilación en BUS_TOPICS: cada uno tiene un
+ * tipo de mensaje de tamaño fijo, un único módulo que publica y hasta
+ * BUS_MAX_SUBSCRIBERS suscriptores. Toda la memoria es estática.
+ *
+ * - BUS_LATEST: último valor. Leer devuelve el mensaje más reciente; los
+ *   intermedios que nadie leyó se pierden sin costo.
+ * - BUS_QUEUE: cola de la profundidad indicada. Cada suscriptor recibe
+ *   todos los mensajes en orden; con la cola llena para el suscriptor más
+ *   atrasado la publicación se descarta y se cuenta.
+ *
+ * Sin copias: el publicador escribe en la ranura que le entrega bus_claim()
+ * y los suscriptores leen la ranura con el puntero que devuelve bus_read().
+ * Una ranura leída queda retenida (el publicador no la reutiliza) hasta la
+ * siguiente lectura o bus_release(). Solo las operaciones sobre índices
+ * toman un spinlock del RP2040, así que se puede publicar y leer desde los
+ * dos núcleos y desde interrupciones.
+ *
+ * Agregar un sensor es agregar una línea a BUS_TOPICS: el módulo publica
+ * con bus_write_<nombre>() y quien lo necesite se suscribe, sin tocar
+ * integration_test().
+ *
+ * Comandos (App -> Robot):
+ * - "BUS?": responde una línea por tópico
+ *   "BUS,<nombre>,<hz>,<suscriptores>,<publicados>,<descartados>"
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef BUS_H
+#define BUS_H
+
+#include "pico/stdlib.h"
+#include "gps.h"
+#include "telemetry.h"
+#include <stdint.h>
+
+/// @defgroup BUS_STRUCTURES Estructuras del bus
+/// @{
+
+/**
+ * @brief Semántica de un tópico.
+ */
+typedef enum {
+    BUS_LATEST = 0,      ///< Último valor (BUS_MAX_SUBSCRIBERS + 2 ranuras)
+    BUS_QUEUE            ///< Cola sin pérdidas para los suscriptores
+} bus_kind_t;
+
+/**
+ * @brief Tópicos: X(id, nombre, tipo, semántica, profundidad de la cola).
+ *
+ * La profundidad solo aplica a BUS_QUEUE.
+ */
+#define BUS_TOPICS(X) \
+    X(BUS_GPS,   gps,   gps_data_t,        BUS_LATEST, 0) \
+    X(BUS_EVENT, event, telemetry_event_t, BUS_QUEUE,  TELEM_EVENT_QUEUE)
+
+/// @brief Identificador de cada tópico
+#define BUS_TOPIC_ID(id, name, type, kind, depth) id,
+typedef enum {
+    BUS_TOPICS(BUS_TOPIC_ID)
+    BUS_TOPIC_COUNT      ///< Número de tópicos
+} bus_topic_t;
+#undef BUS_TOPIC_ID
+
+/**
+ * @brief Suscriptor de un tópico (memoria del módulo que lee).
+ *
+ * Debe seguir existiendo mientras esté suscrito: el bus guarda su dirección.
+ * Para pasarlo a otro tópico primero se llama bus_unsubscribe().
+ */
+typedef struct {
+    bus_topic_t topic;   ///< Tópico suscrito
+    int8_t slot;         ///< Ranura retenida (-1 ninguna)
+    uint32_t sequence;   ///< Último mensaje leído (último valor) o siguiente por leer (cola)
+} bus_subscriber_t;
+
+/**
+ * @brief Estado de un tópico para el diagnóstico.
+ */
+typedef struct {
+    const char* name;    ///< Nombre del tópico
+    bus_kind_t kind;     ///< Semántica
+    uint16_t size;       ///< Tamaño del mensaje en bytes
+    uint8_t slots;       ///< Ranuras reservadas
+    uint8_t subscribers; ///< Suscriptores actuales
+    uint32_t published;  ///< Mensajes publicados
+    uint32_t dropped;    ///< Publicaciones descartadas (cola llena o sin ranura libre)
+    float rate_hz;       ///< Publicaciones por segundo en la última ventana
+} bus_topic_info_t;
+
+/// @}
+
+/// @defgroup BUS_FUNCTIONS Funciones del bus
+/// @{
+
+/**
+ * @brief Prepara los tópicos y reserva el spinlock.
+ *
+ * Debe llamarse una vez al inicio de main(), antes de que se publique o
+ * se suscriba nada.
+ */
+void bus_init(void);
+
+/**
+ * @brief Suscribe a un tópico.
+ *
+ * En una cola el suscriptor recibe solo lo publicado desde ahora. Volver a
+ * suscribir el mismo suscriptor lo reinicia y descarta lo pendiente.
+ *
+ * @param subscriber Suscriptor (memoria estática del módulo)
+ * @param topic Tópico
+ * @return false si el tópico ya tiene BUS_MAX_SUBSCRIBERS suscriptores
+ */
+bool bus_subscribe(bus_subscriber_t* subscriber, bus_topic_t topic);
+
+/**
+ * @brief Cancela una suscripción y libera la ranura retenida.
+ *
+ * @param subscriber Suscriptor
+ */
+void bus_unsubscribe(bus_subscriber_t* subscriber);
+
+/**
+ * @brief Entrega al publicador la ranura del próximo mensaje.
+ *
+ * El mensaje se escribe en su lugar y se hace visible con bus_publish().
+ * Llamarla de nuevo antes de publicar devuelve la misma ranura.
+ *
+ * @param topic Tópico
+ * @return Ranura a llenar, o NULL si la cola está llena (se cuenta como descarte)
+ */
+void* bus_claim(bus_topic_t topic);
+
+/**
+ * @brief Publica la ranura entregada por bus_claim().
+ *
+ * @param topic Tópico
+ */
+void bus_publish(bus_topic_t topic);
+
+/**
+ * @brief Copia un mensaje en una ranura y lo publica.
+ *
+ * @param topic Tópico
+ * @param message Mensaje del tamaño del tipo del tópico
+ * @return false si la cola está llena
+ */
+bool bus_write(bus_topic_t topic, const void* message);
+
+/**
+ * @brief Lee sin copiar.
+ *
+ * Libera la ranura que el suscriptor tenía retenida y retiene la nueva.
+ * En un tópico de último valor devuelve el mensaje más reciente (aunque ya
+ * se haya leído); en una cola, el siguiente sin leer.
+ *
+ * @param subscriber Suscriptor
+ * @return Mensaje, o NULL si no hay ninguno (nada publicado o cola al día)
+ */
+const void* bus_read(bus_subscriber_t* subscriber);
+
+/**
+ * @brief Libera la ranura retenida sin leer otra.
+ *
+ * @param subscriber Suscriptor
+ */
+void bus_release(bus_subscriber_t* subscriber);
+
+/**
+ * @brief Indica si hay un mensaje que el suscriptor no leyó.
+ *
+ * @param subscriber Suscriptor
+ * @return true si bus_read() devolvería un mensaje nuevo
+ */
+bool bus_updated(const bus_subscriber_t* subscriber);
+
+/**
+ * @brief Obtiene el estado de un tópico.
+ *
+ * @param topic Tópico
+ * @return Nombre, ranuras, suscriptores, contadores y frecuencia
+ */
+bus_topic_info_t bus_get_info(bus_topic_t topic);
+
+/**
+ * @brief Procesa el comando BUS?.
+ *
+ * @param line Línea recibida por Bluetooth
+ * @return true si la línea era un comando del bus
+ */
+bool bus_handle_command(const char* line);
+
+/**
+ * @brief Función de prueba del bus.
+ *
+ * Verifica que las ranuras leídas no se sobrescriben, que la cola entrega
+ * en orden y cuenta los descartes, mide el costo de publicar y leer y
+ * muestra los tópicos.
+ */
+void bus_test(void);
+
+/// @}
+
+/// @defgroup BUS_TYPED Acceso con tipo
+/// @{
+
+/**
+ * @brief bus_claim_<nombre>(), bus_write_<nombre>() y bus_read_<nombre>()
+ * con el tipo de mensaje de cada tópico.
+ */
+#define BUS_TYPED(id, name, type, kind, depth) \
+    static inline type* bus_claim_##name(void) { \
+        return (type*)bus_claim(id); \
+    } \
+    static inline bool bus_write_##name(const type* message) { \
+        return bus_write(id, message); \
+    } \
+    static inline const type* bus_read_##name(bus_subscriber_t* subscriber) { \
+        return subscriber->topic == id ? (const type*)bus_read(subscriber) : NULL; \
+    }
+BUS_TOPICS(BUS_TYPED)
+#undef BUS_TYPED
+
+/// @}
+
+#endif // BUS_H
\ No newline at end of file
@@ -41,6 +41,28 @@
 
 /// @}
 
+/// @defgroup MAG_BIAS_CONFIG Aprendizaje del desvío de la brújula con el GPS
+/// @{
+
+/// @brief Velocidad mínima sobre el suelo para aprender en m/s (rumbo GPS fiable)
+#define MAG_BIAS_MIN_SPEED_MPS 0.3
+/// @brief Giro máximo entre rumbos GPS seguidos (y de la brújula) en un tramo recto en grados
+#define MAG_BIAS_MAX_TURN_DEG 8.0
+/// @brief Rumbos GPS seguidos en tramo recto antes de aprender
+#define MAG_BIAS_STRAIGHT_SAMPLES 3
+/// @brief Ganancia mínima del promedio del desvío (constante de ~20 muestras)
+#define MAG_BIAS_GAIN 0.05
+/// @brief Muestras para considerar aprendido el desvío
+#define MAG_BIAS_MIN_SAMPLES 10
+/// @brief Diferencia máxima con el desvío aprendido para usar una muestra en grados
+#define MAG_BIAS_MAX_INNOVATION_DEG 30.0
+/// @brief Descartes seguidos tras los que se vuelve a aprender desde cero
+#define MAG_BIAS_RELEARN_REJECTS 10
+/// @brief Cambio del desvío en grados que justifica reescribir la flash
+#define MAG_BIAS_SAVE_CHANGE_DEG 1.0
+
+/// @}
+
 /// @defgroup GPS_CONFIG Configuración UART para GPS NEO-6M
 /// @{
 
@@ -52,6 +74,76 @@
 #define GPS_RX_PIN 1
 /// @brief Velocidad de comunicación GPS
 #define GPS_BAUD_RATE 9600
+/// @brief Tamaño del buffer circular de recepción (potencia de 2, ~1 s a 9600 baudios)
+#define GPS_RX_BUFFER_SIZE 1024
+
+/// @}
+
+/// @defgroup GPS_QUALITY_CONFIG Modelo de calidad del fix y radio de llegada
+/// @{
+
+/// @brief Error de rango del receptor en m (error horizontal ≈ HDOP × UERE)
+#define GPS_UERE_M 2.5
+/// @brief Multiplicador del error con fix 2D (altura supuesta)
+#define GPS_2D_ERROR_FACTOR 2.0
+/// @brief HDOP que informa el receptor sin geometría (sin dato)
+#define GPS_HDOP_UNKNOWN 99.99
+/// @brief HDOP a partir del cual el fix no es válido
+#define GPS_MAX_HDOP 20.0
+/// @brief Error estimado en m a partir del cual la navegación se detiene y espera
+#define GPS_HOLD_ERROR_M 10.0
+/// @brief Radio de llegada mínimo en m (geometría buena)
+#define GPS_ARRIVAL_MIN_M 1.5
+/// @brief Radio de llegada máximo en m (geometría pobre)
+#define GPS_ARRIVAL_MAX_M 6.0
+/// @brief Radio de llegada en múltiplos del error estimado
+#define GPS_ARRIVAL_ERROR_FACTOR 1.0
+/// @brief Banda de histéresis de la llegada en múltiplos del radio
+#define GPS_ARRIVAL_HYSTERESIS 1.5
+/// @brief Fixes seguidos dentro de la histéresis para confirmar la llegada
+#define GPS_ARRIVAL_CONFIRM_FIXES 3
+/// @brief Fracción mínima de la velocidad base con peso de fix nulo
+#define GPS_MIN_SPEED_SCALE 0.5
+
+/// @}
+
+/// @defgroup GPS_AID_CONFIG Asistencia de arranque del GPS
+/// @{
+
+/// @brief Tiempo con fix antes de la primera captura en s (el receptor termina de bajar efemérides)
+#define GPS_AID_FIRST_POLL_S 120
+/// @brief Periodo entre capturas en s
+#define GPS_AID_POLL_INTERVAL_S 1800
+/// @brief Duración de la recepción de una captura AID-DATA en ms (~5 KB a 9600 baudios)
+#define GPS_AID_CAPTURE_MS 12000
+/// @brief Antigüedad máxima de las efemérides que se inyectan en s
+#define GPS_AID_EPH_MAX_AGE_S 14400
+/// @brief Precisión mínima declarada para la posición guardada en m
+#define GPS_AID_POS_ACC_M 300
+/// @brief Precisión declarada del tiempo estimado (reinicio o teléfono) en ms
+#define GPS_AID_TIME_ACC_MS 3000
+/// @brief Periodo de sincronización del reloj con NAV-TIMEGPS en ms
+#define GPS_AID_TIME_SYNC_MS 60000
+/// @brief Segundos intercalares GPS-UTC hasta que el receptor informe el valor
+#define GPS_LEAP_SECONDS 18
+
+/// @}
+
+/// @defgroup TIMEBASE_CONFIG Base de tiempo disciplinada por PPS
+/// @{
+
+/// @brief Pin conectado a la salida PPS (TIMEPULSE) del NEO-6M
+#define TIMEBASE_PPS_PIN 16
+/// @brief Error máximo aceptado del cristal y de cada flanco en ppm (µs por segundo)
+#define TIMEBASE_MAX_PPM 500
+/// @brief Divisor de la corrección de frecuencia por flanco (más alto = más suave)
+#define TIMEBASE_RATE_GAIN 8
+/// @brief Flancos seguidos para considerar el PPS enganchado
+#define TIMEBASE_LOCK_PULSES 3
+/// @brief Tiempo sin flancos tras el que se pierde el enganche en ms
+#define TIMEBASE_LOCK_TIMEOUT_MS 1500
+/// @brief Hueco entre flancos en s tras el que se reinicia el enganche
+#define TIMEBASE_REANCHOR_S 10
 
 /// @}
 
@@ -66,6 +158,24 @@
 #define BT_RX_PIN 9
 /// @brief Velocidad de comunicación Bluetooth
 #define BT_BAUD_RATE 9600
+/// @brief Pin conectado a KEY (EN) del HC-05 para entrar en modo AT
+#define BT_KEY_PIN 14
+/// @brief Reconfigurar el módulo al arrancar (1 = sí, 0 = usar BT_BAUD_RATE)
+#define BT_AUTO_CONFIG 1
+/// @brief Velocidad deseada tras la configuración automática
+#define BT_TARGET_BAUD 115200
+/// @brief Nombre visible del módulo
+#define BT_DEVICE_NAME "WALLY-S"
+/// @brief PIN de emparejamiento (4 dígitos)
+#define BT_PIN_CODE "4321"
+/// @brief Tiempo máximo de espera de respuesta a un comando AT en ms
+#define BT_AT_TIMEOUT_MS 300
+/// @brief Tamaño del buffer circular de recepción (potencia de 2)
+#define BT_RX_BUFFER_SIZE 2048
+/// @brief Longitud máxima de una línea recibida
+#define BT_LINE_MAX 160
+/// @brief Líneas Bluetooth procesadas como máximo por iteración del bucle
+#define BT_MAX_LINES_PER_LOOP 16
 
 /// @}
 
@@ -84,6 +194,18 @@
 #define MOTOR_IN3_PIN 12
 /// @brief Pin Input 4 (Dirección Motor B)
 #define MOTOR_IN4_PIN 13
+/// @brief Frecuencia del PWM de los motores en Hz (fase correcta)
+#define MOTOR_PWM_FREQ_HZ 1000
+/// @brief Pin ADC conectado a SENSE A del L298N (GPIO27 = ADC1)
+#define MOTOR_SENSE_A_PIN 27
+/// @brief Entrada del ADC correspondiente a MOTOR_SENSE_A_PIN
+#define MOTOR_SENSE_A_INPUT 1
+/// @brief Pin ADC conectado a SENSE B del L298N (GPIO28 = ADC2)
+#define MOTOR_SENSE_B_PIN 28
+/// @brief Entrada del ADC correspondiente a MOTOR_SENSE_B_PIN
+#define MOTOR_SENSE_B_INPUT 2
+/// @brief Resistencia de medición de corriente en SENSE A/B en ohmios
+#define MOTOR_SENSE_RESISTOR_OHM 0.5
 
 /// @}
 
@@ -114,6 +236,13 @@
 /// @brief Ganancia derivativa para control de dirección
 #define KD_DIR 0.2
 
+/// @brief Constante de tiempo del filtro derivativo del rumbo en segundos
+#define PID_DIR_D_FILTER_TAU 0.2
+/// @brief Peso de la referencia en el término proporcional del rumbo
+#define PID_DIR_WEIGHT_P 1.0
+/// @brief Peso de la referencia en el término derivativo del rumbo
+#define PID_DIR_WEIGHT_D 0.0
+
 /// @}
 
 /// @defgroup SYSTEM_CONSTANTS Constantes del sistema
@@ -144,4 +273,329 @@
 
 /// @}
 
+/// @defgroup ROUTE_CONFIG Configuración de rutas y seguimiento de trayectoria
+/// @{
+
+/// @brief Número máximo de puntos de ruta almacenados
+#define ROUTE_MAX_WAYPOINTS 256
+/// @brief Distancia de anticipación (lookahead) del pure pursuit en metros
+#define ROUTE_LOOKAHEAD_M 3.0
+/// @brief Radio mínimo para dar por alcanzado un waypoint en metros (crece con el error del GPS)
+#define ROUTE_SWITCH_RADIUS_M 1.5
+/// @brief Distancia entre ruedas (trocha) en metros
+#define WHEEL_TRACK_M 0.35
+/// @brief Velocidad aproximada en m/s con BASE_SPEED_A/BASE_SPEED_B
+#define NOMINAL_SPEED_MPS 0.5
+
+/// @}
+
+/// @defgroup GEOFENCE_CONFIG Configuración de la geocerca
+/// @{
+
+/// @brief Número máximo de polígonos de la geocerca
+#define GEOFENCE_MAX_POLYGONS 4
+/// @brief Número máximo de vértices entre todos los polígonos
+#define GEOFENCE_MAX_VERTICES 128
+/// @brief Número máximo de franjas horizontales por polígono
+#define GEOFENCE_BUCKETS 16
+/// @brief Capacidad total de referencias arista-franja
+#define GEOFENCE_MAX_BUCKET_ENTRIES 1024
+/// @brief Extensión máxima de un polígono por eje, en decímetros (3.2 km)
+#define GEOFENCE_MAX_EXTENT_DM 32767
+
+/// @}
+
+/// @defgroup FOLLOW_CONFIG Configuración del modo Follow Me
+/// @{
+
+/// @brief Distancia a mantener respecto al usuario en metros
+#define FOLLOW_STANDOFF_M 1.5
+/// @brief Distancia a partir de la cual el robot vuelve a avanzar en metros
+#define FOLLOW_RESUME_M 2.0
+/// @brief Radio de parada obligatoria alrededor del usuario en metros
+#define FOLLOW_STOP_RADIUS_M 0.5
+/// @brief Tiempo sin coordenadas del usuario para detenerse en ms
+#define FOLLOW_LINK_TIMEOUT_MS 5000
+/// @brief Ganancia de posición del filtro alfa-beta
+#define FOLLOW_ALPHA 0.3
+/// @brief Ganancia de velocidad del filtro alfa-beta
+#define FOLLOW_BETA 0.06
+/// @brief Máxima predicción hacia adelante en ms
+#define FOLLOW_MAX_PREDICTION_MS 2000
+/// @brief Máximo salto aceptado entre medida y predicción en metros
+#define FOLLOW_GATE_M 20.0
+
+/// @}
+
+/// @defgroup LINK_CONFIG Supervisión del enlace Bluetooth
+/// @{
+
+/// @brief Intervalo entre mensajes PING en ms
+#define LINK_PING_INTERVAL_MS 1000
+/// @brief Tiempo máximo para recibir el PONG de un PING en ms
+#define LINK_PONG_TIMEOUT_MS 2000
+/// @brief Tiempo sin tráfico para declarar el enlace perdido en ms
+#define LINK_TIMEOUT_MS 5000
+/// @brief Intervalo entre reportes LINK de calidad del enlace en ms
+#define LINK_REPORT_INTERVAL_MS 5000
+/// @brief 1 para detener también la navegación autónoma al perder el enlace
+#define LINK_FAILSAFE_AUTONOMOUS 0
+
+/// @}
+
+/// @defgroup TELEMETRY_CONFIG Configuración de la telemetría por suscripción
+/// @{
+
+/// @brief Intervalo máximo entre cuadros clave (y reenvíos sin cambios) en ms
+#define TELEM_KEYFRAME_INTERVAL_MS 2000
+/// @brief Frecuencia máxima de un canal en Hz (limitada por LOOP_INTERVAL_MS)
+#define TELEM_MAX_RATE_HZ 20
+/// @brief Frecuencia inicial del canal de navegación en Hz
+#define TELEM_DEFAULT_NAV_HZ 1
+/// @brief Frecuencia inicial del canal de eventos en Hz
+#define TELEM_DEFAULT_EVENTS_HZ 10
+/// @brief Eventos pendientes que se pueden encolar
+#define TELEM_EVENT_QUEUE 8
+/// @brief Delta máximo antes de forzar un cuadro clave (unidades de 1e-6 grados)
+#define TELEM_MAX_DELTA 99999
+
+/// @}
+
+/// @defgroup UPLOAD_CONFIG Configuración de la carga de rutas y mapas
+/// @{
+
+/// @brief Bytes de datos por fragmento (línea de 88 caracteres en base64)
+#define UPLOAD_CHUNK_SIZE 64
+/// @brief Fragmentos en vuelo aceptados por delante del primero pendiente (<= 33)
+#define UPLOAD_WINDOW 16
+/// @brief Número máximo de fragmentos de una carga
+#define UPLOAD_MAX_CHUNKS 128
+/// @brief Tiempo sin fragmentos para abortar la carga en ms
+#define UPLOAD_TIMEOUT_MS 5000
+
+/// @}
+
+/// @defgroup STORAGE_CONFIG Almacenamiento en flash
+/// @{
+
+/// @brief Espera máxima para detener el otro núcleo antes de escribir la flash en ms
+#define STORAGE_FLASH_TIMEOUT_MS 100
+
+/// @}
+
+/// @defgroup TUNE_CONFIG Configuración del ajuste de PID en vivo
+/// @{
+
+/// @brief Controladores que se pueden registrar para ajuste
+#define TUNE_MAX_CONTROLLERS 4
+/// @brief Muestras máximas de una prueba de escalón (20 s a 20 Hz)
+#define TUNE_MAX_SAMPLES 400
+/// @brief Muestras antes del escalón
+#define TUNE_PRETRIGGER_SAMPLES 10
+/// @brief Espera máxima por iteración del bucle al enviar las muestras (µs)
+#define TUNE_STREAM_BLOCK_US 3000
+
+/// @}
+
+/// @defgroup SCHEDULE_CONFIG Programación de ganancias del rumbo
+/// @{
+
+/// @brief Puntos de distancia de la tabla de ganancias
+#define SCHED_DISTANCE_POINTS 3
+/// @brief Estado inicial de la programación de ganancias (1 = activa)
+#define SCHED_DEFAULT_ENABLED 1
+
+/// @}
+
+/// @defgroup MPC_CONFIG Control predictivo de trayectoria
+/// @{
+
+/// @brief 1 para seguir rutas con el MPC, 0 para pure pursuit (por defecto hasta
+/// medir en la Pico el tiempo de cálculo con la prueba del MPC; sin FPU la
+/// medición en el host no acota el ciclo de control)
+#define NAV_USE_MPC 0
+/// @brief Pasos del horizonte de predicción
+#define MPC_HORIZON 20
+/// @brief Duración de cada paso del horizonte en segundos (float)
+#define MPC_STEP_S 0.1f
+/// @brief Iteraciones fijas del solucionador
+#define MPC_ITERATIONS 30
+/// @brief Peso del error lateral (1/m^2)
+#define MPC_Q_LATERAL 1.0f
+/// @brief Peso del error de rumbo (1/rad^2)
+#define MPC_Q_HEADING 1.0f
+/// @brief Peso de la desviación respecto al giro de la referencia
+#define MPC_R_TRACK 0.1f
+/// @brief Peso del cambio de giro entre pasos
+#define MPC_R_RATE 0.5f
+/// @brief Aceleración máxima de cada rueda en m/s^2
+#define MPC_WHEEL_ACCEL_MPS2 0.5f
+/// @brief Corrección máxima en PWM (igual que el límite del PID de rumbo)
+#define MPC_MAX_CORRECTION 50.0f
+
+/// @}
+
+/// @defgroup ANALOG_CONFIG Muestreo analógico sincronizado con el PWM
+/// @{
+
+/// @brief Entradas del ADC en rueda (0-3; ADC3 mide VSYS/3 en la Pico y completa la potencia de 2)
+#define ANALOG_INPUTS 4
+/// @brief Muestras del buffer circular de DMA (potencia de 2, múltiplo de ANALOG_INPUTS)
+#define ANALOG_DMA_SAMPLES 256
+/// @brief Tensión de referencia del ADC en voltios
+#define ANALOG_VREF 3.3
+
+/// @}
+
+/// @defgroup MOTOR_STALL_CONFIG Medición de corriente y detección de atasco
+/// @{
+
+/// @brief Muestras por motor promediadas en cada lectura (16 = 64 ms a 1 kHz)
+#define MOTOR_SENSE_SAMPLES 16
+/// @brief Constante de tiempo del filtro de corriente en segundos
+#define MOTOR_CURRENT_TAU_S 0.1
+/// @brief Ventana mínima para calcular las RPM del encoder en ms
+#define MOTOR_RPM_WINDOW_MS 100
+/// @brief PWM mínimo para considerar que el motor está empujando
+#define MOTOR_STALL_MIN_PWM 100
+/// @brief Corriente por encima de la cual el motor puede estar bloqueado en A
+#define MOTOR_STALL_CURRENT_A 1.6
+/// @brief Velocidad de la rueda por debajo de la cual se considera detenida
+#define MOTOR_STALL_MAX_RPM 10.0
+/// @brief Tiempo sostenido de atasco antes de recortar el motor en ms
+#define MOTOR_STALL_TIME_MS 250
+/// @brief PWM máximo del motor atascado hasta la siguiente parada
+#define MOTOR_STALL_CUTBACK_PWM 0
+
+/// @}
+
+/// @defgroup BATTERY_CONFIG Monitoreo de la batería LiPo 3S
+/// @{
+
+/// @brief Pin ADC del divisor de la batería (GPIO26 = ADC0)
+#define BATTERY_ADC_PIN 26
+/// @brief Entrada del ADC correspondiente a BATTERY_ADC_PIN
+#define BATTERY_ADC_INPUT 0
+/// @brief Relación del divisor resistivo (47k / 10k: 12.6 V -> 2.21 V)
+#define BATTERY_DIVIDER_RATIO 5.7
+/// @brief Celdas en serie del paquete
+#define BATTERY_CELLS 3
+/// @brief Capacidad del paquete en mAh (3S2P con celdas de 2500 mAh)
+#define BATTERY_CAPACITY_MAH 5000
+/// @brief Resistencia interna del paquete en ohmios
+#define BATTERY_INTERNAL_RESISTANCE 0.15
+/// @brief Consumo de la electrónica con los motores detenidos en A
+#define BATTERY_IDLE_CURRENT_A 0.25
+/// @brief Consumo de los dos motores con PWM máximo en A
+#define BATTERY_MOTOR_CURRENT_A 3.0
+/// @brief Corrección del conteo de carga hacia la tensión, por segundo
+#define BATTERY_VOLTAGE_GAIN 0.002
+/// @brief Tensión con la que se calibraron BASE_SPEED_A y BASE_SPEED_B
+#define BATTERY_NOMINAL_V 11.4
+/// @brief Factor mínimo de compensación del PWM (batería sobre la nominal)
+#define BATTERY_COMP_MIN 0.85
+/// @brief Factor máximo de compensación del PWM (batería descargada)
+#define BATTERY_COMP_MAX 1.25
+/// @brief Carga mínima para navegar en % (requisito: detenerse bajo el 10%)
+#define BATTERY_STOP_SOC 10.0
+
+/// @}
+
+/// @defgroup FAULT_CONFIG Watchdog y supervisión de tareas
+/// @{
+
+/// @brief Tiempo sin alimentar el watchdog antes del reinicio en ms (cubre un borrado de flash)
+#define FAULT_WATCHDOG_TIMEOUT_MS 1000
+/// @brief Periodo de la revisión de tareas en ms
+#define FAULT_CHECK_INTERVAL_MS 50
+/// @brief Tareas supervisadas como máximo
+#define FAULT_MAX_TASKS 8
+/// @brief Plazo de las tareas del bucle principal en ms
+#define FAULT_TASK_DEADLINE_MS 500
+
+/// @}
+
+/// @defgroup MEMORY_CONFIG Diagnóstico de memoria
+/// @{
+
+/// @brief Patrón con el que se pintan las pilas al arrancar
+#define MEMORY_PAINT_WORD 0x5354414Bu
+/// @brief Bytes bajo el puntero de pila actual que no se pintan al arrancar
+#define MEMORY_PAINT_MARGIN_BYTES 64
+/// @brief Uso de pila (% del tamaño) a partir del cual se avisa
+#define MEMORY_STACK_WARN_PERCENT 75
+
+/// @}
+
+/// @defgroup TRACE_CONFIG Traza binaria por USB
+/// @{
+
+/// @brief Tamaño de cada uno de los dos buffers de registros en bytes
+#define TRACE_BUFFER_SIZE 2048
+/// @brief Bytes de texto de printf por registro
+#define TRACE_TEXT_MAX 120
+/// @brief Cola de la entrada estándar en bytes
+#define TRACE_RX_BUFFER_SIZE 64
+/// @brief Periodo de reenvío de los esquemas en ms
+#define TRACE_SCHEMA_INTERVAL_MS 1000
+/// @brief Periodo de las estadísticas de la traza en ms
+#define TRACE_STATS_INTERVAL_MS 1000
+/// @brief VID USB (0xCAFE: identificador de pruebas de TinyUSB, no apto para distribuir)
+#define TRACE_USB_VID 0xCAFE
+/// @brief PID USB
+#define TRACE_USB_PID 0x5753
+
+/// @}
+
+/// @defgroup BUS_CONFIG Bus de mensajes entre módulos
+/// @{
+
+/// @brief Suscriptores por tópico (un tópico de último valor reserva 2 ranuras más)
+#define BUS_MAX_SUBSCRIBERS 4
+/// @brief Ventana de medición de la frecuencia de publicación en ms
+#define BUS_RATE_WINDOW_MS 2000
+
+/// @}
+
+/// @defgroup POOL_CONFIG Bloques de memoria de tamaño fijo
+/// @{
+
+/// @brief Bloques chicos (eventos, comandos cortos): bytes y cantidad
+#define POOL_SMALL_SIZE 48
+#define POOL_SMALL_COUNT 32
+/// @brief Bloques medianos (líneas de telemetría, fragmentos de carga): bytes y cantidad
+#define POOL_MEDIUM_SIZE 104
+#define POOL_MEDIUM_COUNT 16
+/// @brief Bloques grandes (líneas de comando de BT_LINE_MAX, registros): bytes y cantidad
+#define POOL_LARGE_SIZE 256
+#define POOL_LARGE_COUNT 8
+
+/// @}
+
+/// @defgroup SIM_CONFIG Modelo del vehículo para simulaciones
+/// @{
+
+/// @brief PWM por debajo del cual la rueda no gira
+#define SIM_PWM_DEADBAND 40
+/// @brief Constante de tiempo de los motores en segundos
+#define SIM_MOTOR_TAU_S 0.25
+/// @brief Desviación del ruido de la brújula en grados
+#define SIM_COMPASS_NOISE_DEG 2.0
+/// @brief Constante de tiempo del filtro de la brújula en segundos
+#define SIM_COMPASS_TAU_S 0.15
+/// @brief Periodo de las posiciones GPS en ms (NEO-6M a 1 Hz)
+#define SIM_GPS_PERIOD_MS 1000
+/// @brief Desviación del ruido de posición GPS en metros
+#define SIM_GPS_NOISE_M 0.8
+/// @brief Diámetro de las ruedas en metros (pulsos de los encoders en el SIL)
+#define SIM_WHEEL_DIAMETER_M 0.065
+/// @brief Tensión en vacío de la batería simulada en voltios
+#define SIM_BATTERY_V 11.8
+/// @brief Corriente de un motor girando sin carga en A
+#define SIM_MOTOR_NOLOAD_A 0.3
+/// @brief Corriente de un motor bloqueado con PWM máximo en A
+#define SIM_MOTOR_STALL_A 2.5
+
+/// @}
+
 #endif // CONFIG_H
\ No newline at end of file
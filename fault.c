@@ -0,0 +1,344 @@
+/**
+ * @file fault.c
+ * @brief Implementación del gestor de fallas con watchdog.
+ *
+ * La revisión corre en la interrupción de un temporizador repetitivo, así
+ * que sigue funcionando aunque el bucle principal esté bloqueado. Si una
+ * tarea vence su plazo se apagan los motores escribiendo directamente los
+ * pines del L298N, se guarda el registro y se fuerza el reinicio por
+ * watchdog; si ni siquiera la interrupción puede correr, el watchdog vence
+ * solo tras FAULT_WATCHDOG_TIMEOUT_MS.
+ *
+ * El registro pendiente vive en RAM no inicializada (.uninitialized_data),
+ * que el arranque no pone a cero. fault_init() lo valida con firma y CRC,
+ * lo copia a flash y lo invalida.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "fault.h"
+#include "storage.h"
+#include "bluetooth.h"
+#include "config.h"
+#include "hardware/watchdog.h"
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+
+/// @brief Firma de un registro válido ("FULT")
+#define FAULT_MAGIC 0x544C5546u
+
+/// @brief Fin de la SRAM (la copia de pila no lee más allá)
+#define SRAM_END_ADDRESS 0x20042000u
+
+/**
+ * @brief Tarea supervisada.
+ */
+typedef struct {
+    char name[FAULT_TASK_NAME_SIZE];  ///< Nombre de la tarea
+    uint32_t deadline_ms;             ///< Plazo máximo entre reportes
+    volatile uint32_t last_ms;        ///< Último reporte
+} fault_task_t;
+
+/// @brief Tareas registradas
+static fault_task_t tasks[FAULT_MAX_TASKS];
+static volatile int task_count = 0;
+
+/// @brief Registro que sobrevive al reinicio
+static fault_record_t __uninitialized_ram(pending_record);
+
+/// @brief Última falla guardada en flash
+static fault_record_t last_record;
+static bool has_last = false;
+
+/// @brief Temporizador de la supervisión
+static repeating_timer_t supervisor_timer;
+
+/// @brief Nombres de las causas
+static const char* const reason_names[] = {
+    "NINGUNA", "WATCHDOG", "TAREA", "HARDFAULT"
+};
+
+/**
+ * @brief Deja los pines del L298N en bajo (motores sin tensión).
+ *
+ * Solo escribe registros GPIO: se puede llamar desde interrupciones y
+ * desde el manejador de HardFault.
+ */
+static void motors_safe(void) {
+    static const uint pins[] = {
+        MOTOR_ENA_PIN, MOTOR_ENB_PIN,
+        MOTOR_IN1_PIN, MOTOR_IN2_PIN, MOTOR_IN3_PIN, MOTOR_IN4_PIN
+    };
+
+    for (size_t i = 0; i < count_of(pins); i++) {
+        gpio_init(pins[i]);
+        gpio_set_dir(pins[i], GPIO_OUT);
+        gpio_put(pins[i], 0);
+    }
+}
+
+/**
+ * @brief Calcula el CRC del registro.
+ */
+static uint32_t record_crc(const fault_record_t* record) {
+    return storage_crc32(record, offsetof(fault_record_t, crc));
+}
+
+/**
+ * @brief Prepara el registro pendiente con la causa y la tarea.
+ */
+static void record_fault(fault_reason_t reason, const char* task) {
+    memset(&pending_record, 0, sizeof(pending_record));
+    pending_record.magic = FAULT_MAGIC;
+    pending_record.reason = reason;
+    pending_record.uptime_ms = to_ms_since_boot(get_absolute_time());
+    if (task) {
+        strncpy(pending_record.task, task, FAULT_TASK_NAME_SIZE - 1);
+    }
+}
+
+/**
+ * @brief Revisa los plazos de las tareas y alimenta el watchdog.
+ *
+ * Si hay tareas vencidas se culpa a la más atrasada respecto a su plazo:
+ * las tareas se reportan en orden dentro del bucle, así que la que se colgó
+ * es la que lleva más tiempo sin reportar.
+ */
+static bool supervise(repeating_timer_t* timer) {
+    uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+    int late = -1;
+    uint32_t worst_ms = 0;
+
+    for (int i = 0; i < task_count; i++) {
+        uint32_t elapsed = now_ms - tasks[i].last_ms;
+        if (elapsed > tasks[i].deadline_ms && elapsed - tasks[i].deadline_ms >= worst_ms) {
+            worst_ms = elapsed - tasks[i].deadline_ms;
+            late = i;
+        }
+    }
+
+    if (late < 0) {
+        watchdog_update();
+        return true;
+    }
+
+    motors_safe();
+    record_fault(FAULT_TASK_TIMEOUT, tasks[late].name);
+    pending_record.crc = record_crc(&pending_record);
+    watchdog_reboot(0, 0, 0);
+    return false;
+}
+
+/**
+ * @brief Guarda los registros y la pila de un HardFault y reinicia.
+ *
+ * @param frame Marco de excepción apilado (r0-r3, r12, lr, pc, xpsr)
+ */
+void __attribute__((used)) fault_capture_hardfault(uint32_t* frame) {
+    motors_safe();
+    record_fault(FAULT_HARDFAULT, NULL);
+
+    pending_record.sp = (uint32_t)(uintptr_t)frame;
+    for (int i = 0; i < 8; i++) {
+        pending_record.registers[i] = frame[i];
+    }
+
+    const uint32_t* stack = frame + 8;
+    for (int i = 0; i < FAULT_STACK_WORDS &&
+                    (uintptr_t)(stack + i) < SRAM_END_ADDRESS; i++) {
+        pending_record.stack[i] = stack[i];
+    }
+
+    pending_record.crc = record_crc(&pending_record);
+    watchdog_reboot(0, 0, 0);
+    while (true) {
+        tight_loop_contents();
+    }
+}
+
+#if defined(__arm__)
+/**
+ * @brief Manejador de HardFault: pasa el marco de la pila activa (MSP o PSP).
+ *
+ * Reemplaza el manejador débil del SDK.
+ */
+void __attribute__((naked)) isr_hardfault(void) {
+    __asm volatile(
+        "movs r0, #4                      \n"
+        "mov r1, lr                       \n"
+        "tst r0, r1                       \n"
+        "beq 1f                           \n"
+        "mrs r0, psp                      \n"
+        "b 2f                             \n"
+        "1:                               \n"
+        "mrs r0, msp                      \n"
+        "2:                               \n"
+        "ldr r1, =fault_capture_hardfault \n"
+        "bx r1                            \n"
+        ".align 2                         \n"
+        ".ltorg                           \n"
+    );
+}
+#endif
+
+fault_reason_t fault_init(void) {
+    motors_safe();
+
+    fault_reason_t reason = FAULT_NONE;
+    bool pending = pending_record.magic == FAULT_MAGIC &&
+                   pending_record.crc == record_crc(&pending_record);
+
+    if (!pending && watchdog_enable_caused_reboot()) {
+        // El watchdog venció sin que la supervisión pudiera registrar la causa
+        record_fault(FAULT_WATCHDOG, NULL);
+        pending_record.uptime_ms = 0;
+        pending = true;
+    }
+
+    if (pending) {
+        reason = (fault_reason_t)pending_record.reason;
+
+        fault_record_t stored;
+        size_t length = 0;
+        bool has_stored = storage_read(STORAGE_REGION_FAULT, &stored, sizeof(stored), &length) &&
+                          length == sizeof(stored);
+        pending_record.total = has_stored ? stored.total + 1 : 1;
+        pending_record.crc = record_crc(&pending_record);
+
+        storage_write(STORAGE_REGION_FAULT, &pending_record, sizeof(pending_record));
+    }
+    pending_record.magic = 0;
+
+    size_t length = 0;
+    has_last = storage_read(STORAGE_REGION_FAULT, &last_record, sizeof(last_record), &length) &&
+               length == sizeof(last_record);
+
+    task_count = 0;
+    watchdog_enable(FAULT_WATCHDOG_TIMEOUT_MS, true);
+    add_repeating_timer_ms(-FAULT_CHECK_INTERVAL_MS, supervise, NULL, &supervisor_timer);
+
+    return reason;
+}
+
+int fault_register_task(const char* name, uint32_t deadline_ms) {
+    if (!name || task_count >= FAULT_MAX_TASKS) return -1;
+
+    fault_task_t* task = &tasks[task_count];
+    strncpy(task->name, name, FAULT_TASK_NAME_SIZE - 1);
+    task->name[FAULT_TASK_NAME_SIZE - 1] = '\0';
+    task->deadline_ms = deadline_ms;
+    task->last_ms = to_ms_since_boot(get_absolute_time());
+
+    // Visible para la supervisión solo cuando ya está completa
+    return task_count++;
+}
+
+void fault_checkin(int task) {
+    if (task < 0 || task >= task_count) return;
+    tasks[task].last_ms = to_ms_since_boot(get_absolute_time());
+}
+
+bool fault_get_last(fault_record_t* record) {
+    if (!has_last) return false;
+    if (record) *record = last_record;
+    return true;
+}
+
+const char* fault_reason_name(fault_reason_t reason) {
+    return (reason <= FAULT_HARDFAULT) ? reason_names[reason] : "DESCONOCIDA";
+}
+
+bool fault_handle_command(const char* line) {
+    if (!line) return false;
+
+    char reply[96];
+
+    if (strcmp(line, "FAULT?") == 0) {
+        if (has_last) {
+            snprintf(reply, sizeof(reply), "FAULT,%s,%s,%08lX,%08lX,%lu,%lu\n",
+                     fault_reason_name((fault_reason_t)last_record.reason),
+                     last_record.task[0] ? last_record.task : "-",
+                     (unsigned long)last_record.registers[6],
+                     (unsigned long)last_record.registers[5],
+                     (unsigned long)last_record.uptime_ms,
+                     (unsigned long)last_record.total);
+        } else {
+            snprintf(reply, sizeof(reply), "FAULT,NINGUNA\n");
+        }
+        bluetooth_send_string(reply);
+        return true;
+    }
+
+    if (strcmp(line, "FAULT_CLEAR") == 0) {
+        storage_write(STORAGE_REGION_FAULT, NULL, 0);
+        has_last = false;
+        bluetooth_send_string("FAULT,BORRADO\n");
+        return true;
+    }
+
+    return false;
+}
+
+void fault_test(void) {
+    printf("=== PRUEBA GESTOR DE FALLAS ===\n");
+
+    fault_record_t record;
+    bool hardfault_next = false;
+
+    if (fault_get_last(&record)) {
+        printf("Última falla: %s", fault_reason_name((fault_reason_t)record.reason));
+        if (record.task[0]) printf(" (tarea %s)", record.task);
+        printf(" a los %lu ms, %lu registradas\n",
+               (unsigned long)record.uptime_ms, (unsigned long)record.total);
+
+        if (record.reason == FAULT_HARDFAULT) {
+            printf("  pc=%08lX lr=%08lX sp=%08lX xpsr=%08lX\n",
+                   (unsigned long)record.registers[6], (unsigned long)record.registers[5],
+                   (unsigned long)record.sp, (unsigned long)record.registers[7]);
+            printf("  r0=%08lX r1=%08lX r2=%08lX r3=%08lX r12=%08lX\n",
+                   (unsigned long)record.registers[0], (unsigned long)record.registers[1],
+                   (unsigned long)record.registers[2], (unsigned long)record.registers[3],
+                   (unsigned long)record.registers[4]);
+            printf("  pila:");
+            for (int i = 0; i < FAULT_STACK_WORDS; i++) {
+                printf("%s%08lX", (i % 8 == 0) ? "\n    " : " ", (unsigned long)record.stack[i]);
+            }
+            printf("\n");
+        }
+
+        hardfault_next = record.reason == FAULT_TASK_TIMEOUT && strcmp(record.task, "PRUEBA") == 0;
+    } else {
+        printf("Sin fallas registradas\n");
+    }
+
+    if (!hardfault_next) {
+        int task = fault_register_task("PRUEBA", 300);
+        if (task < 0) {
+            printf("ERROR: no hay espacio para otra tarea\n");
+            return;
+        }
+
+        printf("Tarea PRUEBA (plazo 300 ms) reportando durante 1 s...\n");
+        uint32_t start_ms = to_ms_since_boot(get_absolute_time());
+        while (to_ms_since_boot(get_absolute_time()) - start_ms < 1000) {
+            fault_checkin(task);
+            sleep_ms(50);
+        }
+
+        printf("Tarea colgada: reinicio en ~%d ms con los motores apagados\n",
+               300 + FAULT_CHECK_INTERVAL_MS);
+        printf("Ejecuta de nuevo esta prueba para provocar un HardFault\n");
+        while (true) {
+            tight_loop_contents();
+        }
+    }
+
+    // En Cortex-M0+ un acceso de 32 bits no alineado produce HardFault
+    printf("Provocando un HardFault (lectura no alineada)...\n");
+    sleep_ms(100);
+    volatile uint32_t* unaligned = (volatile uint32_t*)(uintptr_t)0x20000001u;
+    printf("Lectura: %08lX (no debería llegar aquí)\n", (unsigned long)*unaligned);
+}
\ No newline at end of file
@@ -0,0 +1,131 @@
+/**
+ * @file fault.h
+ * @brief Header del gestor de fallas con watchdog.
+ *
+ * Un temporizador revisa periódicamente que cada tarea registrada haya
+ * reportado actividad dentro de su plazo y solo entonces alimenta el
+ * watchdog del RP2040. Si una tarea se cuelga (lectura Bluetooth, I2C...)
+ * los motores se apagan en el acto, se guarda qué tarea falló y el sistema
+ * se reinicia. Un HardFault guarda los registros y parte de la pila. El
+ * registro sobrevive al reinicio en RAM no inicializada y al arrancar se
+ * copia a flash.
+ *
+ * Comandos (App -> Robot):
+ * - "FAULT?": responde "FAULT,<causa>,<tarea>,<pc_hex>,<lr_hex>,<uptime_ms>,<total>"
+ * - "FAULT_CLEAR": borra el registro guardado en flash
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef FAULT_H
+#define FAULT_H
+
+#include "pico/stdlib.h"
+#include <stdint.h>
+
+/// @defgroup FAULT_STRUCTURES Estructuras del gestor de fallas
+/// @{
+
+/// @brief Longitud máxima del nombre de una tarea (incluye el terminador)
+#define FAULT_TASK_NAME_SIZE 12
+
+/// @brief Palabras de pila guardadas tras un HardFault
+#define FAULT_STACK_WORDS 16
+
+/**
+ * @brief Causa del último reinicio.
+ */
+typedef enum {
+    FAULT_NONE = 0,      ///< Encendido normal
+    FAULT_WATCHDOG,      ///< Watchdog sin registro (interrupciones bloqueadas)
+    FAULT_TASK_TIMEOUT,  ///< Una tarea no reportó actividad a tiempo
+    FAULT_HARDFAULT      ///< Excepción HardFault
+} fault_reason_t;
+
+/**
+ * @brief Registro de una falla.
+ */
+typedef struct {
+    uint32_t magic;                       ///< Firma de registro válido
+    uint32_t reason;                      ///< Causa (fault_reason_t)
+    uint32_t uptime_ms;                   ///< Tiempo desde el arranque al fallar
+    uint32_t total;                       ///< Fallas registradas desde el último FAULT_CLEAR
+    char task[FAULT_TASK_NAME_SIZE];      ///< Tarea que no respondió
+    uint32_t registers[8];                ///< r0, r1, r2, r3, r12, lr, pc, xpsr (HardFault)
+    uint32_t sp;                          ///< Puntero de pila al fallar
+    uint32_t stack[FAULT_STACK_WORDS];    ///< Palabras de pila sobre el marco de excepción
+    uint32_t crc;                         ///< CRC32 de los campos anteriores
+} fault_record_t;
+
+/// @}
+
+/// @defgroup FAULT_FUNCTIONS Funciones del gestor de fallas
+/// @{
+
+/**
+ * @brief Apaga los motores, recupera el registro del reinicio anterior y
+ *        arranca el watchdog y la supervisión.
+ *
+ * Debe ser lo primero en main(): deja los pines del L298N en bajo antes de
+ * cualquier espera.
+ *
+ * @return Causa del reinicio anterior
+ */
+fault_reason_t fault_init(void);
+
+/**
+ * @brief Registra una tarea supervisada.
+ *
+ * La tarea empieza a contar su plazo desde el registro.
+ *
+ * @param name Nombre corto (se trunca a FAULT_TASK_NAME_SIZE - 1)
+ * @param deadline_ms Tiempo máximo entre reportes en ms
+ * @return Identificador de la tarea, o -1 si no hay espacio
+ */
+int fault_register_task(const char* name, uint32_t deadline_ms);
+
+/**
+ * @brief Reporta actividad de una tarea.
+ *
+ * @param task Identificador devuelto por fault_register_task()
+ */
+void fault_checkin(int task);
+
+/**
+ * @brief Obtiene el registro de la última falla.
+ *
+ * @param[out] record Registro
+ * @return true si hay una falla registrada
+ */
+bool fault_get_last(fault_record_t* record);
+
+/**
+ * @brief Nombre de una causa de reinicio.
+ *
+ * @param reason Causa
+ * @return Nombre en texto
+ */
+const char* fault_reason_name(fault_reason_t reason);
+
+/**
+ * @brief Procesa los comandos FAULT.
+ *
+ * @param line Línea recibida por Bluetooth
+ * @return true si la línea era un comando del gestor de fallas
+ */
+bool fault_handle_command(const char* line);
+
+/**
+ * @brief Función de prueba del gestor de fallas.
+ *
+ * Muestra el registro de la última falla y provoca un fallo real: la
+ * primera vez una tarea que deja de reportar, la siguiente un HardFault.
+ * En ambos casos el robot se reinicia.
+ */
+void fault_test(void);
+
+/// @}
+
+#endif // FAULT_H
\ No newline at end of file
@@ -0,0 +1,333 @@
+/**
+ * @file follow.c
+ * @brief Implementación del modo Follow Me.
+ *
+ * Las coordenadas del teléfono llegan ruidosas y con retardo. Este módulo
+ * las ubica en el tiempo del robot usando el sello del teléfono, las filtra
+ * con un estimador alfa-beta (posición y velocidad constantes en un plano
+ * local) y predice la posición actual del usuario para seguirla a la
+ * distancia configurada.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "follow.h"
+#include "gps.h"
+#include "config.h"
+#include <math.h>
+
+/// @brief Velocidad máxima creíble del usuario en m/s
+#define USER_MAX_SPEED 3.0
+
+/// @brief Rechazos consecutivos tras los que se reinicia el estimador
+#define MAX_REJECTIONS 3
+
+/// @brief true si el modo está activo
+static bool active = false;
+
+/// @brief Origen del plano local (primera posición recibida)
+static double origin_lat = 0.0;
+static double origin_lng = 0.0;
+
+/// @brief Estado del estimador alfa-beta
+static bool has_estimate = false;
+static double est_x = 0.0;
+static double est_y = 0.0;
+static double est_vx = 0.0;
+static double est_vy = 0.0;
+static uint32_t est_time_ms = 0;
+
+/// @brief Mínimo (recepción - sello del teléfono): mensaje con menor latencia
+static uint32_t min_offset_ms = 0;
+static bool offset_valid = false;
+
+/// @brief Tiempo local de la última recepción
+static uint32_t last_rx_ms = 0;
+
+/// @brief Latencia estimada de la última medida aceptada
+static uint32_t last_latency_ms = 0;
+
+/// @brief Medidas rechazadas consecutivas
+static int rejections = 0;
+
+/// @brief Histéresis de movimiento entre FOLLOW_STANDOFF_M y FOLLOW_RESUME_M
+static bool moving = false;
+
+/**
+ * @brief Reinicia el estimador con una medida.
+ */
+static void reset_estimate(double x, double y, uint32_t time_ms) {
+    est_x = x;
+    est_y = y;
+    est_vx = 0.0;
+    est_vy = 0.0;
+    est_time_ms = time_ms;
+    has_estimate = true;
+    rejections = 0;
+}
+
+void follow_start(void) {
+    active = true;
+    has_estimate = false;
+    offset_valid = false;
+    moving = false;
+    rejections = 0;
+    last_latency_ms = 0;
+}
+
+void follow_stop(void) {
+    active = false;
+    moving = false;
+}
+
+bool follow_is_active(void) {
+    return active;
+}
+
+bool follow_feed(double lat, double lng, uint32_t phone_time_ms, uint32_t now_ms) {
+    if (!active) return false;
+
+    last_rx_ms = now_ms;
+
+    // Latencia relativa al mensaje más rápido observado
+    uint32_t latency_ms = 0;
+    if (phone_time_ms != 0) {
+        uint32_t offset = now_ms - phone_time_ms;
+
+        if (!offset_valid || (int32_t)(offset - min_offset_ms) < 0) {
+            min_offset_ms = offset;
+            offset_valid = true;
+        } else {
+            // Deriva lenta para seguir la diferencia de relojes
+            min_offset_ms++;
+        }
+
+        latency_ms = offset - min_offset_ms;
+        if (latency_ms > FOLLOW_MAX_PREDICTION_MS) {
+            latency_ms = FOLLOW_MAX_PREDICTION_MS;
+        }
+    }
+
+    uint32_t measure_ms = now_ms - latency_ms;
+
+    if (!has_estimate) {
+        origin_lat = lat;
+        origin_lng = lng;
+        reset_estimate(0.0, 0.0, measure_ms);
+        last_latency_ms = latency_ms;
+        return true;
+    }
+
+    double zx, zy;
+    gps_latlng_to_local(origin_lat, origin_lng, lat, lng, &zx, &zy);
+
+    double dt = (int32_t)(measure_ms - est_time_ms) / 1000.0;
+    if (dt <= 0.0) return false; // Mensaje fuera de orden o duplicado
+
+    // Predicción con velocidad constante
+    double px = est_x + est_vx * dt;
+    double py = est_y + est_vy * dt;
+    double rx = zx - px;
+    double ry = zy - py;
+
+    // Rechazar saltos imposibles; reiniciar si se repiten
+    if (hypot(rx, ry) > FOLLOW_GATE_M) {
+        if (++rejections >= MAX_REJECTIONS) {
+            reset_estimate(zx, zy, measure_ms);
+            last_latency_ms = latency_ms;
+            return true;
+        }
+        return false;
+    }
+    rejections = 0;
+
+    // Corrección alfa-beta
+    est_x = px + FOLLOW_ALPHA * rx;
+    est_y = py + FOLLOW_ALPHA * ry;
+    est_vx += (FOLLOW_BETA / dt) * rx;
+    est_vy += (FOLLOW_BETA / dt) * ry;
+    est_time_ms = measure_ms;
+
+    double speed = hypot(est_vx, est_vy);
+    if (speed > USER_MAX_SPEED) {
+        est_vx *= USER_MAX_SPEED / speed;
+        est_vy *= USER_MAX_SPEED / speed;
+    }
+
+    last_latency_ms = latency_ms;
+    return true;
+}
+
+bool follow_update(double lat, double lng, uint32_t now_ms, follow_command_t* command) {
+    if (!active || !command) return false;
+
+    command->drive = false;
+    command->bearing = 0.0;
+    command->distance = 0.0;
+    command->speed_scale = 0.0;
+    command->user_speed = 0.0;
+    command->latency_ms = last_latency_ms;
+
+    if (!has_estimate) {
+        command->state = FOLLOW_WAITING;
+        return true;
+    }
+
+    if (now_ms - last_rx_ms > FOLLOW_LINK_TIMEOUT_MS) {
+        command->state = FOLLOW_LINK_LOST;
+        moving = false;
+        return true;
+    }
+
+    // Posición del usuario predicha para el instante actual
+    double age = (now_ms - est_time_ms) / 1000.0;
+    if (age > FOLLOW_MAX_PREDICTION_MS / 1000.0) {
+        age = FOLLOW_MAX_PREDICTION_MS / 1000.0;
+    }
+    double ux = est_x + est_vx * age;
+    double uy = est_y + est_vy * age;
+
+    double x, y;
+    gps_latlng_to_local(origin_lat, origin_lng, lat, lng, &x, &y);
+
+    double dx = ux - x;
+    double dy = uy - y;
+    command->distance = hypot(dx, dy);
+    command->user_speed = hypot(est_vx, est_vy);
+
+    command->bearing = atan2(dx, dy) * 180.0 / M_PI;
+    if (command->bearing < 0) {
+        command->bearing += 360;
+    }
+
+    if (command->distance < FOLLOW_STOP_RADIUS_M) {
+        command->state = FOLLOW_TOO_CLOSE;
+        moving = false;
+        return true;
+    }
+
+    if (moving && command->distance <= FOLLOW_STANDOFF_M) {
+        moving = false;
+    } else if (!moving && command->distance > FOLLOW_RESUME_M) {
+        moving = true;
+    }
+
+    if (!moving) {
+        command->state = FOLLOW_HOLDING;
+        return true;
+    }
+
+    // Velocidad del usuario más una corrección proporcional al error de distancia
+    double speed = command->user_speed + 0.5 * (command->distance - FOLLOW_STANDOFF_M);
+    command->speed_scale = speed / NOMINAL_SPEED_MPS;
+    if (command->speed_scale > 1.0) command->speed_scale = 1.0;
+    if (command->speed_scale < 0.2) command->speed_scale = 0.2;
+
+    command->state = FOLLOW_TRACKING;
+    command->drive = true;
+    return true;
+}
+
+const char* follow_state_name(follow_state_t state) {
+    switch (state) {
+        case FOLLOW_WAITING:   return "ESPERANDO";
+        case FOLLOW_TRACKING:  return "SIGUIENDO";
+        case FOLLOW_HOLDING:   return "EN_DISTANCIA";
+        case FOLLOW_TOO_CLOSE: return "MUY_CERCA";
+        case FOLLOW_LINK_LOST: return "SIN_SENAL";
+        default:               return "DESCONOCIDO";
+    }
+}
+
+/**
+ * @brief Genera ruido gaussiano para la simulación (Box-Muller).
+ */
+static double simulated_noise(uint32_t* seed, double sigma) {
+    *seed = *seed * 1103515245u + 12345u;
+    double u1 = ((*seed >> 8) + 1.0) / 16777217.0;
+    *seed = *seed * 1103515245u + 12345u;
+    double u2 = (*seed >> 8) / 16777216.0;
+    return sigma * sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+void follow_test(void) {
+    printf("=== PRUEBA FOLLOW ME (SIMULACIÓN) ===\n");
+
+    const double lat0 = 6.267300;
+    const double lng0 = -75.568800;
+    const double meters_per_deg = 6371000 * M_PI / 180.0;
+    const double cos_lat0 = cos(lat0 * M_PI / 180.0);
+    const uint32_t phone_clock_offset = 5000000; // Reloj del teléfono desfasado
+
+    uint32_t seed = 42;
+    double raw_x = 0.0, raw_y = 0.0;
+    double raw_sq = 0.0, filtered_sq = 0.0;
+    int samples = 0;
+    uint32_t next_fix_ms = 0;
+
+    // Cola de mensajes en tránsito (latencia variable del enlace)
+    struct { uint32_t arrival_ms, phone_ms; double x, y; } in_flight[4];
+    int pending = 0;
+
+    follow_start();
+
+    for (uint32_t t = 0; t <= 90000; t += LOOP_INTERVAL_MS) {
+        // Usuario: 45 s hacia el norte y luego hacia el este a 1.2 m/s
+        double ux = (t < 45000) ? 0.0 : 1.2 * (t - 45000) / 1000.0;
+        double uy = 1.2 * ((t < 45000) ? t : 45000) / 1000.0;
+
+        // El teléfono obtiene un fix por segundo y lo envía con 200-1200 ms de retardo
+        if (t >= next_fix_ms && pending < 4) {
+            seed = seed * 1103515245u + 12345u;
+            in_flight[pending].arrival_ms = t + 200 + (seed >> 16) % 1000;
+            in_flight[pending].phone_ms = t + phone_clock_offset;
+            in_flight[pending].x = ux + simulated_noise(&seed, 2.0);
+            in_flight[pending].y = uy + simulated_noise(&seed, 2.0);
+            pending++;
+            next_fix_ms += 1000;
+        }
+
+        for (int i = 0; i < pending; i++) {
+            if (t >= in_flight[i].arrival_ms) {
+                raw_x = in_flight[i].x;
+                raw_y = in_flight[i].y;
+                follow_feed(lat0 + raw_y / meters_per_deg,
+                            lng0 + raw_x / (meters_per_deg * cos_lat0),
+                            in_flight[i].phone_ms, t);
+                in_flight[i] = in_flight[--pending];
+                i--;
+            }
+        }
+
+        // Comparar con la posición real usando un robot fijo en el origen
+        follow_command_t cmd;
+        follow_update(lat0, lng0, t, &cmd);
+        if (cmd.state == FOLLOW_WAITING || t < 5000) continue;
+
+        double fx = cmd.distance * sin(cmd.bearing * M_PI / 180.0);
+        double fy = cmd.distance * cos(cmd.bearing * M_PI / 180.0);
+        raw_sq += (raw_x - ux) * (raw_x - ux) + (raw_y - uy) * (raw_y - uy);
+        filtered_sq += (fx - ux) * (fx - ux) + (fy - uy) * (fy - uy);
+        samples++;
+
+        if (t % 10000 == 0) {
+            printf("t=%2lus Real=(%.1f,%.1f) Crudo=(%.1f,%.1f) Predicho=(%.1f,%.1f) V=%.2f m/s Lat=%lums\n",
+                   (unsigned long)(t / 1000), ux, uy, raw_x, raw_y, fx, fy,
+                   cmd.user_speed, (unsigned long)cmd.latency_ms);
+        }
+    }
+
+    printf("Error RMS posición cruda:    %.2f m\n", sqrt(raw_sq / samples));
+    printf("Error RMS posición predicha: %.2f m\n", sqrt(filtered_sq / samples));
+
+    // Verificar la parada por pérdida de enlace
+    follow_command_t cmd;
+    follow_update(lat0, lng0, 90000 + FOLLOW_LINK_TIMEOUT_MS + 1000, &cmd);
+    printf("Sin mensajes por %d s -> estado %s\n",
+           (FOLLOW_LINK_TIMEOUT_MS + 1000) / 1000, follow_state_name(cmd.state));
+
+    follow_stop();
+    printf("Prueba Follow Me completada\n");
+}
\ No newline at end of file
@@ -0,0 +1,113 @@
+/**
+ * @file follow.h
+ * @brief Header del modo Follow Me.
+ *
+ * Define las funciones para seguir al usuario a partir de las coordenadas
+ * que envía su teléfono, filtradas con un estimador alfa-beta de
+ * velocidad constante y compensadas por la latencia del enlace.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef FOLLOW_H
+#define FOLLOW_H
+
+#include "pico/stdlib.h"
+#include <stdint.h>
+
+/// @defgroup FOLLOW_STRUCTURES Estructuras del modo Follow Me
+/// @{
+
+/**
+ * @brief Estado del seguimiento del usuario.
+ */
+typedef enum {
+    FOLLOW_WAITING = 0,   ///< Sin coordenadas del usuario todavía
+    FOLLOW_TRACKING,      ///< Avanzando hacia el usuario
+    FOLLOW_HOLDING,       ///< A distancia de seguimiento, detenido
+    FOLLOW_TOO_CLOSE,     ///< Usuario dentro del radio de parada
+    FOLLOW_LINK_LOST      ///< Sin coordenadas durante FOLLOW_LINK_TIMEOUT_MS
+} follow_state_t;
+
+/**
+ * @brief Comando de movimiento calculado por el modo Follow Me.
+ */
+typedef struct {
+    follow_state_t state;  ///< Estado actual del seguimiento
+    bool drive;            ///< true si el robot debe avanzar
+    double bearing;        ///< Rumbo hacia la posición predicha del usuario (0-360)
+    double distance;       ///< Distancia a la posición predicha en metros
+    double speed_scale;    ///< Fracción de la velocidad base (0.0 - 1.0)
+    double user_speed;     ///< Velocidad estimada del usuario en m/s
+    uint32_t latency_ms;   ///< Latencia estimada de la última medida
+} follow_command_t;
+
+/// @}
+
+/// @defgroup FOLLOW_FUNCTIONS Funciones del modo Follow Me
+/// @{
+
+/**
+ * @brief Activa el modo Follow Me y reinicia el estimador.
+ */
+void follow_start(void);
+
+/**
+ * @brief Desactiva el modo Follow Me.
+ */
+void follow_stop(void);
+
+/**
+ * @brief Verifica si el modo Follow Me está activo.
+ *
+ * @return true si está activo
+ */
+bool follow_is_active(void);
+
+/**
+ * @brief Incorpora una posición del usuario recibida por Bluetooth.
+ *
+ * El sello de tiempo del teléfono se usa para estimar la latencia de
+ * cada mensaje respecto al más rápido recibido y ubicar la medida en el
+ * tiempo del robot. Un sello 0 significa "sin sello" (latencia cero).
+ *
+ * @param lat Latitud del usuario
+ * @param lng Longitud del usuario
+ * @param phone_time_ms Sello de tiempo del teléfono en ms (0 si no hay)
+ * @param now_ms Tiempo local de recepción en ms
+ * @return true si la medida fue aceptada por el estimador
+ */
+bool follow_feed(double lat, double lng, uint32_t phone_time_ms, uint32_t now_ms);
+
+/**
+ * @brief Calcula el comando de seguimiento para la posición actual del robot.
+ *
+ * @param lat Latitud actual del robot
+ * @param lng Longitud actual del robot
+ * @param now_ms Tiempo local en ms
+ * @param[out] command Comando calculado
+ * @return true si el modo está activo y se calculó el comando
+ */
+bool follow_update(double lat, double lng, uint32_t now_ms, follow_command_t* command);
+
+/**
+ * @brief Obtiene un texto descriptivo del estado de seguimiento.
+ *
+ * @param state Estado
+ * @return Cadena constante con el nombre del estado
+ */
+const char* follow_state_name(follow_state_t state);
+
+/**
+ * @brief Función de prueba del estimador alfa-beta.
+ *
+ * Simula un usuario caminando con GPS ruidoso y enlace con retardo, y
+ * compara el error de las posiciones crudas con el de la predicción.
+ */
+void follow_test(void);
+
+/// @}
+
+#endif // FOLLOW_H
\ No newline at end of file
@@ -0,0 +1,439 @@
+/**
+ * @file geofence.c
+ * @brief Implementación del módulo de geocerca.
+ *
+ * Los polígonos se guardan en flash en coordenadas locales ENU de punto
+ * fijo (decímetros respecto a un origen). Al activarlos se construye un
+ * índice en RAM con la caja envolvente de cada polígono y franjas
+ * horizontales que listan solo las aristas que las cruzan, de modo que la
+ * prueba de contención revisa pocas aristas usando aritmética entera.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "geofence.h"
+#include "storage.h"
+#include "config.h"
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+/**
+ * @brief Vértice en coordenadas locales (decímetros).
+ */
+typedef struct {
+    int32_t east;   ///< Coordenada Este en dm
+    int32_t north;  ///< Coordenada Norte en dm
+} geofence_point_t;
+
+/**
+ * @brief Definición de un polígono dentro del bloque de vértices.
+ */
+typedef struct {
+    uint16_t first;       ///< Índice del primer vértice
+    uint16_t count;       ///< Número de vértices
+    uint8_t keep_out;     ///< 1 si es zona prohibida
+    uint8_t reserved[3];  ///< Relleno
+} geofence_polygon_t;
+
+/**
+ * @brief Geocerca completa tal como se guarda en flash.
+ */
+typedef struct {
+    double origin_lat;        ///< Latitud del origen ENU
+    double origin_lng;        ///< Longitud del origen ENU
+    uint32_t polygon_count;   ///< Número de polígonos
+    uint32_t vertex_count;    ///< Número total de vértices
+    geofence_polygon_t polygons[GEOFENCE_MAX_POLYGONS];
+    geofence_point_t vertices[GEOFENCE_MAX_VERTICES];
+} geofence_blob_t;
+
+// El formato es parte del protocolo de carga (upload.h)
+_Static_assert(sizeof(geofence_point_t) == 8 && sizeof(geofence_polygon_t) == 8,
+               "vértices y polígonos deben ocupar 8 bytes");
+_Static_assert(offsetof(geofence_blob_t, polygons) == 24 &&
+               offsetof(geofence_blob_t, vertices) == 24 + 8 * GEOFENCE_MAX_POLYGONS,
+               "geofence_blob_t no coincide con el formato documentado en upload.h");
+
+/**
+ * @brief Índice de aceleración de un polígono (solo en RAM).
+ */
+typedef struct {
+    int32_t min_east;     ///< Caja envolvente
+    int32_t max_east;
+    int32_t min_north;
+    int32_t max_north;
+    uint8_t bucket_shift; ///< Altura de franja = 1 << bucket_shift dm
+    uint8_t bucket_count; ///< Número de franjas usadas
+    uint16_t bucket_start[GEOFENCE_BUCKETS + 1]; ///< Inicio de cada franja en bucket_edges
+} geofence_index_t;
+
+/// @brief Geocerca activa
+static geofence_blob_t active_fence;
+
+/// @brief Geocerca en edición
+static geofence_blob_t edit_fence;
+
+/// @brief Índices de los polígonos activos
+static geofence_index_t fence_index[GEOFENCE_MAX_POLYGONS];
+
+/// @brief Aristas de cada franja (índice relativo al primer vértice del polígono)
+static uint8_t bucket_edges[GEOFENCE_MAX_BUCKET_ENTRIES];
+
+/// @brief true si existe al menos un polígono permitido
+static bool keep_in_required = false;
+
+/// @brief Escalas de grados a decímetros para la geocerca activa
+static double east_scale = 0.0;
+static double north_scale = 0.0;
+
+/**
+ * @brief Verifica si un punto está dentro de un polígono activo.
+ *
+ * Cruce de rayo hacia +Este restringido a las aristas de la franja del
+ * punto. Como la extensión del polígono es menor a 2^15 dm, los productos
+ * caben en 32 bits y no se necesita división.
+ */
+static bool __not_in_flash_func(polygon_contains)(int p, int32_t east, int32_t north) {
+    const geofence_index_t* idx = &fence_index[p];
+
+    if (east < idx->min_east || east > idx->max_east ||
+        north < idx->min_north || north > idx->max_north) {
+        return false;
+    }
+
+    const geofence_polygon_t* poly = &active_fence.polygons[p];
+    const geofence_point_t* v = &active_fence.vertices[poly->first];
+    uint32_t bucket = (uint32_t)(north - idx->min_north) >> idx->bucket_shift;
+    bool inside = false;
+
+    for (uint16_t k = idx->bucket_start[bucket]; k < idx->bucket_start[bucket + 1]; k++) {
+        uint8_t i = bucket_edges[k];
+        const geofence_point_t* a = &v[i];
+        const geofence_point_t* b = &v[(i + 1 == poly->count) ? 0 : i + 1];
+
+        if ((a->north > north) != (b->north > north)) {
+            // ¿El punto está a la izquierda del cruce de la arista?
+            int32_t lhs = (east - a->east) * (b->north - a->north);
+            int32_t rhs = (north - a->north) * (b->east - a->east);
+
+            if ((b->north > a->north) ? (lhs < rhs) : (lhs > rhs)) {
+                inside = !inside;
+            }
+        }
+    }
+
+    return inside;
+}
+
+/**
+ * @brief Valida una geocerca y construye su índice.
+ *
+ * Además de la forma de los polígonos revisa el origen y que cada vértice
+ * quede dentro de ±GEOFENCE_MAX_EXTENT_DM, porque una geocerca cargada por
+ * Bluetooth no pasa por geofence_add_point().
+ *
+ * @param fence Geocerca a indexar
+ * @param apply false para solo validar, true para escribir el índice activo
+ * @return true si la geocerca es válida y el índice cabe en memoria
+ */
+static bool build_index(const geofence_blob_t* fence, bool apply) {
+    uint32_t entries = 0;
+
+    if (fence->polygon_count > GEOFENCE_MAX_POLYGONS ||
+        fence->vertex_count > GEOFENCE_MAX_VERTICES) {
+        return false;
+    }
+
+    if (!isfinite(fence->origin_lat) || fabs(fence->origin_lat) > 90.0 ||
+        !isfinite(fence->origin_lng) || fabs(fence->origin_lng) > 180.0) {
+        return false;
+    }
+
+    for (uint32_t k = 0; k < fence->vertex_count; k++) {
+        const geofence_point_t* point = &fence->vertices[k];
+        if (point->east < -GEOFENCE_MAX_EXTENT_DM || point->east > GEOFENCE_MAX_EXTENT_DM ||
+            point->north < -GEOFENCE_MAX_EXTENT_DM || point->north > GEOFENCE_MAX_EXTENT_DM) {
+            return false;
+        }
+    }
+
+    for (uint32_t p = 0; p < fence->polygon_count; p++) {
+        const geofence_polygon_t* poly = &fence->polygons[p];
+        const geofence_point_t* v = &fence->vertices[poly->first];
+        geofence_index_t idx;
+
+        if (poly->count < 3 || poly->first + poly->count > fence->vertex_count) return false;
+
+        // Caja envolvente
+        idx.min_east = idx.max_east = v[0].east;
+        idx.min_north = idx.max_north = v[0].north;
+        for (uint16_t i = 1; i < poly->count; i++) {
+            if (v[i].east < idx.min_east) idx.min_east = v[i].east;
+            if (v[i].east > idx.max_east) idx.max_east = v[i].east;
+            if (v[i].north < idx.min_north) idx.min_north = v[i].north;
+            if (v[i].north > idx.max_north) idx.max_north = v[i].north;
+        }
+
+        if ((int64_t)idx.max_east - idx.min_east > GEOFENCE_MAX_EXTENT_DM ||
+            (int64_t)idx.max_north - idx.min_north > GEOFENCE_MAX_EXTENT_DM) {
+            return false;
+        }
+
+        // Franjas de altura potencia de 2 para indexar con un desplazamiento
+        uint32_t height = (uint32_t)(idx.max_north - idx.min_north);
+        idx.bucket_shift = 0;
+        while ((height >> idx.bucket_shift) >= GEOFENCE_BUCKETS) {
+            idx.bucket_shift++;
+        }
+        idx.bucket_count = (uint8_t)((height >> idx.bucket_shift) + 1);
+
+        for (uint8_t b = 0; b < idx.bucket_count; b++) {
+            int32_t slab_min = idx.min_north + ((int32_t)b << idx.bucket_shift);
+            int32_t slab_max = slab_min + (1 << idx.bucket_shift) - 1;
+
+            idx.bucket_start[b] = (uint16_t)entries;
+
+            for (uint16_t i = 0; i < poly->count; i++) {
+                const geofence_point_t* a = &v[i];
+                const geofence_point_t* c = &v[(i + 1 == poly->count) ? 0 : i + 1];
+                int32_t edge_min = (a->north < c->north) ? a->north : c->north;
+                int32_t edge_max = (a->north < c->north) ? c->north : a->north;
+
+                if (edge_max < slab_min || edge_min > slab_max) continue;
+                if (entries >= GEOFENCE_MAX_BUCKET_ENTRIES) return false;
+
+                if (apply) {
+                    bucket_edges[entries] = (uint8_t)i;
+                }
+                entries++;
+            }
+        }
+        idx.bucket_start[idx.bucket_count] = (uint16_t)entries;
+
+        if (apply) {
+            fence_index[p] = idx;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Activa una geocerca ya validada.
+ *
+ * @param fence Geocerca a activar
+ * @return true si la geocerca es válida
+ */
+static bool activate(const geofence_blob_t* fence) {
+    if (!build_index(fence, false)) {
+        return false;
+    }
+
+    if (fence != &active_fence) {
+        active_fence = *fence;
+    }
+    build_index(&active_fence, true);
+
+    keep_in_required = false;
+    for (uint32_t p = 0; p < active_fence.polygon_count; p++) {
+        if (!active_fence.polygons[p].keep_out) {
+            keep_in_required = true;
+        }
+    }
+
+    double dm_per_deg = 6371000 * M_PI / 180.0 * 10.0;
+    north_scale = dm_per_deg;
+    east_scale = dm_per_deg * cos(active_fence.origin_lat * M_PI / 180.0);
+
+    return true;
+}
+
+bool geofence_init(void) {
+    memset(&active_fence, 0, sizeof(active_fence));
+    geofence_clear();
+
+    if (!storage_read(STORAGE_REGION_GEOFENCE, &active_fence, sizeof(active_fence), NULL) ||
+        !activate(&active_fence)) {
+        memset(&active_fence, 0, sizeof(active_fence));
+        return false;
+    }
+
+    return active_fence.polygon_count > 0;
+}
+
+void geofence_clear(void) {
+    memset(&edit_fence, 0, sizeof(edit_fence));
+}
+
+bool geofence_begin_polygon(bool keep_out) {
+    if (edit_fence.polygon_count >= GEOFENCE_MAX_POLYGONS) return false;
+
+    geofence_polygon_t* poly = &edit_fence.polygons[edit_fence.polygon_count++];
+    poly->first = (uint16_t)edit_fence.vertex_count;
+    poly->count = 0;
+    poly->keep_out = keep_out ? 1 : 0;
+
+    return true;
+}
+
+bool geofence_add_point(double lat, double lng) {
+    if (lat < -90.0 || lat > 90.0 || lng < -180.0 || lng > 180.0) return false;
+    if (edit_fence.vertex_count >= GEOFENCE_MAX_VERTICES) return false;
+
+    // Sin polígono iniciado se asume una zona permitida
+    if (edit_fence.polygon_count == 0 && !geofence_begin_polygon(false)) return false;
+
+    // El primer vértice fija el origen ENU
+    if (edit_fence.vertex_count == 0) {
+        edit_fence.origin_lat = lat;
+        edit_fence.origin_lng = lng;
+    }
+
+    double dm_per_deg = 6371000 * M_PI / 180.0 * 10.0;
+    double north = (lat - edit_fence.origin_lat) * dm_per_deg;
+    double east = (lng - edit_fence.origin_lng) * dm_per_deg *
+                  cos(edit_fence.origin_lat * M_PI / 180.0);
+
+    if (fabs(north) > GEOFENCE_MAX_EXTENT_DM || fabs(east) > GEOFENCE_MAX_EXTENT_DM) return false;
+
+    geofence_point_t* point = &edit_fence.vertices[edit_fence.vertex_count++];
+    point->east = (int32_t)lround(east);
+    point->north = (int32_t)lround(north);
+    edit_fence.polygons[edit_fence.polygon_count - 1].count++;
+
+    return true;
+}
+
+bool geofence_save(void) {
+    if (!build_index(&edit_fence, false)) return false;
+
+    if (!storage_write(STORAGE_REGION_GEOFENCE, &edit_fence, sizeof(edit_fence))) return false;
+
+    return activate(&edit_fence);
+}
+
+bool geofence_install(storage_region_t region) {
+    geofence_clear();
+
+    if (!storage_read(region, &edit_fence, sizeof(edit_fence), NULL)) {
+        geofence_clear();
+        return false;
+    }
+
+    bool installed = geofence_save();
+    if (!installed) {
+        // La escritura pudo dejar la región borrada: guardar la activa
+        storage_write(STORAGE_REGION_GEOFENCE, &active_fence, sizeof(active_fence));
+    }
+
+    geofence_clear();
+    return installed;
+}
+
+bool geofence_is_enabled(void) {
+    return active_fence.polygon_count > 0;
+}
+
+int geofence_get_polygon_count(void) {
+    return (int)active_fence.polygon_count;
+}
+
+bool geofence_contains(double lat, double lng) {
+    if (active_fence.polygon_count == 0) return true;
+
+    double east = (lng - active_fence.origin_lng) * east_scale;
+    double north = (lat - active_fence.origin_lat) * north_scale;
+
+    // Fuera de cualquier caja envolvente posible
+    if (fabs(east) > 2.0 * GEOFENCE_MAX_EXTENT_DM || fabs(north) > 2.0 * GEOFENCE_MAX_EXTENT_DM) {
+        return !keep_in_required;
+    }
+
+    return geofence_contains_local((int32_t)lround(east), (int32_t)lround(north));
+}
+
+bool __not_in_flash_func(geofence_contains_local)(int32_t east, int32_t north) {
+    bool inside_keep_in = false;
+
+    for (uint32_t p = 0; p < active_fence.polygon_count; p++) {
+        if (polygon_contains(p, east, north)) {
+            if (active_fence.polygons[p].keep_out) return false;
+            inside_keep_in = true;
+        }
+    }
+
+    return inside_keep_in || !keep_in_required;
+}
+
+void geofence_test(void) {
+    printf("=== PRUEBA GEOCERCA ===\n");
+
+    // Origen de referencia: campus Universidad de Antioquia
+    const double lat0 = 6.267300;
+    const double lng0 = -75.568800;
+    const double meters_per_deg = 6371000 * M_PI / 180.0;
+    const double cos_lat0 = cos(lat0 * M_PI / 180.0);
+
+    // Zona permitida en L (200 x 100 m con muesca) y zona prohibida cuadrada
+    const double keep_in[][2] = {{0, 0}, {200, 0}, {200, 40}, {100, 40}, {100, 100}, {0, 100}};
+    const double keep_out[][2] = {{30, 30}, {60, 30}, {60, 60}, {30, 60}};
+
+    geofence_clear();
+    geofence_begin_polygon(false);
+    for (int i = 0; i < 6; i++) {
+        geofence_add_point(lat0 + keep_in[i][1] / meters_per_deg,
+                           lng0 + keep_in[i][0] / (meters_per_deg * cos_lat0));
+    }
+    geofence_begin_polygon(true);
+    for (int i = 0; i < 4; i++) {
+        geofence_add_point(lat0 + keep_out[i][1] / meters_per_deg,
+                           lng0 + keep_out[i][0] / (meters_per_deg * cos_lat0));
+    }
+
+    // Activar solo en RAM, sin sobrescribir la geocerca guardada
+    if (!activate(&edit_fence)) {
+        printf("ERROR: geocerca de prueba inválida\n");
+        return;
+    }
+
+    const struct { double east, north; bool expected; } cases[] = {
+        {10, 10, true}, {150, 20, true}, {90, 90, true},
+        {150, 70, false}, {45, 45, false}, {250, 50, false}, {-5, 50, false}
+    };
+
+    int passed = 0;
+    int total = sizeof(cases) / sizeof(cases[0]);
+    for (int i = 0; i < total; i++) {
+        bool result = geofence_contains(lat0 + cases[i].north / meters_per_deg,
+                                        lng0 + cases[i].east / (meters_per_deg * cos_lat0));
+        printf("  E=%.0f N=%.0f -> %s (%s)\n", cases[i].east, cases[i].north,
+               result ? "DENTRO" : "FUERA", result == cases[i].expected ? "OK" : "FALLO");
+        if (result == cases[i].expected) passed++;
+    }
+    printf("Casos correctos: %d/%d\n", passed, total);
+
+    // Medir el tiempo de la prueba de contención en coordenadas locales
+    const int iterations = 10000;
+    volatile bool sink = false;
+    uint32_t seed = 12345;
+    uint32_t start = time_us_32();
+
+    for (int i = 0; i < iterations; i++) {
+        seed = seed * 1103515245u + 12345u;
+        int32_t east = (int32_t)((seed >> 8) % 2400) - 200;
+        int32_t north = (int32_t)((seed >> 20) % 1200) - 100;
+        sink = geofence_contains_local(east, north);
+    }
+
+    uint32_t elapsed = time_us_32() - start;
+    (void)sink;
+    printf("Tiempo medio por consulta: %lu ns\n",
+           (unsigned long)((uint64_t)elapsed * 1000 / iterations));
+
+    // Restaurar la geocerca guardada
+    geofence_init();
+    printf("Prueba de geocerca completada\n");
+}
\ No newline at end of file
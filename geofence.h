@@ -0,0 +1,122 @@
+/**
+ * @file geofence.h
+ * @brief Header del módulo de geocerca (zona de operación permitida).
+ *
+ * Define las funciones para cargar, editar y guardar en flash los
+ * polígonos que delimitan la zona de operación, y para verificar
+ * rápidamente si una posición está dentro de ella.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef GEOFENCE_H
+#define GEOFENCE_H
+
+#include "pico/stdlib.h"
+#include "storage.h"
+#include <stdint.h>
+
+/// @defgroup GEOFENCE_FUNCTIONS Funciones de la geocerca
+/// @{
+
+/**
+ * @brief Carga la geocerca guardada en flash y la activa.
+ *
+ * @return true si había una geocerca válida con al menos un polígono
+ */
+bool geofence_init(void);
+
+/**
+ * @brief Descarta los polígonos en edición.
+ *
+ * La geocerca activa no cambia hasta llamar a geofence_save().
+ */
+void geofence_clear(void);
+
+/**
+ * @brief Inicia un nuevo polígono en edición.
+ *
+ * @param keep_out true para una zona prohibida, false para una zona permitida
+ * @return true si hay espacio para otro polígono
+ */
+bool geofence_begin_polygon(bool keep_out);
+
+/**
+ * @brief Agrega un vértice al polígono en edición.
+ *
+ * El primer vértice recibido fija el origen del plano local (ENU).
+ *
+ * @param lat Latitud en grados decimales
+ * @param lng Longitud en grados decimales
+ * @return true si hay espacio y el vértice está dentro de la extensión permitida
+ */
+bool geofence_add_point(double lat, double lng);
+
+/**
+ * @brief Valida los polígonos en edición, los guarda en flash y los activa.
+ *
+ * Una edición vacía desactiva la geocerca.
+ *
+ * @return true si la geocerca es válida y se guardó correctamente
+ */
+bool geofence_save(void);
+
+/**
+ * @brief Valida una geocerca recibida en otra región, la guarda y la activa.
+ *
+ * Si los datos no son una geocerca válida, la geocerca activa y la
+ * guardada no cambian.
+ *
+ * @param region Región con el bloque recibido
+ * @return true si la geocerca recibida es válida y quedó activa
+ */
+bool geofence_install(storage_region_t region);
+
+/**
+ * @brief Verifica si hay una geocerca activa.
+ *
+ * @return true si hay al menos un polígono activo
+ */
+bool geofence_is_enabled(void);
+
+/**
+ * @brief Obtiene el número de polígonos activos.
+ *
+ * @return Número de polígonos de la geocerca activa
+ */
+int geofence_get_polygon_count(void);
+
+/**
+ * @brief Verifica si una posición está dentro de la zona permitida.
+ *
+ * La posición es válida si está dentro de algún polígono permitido y
+ * fuera de todos los prohibidos. Sin geocerca activa siempre es válida.
+ *
+ * @param lat Latitud en grados decimales
+ * @param lng Longitud en grados decimales
+ * @return true si la posición está permitida
+ */
+bool geofence_contains(double lat, double lng);
+
+/**
+ * @brief Verifica una posición ya expresada en el plano local de la geocerca.
+ *
+ * @param east Coordenada Este en decímetros respecto al origen de la geocerca
+ * @param north Coordenada Norte en decímetros respecto al origen de la geocerca
+ * @return true si la posición está permitida
+ */
+bool geofence_contains_local(int32_t east, int32_t north);
+
+/**
+ * @brief Función de prueba de la geocerca.
+ *
+ * Construye una geocerca de ejemplo en RAM, verifica puntos conocidos y
+ * mide el tiempo medio de la prueba de contención.
+ */
+void geofence_test(void);
+
+/// @}
+
+#endif // GEOFENCE_H
\ No newline at end of file
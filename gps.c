@@ -3,7 +3,15 @@
  * @brief Implementación del driver para GPS NEO-6M.
  *
  * Este módulo maneja la comunicación UART con el GPS, procesa sentencias
- * NMEA GPGGA y proporciona funciones de navegación básica.
+ * NMEA GPGGA, GPGSA, GPRMC y GPVTG, estima la calidad de cada fix a partir
+ * de la dilución de la precisión y proporciona funciones de navegación
+ * básica. Los mensajes
+ * binarios UBX que llegan entre sentencias se separan del flujo NMEA y se
+ * entregan a la asistencia de arranque (gps_aid.c).
+ *
+ * La interrupción de la UART guarda los bytes en un buffer circular: la
+ * respuesta a AID-DATA son varios KB seguidos, que sondeando una vez por
+ * iteración del bucle se perderían en la FIFO.
  * 
  * @author Equipo WALLY-S
  * @date 2025
@@ -11,7 +19,11 @@
  */
 
 #include "gps.h"
+#include "gps_aid.h"
+#include "timebase.h"
+#include "bus.h"
 #include "config.h"
+#include "hardware/irq.h"
 #include <string.h>
 #include <stdlib.h>
 #include <math.h>
@@ -19,12 +31,86 @@
 /// @brief Estado de inicialización del GPS
 static bool initialized = false;
 
+/// @brief Buffer circular de recepción llenado por la interrupción de la UART
+static volatile uint8_t rx_buffer[GPS_RX_BUFFER_SIZE];
+static volatile uint32_t rx_head = 0;
+static volatile uint32_t rx_tail = 0;
+
+/// @brief Bytes descartados por buffer lleno
+static volatile uint32_t rx_overflows = 0;
+
+/// @brief Inicios de sentencia pendientes de leer con sello de llegada
+#define SENTENCE_STAMPS 8
+
+/**
+ * @brief Llegada de un '$', capturada en la interrupción.
+ */
+typedef struct {
+    uint32_t position;   ///< Posición del '$' en rx_buffer
+    uint64_t local_us;   ///< time_us_64() al recibirlo
+} sentence_stamp_t;
+
+/// @brief Cola de sellos de inicio de sentencia (llenada por la interrupción)
+static volatile sentence_stamp_t sentence_stamps[SENTENCE_STAMPS];
+static volatile uint32_t stamp_head = 0;
+static volatile uint32_t stamp_tail = 0;
+
+/// @brief Mensajes UBX correctos y descartados por suma de verificación
+static uint32_t ubx_frames = 0;
+static uint32_t ubx_errors = 0;
+
+/// @brief Sentencias NMEA descartadas por suma de verificación
+static uint32_t nmea_errors = 0;
+
 /// @brief Datos GPS actuales
 static gps_data_t current_gps_data = {0};
 
 /// @brief Coordenadas objetivo
 static target_data_t target_data = {0};
 
+/// @brief Modelo de calidad del último fix
+static gps_quality_t quality = {0};
+
+/// @brief Fixes válidos recibidos (cuenta cada sentencia una sola vez)
+static uint32_t fix_count = 0;
+
+/// @brief El receptor envía GPRMC: GPVTG repite el mismo rumbo y se ignora
+static bool rmc_seen = false;
+
+/// @brief Metros por segundo en un nudo
+#define KNOTS_TO_MPS 0.514444
+
+/**
+ * @brief Estado de la llegada al objetivo.
+ */
+typedef struct {
+    bool holding;          ///< Dentro del radio: esperando la confirmación
+    int confirmed;         ///< Fixes seguidos dentro de la histéresis
+    uint32_t last_fix;     ///< Último fix evaluado
+} arrival_state_t;
+
+/// @brief Llegada al objetivo actual
+static arrival_state_t arrival = {0};
+
+/// @brief Contenido UBX más largo que se procesa (AID-EPH ocupa 104 bytes)
+#define UBX_MAX_PAYLOAD 128
+
+/**
+ * @brief Estado del decodificador de mensajes UBX.
+ */
+typedef struct {
+    int state;                         ///< Byte esperado (0 = fuera de un mensaje)
+    uint8_t msg_class;                 ///< Clase del mensaje
+    uint8_t msg_id;                    ///< Identificador del mensaje
+    uint16_t length;                   ///< Longitud del contenido
+    uint16_t index;                    ///< Bytes de contenido recibidos
+    uint8_t ck_a, ck_b;                ///< Suma de verificación en curso
+    uint8_t payload[UBX_MAX_PAYLOAD];  ///< Contenido
+} ubx_parser_t;
+
+/// @brief Decodificador UBX
+static ubx_parser_t ubx = {0};
+
 /**
  * @brief Convierte coordenadas en formato DDMM.MMMM a grados decimales.
  * 
@@ -40,22 +126,113 @@ static double convert_to_degrees(const char* raw_degrees) {
     return degrees + (minutes / 60.0);
 }
 
+/**
+ * @brief Verifica la suma de verificación "*hh" de una sentencia NMEA.
+ *
+ * Con las interrupciones detenidas por una escritura en flash se pierden
+ * bytes y dos sentencias pueden quedar unidas; la suma lo detecta. Las
+ * sentencias sin suma se aceptan.
+ *
+ * @param sentence Sentencia completa, empezando por '$'
+ * @return true si la suma coincide o no existe
+ */
+static bool nmea_checksum_ok(const char* sentence) {
+    const char* star = strchr(sentence, '*');
+    if (!star) return true;
+    
+    uint8_t value = 0;
+    for (const char* c = sentence + 1; c < star; c++) {
+        value ^= (uint8_t)*c;
+    }
+    
+    char* end;
+    long given = strtol(star + 1, &end, 16);
+    return end == star + 3 && given == value;
+}
+
+/**
+ * @brief Separa el siguiente campo de una sentencia NMEA.
+ * 
+ * A diferencia de strtok, conserva los campos vacíos (",,"), de modo que
+ * el índice de cada campo no cambia cuando el receptor no tiene dato.
+ * 
+ * @param[in,out] cursor Posición actual (NULL al terminar)
+ * @return Campo sin la suma de verificación, o NULL si no hay más
+ */
+static char* next_field(char** cursor) {
+    char* field = *cursor;
+    if (!field) return NULL;
+    
+    char* comma = strchr(field, ',');
+    if (comma) {
+        *comma = '\0';
+        *cursor = comma + 1;
+    } else {
+        *cursor = NULL;
+    }
+    
+    char* star = strchr(field, '*');
+    if (star) *star = '\0';
+    return field;
+}
+
+/**
+ * @brief Convierte un campo hhmmss(.ss) en segundos del día.
+ * 
+ * @param token Campo de tiempo
+ * @return Segundos desde las 00:00 UTC, o -1 si el campo está vacío
+ */
+static int32_t parse_second_of_day(const char* token) {
+    if (strlen(token) < 6) return -1;
+    int hhmmss = atoi(token);
+    return (hhmmss / 10000) * 3600 + (hhmmss / 100 % 100) * 60 + hhmmss % 100;
+}
+
+/**
+ * @brief Recalcula el modelo de calidad con los DOP del último fix.
+ */
+static void update_quality(void) {
+    double error = current_gps_data.hdop * GPS_UERE_M;
+    if (current_gps_data.fix_type == 2) {
+        error *= GPS_2D_ERROR_FACTOR; // Altura supuesta: la horizontal absorbe el error
+    }
+    quality.error_m = error;
+    
+    // Peso relativo a la varianza con HDOP 1
+    double ratio = (error > 0.0) ? GPS_UERE_M / error : 0.0;
+    quality.weight = (ratio > 1.0) ? 1.0 : ratio * ratio;
+    
+    double radius = GPS_ARRIVAL_ERROR_FACTOR * error;
+    if (radius < GPS_ARRIVAL_MIN_M) radius = GPS_ARRIVAL_MIN_M;
+    if (radius > GPS_ARRIVAL_MAX_M) radius = GPS_ARRIVAL_MAX_M;
+    quality.arrival_radius_m = radius;
+    
+    quality.hold = current_gps_data.fix_valid && error > GPS_HOLD_ERROR_M;
+}
+
 /**
  * @brief Procesa una sentencia GPGGA y actualiza los datos GPS.
  * 
  * @param sentence Sentencia NMEA a procesar
+ * @param arrival_us Sello de la llegada de la sentencia
  * @return true si se procesó correctamente y hay fix válido
  */
-static bool parse_gga_sentence(char* sentence) {
-    char* token = strtok(sentence, ",");
+static bool parse_gga_sentence(char* sentence, uint64_t arrival_us) {
+    char* cursor = sentence;
+    char* token;
     int field = 0;
+    int32_t second_of_day = -1;
+    
+    // Sin dato el receptor deja el campo vacío (o HDOP en 99.99)
+    current_gps_data.hdop = GPS_HDOP_UNKNOWN;
     
-    while (token != NULL && field < 15) {
+    while ((token = next_field(&cursor)) != NULL && field < 15) {
         switch (field) {
             case 1: // Tiempo
                 if (strlen(token) >= 6) {
                     strncpy(current_gps_data.time, token, 6);
                     current_gps_data.time[6] = '\0';
+                    second_of_day = parse_second_of_day(token);
                 }
                 break;
             case 2: // Latitud
@@ -84,20 +261,246 @@ static bool parse_gga_sentence(char* sentence) {
             case 7: // Satellites
                 current_gps_data.satellites = atoi(token);
                 break;
+            case 8: // HDOP
+                if (strlen(token) > 0) {
+                    current_gps_data.hdop = atof(token);
+                }
+                break;
             case 9: // Altitude
                 current_gps_data.altitude = atof(token);
                 break;
         }
-        token = strtok(NULL, ",");
         field++;
     }
     
-    // Considerar fix válido si hay al menos 4 satélites y fix quality > 0
-    current_gps_data.fix_valid = (current_gps_data.satellites >= 4 && current_gps_data.fix_quality > 0);
+    // Fix válido: al menos 4 satélites, fix quality > 0 y una geometría utilizable
+    current_gps_data.fix_valid = (current_gps_data.satellites >= 4 && current_gps_data.fix_quality > 0 &&
+                                  current_gps_data.hdop < GPS_MAX_HDOP);
+    if (current_gps_data.fix_valid) fix_count++;
+    update_quality();
+    
+    // La posición corresponde al flanco PPS de su segundo, no a la llegada
+    current_gps_data.timestamp_us = (second_of_day >= 0)
+        ? timebase_gps_epoch((uint32_t)second_of_day, arrival_us)
+        : arrival_us;
     
     return current_gps_data.fix_valid;
 }
 
+/**
+ * @brief Procesa una sentencia GPGSA (tipo de fix y DOP).
+ * 
+ * Campos: modo, tipo de fix, 12 satélites, PDOP, HDOP y VDOP. El NEO-6M la
+ * envía después de GPGGA, así que se aplica desde el siguiente fix.
+ * 
+ * @param sentence Sentencia NMEA a procesar
+ */
+static void parse_gsa_sentence(char* sentence) {
+    char* cursor = sentence;
+    char* token;
+    int field = 0;
+    
+    while ((token = next_field(&cursor)) != NULL && field < 18) {
+        if (strlen(token) > 0) {
+            switch (field) {
+                case 2: // Tipo de fix
+                    current_gps_data.fix_type = atoi(token);
+                    break;
+                case 15: // PDOP
+                    current_gps_data.pdop = atof(token);
+                    break;
+                case 17: // VDOP
+                    current_gps_data.vdop = atof(token);
+                    break;
+            }
+        }
+        field++;
+    }
+}
+
+/**
+ * @brief Procesa una sentencia GPRMC (velocidad y rumbo sobre el suelo).
+ * 
+ * Campos usados: 1 tiempo, 2 estado (A = válido), 7 velocidad en nudos,
+ * 8 rumbo verdadero y 12 modo (N = sin dato, solo NMEA 2.3).
+ * 
+ * @param sentence Sentencia NMEA a procesar
+ * @param arrival_us Sello de la llegada de la sentencia
+ */
+static void parse_rmc_sentence(char* sentence, uint64_t arrival_us) {
+    char* cursor = sentence;
+    char* token;
+    int field = 0;
+    int32_t second_of_day = -1;
+    bool active = false;
+    bool has_course = false;
+    
+    while ((token = next_field(&cursor)) != NULL && field < 13) {
+        switch (field) {
+            case 1: // Tiempo
+                second_of_day = parse_second_of_day(token);
+                break;
+            case 2: // Estado
+                active = (token[0] == 'A');
+                break;
+            case 7: // Velocidad en nudos
+                current_gps_data.speed_mps = atof(token) * KNOTS_TO_MPS;
+                break;
+            case 8: // Rumbo verdadero
+                has_course = (strlen(token) > 0);
+                if (has_course) current_gps_data.course_deg = atof(token);
+                break;
+            case 12: // Modo
+                if (token[0] == 'N') active = false;
+                break;
+        }
+        field++;
+    }
+    
+    rmc_seen = true;
+    current_gps_data.course_valid = active && has_course;
+    current_gps_data.course_timestamp_us = (second_of_day >= 0)
+        ? timebase_gps_epoch((uint32_t)second_of_day, arrival_us)
+        : arrival_us;
+}
+
+/**
+ * @brief Procesa una sentencia GPVTG (velocidad y rumbo sobre el suelo).
+ * 
+ * Solo se usa si el receptor no envía GPRMC. Campos: 1 rumbo verdadero,
+ * 7 velocidad en km/h y 9 modo (N = sin dato).
+ * 
+ * @param sentence Sentencia NMEA a procesar
+ * @param arrival_us Sello de la llegada de la sentencia
+ */
+static void parse_vtg_sentence(char* sentence, uint64_t arrival_us) {
+    if (rmc_seen) return;
+    
+    char* cursor = sentence;
+    char* token;
+    int field = 0;
+    bool has_course = false;
+    bool active = true;
+    
+    while ((token = next_field(&cursor)) != NULL && field < 10) {
+        switch (field) {
+            case 1: // Rumbo verdadero
+                has_course = (strlen(token) > 0);
+                if (has_course) current_gps_data.course_deg = atof(token);
+                break;
+            case 7: // Velocidad en km/h
+                current_gps_data.speed_mps = atof(token) / 3.6;
+                break;
+            case 9: // Modo
+                if (token[0] == 'N') active = false;
+                break;
+        }
+        field++;
+    }
+    
+    current_gps_data.course_valid = active && has_course && current_gps_data.fix_valid;
+    current_gps_data.course_timestamp_us = arrival_us;
+}
+
+/**
+ * @brief Procesa un byte recibido como parte de un mensaje UBX.
+ *
+ * Formato: 0xB5 0x62, clase, id, longitud (2 bytes, little endian),
+ * contenido y suma de Fletcher de 8 bits sobre clase..contenido.
+ *
+ * @param byte Byte recibido
+ * @return true si el byte pertenece a un mensaje UBX
+ */
+static bool ubx_parse_byte(uint8_t byte) {
+    if (ubx.state == 0) {
+        if (byte != 0xB5) return false;
+        ubx.state = 1;
+        return true;
+    }
+
+    if (ubx.state >= 2 && ubx.state <= 6) {
+        ubx.ck_a += byte;
+        ubx.ck_b += ubx.ck_a;
+    }
+
+    switch (ubx.state) {
+        case 1:
+            ubx.state = (byte == 0x62) ? 2 : 0;
+            ubx.ck_a = ubx.ck_b = 0;
+            break;
+        case 2:
+            ubx.msg_class = byte;
+            ubx.state = 3;
+            break;
+        case 3:
+            ubx.msg_id = byte;
+            ubx.state = 4;
+            break;
+        case 4:
+            ubx.length = byte;
+            ubx.state = 5;
+            break;
+        case 5:
+            ubx.length |= (uint16_t)byte << 8;
+            ubx.index = 0;
+            ubx.state = (ubx.length > 0) ? 6 : 7;
+            break;
+        case 6:
+            if (ubx.index < UBX_MAX_PAYLOAD) {
+                ubx.payload[ubx.index] = byte;
+            }
+            if (++ubx.index >= ubx.length) ubx.state = 7;
+            break;
+        case 7:
+            if (byte == ubx.ck_a) {
+                ubx.state = 8;
+            } else {
+                ubx_errors++;
+                ubx.state = 0;
+            }
+            break;
+        case 8:
+            if (byte != ubx.ck_b) {
+                ubx_errors++;
+            } else {
+                ubx_frames++;
+                if (ubx.length <= UBX_MAX_PAYLOAD) {
+                    gps_aid_handle_ubx(ubx.msg_class, ubx.msg_id, ubx.payload, ubx.length);
+                }
+            }
+            ubx.state = 0;
+            break;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Interrupción de recepción: vacía la FIFO en el buffer circular.
+ */
+static void on_uart_rx(void) {
+    while (uart_is_readable(GPS_UART_ID)) {
+        uint8_t c = (uint8_t)uart_getc(GPS_UART_ID);
+        uint32_t next = (rx_head + 1) & (GPS_RX_BUFFER_SIZE - 1);
+        
+        if (next == rx_tail) {
+            rx_overflows++;
+        } else {
+            rx_buffer[rx_head] = c;
+            
+            // La sentencia se considera capturada al llegar su primer byte
+            uint32_t next_stamp = (stamp_head + 1) % SENTENCE_STAMPS;
+            if (c == '$' && next_stamp != stamp_tail) {
+                sentence_stamps[stamp_head].position = rx_head;
+                sentence_stamps[stamp_head].local_us = time_us_64();
+                stamp_head = next_stamp;
+            }
+            
+            rx_head = next;
+        }
+    }
+}
+
 bool gps_init(void) {
     // Inicializar UART para GPS
     uart_init(GPS_UART_ID, GPS_BAUD_RATE);
@@ -107,7 +510,22 @@ bool gps_init(void) {
     // Configurar formato UART
     uart_set_format(GPS_UART_ID, 8, 1, UART_PARITY_NONE);
     uart_set_hw_flow(GPS_UART_ID, false, false);
-    uart_set_fifo_enabled(GPS_UART_ID, false);
+    
+    // Recepción por interrupción: la FIFO de 32 bytes cubre la latencia del manejador
+    rx_head = rx_tail = 0;
+    stamp_head = stamp_tail = 0;
+    uart_set_fifo_enabled(GPS_UART_ID, true);
+    
+    int irq = (uart_get_index(GPS_UART_ID) == 0) ? UART0_IRQ : UART1_IRQ;
+    irq_set_exclusive_handler(irq, on_uart_rx);
+    irq_set_enabled(irq, true);
+    uart_set_irq_enables(GPS_UART_ID, true, false);
+    
+    // Pulso por segundo para sellar las posiciones
+    timebase_init();
+    
+    // Los suscriptores de BUS_GPS siempre tienen un valor que leer
+    bus_write_gps(&current_gps_data);
     
     initialized = true;
     return true;
@@ -118,18 +536,51 @@ bool gps_update(void) {
     
     static char buffer[256];
     static int buffer_index = 0;
+    static uint64_t sentence_local_us = 0;
+    bool changed = false;
     
-    // Leer datos disponibles
-    while (uart_is_readable(GPS_UART_ID)) {
-        char c = uart_getc(GPS_UART_ID);
+    // Leer los bytes que dejó la interrupción
+    while (rx_tail != rx_head) {
+        char c = (char)rx_buffer[rx_tail];
+        uint32_t position = rx_tail;
+        rx_tail = (rx_tail + 1) & (GPS_RX_BUFFER_SIZE - 1);
+        
+        // Sello del '$' (también se retira si el byte era parte de un UBX)
+        bool stamped = false;
+        uint64_t local_us = 0;
+        if (stamp_tail != stamp_head && sentence_stamps[stamp_tail].position == position) {
+            local_us = sentence_stamps[stamp_tail].local_us;
+            stamp_tail = (stamp_tail + 1) % SENTENCE_STAMPS;
+            stamped = true;
+        }
+        
+        if (ubx_parse_byte((uint8_t)c)) continue;
+        
+        // Sin sello (cola llena) se usa el momento de lectura
+        if (c == '$') {
+            sentence_local_us = stamped ? local_us : time_us_64();
+        }
         
         if (c == '\n' || c == '\r') {
             if (buffer_index > 0) {
                 buffer[buffer_index] = '\0';
+                uint64_t arrival_us = timebase_from_local(sentence_local_us);
                 
-                // Procesar solo sentencias GPGGA
-                if (strncmp(buffer, "$GPGGA", 6) == 0) {
-                    parse_gga_sentence(buffer);
+                // Posición (GPGGA), geometría (GPGSA) y movimiento (GPRMC/GPVTG)
+                if (!nmea_checksum_ok(buffer)) {
+                    nmea_errors++;
+                } else if (strncmp(buffer, "$GPGGA", 6) == 0) {
+                    parse_gga_sentence(buffer, arrival_us);
+                    changed = true;
+                } else if (strncmp(buffer, "$GPGSA", 6) == 0) {
+                    parse_gsa_sentence(buffer);
+                    changed = true;
+                } else if (strncmp(buffer, "$GPRMC", 6) == 0) {
+                    parse_rmc_sentence(buffer, arrival_us);
+                    changed = true;
+                } else if (strncmp(buffer, "$GPVTG", 6) == 0) {
+                    parse_vtg_sentence(buffer, arrival_us);
+                    changed = true;
                 }
                 
                 buffer_index = 0;
@@ -139,23 +590,70 @@ bool gps_update(void) {
         }
     }
     
+    // Una publicación por llamada aunque hayan llegado varias sentencias
+    if (changed) bus_write_gps(&current_gps_data);
+    
     return true;
 }
 
+void gps_send_ubx(uint8_t msg_class, uint8_t msg_id, const void* payload, uint16_t length) {
+    if (!initialized || (!payload && length > 0)) return;
+    
+    uint8_t header[6] = { 0xB5, 0x62, msg_class, msg_id, (uint8_t)(length & 0xFF), (uint8_t)(length >> 8) };
+    uint8_t checksum[2] = {0, 0};
+    
+    for (int i = 2; i < 6; i++) {
+        checksum[0] += header[i];
+        checksum[1] += checksum[0];
+    }
+    for (uint16_t i = 0; i < length; i++) {
+        checksum[0] += ((const uint8_t*)payload)[i];
+        checksum[1] += checksum[0];
+    }
+    
+    uart_write_blocking(GPS_UART_ID, header, sizeof(header));
+    if (length > 0) {
+        uart_write_blocking(GPS_UART_ID, (const uint8_t*)payload, length);
+    }
+    uart_write_blocking(GPS_UART_ID, checksum, sizeof(checksum));
+}
+
 gps_data_t gps_get_data(void) {
     return current_gps_data;
 }
 
+gps_quality_t gps_get_quality(void) {
+    return quality;
+}
+
+gps_rx_stats_t gps_get_rx_stats(void) {
+    gps_rx_stats_t stats = {
+        .rx_overflows = rx_overflows,
+        .ubx_frames = ubx_frames,
+        .ubx_errors = ubx_errors,
+        .nmea_errors = nmea_errors
+    };
+    return stats;
+}
+
 void gps_set_target(double lat, double lng) {
     target_data.latitude = lat;
     target_data.longitude = lng;
     target_data.target_set = true;
+    
+    arrival.holding = false;
+    arrival.confirmed = 0;
+    arrival.last_fix = fix_count;
 }
 
 bool gps_has_target(void) {
     return target_data.target_set;
 }
 
+target_data_t gps_get_target(void) {
+    return target_data;
+}
+
 double gps_distance_to_target(void) {
     if (!current_gps_data.fix_valid || !target_data.target_set) {
         return 0.0;
@@ -197,7 +695,44 @@ double gps_bearing_to_target(void) {
 }
 
 bool gps_target_reached(void) {
-    return gps_distance_to_target() < 2.0; // Menos de 2 metros
+    if (!current_gps_data.fix_valid || !target_data.target_set) {
+        return false;
+    }
+    
+    // Cada fix cuenta una vez aunque se consulte en todas las iteraciones
+    if (arrival.last_fix != fix_count) {
+        arrival.last_fix = fix_count;
+        double distance = gps_distance_to_target();
+        double radius = quality.arrival_radius_m;
+        
+        if (!arrival.holding) {
+            if (distance < radius) {
+                arrival.holding = true;
+                arrival.confirmed = 1;
+            }
+        } else if (distance > radius * GPS_ARRIVAL_HYSTERESIS) {
+            // El fix lo sitúa claramente fuera: volver a acercarse
+            arrival.holding = false;
+            arrival.confirmed = 0;
+        } else {
+            arrival.confirmed++;
+        }
+    }
+    
+    return arrival.confirmed >= GPS_ARRIVAL_CONFIRM_FIXES;
+}
+
+bool gps_target_holding(void) {
+    return arrival.holding;
+}
+
+void gps_latlng_to_local(double origin_lat, double origin_lng, double lat, double lng,
+                         double* east, double* north) {
+    if (!east || !north) return;
+    
+    double meters_per_deg = 6371000 * M_PI / 180.0;
+    *north = (lat - origin_lat) * meters_per_deg;
+    *east = (lng - origin_lng) * meters_per_deg * cos(origin_lat * M_PI / 180.0);
 }
 
 void gps_test(void) {
@@ -209,21 +744,52 @@ void gps_test(void) {
     }
     
     printf("GPS inicializado correctamente\n");
-    printf("Esperando señal GPS (puede tomar varios minutos)...\n");
+    
+    gps_start_t start = gps_aid_init();
+    gps_aid_status_t aid = gps_aid_get_status();
+    printf("Asistencia: %d efemérides, %d almanaques, tiempo %s\n",
+           aid.ephemerides, aid.almanacs, aid.time_known ? "estimado" : "desconocido");
+    printf("Esperando señal GPS (arranque %s%s)...\n", gps_aid_start_name(start),
+           (start == GPS_START_COLD) ? ", puede tomar varios minutos" : "");
     
     while (true) {
         gps_update();
+        uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+        if (gps_aid_update(now_ms)) {
+            printf("Primer fix en %.1f s\n", gps_aid_get_status().ttff_ms / 1000.0);
+        }
+        if (gps_aid_save()) {
+            gps_aid_status_t status = gps_aid_get_status();
+            printf("Asistencia guardada: %d efemérides, %d almanaques\n",
+                   status.ephemerides, status.almanacs);
+        }
         gps_data_t data = gps_get_data();
         
         if (data.fix_valid) {
             printf("GPS Fix válido:\n");
             printf("  Lat: %.6f, Lng: %.6f\n", data.latitude, data.longitude);
             printf("  Satélites: %d, Altitud: %.1f m\n", data.satellites, data.altitude);
+            gps_quality_t fix_quality = gps_get_quality();
+            printf("  Fix %s, HDOP %.2f, PDOP %.2f, VDOP %.2f\n",
+                   (data.fix_type == 2) ? "2D" : (data.fix_type == 3) ? "3D" : "?",
+                   data.hdop, data.pdop, data.vdop);
+            printf("  Error estimado %.1f m, peso %.2f, radio de llegada %.1f m%s\n",
+                   fix_quality.error_m, fix_quality.weight, fix_quality.arrival_radius_m,
+                   fix_quality.hold ? " (geometría pobre: retener)" : "");
             printf("  Tiempo: %s\n", data.time);
+            if (data.course_valid) {
+                printf("  Velocidad: %.2f m/s, rumbo sobre el suelo: %.1f°\n",
+                       data.speed_mps, data.course_deg);
+            }
         } else {
             printf("Sin fix GPS - Satélites: %d\n", data.satellites);
         }
         
+        gps_rx_stats_t rx = gps_get_rx_stats();
+        printf("  Recepción: %lu bytes perdidos, %lu mensajes UBX, %lu inválidos, %lu NMEA inválidas\n",
+               (unsigned long)rx.rx_overflows, (unsigned long)rx.ubx_frames,
+               (unsigned long)rx.ubx_errors, (unsigned long)rx.nmea_errors);
+        
         sleep_ms(1000);
     }
 }
\ No newline at end of file
@@ -28,10 +28,42 @@ typedef struct {
     double altitude;     ///< Altitud en metros
     int satellites;      ///< Número de satélites en uso
     int fix_quality;     ///< Calidad del fix (0=sin fix, 1=GPS, 2=DGPS)
+    int fix_type;        ///< Tipo de fix según GSA (0=desconocido, 1=sin fix, 2=2D, 3=3D)
+    double hdop;         ///< Dilución horizontal de la precisión (GGA)
+    double pdop;         ///< Dilución de la precisión en posición (GSA)
+    double vdop;         ///< Dilución vertical de la precisión (GSA)
     bool fix_valid;      ///< true si el fix GPS es válido
     char time[8];        ///< Tiempo UTC en formato HHMMSS
+    uint64_t timestamp_us; ///< Época del fix en la base de tiempo (timebase.h)
+    double speed_mps;    ///< Velocidad sobre el suelo en m/s (RMC/VTG)
+    double course_deg;   ///< Rumbo sobre el suelo en grados verdaderos (RMC/VTG)
+    bool course_valid;   ///< true si el rumbo sobre el suelo es válido
+    uint64_t course_timestamp_us; ///< Época del rumbo en la base de tiempo
 } gps_data_t;
 
+/**
+ * @brief Modelo de calidad del fix actual.
+ *
+ * El error horizontal se estima como HDOP por el error de rango del
+ * receptor (GPS_UERE_M); con fix 2D se multiplica por GPS_2D_ERROR_FACTOR.
+ */
+typedef struct {
+    double error_m;          ///< Error horizontal estimado en m (1 sigma)
+    double weight;           ///< Peso del fix para la navegación (1 = HDOP 1 o mejor)
+    double arrival_radius_m; ///< Radio de llegada según el error actual
+    bool hold;               ///< Geometría demasiado pobre: mantener la posición
+} gps_quality_t;
+
+/**
+ * @brief Contadores de la recepción por la UART del GPS.
+ */
+typedef struct {
+    uint32_t rx_overflows;   ///< Bytes descartados por buffer de recepción lleno
+    uint32_t ubx_frames;     ///< Mensajes UBX recibidos con suma de verificación correcta
+    uint32_t ubx_errors;     ///< Mensajes UBX descartados por suma de verificación
+    uint32_t nmea_errors;    ///< Sentencias NMEA descartadas por suma de verificación
+} gps_rx_stats_t;
+
 /**
  * @brief Estructura que contiene las coordenadas objetivo.
  */
@@ -49,7 +81,9 @@ typedef struct {
 /**
  * @brief Inicializa la comunicación UART con el módulo GPS.
  * 
- * Configura los pines UART, velocidad de comunicación y formato.
+ * Configura los pines UART, velocidad de comunicación y formato. La
+ * recepción queda a cargo de la interrupción de la UART, que vacía la FIFO
+ * en un buffer circular de GPS_RX_BUFFER_SIZE bytes.
  * 
  * @return true si la inicialización fue exitosa
  */
@@ -58,20 +92,54 @@ bool gps_init(void);
 /**
  * @brief Actualiza los datos GPS leyendo desde UART.
  * 
- * Lee los datos disponibles en el buffer UART y procesa las
- * sentencias NMEA GPGGA para actualizar la información de posición.
+ * Lee los datos acumulados en el buffer de recepción y procesa las
+ * sentencias NMEA GPGGA (posición y HDOP), GPGSA (tipo de fix y DOP) y
+ * GPRMC/GPVTG (velocidad y rumbo sobre el suelo) para actualizar la
+ * información de posición, su calidad y el movimiento.
+ * Los mensajes UBX se pasan a la asistencia de arranque.
+ * Si llegó alguna sentencia publica los datos en el tópico BUS_GPS.
  * 
  * @return true si se procesaron datos correctamente
  */
 bool gps_update(void);
 
+/**
+ * @brief Envía un mensaje UBX al receptor.
+ *
+ * Agrega la sincronización y la suma de verificación. Bloquea hasta
+ * terminar de transmitir (~1 ms por byte a 9600 baudios).
+ *
+ * @param msg_class Clase del mensaje
+ * @param msg_id Identificador del mensaje
+ * @param payload Contenido (puede ser NULL si length es 0, p. ej. un sondeo)
+ * @param length Longitud del contenido
+ */
+void gps_send_ubx(uint8_t msg_class, uint8_t msg_id, const void* payload, uint16_t length);
+
 /**
  * @brief Obtiene la estructura con los datos GPS actuales.
  * 
+ * Devuelve una copia; en el bucle de control conviene leer el tópico
+ * BUS_GPS (bus.h), que no copia.
+ * 
  * @return Estructura gps_data_t con los datos más recientes
  */
 gps_data_t gps_get_data(void);
 
+/**
+ * @brief Obtiene el modelo de calidad del fix actual.
+ * 
+ * @return Error estimado, peso, radio de llegada y retención
+ */
+gps_quality_t gps_get_quality(void);
+
+/**
+ * @brief Obtiene los contadores de la recepción.
+ *
+ * @return Bytes perdidos y mensajes UBX correctos y descartados
+ */
+gps_rx_stats_t gps_get_rx_stats(void);
+
 /**
  * @brief Establece las coordenadas objetivo para navegación.
  * 
@@ -87,6 +155,13 @@ void gps_set_target(double lat, double lng);
  */
 bool gps_has_target(void);
 
+/**
+ * @brief Obtiene las coordenadas objetivo actuales.
+ * 
+ * @return Estructura target_data_t con el objetivo (target_set = false si no hay)
+ */
+target_data_t gps_get_target(void);
+
 /**
  * @brief Calcula la distancia al objetivo usando fórmula haversine.
  * 
@@ -104,10 +179,40 @@ double gps_bearing_to_target(void);
 /**
  * @brief Verifica si se ha alcanzado el objetivo.
  * 
- * @return true si la distancia al objetivo es menor a 2 metros
+ * El radio de llegada se adapta al error estimado del fix. Al entrar en
+ * él el robot se detiene (gps_target_holding()) y la llegada se confirma
+ * con GPS_ARRIVAL_CONFIRM_FIXES fixes seguidos dentro de la banda de
+ * histéresis, para no declararla por un salto de ruido ni rodear el
+ * objetivo persiguiéndolo.
+ * 
+ * @return true si la llegada está confirmada
  */
 bool gps_target_reached(void);
 
+/**
+ * @brief Indica si el robot debe esperar quieto junto al objetivo.
+ * 
+ * @return true desde que entra en el radio de llegada hasta que la
+ *         llegada se confirma o un fix lo sitúa fuera de la histéresis
+ */
+bool gps_target_holding(void);
+
+/**
+ * @brief Proyecta coordenadas geográficas a un plano local (Este, Norte).
+ * 
+ * Usa una proyección equirectangular centrada en el origen dado, suficiente
+ * para las distancias cortas de operación (error < 0.1% en pocos km).
+ * 
+ * @param origin_lat Latitud del origen en grados decimales
+ * @param origin_lng Longitud del origen en grados decimales
+ * @param lat Latitud a proyectar
+ * @param lng Longitud a proyectar
+ * @param[out] east Coordenada Este en metros
+ * @param[out] north Coordenada Norte en metros
+ */
+void gps_latlng_to_local(double origin_lat, double origin_lng, double lat, double lng,
+                         double* east, double* north);
+
 /**
  * @brief Función de prueba independiente del GPS.
  * 
@@ -0,0 +1,497 @@
+/**
+ * @file gps_aid.c
+ * @brief Implementación de la asistencia de arranque del GPS NEO-6M.
+ *
+ * Mensajes UBX usados (protocolo u-blox 6):
+ * - AID-DATA (sondeo): el receptor responde AID-INI, AID-HUI y un AID-ALM y
+ *   un AID-EPH por satélite (contenido corto si no tiene datos de ese SV).
+ * - AID-INI: posición y tiempo iniciales; se reenvía la posición que dio el
+ *   receptor con el tiempo estimado al arrancar.
+ * - NAV-TIMEGPS (sondeo periódico con fix): disciplina el reloj interno en
+ *   tiempo GPS, que es el que se guarda y el que se inyecta.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "gps_aid.h"
+#include "gps.h"
+#include "bus.h"
+#include "storage.h"
+#include "bluetooth.h"
+#include "config.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+/// @defgroup UBX_AID Mensajes UBX de asistencia
+/// @{
+#define UBX_CLASS_NAV 0x01
+#define UBX_CLASS_AID 0x0B
+#define UBX_NAV_TIMEGPS 0x20
+#define UBX_AID_INI 0x01
+#define UBX_AID_HUI 0x02
+#define UBX_AID_DATA 0x10
+#define UBX_AID_ALM 0x30
+#define UBX_AID_EPH 0x31
+
+#define AID_INI_SIZE 48
+#define AID_HUI_SIZE 72
+#define AID_ALM_WORDS 8
+#define AID_EPH_WORDS 24
+
+#define INI_FLAG_POS 0x0001u   ///< Posición válida
+#define INI_FLAG_TIME 0x0002u  ///< Tiempo válido
+#define INI_FLAG_CLOCK 0x001Cu ///< Deriva, pulso de tiempo y frecuencia
+#define INI_FLAG_PREV 0x0080u  ///< Tiempo de un pulso anterior
+#define INI_FLAG_UTC 0x0400u   ///< Tiempo en UTC en lugar de GPS
+/// @}
+
+/// @brief Satélites GPS (SV 1 a 32)
+#define GPS_SV_COUNT 32
+
+/// @brief Versión del formato guardado en flash
+#define AID_VERSION 1
+
+/// @brief Firma del reloj en RAM no inicializada
+#define CLOCK_MAGIC 0x4B4C4347u
+
+/// @brief Milisegundos en una semana GPS
+#define WEEK_MS 604800000LL
+
+/// @brief Segundos Unix al inicio de la época GPS (6 de enero de 1980)
+#define GPS_EPOCH_UNIX_S 315964800LL
+
+/// @brief Retardo máximo entre la época de NAV-TIMEGPS y su lectura en el bucle
+#define SYNC_LATENCY_MS 100
+
+/**
+ * @brief Efemérides de un satélite (subtramas 1 a 3).
+ */
+typedef struct {
+    uint32_t valid;                   ///< 1 si hay datos
+    uint32_t how;                     ///< Palabra HOW
+    uint32_t words[AID_EPH_WORDS];    ///< Palabras de las subtramas
+} aid_eph_t;
+
+/**
+ * @brief Almanaque de un satélite.
+ */
+typedef struct {
+    uint32_t valid;                   ///< 1 si hay datos
+    uint32_t week;                    ///< Semana del almanaque
+    uint32_t words[AID_ALM_WORDS];    ///< Palabras del almanaque
+} aid_alm_t;
+
+/**
+ * @brief Captura completa que se guarda en flash.
+ */
+typedef struct {
+    uint32_t version;                 ///< AID_VERSION
+    uint32_t has_ini;                 ///< 1 si ini es válido
+    uint32_t has_hui;                 ///< 1 si hui es válido
+    uint32_t reserved;                ///< Alineación
+    int64_t gps_ms;                   ///< Tiempo GPS de la captura (0 desconocido)
+    uint8_t ini[AID_INI_SIZE];        ///< AID-INI tal como lo dio el receptor
+    uint8_t hui[AID_HUI_SIZE];        ///< AID-HUI (salud, UTC, ionosfera)
+    aid_alm_t alm[GPS_SV_COUNT];      ///< Almanaques
+    aid_eph_t eph[GPS_SV_COUNT];      ///< Efemérides
+} aid_image_t;
+
+/**
+ * @brief Reloj que sobrevive a un reinicio en caliente.
+ */
+typedef struct {
+    uint32_t magic;                   ///< CLOCK_MAGIC
+    uint32_t check;                   ///< Complemento de la parte baja de gps_ms
+    int64_t gps_ms;                   ///< Último tiempo GPS conocido
+} clock_record_t;
+
+/// @brief Captura en RAM (la guardada o la que se está recibiendo)
+static aid_image_t image;
+static bool image_dirty = false;
+
+/// @brief Reloj en RAM no inicializada
+static clock_record_t __uninitialized_ram(clock_record);
+
+/// @brief Reloj GPS: tiempo GPS = ms desde el arranque + desfase
+static bool time_known = false;
+static int64_t clock_offset_ms = 0;
+static uint32_t time_acc_ms = 0;
+static int leap_seconds = GPS_LEAP_SECONDS;
+
+/// @brief Estado del arranque y de los sondeos
+static bool initialized = false;
+static gps_start_t start_kind = GPS_START_COLD;
+static uint32_t start_ms = 0;
+static uint32_t ttff_ms = 0;
+static bool had_fix = false;
+static uint32_t next_poll_ms = 0;
+static uint32_t next_sync_ms = 0;
+static uint32_t capture_until_ms = 0;
+static int captured_eph = 0;
+static int injected_eph = 0;
+
+/// @brief Mensajes AID-ALM y AID-EPH recibidos en la captura en curso
+static int captured_frames = 0;
+
+/// @brief Contadores de recepción al iniciar la captura
+static gps_rx_stats_t capture_rx;
+
+/// @brief Capturas descartadas por llegar incompletas
+static uint32_t failed_captures = 0;
+
+/// @brief Lector del tópico BUS_GPS
+static bus_subscriber_t gps_subscriber;
+
+/// @brief Nombres de los tipos de arranque
+static const char* const start_names[] = { "FRIO", "TIBIO", "CALIENTE" };
+
+/**
+ * @brief Tiempo GPS estimado en ms.
+ */
+static int64_t gps_time_ms(uint32_t now_ms) {
+    return (int64_t)now_ms + clock_offset_ms;
+}
+
+/**
+ * @brief Ajusta el reloj GPS.
+ */
+static void set_clock(int64_t gps_ms, uint32_t accuracy_ms) {
+    clock_offset_ms = gps_ms - (int64_t)to_ms_since_boot(get_absolute_time());
+    time_acc_ms = accuracy_ms;
+    time_known = true;
+}
+
+/**
+ * @brief Envía AID-INI con la posición guardada y el tiempo estimado.
+ *
+ * @return true si había posición o tiempo para enviar
+ */
+static bool inject_ini(uint32_t now_ms) {
+    uint8_t ini[AID_INI_SIZE] = {0};
+    uint32_t flags = 0;
+
+    if (image.has_ini) {
+        memcpy(ini, image.ini, sizeof(ini));
+        memcpy(&flags, &ini[44], sizeof(flags));
+    }
+
+    // El tiempo y el estado del reloj de la captura ya no valen
+    flags &= ~(INI_FLAG_TIME | INI_FLAG_CLOCK | INI_FLAG_PREV | INI_FLAG_UTC);
+
+    // El robot pudo moverse apagado: la precisión guardada es optimista
+    if (flags & INI_FLAG_POS) {
+        uint32_t pos_acc_cm;
+        memcpy(&pos_acc_cm, &ini[12], sizeof(pos_acc_cm));
+        if (pos_acc_cm < GPS_AID_POS_ACC_M * 100u) {
+            pos_acc_cm = GPS_AID_POS_ACC_M * 100u;
+            memcpy(&ini[12], &pos_acc_cm, sizeof(pos_acc_cm));
+        }
+    }
+
+    if (time_known) {
+        int64_t gps_ms = gps_time_ms(now_ms);
+        uint16_t tm_cfg = 0;
+        uint16_t week = (uint16_t)(gps_ms / WEEK_MS);
+        uint32_t tow_ms = (uint32_t)(gps_ms % WEEK_MS);
+        int32_t tow_ns = 0;
+        uint32_t acc_ns = 0;
+
+        memcpy(&ini[16], &tm_cfg, sizeof(tm_cfg));
+        memcpy(&ini[18], &week, sizeof(week));
+        memcpy(&ini[20], &tow_ms, sizeof(tow_ms));
+        memcpy(&ini[24], &tow_ns, sizeof(tow_ns));
+        memcpy(&ini[28], &time_acc_ms, sizeof(time_acc_ms));
+        memcpy(&ini[32], &acc_ns, sizeof(acc_ns));
+        flags |= INI_FLAG_TIME;
+    }
+
+    if (!(flags & (INI_FLAG_POS | INI_FLAG_TIME))) return false;
+
+    memcpy(&ini[44], &flags, sizeof(flags));
+    gps_send_ubx(UBX_CLASS_AID, UBX_AID_INI, ini, sizeof(ini));
+    return true;
+}
+
+/**
+ * @brief Carga la captura guardada en flash (vacía si no hay una válida).
+ */
+static void load_image(void) {
+    size_t length = 0;
+    if (!storage_read(STORAGE_REGION_GPS_AID, &image, sizeof(image), &length) ||
+        length != sizeof(image) || image.version != AID_VERSION) {
+        memset(&image, 0, sizeof(image));
+    }
+}
+
+/**
+ * @brief Antigüedad de la captura en ms (-1 desconocida).
+ */
+static int64_t image_age_ms(uint32_t now_ms) {
+    if (!time_known || image.gps_ms <= 0) return -1;
+    return gps_time_ms(now_ms) - image.gps_ms;
+}
+
+gps_start_t gps_aid_init(void) {
+    if (initialized) return start_kind;
+    initialized = true;
+    bus_subscribe(&gps_subscriber, BUS_GPS);
+
+    uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+    start_ms = now_ms;
+
+    // Reinicio en caliente: el reloj siguió contando hasta el reinicio
+    if (clock_record.magic == CLOCK_MAGIC && clock_record.check == ~(uint32_t)clock_record.gps_ms) {
+        set_clock(clock_record.gps_ms + now_ms, GPS_AID_TIME_ACC_MS);
+    }
+    clock_record.magic = 0;
+
+    load_image();
+
+    // Orden recomendado: posición y tiempo, salud y después los satélites
+    bool ini_sent = inject_ini(now_ms);
+
+    if (image.has_hui) {
+        gps_send_ubx(UBX_CLASS_AID, UBX_AID_HUI, image.hui, AID_HUI_SIZE);
+    }
+
+    // Sin tiempo el receptor descarta por sí mismo las efemérides vencidas
+    int64_t age_ms = image_age_ms(now_ms);
+    bool eph_current = age_ms < 0 || age_ms <= GPS_AID_EPH_MAX_AGE_S * 1000LL;
+
+    int eph_sent = 0;
+    int alm_sent = 0;
+    uint8_t payload[8 + AID_EPH_WORDS * 4];
+
+    for (uint32_t sv = 1; sv <= GPS_SV_COUNT; sv++) {
+        const aid_eph_t* eph = &image.eph[sv - 1];
+        if (!eph->valid || !eph_current) continue;
+
+        memcpy(&payload[0], &sv, 4);
+        memcpy(&payload[4], &eph->how, 4);
+        memcpy(&payload[8], eph->words, sizeof(eph->words));
+        gps_send_ubx(UBX_CLASS_AID, UBX_AID_EPH, payload, 8 + sizeof(eph->words));
+        eph_sent++;
+    }
+
+    for (uint32_t sv = 1; sv <= GPS_SV_COUNT; sv++) {
+        const aid_alm_t* alm = &image.alm[sv - 1];
+        if (!alm->valid) continue;
+
+        memcpy(&payload[0], &sv, 4);
+        memcpy(&payload[4], &alm->week, 4);
+        memcpy(&payload[8], alm->words, sizeof(alm->words));
+        gps_send_ubx(UBX_CLASS_AID, UBX_AID_ALM, payload, 8 + sizeof(alm->words));
+        alm_sent++;
+    }
+
+    injected_eph = eph_sent;
+    if (eph_sent >= 4 && time_known) {
+        start_kind = GPS_START_HOT;
+    } else if (alm_sent > 0 || ini_sent) {
+        start_kind = GPS_START_WARM;
+    } else {
+        start_kind = GPS_START_COLD;
+    }
+
+    return start_kind;
+}
+
+bool gps_aid_update(uint32_t now_ms) {
+    const gps_data_t* data = bus_read_gps(&gps_subscriber);
+    bool fix_valid = data && data->fix_valid;
+    bus_release(&gps_subscriber);
+    bool first_fix = false;
+
+    if (fix_valid && !had_fix) {
+        if (ttff_ms == 0) {
+            ttff_ms = (now_ms - start_ms) ? (now_ms - start_ms) : 1;
+            first_fix = true;
+        }
+        next_sync_ms = now_ms;
+        next_poll_ms = now_ms + GPS_AID_FIRST_POLL_S * 1000u;
+    }
+    had_fix = fix_valid;
+
+    if (had_fix && (int32_t)(now_ms - next_sync_ms) >= 0) {
+        gps_send_ubx(UBX_CLASS_NAV, UBX_NAV_TIMEGPS, NULL, 0);
+        next_sync_ms = now_ms + GPS_AID_TIME_SYNC_MS;
+    }
+
+    if (had_fix && capture_until_ms == 0 && (int32_t)(now_ms - next_poll_ms) >= 0) {
+        gps_send_ubx(UBX_CLASS_AID, UBX_AID_DATA, NULL, 0);
+        captured_eph = 0;
+        captured_frames = 0;
+        capture_rx = gps_get_rx_stats();
+        capture_until_ms = now_ms + GPS_AID_CAPTURE_MS;
+        next_poll_ms = now_ms + GPS_AID_POLL_INTERVAL_S * 1000u;
+    }
+
+    // Fin de la captura: se guarda solo si llegó completa y trajo efemérides
+    if (capture_until_ms != 0 && (int32_t)(now_ms - capture_until_ms) >= 0) {
+        capture_until_ms = 0;
+        if (captured_frames < 2 * GPS_SV_COUNT) {
+            // Mezclaría satélites nuevos con viejos bajo la fecha nueva: se descarta
+            gps_rx_stats_t rx = gps_get_rx_stats();
+            printf("GPS_AID: captura incompleta (%d de %d mensajes, %lu bytes perdidos, %lu UBX inválidos)\n",
+                   captured_frames, 2 * GPS_SV_COUNT,
+                   (unsigned long)(rx.rx_overflows - capture_rx.rx_overflows),
+                   (unsigned long)(rx.ubx_errors - capture_rx.ubx_errors));
+            failed_captures++;
+            load_image();
+            image_dirty = false;
+        } else if (captured_eph > 0) {
+            image.gps_ms = time_known ? gps_time_ms(now_ms) : 0;
+            image_dirty = true;
+        }
+    }
+
+    if (time_known) {
+        int64_t gps_ms = gps_time_ms(now_ms);
+        clock_record.gps_ms = gps_ms;
+        clock_record.check = ~(uint32_t)gps_ms;
+        clock_record.magic = CLOCK_MAGIC;
+    }
+
+    return first_fix;
+}
+
+bool gps_aid_save(void) {
+    if (!image_dirty) return false;
+
+    image_dirty = false;
+    image.version = AID_VERSION;
+    return storage_write(STORAGE_REGION_GPS_AID, &image, sizeof(image));
+}
+
+void gps_aid_handle_ubx(uint8_t msg_class, uint8_t msg_id, const uint8_t* payload, uint16_t length) {
+    if (msg_class == UBX_CLASS_NAV && msg_id == UBX_NAV_TIMEGPS && length == 16) {
+        uint32_t tow_ms;
+        int16_t week;
+        int8_t leap;
+        memcpy(&tow_ms, &payload[0], 4);
+        memcpy(&week, &payload[8], 2);
+        memcpy(&leap, &payload[10], 1);
+        uint8_t valid = payload[11];
+
+        if ((valid & 0x03) == 0x03) {
+            set_clock((int64_t)week * WEEK_MS + tow_ms + SYNC_LATENCY_MS / 2, SYNC_LATENCY_MS);
+        }
+        if (valid & 0x04) {
+            leap_seconds = leap;
+        }
+        return;
+    }
+
+    // Los datos de asistencia solo se aceptan durante una captura
+    if (msg_class != UBX_CLASS_AID || capture_until_ms == 0) return;
+
+    uint32_t sv = 0;
+    if (length >= 4) memcpy(&sv, payload, 4);
+
+    switch (msg_id) {
+        case UBX_AID_INI:
+            if (length == AID_INI_SIZE) {
+                memcpy(image.ini, payload, AID_INI_SIZE);
+                image.has_ini = 1;
+            }
+            break;
+
+        case UBX_AID_HUI:
+            if (length == AID_HUI_SIZE) {
+                memcpy(image.hui, payload, AID_HUI_SIZE);
+                image.has_hui = 1;
+            }
+            break;
+
+        case UBX_AID_ALM:
+            if (sv < 1 || sv > GPS_SV_COUNT) break;
+            if (length == 8 + AID_ALM_WORDS * 4) {
+                aid_alm_t* alm = &image.alm[sv - 1];
+                memcpy(&alm->week, &payload[4], 4);
+                memcpy(alm->words, &payload[8], sizeof(alm->words));
+                alm->valid = 1;
+                captured_frames++;
+            } else if (length == 8) {
+                image.alm[sv - 1].valid = 0;
+                captured_frames++;
+            }
+            break;
+
+        case UBX_AID_EPH:
+            if (sv < 1 || sv > GPS_SV_COUNT) break;
+            if (length == 8 + AID_EPH_WORDS * 4) {
+                aid_eph_t* eph = &image.eph[sv - 1];
+                memcpy(&eph->how, &payload[4], 4);
+                memcpy(eph->words, &payload[8], sizeof(eph->words));
+                eph->valid = 1;
+                captured_eph++;
+                captured_frames++;
+            } else if (length == 8) {
+                image.eph[sv - 1].valid = 0;
+                captured_frames++;
+            }
+            break;
+    }
+}
+
+bool gps_aid_handle_command(const char* line) {
+    if (!line) return false;
+
+    char reply[64];
+
+    if (strncmp(line, "TIME,", 5) == 0) {
+        char* end = NULL;
+        long long unix_s = strtoll(line + 5, &end, 10);
+        if (end == line + 5 || unix_s < GPS_EPOCH_UNIX_S) {
+            bluetooth_send_string("Formato inválido. Usar: TIME,UNIX_S\n");
+            return true;
+        }
+
+        // El tiempo del propio receptor es más preciso que el del teléfono
+        if (!time_known || time_acc_ms >= GPS_AID_TIME_ACC_MS) {
+            set_clock((unix_s - GPS_EPOCH_UNIX_S + leap_seconds) * 1000LL, GPS_AID_TIME_ACC_MS);
+            // Antes del primer fix el tiempo todavía acelera la búsqueda
+            if (initialized && ttff_ms == 0 && inject_ini(to_ms_since_boot(get_absolute_time()))) {
+                start_kind = (injected_eph >= 4) ? GPS_START_HOT : GPS_START_WARM;
+            }
+        }
+        bluetooth_send_string("TIME,OK\n");
+        return true;
+    }
+
+    if (strcmp(line, "GPS_AID?") == 0) {
+        gps_aid_status_t status = gps_aid_get_status();
+        snprintf(reply, sizeof(reply), "GPS_AID,%d,%d,%ld,%ld,%s,%lu\n",
+                 status.ephemerides, status.almanacs, (long)status.age_min,
+                 status.ttff_ms ? (long)(status.ttff_ms / 1000) : -1L,
+                 gps_aid_start_name(status.start), (unsigned long)status.failed_captures);
+        bluetooth_send_string(reply);
+        return true;
+    }
+
+    return false;
+}
+
+gps_aid_status_t gps_aid_get_status(void) {
+    gps_aid_status_t status = {0};
+
+    for (int sv = 0; sv < GPS_SV_COUNT; sv++) {
+        if (image.eph[sv].valid) status.ephemerides++;
+        if (image.alm[sv].valid) status.almanacs++;
+    }
+
+    int64_t age_ms = image_age_ms(to_ms_since_boot(get_absolute_time()));
+    status.age_min = (age_ms < 0) ? -1 : (int32_t)(age_ms / 60000);
+    status.time_known = time_known;
+    status.start = start_kind;
+    status.ttff_ms = ttff_ms;
+    status.failed_captures = failed_captures;
+    return status;
+}
+
+const char* gps_aid_start_name(gps_start_t start) {
+    return (start <= GPS_START_HOT) ? start_names[start] : "?";
+}
\ No newline at end of file
@@ -0,0 +1,126 @@
+/**
+ * @file gps_aid.h
+ * @brief Header de la asistencia de arranque del GPS NEO-6M (UBX AID).
+ *
+ * Con fix, el receptor se sondea con AID-DATA (posición y tiempo, salud e
+ * ionosfera, almanaque y efemérides) y la captura se guarda en flash. Al
+ * arrancar se inyecta de vuelta junto con una estimación del tiempo GPS,
+ * de modo que el receptor hace un arranque caliente o tibio en lugar de
+ * descargar todo desde los satélites. El tiempo de primer fix (TTFF) se
+ * mide y se informa.
+ *
+ * El RP2040 no tiene reloj con batería: la estimación de tiempo sale del
+ * reloj que se conserva en RAM no inicializada tras un reinicio en caliente
+ * o del comando TIME que envía la app.
+ *
+ * Comandos (App -> Robot):
+ * - "TIME,<unix_s>": hora UTC del teléfono; responde "TIME,OK"
+ * - "GPS_AID?": responde
+ *   "GPS_AID,<efemérides>,<almanaques>,<edad_min|-1>,<ttff_s|-1>,<arranque>,<capturas_incompletas>"
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef GPS_AID_H
+#define GPS_AID_H
+
+#include "pico/stdlib.h"
+#include <stdint.h>
+
+/// @defgroup GPS_AID_STRUCTURES Estructuras de la asistencia GPS
+/// @{
+
+/**
+ * @brief Tipo de arranque según la asistencia inyectada.
+ */
+typedef enum {
+    GPS_START_COLD = 0,  ///< Sin datos: descarga completa desde los satélites
+    GPS_START_WARM,      ///< Almanaque, posición o tiempo aproximados
+    GPS_START_HOT        ///< Efemérides vigentes y tiempo conocido
+} gps_start_t;
+
+/**
+ * @brief Estado de la asistencia y del primer fix.
+ */
+typedef struct {
+    int ephemerides;         ///< Satélites con efemérides guardadas
+    int almanacs;            ///< Satélites con almanaque guardado
+    int32_t age_min;         ///< Antigüedad de los datos guardados (-1 desconocida)
+    bool time_known;         ///< Hay estimación del tiempo GPS
+    gps_start_t start;       ///< Tipo de arranque logrado con la inyección
+    uint32_t ttff_ms;        ///< Tiempo hasta el primer fix (0 sin fix aún)
+    uint32_t failed_captures; ///< Capturas descartadas por no recibir todos los mensajes
+} gps_aid_status_t;
+
+/// @}
+
+/// @defgroup GPS_AID_FUNCTIONS Funciones de la asistencia GPS
+/// @{
+
+/**
+ * @brief Inyecta la asistencia guardada y empieza a medir el TTFF.
+ *
+ * Debe llamarse después de gps_init(). Solo inyecta una vez por arranque.
+ *
+ * @return Tipo de arranque que permite la asistencia inyectada
+ */
+gps_start_t gps_aid_init(void);
+
+/**
+ * @brief Mantiene el reloj, mide el TTFF y programa los sondeos.
+ *
+ * Debe llamarse una vez por iteración, después de gps_update().
+ *
+ * @param now_ms Tiempo actual en ms
+ * @return true en la iteración en que se obtuvo el primer fix
+ */
+bool gps_aid_update(uint32_t now_ms);
+
+/**
+ * @brief Guarda en flash la última captura completa, si hay una nueva.
+ *
+ * El borrado de flash detiene el programa unos 100 ms: llamar solo con el
+ * robot detenido.
+ *
+ * @return true si se escribió la flash
+ */
+bool gps_aid_save(void);
+
+/**
+ * @brief Procesa un mensaje UBX recibido del GPS.
+ *
+ * @param msg_class Clase del mensaje
+ * @param msg_id Identificador del mensaje
+ * @param payload Contenido
+ * @param length Longitud del contenido
+ */
+void gps_aid_handle_ubx(uint8_t msg_class, uint8_t msg_id, const uint8_t* payload, uint16_t length);
+
+/**
+ * @brief Procesa los comandos TIME y GPS_AID?.
+ *
+ * @param line Línea recibida por Bluetooth
+ * @return true si la línea era un comando de la asistencia GPS
+ */
+bool gps_aid_handle_command(const char* line);
+
+/**
+ * @brief Obtiene el estado de la asistencia.
+ *
+ * @return Copia del estado
+ */
+gps_aid_status_t gps_aid_get_status(void);
+
+/**
+ * @brief Nombre de un tipo de arranque.
+ *
+ * @param start Tipo de arranque
+ * @return "FRIO", "TIBIO" o "CALIENTE"
+ */
+const char* gps_aid_start_name(gps_start_t start);
+
+/// @}
+
+#endif // GPS_AID_H
\ No newline at end of file
@@ -0,0 +1,249 @@
+/**
+ * @file link.c
+ * @brief Implementación de la supervisión del enlace Bluetooth.
+ *
+ * El robot envía un PING por segundo con número de secuencia y su propio
+ * tiempo; la app lo devuelve como PONG. El RTT se calcula con el tiempo
+ * devuelto (no hace falta sincronizar relojes) y se suaviza como en
+ * RFC 6298. Cualquier línea recibida cuenta como tráfico para detectar la
+ * pérdida del enlace.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "link.h"
+#include "bluetooth.h"
+#include "config.h"
+#include <string.h>
+#include <stdlib.h>
+
+/// @brief Número de PING en vuelo que se recuerdan
+#define PENDING_SLOTS 8
+
+/**
+ * @brief PING enviado esperando respuesta.
+ */
+typedef struct {
+    uint32_t seq;      ///< Número de secuencia
+    uint32_t sent_ms;  ///< Tiempo de envío
+    bool waiting;      ///< true si aún no llega el PONG
+} link_pending_t;
+
+/// @brief PING en vuelo
+static link_pending_t pending[PENDING_SLOTS];
+
+/// @brief Estadísticas acumuladas
+static link_stats_t stats;
+
+/// @brief Próximo número de secuencia
+static uint32_t next_seq = 0;
+
+/// @brief Tiempos de referencia
+static uint32_t last_ping_ms = 0;
+static uint32_t last_rx_ms = 0;
+static uint32_t last_report_ms = 0;
+
+/// @brief true si ya se recibió alguna línea
+static bool has_rx = false;
+
+/// @brief Estado del enlace en la última actualización
+static bool was_alive = false;
+
+/// @brief true si ya hay una medida de RTT
+static bool rtt_valid = false;
+
+/**
+ * @brief Actualiza la pérdida reciente (media móvil exponencial 1/8).
+ */
+static void update_loss(bool lost) {
+    stats.loss_permille -= stats.loss_permille / 8;
+    if (lost) {
+        stats.loss_permille += 1000 / 8;
+    }
+}
+
+/**
+ * @brief Incorpora una medida de RTT (suavizado RFC 6298).
+ */
+static void update_rtt(uint32_t rtt) {
+    if (!rtt_valid) {
+        stats.srtt_ms = rtt;
+        stats.rttvar_ms = rtt / 2;
+        stats.rtt_min_ms = rtt;
+        stats.rtt_max_ms = rtt;
+        rtt_valid = true;
+        return;
+    }
+
+    uint32_t err = (stats.srtt_ms > rtt) ? stats.srtt_ms - rtt : rtt - stats.srtt_ms;
+    stats.rttvar_ms = (3 * stats.rttvar_ms + err) / 4;
+    stats.srtt_ms = (7 * stats.srtt_ms + rtt) / 8;
+
+    if (rtt < stats.rtt_min_ms) stats.rtt_min_ms = rtt;
+    if (rtt > stats.rtt_max_ms) stats.rtt_max_ms = rtt;
+}
+
+void link_init(uint32_t now_ms) {
+    memset(pending, 0, sizeof(pending));
+    memset(&stats, 0, sizeof(stats));
+    next_seq = 0;
+    last_ping_ms = now_ms;
+    last_rx_ms = now_ms;
+    last_report_ms = now_ms;
+    has_rx = false;
+    was_alive = false;
+    rtt_valid = false;
+}
+
+bool link_handle_line(const char* line, uint32_t now_ms) {
+    if (!line) return false;
+
+    stats.lines_received++;
+    last_rx_ms = now_ms;
+    has_rx = true;
+
+    if (strncmp(line, "PONG,", 5) == 0) {
+        char* end;
+        uint32_t seq = (uint32_t)strtoul(line + 5, &end, 10);
+        if (*end != ',') return true;
+        uint32_t sent_ms = (uint32_t)strtoul(end + 1, NULL, 10);
+
+        link_pending_t* slot = &pending[seq % PENDING_SLOTS];
+        if (slot->waiting && slot->seq == seq && slot->sent_ms == sent_ms) {
+            slot->waiting = false;
+            stats.pongs_received++;
+            update_rtt(now_ms - sent_ms);
+            update_loss(false);
+        }
+        return true;
+    }
+
+    if (strncmp(line, "PING,", 5) == 0) {
+        // Devolver tal cual para que la app mida su RTT
+        char reply[48];
+        snprintf(reply, sizeof(reply), "PONG,%s\n", line + 5);
+        bluetooth_send_string(reply);
+        return true;
+    }
+
+    return false;
+}
+
+bool link_update(uint32_t now_ms) {
+    // PING vencidos cuentan como perdidos
+    for (int i = 0; i < PENDING_SLOTS; i++) {
+        if (pending[i].waiting && now_ms - pending[i].sent_ms > LINK_PONG_TIMEOUT_MS) {
+            pending[i].waiting = false;
+            stats.pongs_lost++;
+            update_loss(true);
+        }
+    }
+
+    if (now_ms - last_ping_ms >= LINK_PING_INTERVAL_MS) {
+        link_pending_t* slot = &pending[next_seq % PENDING_SLOTS];
+        slot->seq = next_seq;
+        slot->sent_ms = now_ms;
+        slot->waiting = true;
+
+        char ping[32];
+        snprintf(ping, sizeof(ping), "PING,%lu,%lu\n",
+                 (unsigned long)next_seq, (unsigned long)now_ms);
+        bluetooth_send_string(ping);
+
+        stats.pings_sent++;
+        next_seq++;
+        last_ping_ms = now_ms;
+    }
+
+    bool alive = link_is_alive(now_ms);
+    bool lost_now = was_alive && !alive;
+    was_alive = alive;
+
+    return lost_now;
+}
+
+bool link_is_alive(uint32_t now_ms) {
+    return has_rx && (now_ms - last_rx_ms) <= LINK_TIMEOUT_MS;
+}
+
+link_stats_t link_get_stats(uint32_t now_ms) {
+    stats.rx_age_ms = has_rx ? now_ms - last_rx_ms : 0;
+    stats.alive = link_is_alive(now_ms);
+    return stats;
+}
+
+void link_send_report(uint32_t now_ms) {
+    if (now_ms - last_report_ms < LINK_REPORT_INTERVAL_MS) return;
+    last_report_ms = now_ms;
+
+    link_stats_t current = link_get_stats(now_ms);
+
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "LINK,%lu,%lu,%lu,%lu\n",
+             (unsigned long)current.srtt_ms, (unsigned long)current.rttvar_ms,
+             (unsigned long)current.loss_permille, (unsigned long)current.rx_age_ms);
+    bluetooth_send_string(buffer);
+}
+
+void link_test(void) {
+    printf("=== PRUEBA ENLACE (SIMULACIÓN) ===\n");
+
+    // PONG simulados en tránsito
+    struct { uint32_t due_ms, seq, sent_ms; bool used; } replies[PENDING_SLOTS] = {0};
+    uint32_t seed = 7;
+    uint32_t last_sent = 0;
+    uint32_t lost_at = 0;
+
+    link_init(0);
+    link_handle_line("HOLA", 0);
+
+    for (uint32_t t = 0; t <= 40000; t += LOOP_INTERVAL_MS) {
+        if (link_update(t) && lost_at == 0) {
+            lost_at = t;
+        }
+
+        // La app responde cada PING con 40-120 ms de retardo y 10% de pérdida
+        // durante los primeros 20 s; después deja de responder.
+        if (stats.pings_sent != last_sent) {
+            last_sent = stats.pings_sent;
+            seed = seed * 1103515245u + 12345u;
+            link_pending_t* sent = &pending[(next_seq - 1) % PENDING_SLOTS];
+
+            if (t < 20000 && (seed >> 16) % 10 != 0) {
+                for (int i = 0; i < PENDING_SLOTS; i++) {
+                    if (!replies[i].used) {
+                        replies[i].used = true;
+                        replies[i].due_ms = t + 40 + (seed >> 8) % 80;
+                        replies[i].seq = sent->seq;
+                        replies[i].sent_ms = sent->sent_ms;
+                        break;
+                    }
+                }
+            }
+        }
+
+        for (int i = 0; i < PENDING_SLOTS; i++) {
+            if (replies[i].used && t >= replies[i].due_ms) {
+                char line[32];
+                snprintf(line, sizeof(line), "PONG,%lu,%lu",
+                         (unsigned long)replies[i].seq, (unsigned long)replies[i].sent_ms);
+                link_handle_line(line, t);
+                replies[i].used = false;
+            }
+        }
+
+        if (t % 5000 == 0) {
+            link_stats_t s = link_get_stats(t);
+            printf("t=%2lus PING=%lu PONG=%lu Perdidos=%lu SRTT=%lums RTTVAR=%lums Pérdida=%lu%% Enlace=%s\n",
+                   (unsigned long)(t / 1000), (unsigned long)s.pings_sent,
+                   (unsigned long)s.pongs_received, (unsigned long)s.pongs_lost,
+                   (unsigned long)s.srtt_ms, (unsigned long)s.rttvar_ms,
+                   (unsigned long)(s.loss_permille / 10), s.alive ? "OK" : "PERDIDO");
+        }
+    }
+
+    printf("Enlace declarado perdido a los %.2f s (último tráfico ~20 s)\n", lost_at / 1000.0);
+    printf("Prueba de enlace completada\n");
+}
\ No newline at end of file
@@ -0,0 +1,112 @@
+/**
+ * @file link.h
+ * @brief Header de la supervisión del enlace Bluetooth.
+ *
+ * Define el protocolo de latido PING/PONG con números de secuencia y
+ * sellos de tiempo, las estadísticas de calidad del enlace y la detección
+ * de pérdida de señal usada por la parada de seguridad.
+ *
+ * Protocolo (texto, una línea por mensaje):
+ * - Robot -> App: "PING,<seq>,<t_ms>" cada LINK_PING_INTERVAL_MS
+ * - App -> Robot: "PONG,<seq>,<t_ms>" devolviendo los mismos valores
+ * - La app también puede enviar "PING,<seq>,<t>" y el robot responde
+ *   "PONG,<seq>,<t>" para que la app mida su propio RTT.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef LINK_H
+#define LINK_H
+
+#include "pico/stdlib.h"
+#include <stdint.h>
+
+/// @defgroup LINK_STRUCTURES Estructuras del enlace
+/// @{
+
+/**
+ * @brief Estadísticas de calidad del enlace.
+ */
+typedef struct {
+    uint32_t pings_sent;      ///< PING enviados
+    uint32_t pongs_received;  ///< PONG válidos recibidos
+    uint32_t pongs_lost;      ///< PING sin respuesta dentro de LINK_PONG_TIMEOUT_MS
+    uint32_t lines_received;  ///< Líneas recibidas de cualquier tipo
+    uint32_t srtt_ms;         ///< RTT suavizado en ms
+    uint32_t rttvar_ms;       ///< Variación del RTT en ms
+    uint32_t rtt_min_ms;      ///< RTT mínimo observado
+    uint32_t rtt_max_ms;      ///< RTT máximo observado
+    uint32_t loss_permille;   ///< Pérdida reciente de PONG en tanto por mil
+    uint32_t rx_age_ms;       ///< Tiempo desde la última línea recibida
+    bool alive;               ///< true si hubo tráfico en los últimos LINK_TIMEOUT_MS
+} link_stats_t;
+
+/// @}
+
+/// @defgroup LINK_FUNCTIONS Funciones del enlace
+/// @{
+
+/**
+ * @brief Reinicia las estadísticas y el estado del enlace.
+ *
+ * @param now_ms Tiempo actual en ms
+ */
+void link_init(uint32_t now_ms);
+
+/**
+ * @brief Registra la recepción de una línea y procesa PING/PONG.
+ *
+ * Debe llamarse con cada línea recibida por Bluetooth.
+ *
+ * @param line Línea recibida
+ * @param now_ms Tiempo de recepción en ms
+ * @return true si la línea era un mensaje del enlace (no requiere más proceso)
+ */
+bool link_handle_line(const char* line, uint32_t now_ms);
+
+/**
+ * @brief Envía los PING pendientes y actualiza el estado del enlace.
+ *
+ * @param now_ms Tiempo actual en ms
+ * @return true si el enlace se acaba de perder en esta llamada
+ */
+bool link_update(uint32_t now_ms);
+
+/**
+ * @brief Verifica si el enlace está activo.
+ *
+ * @param now_ms Tiempo actual en ms
+ * @return true si hubo tráfico en los últimos LINK_TIMEOUT_MS
+ */
+bool link_is_alive(uint32_t now_ms);
+
+/**
+ * @brief Obtiene las estadísticas del enlace.
+ *
+ * @param now_ms Tiempo actual en ms
+ * @return Copia de las estadísticas
+ */
+link_stats_t link_get_stats(uint32_t now_ms);
+
+/**
+ * @brief Envía el reporte LINK si corresponde según LINK_REPORT_INTERVAL_MS.
+ *
+ * Formato: "LINK,<srtt>,<rttvar>,<perdida_permil>,<edad_rx_ms>"
+ *
+ * @param now_ms Tiempo actual en ms
+ */
+void link_send_report(uint32_t now_ms);
+
+/**
+ * @brief Función de prueba de la supervisión del enlace.
+ *
+ * Simula respuestas con retardo y pérdidas y muestra la estimación de
+ * RTT, la pérdida medida y la detección de enlace caído.
+ */
+void link_test(void);
+
+/// @}
+
+#endif // LINK_H
\ No newline at end of file
@@ -5,6 +5,12 @@
  * Este módulo maneja toda la comunicación I2C con el magnetómetro,
  * incluyendo inicialización, lectura de datos y cálculo de rumbo
  * con filtrado paso bajo para estabilidad.
+ *
+ * El desvío de la brújula (montaje, hierro del chasis y de los motores)
+ * se aprende comparando el rumbo medido con el rumbo sobre el suelo del
+ * GPS mientras el robot avanza recto y a velocidad: en esas condiciones
+ * el rumbo del GPS no tiene sesgo. La corrección se resta dentro de
+ * magnetometer_get_filtered_heading() y se guarda en flash.
  * 
  * @author Equipo WALLY-S
  * @date 2025
@@ -12,6 +18,8 @@
  */
 
 #include "magnetometer.h"
+#include "timebase.h"
+#include "storage.h"
 #include "config.h"
 #include <math.h>
 
@@ -27,6 +35,46 @@ static const double ALPHA = 0.6;
 /// @brief Declinación magnética local en radianes
 static double declination_angle = 0.0404;
 
+/// @brief Sello de la última lectura cruda en la base de tiempo
+static uint64_t sample_time_us = 0;
+
+/**
+ * @brief Desvío guardado en flash.
+ */
+typedef struct {
+    double bias_deg;     ///< Desvío aprendido en grados
+    uint32_t samples;    ///< Muestras usadas
+} bias_record_t;
+
+/// @brief Desvío actual de la brújula
+static magnetometer_bias_t bias = {0};
+
+/// @brief Desvío guardado en flash (para no reescribir por cambios pequeños)
+static double saved_bias_deg = 0.0;
+
+/// @brief Media circular del rumbo sin corregir desde el último rumbo GPS
+static double heading_sum_sin = 0.0;
+static double heading_sum_cos = 0.0;
+static uint32_t heading_count = 0;
+
+/// @brief Estado del detector de tramo recto
+static bool has_previous = false;
+static double previous_course = 0.0;
+static double previous_heading = 0.0;
+static int straight_samples = 0;
+
+/// @brief Descartes seguidos (muchos indican que la brújula se movió de lugar)
+static int consecutive_rejects = 0;
+
+/**
+ * @brief Lleva un ángulo a [-180, 180).
+ */
+static double wrap_180(double angle) {
+    angle = fmod(angle + 180.0, 360.0);
+    if (angle < 0) angle += 360.0;
+    return angle - 180.0;
+}
+
 bool magnetometer_init(void) {
     // Inicializar I2C a 400kHz
     i2c_init(I2C_PORT, 400000);
@@ -47,6 +95,16 @@ bool magnetometer_init(void) {
     uint8_t period_data[] = {0x0B, 0x01};
     i2c_write_blocking(I2C_PORT, QMC5883L_ADDR, period_data, 2, false);
     
+    // Desvío aprendido en recorridos anteriores: sigue aprendiendo con la ganancia mínima
+    bias_record_t record;
+    size_t length = 0;
+    if (storage_read(STORAGE_REGION_COMPASS, &record, sizeof(record), &length) &&
+        length == sizeof(record) && fabs(record.bias_deg) <= 180.0) {
+        bias.bias_deg = saved_bias_deg = record.bias_deg;
+        bias.samples = record.samples;
+        bias.learned = (record.samples >= MAG_BIAS_MIN_SAMPLES);
+    }
+    
     initialized = true;
     return true;
 }
@@ -69,16 +127,17 @@ bool magnetometer_read_raw(int16_t *x, int16_t *y, int16_t *z) {
     *x = (int16_t)(buffer[1] << 8 | buffer[0]);
     *y = (int16_t)(buffer[3] << 8 | buffer[2]);
     *z = (int16_t)(buffer[5] << 8 | buffer[4]);
+    sample_time_us = timebase_now_us();
     
     return true;
 }
 
 double magnetometer_calculate_heading(int16_t x, int16_t y) {
     // Calcular rumbo usando atan2
-    double heading = atan2(y, x) * 180.0 ;
+    double heading = atan2(y, x) * 180.0 / M_PI;
     
     // Ajustar declinación magnética
-    heading += declination_angle * 180.0 ;
+    heading += declination_angle * 180.0 / M_PI;
     
     // Normalizar a 0-360 grados
     if (heading < 0) {
@@ -96,7 +155,20 @@ double magnetometer_get_filtered_heading(void) {
         return filtered_heading; // Retornar último valor válido
     }
     
-    double new_heading = magnetometer_calculate_heading(x, y);
+    double raw_heading = magnetometer_calculate_heading(x, y);
+    
+    // Acumular el rumbo sin corregir para compararlo con el del GPS
+    heading_sum_sin += sin(raw_heading * M_PI / 180.0);
+    heading_sum_cos += cos(raw_heading * M_PI / 180.0);
+    heading_count++;
+    
+    // Restar el desvío aprendido
+    double new_heading = raw_heading - bias.bias_deg;
+    if (new_heading < 0) {
+        new_heading += 360;
+    } else if (new_heading >= 360) {
+        new_heading -= 360;
+    }
     
     // Aplicar filtro paso bajo
     double difference = new_heading - filtered_heading;
@@ -128,6 +200,70 @@ void magnetometer_set_declination(double declination_rad) {
     declination_angle = declination_rad;
 }
 
+uint64_t magnetometer_get_timestamp(void) {
+    return sample_time_us;
+}
+
+bool magnetometer_learn_bias(double course_deg, double speed_mps) {
+    if (heading_count == 0) {
+        has_previous = false;
+        straight_samples = 0;
+        return false;
+    }
+    
+    // Rumbo medio de la brújula desde el rumbo GPS anterior
+    double heading = atan2(heading_sum_sin, heading_sum_cos) * 180.0 / M_PI;
+    heading_sum_sin = heading_sum_cos = 0.0;
+    heading_count = 0;
+    
+    // Tramo recto: ni el GPS ni la brújula giraron desde la muestra anterior
+    bool straight = has_previous && speed_mps >= MAG_BIAS_MIN_SPEED_MPS &&
+                    fabs(wrap_180(course_deg - previous_course)) <= MAG_BIAS_MAX_TURN_DEG &&
+                    fabs(wrap_180(heading - previous_heading)) <= MAG_BIAS_MAX_TURN_DEG;
+    straight_samples = straight ? straight_samples + 1 : 0;
+    has_previous = true;
+    previous_course = course_deg;
+    previous_heading = heading;
+    
+    if (straight_samples < MAG_BIAS_STRAIGHT_SAMPLES) return false;
+    
+    // Una vez aprendido, descartar saltos (derrape, imán cercano, rumbo GPS erróneo)
+    double innovation = wrap_180(wrap_180(heading - course_deg) - bias.bias_deg);
+    if (bias.learned && fabs(innovation) > MAG_BIAS_MAX_INNOVATION_DEG) {
+        bias.rejected++;
+        if (++consecutive_rejects < MAG_BIAS_RELEARN_REJECTS) return false;
+        
+        // El desvío cambió de verdad: volver a aprender desde cero
+        bias.samples = 0;
+        bias.learned = false;
+    }
+    consecutive_rejects = 0;
+    
+    // Media al principio, luego promedio exponencial para seguir cambios lentos
+    bias.samples++;
+    double gain = 1.0 / bias.samples;
+    if (gain < MAG_BIAS_GAIN) gain = MAG_BIAS_GAIN;
+    bias.bias_deg = wrap_180(bias.bias_deg + gain * innovation);
+    bias.learned = (bias.samples >= MAG_BIAS_MIN_SAMPLES);
+    return true;
+}
+
+magnetometer_bias_t magnetometer_get_bias(void) {
+    return bias;
+}
+
+bool magnetometer_save_bias(void) {
+    if (!bias.learned || fabs(wrap_180(bias.bias_deg - saved_bias_deg)) < MAG_BIAS_SAVE_CHANGE_DEG) {
+        return false;
+    }
+    
+    bias_record_t record = { .bias_deg = bias.bias_deg, .samples = bias.samples };
+    if (!storage_write(STORAGE_REGION_COMPASS, &record, sizeof(record))) return false;
+    
+    saved_bias_deg = bias.bias_deg;
+    return true;
+}
+
 void magnetometer_test(void) {
     printf("=== PRUEBA MAGNETÓMETRO ===\n");
     
@@ -137,6 +273,9 @@ void magnetometer_test(void) {
     }
     
     printf("Magnetómetro inicializado correctamente\n");
+    magnetometer_bias_t learned = magnetometer_get_bias();
+    printf("Desvío aprendido con el GPS: %.1f° (%lu muestras%s)\n", learned.bias_deg,
+           (unsigned long)learned.samples, learned.learned ? "" : ", aún sin confirmar");
     printf("Leyendo datos cada 500ms (Ctrl+C para salir):\n");
     
     while (true) {
@@ -16,6 +16,21 @@
 #include "pico/stdlib.h"
 #include <stdint.h>
 
+/// @defgroup MAG_STRUCTURES Estructuras del magnetómetro
+/// @{
+
+/**
+ * @brief Desvío de la brújula aprendido contra el rumbo del GPS.
+ */
+typedef struct {
+    double bias_deg;     ///< Desvío restado al rumbo medido (+ = la brújula marca de más)
+    uint32_t samples;    ///< Muestras de tramo recto usadas
+    uint32_t rejected;   ///< Muestras descartadas por salto excesivo
+    bool learned;        ///< Hay muestras suficientes para confiar en el desvío
+} magnetometer_bias_t;
+
+/// @}
+
 /// @defgroup MAG_FUNCTIONS Funciones del magnetómetro
 /// @{
 
@@ -51,8 +66,9 @@ double magnetometer_calculate_heading(int16_t x, int16_t y);
 /**
  * @brief Obtiene el rumbo filtrado para reducir ruido.
  * 
- * Aplica un filtro paso bajo para estabilizar las lecturas y maneja
- * correctamente el cruce de 0/360 grados.
+ * Resta el desvío aprendido contra el GPS, aplica un filtro paso bajo
+ * para estabilizar las lecturas y maneja correctamente el cruce de
+ * 0/360 grados.
  * 
  * @return Rumbo filtrado en grados (0-360)
  */
@@ -72,6 +88,47 @@ bool magnetometer_is_initialized(void);
  */
 void magnetometer_set_declination(double declination_rad);
 
+/**
+ * @brief Obtiene el sello de la última lectura del sensor.
+ * 
+ * El rumbo filtrado va retrasado respecto a este instante por el filtro
+ * paso bajo.
+ * 
+ * @return Momento de la última lectura en la base de tiempo (0 sin lecturas)
+ */
+uint64_t magnetometer_get_timestamp(void);
+
+/**
+ * @brief Aprende el desvío de la brújula con un rumbo sobre el suelo.
+ * 
+ * Llamar una vez por cada rumbo nuevo del GPS. Compara el rumbo medio de
+ * la brújula desde la llamada anterior con el del GPS, solo si el robot va
+ * a MAG_BIAS_MIN_SPEED_MPS o más y ninguno de los dos giró más de
+ * MAG_BIAS_MAX_TURN_DEG durante MAG_BIAS_STRAIGHT_SAMPLES muestras.
+ * 
+ * @param course_deg Rumbo sobre el suelo en grados verdaderos
+ * @param speed_mps Velocidad sobre el suelo en m/s
+ * @return true si la muestra se usó para corregir el desvío
+ */
+bool magnetometer_learn_bias(double course_deg, double speed_mps);
+
+/**
+ * @brief Obtiene el desvío aprendido.
+ * 
+ * @return Copia del estado del desvío
+ */
+magnetometer_bias_t magnetometer_get_bias(void);
+
+/**
+ * @brief Guarda el desvío en flash si cambió lo suficiente.
+ * 
+ * El borrado de flash detiene el programa unos 100 ms: llamar solo con el
+ * robot detenido.
+ * 
+ * @return true si se escribió la flash
+ */
+bool magnetometer_save_bias(void);
+
 /**
  * @brief Función de prueba independiente del magnetómetro.
  * 
@@ -0,0 +1,173 @@
+/**
+ * @file memory.c
+ * @brief Implementación del diagnóstico de memoria en tiempo de ejecución.
+ *
+ * Los límites salen de los símbolos del script de enlace del SDK: la pila
+ * del núcleo 0 ocupa el final de SCRATCH_Y y la del núcleo 1 el final de
+ * SCRATCH_X (tamaño 0 mientras no se enlace pico_multicore). El montón va
+ * de __end__ a __HeapLimit en la RAM principal.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "memory.h"
+#include "bluetooth.h"
+#include "pool.h"
+#include "config.h"
+#include <stdio.h>
+#include <string.h>
+#include <malloc.h>
+
+/// @brief Inicio de la RAM principal
+#define SRAM_START_ADDRESS 0x20000000u
+
+/// @brief Símbolos del script de enlace
+extern uint32_t __StackBottom[], __StackTop[];
+extern uint32_t __StackOneBottom[], __StackOneTop[];
+extern char __end__[], __HeapLimit[];
+
+/**
+ * @brief Región de la pila de un núcleo.
+ */
+typedef struct {
+    uint32_t* bottom;  ///< Dirección más baja (límite de crecimiento)
+    uint32_t* top;     ///< Dirección inicial del puntero de pila
+} stack_region_t;
+
+/**
+ * @brief Obtiene la región de pila de un núcleo.
+ */
+static stack_region_t stack_region(int core) {
+    stack_region_t region;
+    if (core == 0) {
+        region.bottom = __StackBottom;
+        region.top = __StackTop;
+    } else {
+        region.bottom = __StackOneBottom;
+        region.top = __StackOneTop;
+    }
+    return region;
+}
+
+/**
+ * @brief Rellena con el patrón las palabras de [from, to).
+ */
+static void paint(uint32_t* from, uint32_t* to) {
+    for (volatile uint32_t* word = from; word < to; word++) {
+        *word = MEMORY_PAINT_WORD;
+    }
+}
+
+/**
+ * @brief Mide la marca de agua de una pila pintada.
+ *
+ * La pila crece hacia abajo: desde el fondo, la primera palabra sin el
+ * patrón es el punto más profundo que se alcanzó.
+ */
+static memory_stack_t measure(stack_region_t region) {
+    memory_stack_t stack = {0};
+    if (region.top <= region.bottom) return stack;
+
+    const volatile uint32_t* word = region.bottom;
+    while (word < region.top && *word == MEMORY_PAINT_WORD) {
+        word++;
+    }
+
+    stack.size = (uint32_t)((region.top - region.bottom) * sizeof(uint32_t));
+    stack.used = (uint32_t)((region.top - word) * sizeof(uint32_t));
+    stack.overflow = (word == region.bottom);
+    return stack;
+}
+
+void memory_init(void) {
+    // Núcleo 0: solo la parte libre, lejos del marco actual
+    uint32_t marker = 0;
+    uintptr_t limit = ((uintptr_t)&marker - MEMORY_PAINT_MARGIN_BYTES) & ~(uintptr_t)3;
+    stack_region_t core0 = stack_region(0);
+    if (limit > (uintptr_t)core0.bottom && limit < (uintptr_t)core0.top) {
+        paint(core0.bottom, (uint32_t*)limit);
+    }
+
+    // Núcleo 1: todavía no está en marcha, se pinta completa
+    stack_region_t core1 = stack_region(1);
+    if (core1.top > core1.bottom) {
+        paint(core1.bottom, core1.top);
+    }
+}
+
+memory_report_t memory_get_report(void) {
+    memory_report_t report;
+
+    for (int core = 0; core < MEMORY_CORES; core++) {
+        report.stack[core] = measure(stack_region(core));
+    }
+
+    struct mallinfo heap = mallinfo();
+    report.static_bytes = (uint32_t)((uintptr_t)__end__ - SRAM_START_ADDRESS);
+    report.heap_size = (uint32_t)(__HeapLimit - __end__);
+    report.heap_used = (uint32_t)heap.uordblks;
+
+    return report;
+}
+
+bool memory_handle_command(const char* line) {
+    if (!line || strcmp(line, "MEM?") != 0) return false;
+
+    memory_report_t report = memory_get_report();
+    char reply[96];
+    snprintf(reply, sizeof(reply), "MEM,%lu,%lu,%lu,%lu,%lu,%lu,%lu\n",
+             (unsigned long)report.stack[0].used, (unsigned long)report.stack[0].size,
+             (unsigned long)report.stack[1].used, (unsigned long)report.stack[1].size,
+             (unsigned long)report.static_bytes,
+             (unsigned long)report.heap_used, (unsigned long)report.heap_size);
+    bluetooth_send_string(reply);
+    return true;
+}
+
+/**
+ * @brief Muestra el resumen de memoria por consola.
+ */
+static void print_report(const memory_report_t* report) {
+    for (int core = 0; core < MEMORY_CORES; core++) {
+        const memory_stack_t* stack = &report->stack[core];
+        if (stack->size == 0) {
+            printf("  Pila núcleo %d: sin pila propia\n", core);
+            continue;
+        }
+
+        uint32_t percent = stack->used * 100 / stack->size;
+        printf("  Pila núcleo %d: %lu / %lu bytes (%lu%%)%s\n", core,
+               (unsigned long)stack->used, (unsigned long)stack->size, (unsigned long)percent,
+               stack->overflow ? "  ✗ DESBORDADA" :
+               (percent >= MEMORY_STACK_WARN_PERCENT) ? "  ⚠️ poco margen" : "");
+    }
+    printf("  RAM estática: %lu bytes\n", (unsigned long)report->static_bytes);
+    printf("  Montón: %lu / %lu bytes\n",
+           (unsigned long)report->heap_used, (unsigned long)report->heap_size);
+}
+
+void memory_test(void) {
+    printf("=== PRUEBA DIAGNÓSTICO DE MEMORIA ===\n");
+
+    memory_report_t before = memory_get_report();
+    printf("Uso desde el arranque:\n");
+    print_report(&before);
+
+    // Las funciones con búferes grandes en pila y printf de coma flotante
+    printf("\nRecorriendo envío de estado y navegación...\n");
+    bluetooth_send_status(123.4, 234.5, 56.7, true);
+    bluetooth_send_navigation_info(6.267417, -75.568389, 6.268000, -75.569000, 89.1, 310.2);
+
+    memory_report_t after = memory_get_report();
+    printf("Uso tras la prueba:\n");
+    print_report(&after);
+
+    printf("\nBloques de tamaño fijo (pool.c):\n");
+    pool_print();
+
+    printf("\nLa marca de agua del núcleo 0 creció %lu bytes\n",
+           (unsigned long)(after.stack[0].used - before.stack[0].used));
+    printf("Detalle por función y módulo: tools/memory_report.py tras compilar\n");
+}
\ No newline at end of file
@@ -0,0 +1,91 @@
+/**
+ * @file memory.h
+ * @brief Header del diagnóstico de memoria en tiempo de ejecución.
+ *
+ * Al arrancar se pinta la pila de cada núcleo con un patrón conocido; la
+ * marca de agua (el punto más profundo al que llegó la pila) es la primera
+ * palabra que ya no tiene el patrón. Junto con la RAM estática y el montón
+ * indica cuánto margen queda en los 264 KB de SRAM.
+ *
+ * El análisis en compilación (-fstack-usage y el mapa del enlazador,
+ * resumido por módulo) lo hace tools/memory_report.py.
+ *
+ * Comandos (App -> Robot):
+ * - "MEM?": responde "MEM,<pila0_usada>,<pila0>,<pila1_usada>,<pila1>,<estatica>,<monton_usado>,<monton>"
+ *   (todo en bytes; una pila de tamaño 0 es un núcleo sin pila propia)
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include "pico/stdlib.h"
+#include <stdint.h>
+
+/// @defgroup MEMORY_STRUCTURES Estructuras del diagnóstico de memoria
+/// @{
+
+/// @brief Núcleos del RP2040
+#define MEMORY_CORES 2
+
+/**
+ * @brief Uso de la pila de un núcleo.
+ */
+typedef struct {
+    uint32_t size;       ///< Tamaño reservado en bytes
+    uint32_t used;       ///< Marca de agua en bytes
+    bool overflow;       ///< La pila alcanzó el final de su región
+} memory_stack_t;
+
+/**
+ * @brief Resumen del uso de memoria.
+ */
+typedef struct {
+    memory_stack_t stack[MEMORY_CORES];  ///< Pila de cada núcleo
+    uint32_t static_bytes;               ///< RAM de datos estáticos (.data y .bss)
+    uint32_t heap_size;                  ///< Tamaño disponible para el montón
+    uint32_t heap_used;                  ///< Bytes reservados en el montón
+} memory_report_t;
+
+/// @}
+
+/// @defgroup MEMORY_FUNCTIONS Funciones del diagnóstico de memoria
+/// @{
+
+/**
+ * @brief Pinta las pilas de los dos núcleos.
+ *
+ * Debe llamarse al inicio de main(), antes de lanzar el núcleo 1. De la
+ * pila del núcleo 0 solo se pinta la parte libre bajo el puntero actual.
+ */
+void memory_init(void);
+
+/**
+ * @brief Mide las marcas de agua y el uso de RAM.
+ *
+ * @return Resumen del uso de memoria
+ */
+memory_report_t memory_get_report(void);
+
+/**
+ * @brief Procesa el comando MEM?.
+ *
+ * @param line Línea recibida por Bluetooth
+ * @return true si la línea era un comando de diagnóstico de memoria
+ */
+bool memory_handle_command(const char* line);
+
+/**
+ * @brief Función de prueba del diagnóstico de memoria.
+ *
+ * Muestra el uso de memoria antes y después de recorrer las funciones con
+ * más pila (envío de estado por Bluetooth con números en coma flotante).
+ */
+void memory_test(void);
+
+/// @}
+
+#endif // MEMORY_H
\ No newline at end of file
@@ -0,0 +1,348 @@
+/**
+ * @file motors.c
+ * @brief Implementación del driver de motores L298N y encoders.
+ *
+ * ENA y ENB (GPIO 6 y 7) comparten el slice 3 del PWM, así que los dos
+ * pulsos están centrados en el mismo instante y una sola señal de fin de
+ * ciclo sirve para medir la corriente de ambos motores (analog.c). La
+ * corriente medida es la del bobinado mientras el puente conduce.
+ *
+ * Un motor atascado consume la corriente de arranque y el encoder deja de
+ * contar; el PID de velocidad o de rumbo reacciona subiendo el PWM, lo que
+ * empeora el calentamiento del L298N. Por eso el recorte se aplica aquí,
+ * sin esperar a que la navegación reaccione.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "motors.h"
+#include "analog.h"
+#include "timebase.h"
+#include "config.h"
+#include "hardware/pwm.h"
+#include "hardware/clocks.h"
+#include "hardware/sync.h"
+#include <stdio.h>
+#include <math.h>
+
+/**
+ * @brief Estado interno de un motor.
+ */
+typedef struct {
+    uint en_pin;                 ///< Pin PWM (ENA/ENB)
+    uint in1_pin;                ///< Primer pin de dirección
+    uint in2_pin;                ///< Segundo pin de dirección
+    uint encoder_pin;            ///< Pin del encoder
+    uint sense_input;            ///< Entrada del ADC de SENSE
+    motor_direction_t direction; ///< Sentido pedido
+    int speed;                   ///< PWM pedido
+    int applied;                 ///< PWM aplicado (tras el recorte)
+    volatile uint32_t pulses;    ///< Pulsos del encoder (incrementados en la IRQ)
+    volatile uint64_t pulse_us;  ///< time_us_64() del último pulso (capturado en la IRQ)
+    uint32_t window_pulses;      ///< Pulsos al inicio de la ventana de RPM
+    uint32_t window_ms;          ///< Inicio de la ventana de RPM
+    double rpm;                  ///< Velocidad de la rueda
+    double current;              ///< Corriente filtrada en A
+    uint32_t stall_ms;           ///< Tiempo acumulado en condición de atasco
+    bool stalled;                ///< Motor recortado por atasco
+} motor_state_t;
+
+/// @brief Estado de los motores
+static motor_state_t motors[MOTOR_COUNT] = {
+    { .en_pin = MOTOR_ENA_PIN, .in1_pin = MOTOR_IN1_PIN, .in2_pin = MOTOR_IN2_PIN,
+      .encoder_pin = ENCODER_A_PIN, .sense_input = MOTOR_SENSE_A_INPUT },
+    { .en_pin = MOTOR_ENB_PIN, .in1_pin = MOTOR_IN3_PIN, .in2_pin = MOTOR_IN4_PIN,
+      .encoder_pin = ENCODER_B_PIN, .sense_input = MOTOR_SENSE_B_INPUT },
+};
+
+static bool initialized = false;
+static uint32_t last_update_ms = 0;
+
+/**
+ * @brief Cuenta y sella los flancos de subida de los encoders.
+ */
+static void on_encoder(uint gpio, uint32_t events) {
+    uint64_t now_us = time_us_64();
+    for (int i = 0; i < MOTOR_COUNT; i++) {
+        if (gpio == motors[i].encoder_pin) {
+            motors[i].pulses++;
+            motors[i].pulse_us = now_us;
+        }
+    }
+}
+
+/**
+ * @brief Escribe dirección y PWM de un motor, aplicando el recorte por atasco.
+ */
+static void apply(motor_state_t* motor) {
+    int speed = motor->speed;
+    if (motor->stalled && speed > MOTOR_STALL_CUTBACK_PWM) {
+        speed = MOTOR_STALL_CUTBACK_PWM;
+    }
+    if (speed < 0) speed = 0;
+    if (speed > MAX_SPEED) speed = MAX_SPEED;
+
+    bool in1 = false, in2 = false;
+    switch (motor->direction) {
+        case MOTOR_FORWARD:  in1 = true; break;
+        case MOTOR_BACKWARD: in2 = true; break;
+        case MOTOR_BRAKE:    in1 = in2 = true; speed = MAX_SPEED; break;
+        default:             speed = 0; break;
+    }
+
+    gpio_put(motor->in1_pin, in1);
+    gpio_put(motor->in2_pin, in2);
+    pwm_set_gpio_level(motor->en_pin, speed);
+    motor->applied = speed;
+}
+
+/**
+ * @brief Actualiza corriente, RPM y condición de atasco de un motor.
+ *
+ * @param motor Motor
+ * @param sensed_current Corriente medida durante el pulso en A
+ * @param pulses Pulsos acumulados del encoder
+ * @param now_ms Tiempo actual en ms
+ * @param dt_ms Tiempo desde la actualización anterior en ms
+ * @return true si el motor acaba de quedar atascado
+ */
+static bool update_motor(motor_state_t* motor, double sensed_current, uint32_t pulses,
+                         uint32_t now_ms, uint32_t dt_ms) {
+    double dt_s = dt_ms / 1000.0;
+    motor->current += (sensed_current - motor->current) * dt_s / (MOTOR_CURRENT_TAU_S + dt_s);
+
+    uint32_t window = now_ms - motor->window_ms;
+    if (window >= MOTOR_RPM_WINDOW_MS) {
+        motor->rpm = (pulses - motor->window_pulses) * 60000.0 / ((double)PULSES_PER_REV * window);
+        motor->window_pulses = pulses;
+        motor->window_ms = now_ms;
+    }
+
+    if (motor->stalled) return false;
+
+    bool pushing = motor->applied >= MOTOR_STALL_MIN_PWM &&
+                   (motor->direction == MOTOR_FORWARD || motor->direction == MOTOR_BACKWARD);
+
+    if (pushing && motor->current > MOTOR_STALL_CURRENT_A && motor->rpm < MOTOR_STALL_MAX_RPM) {
+        motor->stall_ms += dt_ms;
+        if (motor->stall_ms >= MOTOR_STALL_TIME_MS) {
+            motor->stalled = true;
+            return true;
+        }
+    } else {
+        motor->stall_ms = 0;
+    }
+
+    return false;
+}
+
+bool motors_init(void) {
+    if (initialized) {
+        motors_stop_all();
+        return true;
+    }
+
+    // PWM de fase correcta: periodo = 2 * (TOP + 1) ciclos del divisor
+    uint slice = pwm_gpio_to_slice_num(MOTOR_ENA_PIN);
+    pwm_config config = pwm_get_default_config();
+    pwm_config_set_phase_correct(&config, true);
+    pwm_config_set_wrap(&config, MAX_SPEED);
+    pwm_config_set_clkdiv(&config, clock_get_hz(clk_sys) /
+                          (2.0f * (MAX_SPEED + 1) * MOTOR_PWM_FREQ_HZ));
+
+    for (int i = 0; i < MOTOR_COUNT; i++) {
+        motor_state_t* motor = &motors[i];
+
+        gpio_set_function(motor->en_pin, GPIO_FUNC_PWM);
+
+        gpio_init(motor->in1_pin);
+        gpio_set_dir(motor->in1_pin, GPIO_OUT);
+        gpio_init(motor->in2_pin);
+        gpio_set_dir(motor->in2_pin, GPIO_OUT);
+
+        gpio_init(motor->encoder_pin);
+        gpio_set_dir(motor->encoder_pin, GPIO_IN);
+        gpio_pull_up(motor->encoder_pin);
+    }
+
+    pwm_init(slice, &config, false);
+    pwm_set_gpio_level(MOTOR_ENA_PIN, 0);
+    pwm_set_gpio_level(MOTOR_ENB_PIN, 0);
+    pwm_set_enabled(slice, true);
+
+    gpio_set_irq_enabled_with_callback(ENCODER_A_PIN, GPIO_IRQ_EDGE_RISE, true, &on_encoder);
+    gpio_set_irq_enabled(ENCODER_B_PIN, GPIO_IRQ_EDGE_RISE, true);
+
+    // Muestreo de corriente y batería disparado por el fin de ciclo del PWM
+    if (!analog_init()) return false;
+
+    initialized = true;
+    last_update_ms = to_ms_since_boot(get_absolute_time());
+    motors_stop_all();
+    return true;
+}
+
+void motors_set_motor(motor_id_t motor, motor_direction_t direction, int speed) {
+    if (motor >= MOTOR_COUNT || !initialized) return;
+
+    motors[motor].direction = direction;
+    motors[motor].speed = speed;
+    apply(&motors[motor]);
+}
+
+void motors_set_both_motors(motor_direction_t direction_a, int speed_a,
+                            motor_direction_t direction_b, int speed_b) {
+    motors_set_motor(MOTOR_A, direction_a, speed_a);
+    motors_set_motor(MOTOR_B, direction_b, speed_b);
+}
+
+void motors_stop_all(void) {
+    for (int i = 0; i < MOTOR_COUNT; i++) {
+        motors[i].stalled = false;
+        motors[i].stall_ms = 0;
+        motors_set_motor((motor_id_t)i, MOTOR_STOP, 0);
+    }
+}
+
+uint8_t motors_update(uint32_t now_ms) {
+    if (!initialized) return 0;
+
+    uint32_t dt_ms = now_ms - last_update_ms;
+    last_update_ms = now_ms;
+    uint8_t stalled = 0;
+
+    for (int i = 0; i < MOTOR_COUNT; i++) {
+        motor_state_t* motor = &motors[i];
+        double sensed = analog_read(motor->sense_input, MOTOR_SENSE_SAMPLES) /
+                        MOTOR_SENSE_RESISTOR_OHM;
+
+        if (update_motor(motor, sensed, motor->pulses, now_ms, dt_ms)) {
+            apply(motor);
+            stalled |= 1u << i;
+        }
+    }
+
+    return stalled;
+}
+
+motor_status_t motors_get_status(motor_id_t motor) {
+    motor_status_t status = {0};
+    if (motor >= MOTOR_COUNT) return status;
+
+    status.speed = motors[motor].applied;
+    status.current = motors[motor].current;
+    status.rpm = motors[motor].rpm;
+    uint32_t irq_state = save_and_disable_interrupts();
+    status.pulses = motors[motor].pulses;
+    uint64_t pulse_us = motors[motor].pulse_us;
+    restore_interrupts(irq_state);
+    status.pulse_time_us = pulse_us ? timebase_from_local(pulse_us) : 0;
+    status.stalled = motors[motor].stalled;
+    return status;
+}
+
+/**
+ * @brief Simula una rueda que choca contra un bordillo.
+ *
+ * Motor DC de 12 V (R = 4 ohm, 150 RPM en vacío) empujado por un
+ * controlador que sube el PWM cuando la rueda se frena. Devuelve el tiempo
+ * de detección en ms (-1 si no se detectó) y el calor disipado en el
+ * bobinado durante 3 s desde el choque.
+ */
+static int simulate_kerb(bool detection, double* heat_j) {
+    const double volts = 12.0, resistance = 4.0, rpm_per_volt = 150.0 / 12.0;
+    motor_state_t motor = { .direction = MOTOR_FORWARD, .speed = BASE_SPEED_A };
+    double rpm = 0.0, pulse_fraction = 0.0, sensed = 0.0;
+    uint32_t pulses = 0;
+    int detected_ms = -1;
+    *heat_j = 0.0;
+
+    for (uint32_t t = 0; t < 4000; t += 10) {
+        bool blocked = t >= 1000;
+
+        // Controlador: con la rueda frenada sube el PWM hasta el máximo
+        if (blocked && motor.speed < MAX_SPEED) motor.speed += 2;
+        motor.applied = (detection && motor.stalled) ? MOTOR_STALL_CUTBACK_PWM : motor.speed;
+
+        double duty = motor.applied / (double)MAX_SPEED;
+        double target = blocked ? 0.0 : duty * volts * rpm_per_volt * 0.9;
+        rpm += (target - rpm) * (blocked ? 0.3 : 0.05);
+
+        // Corriente durante el pulso: (V - fuerza contraelectromotriz) / R
+        double on_current = duty > 0.0 ? (volts - rpm / rpm_per_volt) / resistance : 0.0;
+        sensed = on_current;
+        if (blocked) *heat_j += on_current * on_current * resistance * duty * 0.010;
+
+        pulse_fraction += rpm * PULSES_PER_REV / 60.0 * 0.010;
+        while (pulse_fraction >= 1.0) {
+            pulses++;
+            pulse_fraction -= 1.0;
+        }
+
+        if (t % LOOP_INTERVAL_MS == 0 &&
+            update_motor(&motor, sensed, pulses, t, LOOP_INTERVAL_MS) && detected_ms < 0) {
+            detected_ms = (int)t - 1000;
+        }
+    }
+
+    return detected_ms;
+}
+
+void motors_test(void) {
+    printf("=== PRUEBA MOTORES Y ENCODERS ===\n");
+
+    if (!motors_init()) {
+        printf("ERROR: no se pudo iniciar el muestreo de corriente\n");
+        return;
+    }
+
+    struct {
+        const char* name;
+        motor_direction_t direction_a;
+        motor_direction_t direction_b;
+    } const steps[] = {
+        {"Adelante", MOTOR_FORWARD, MOTOR_FORWARD},
+        {"Atrás", MOTOR_BACKWARD, MOTOR_BACKWARD},
+        {"Giro (A adelante, B atrás)", MOTOR_FORWARD, MOTOR_BACKWARD},
+        {"Giro (A atrás, B adelante)", MOTOR_BACKWARD, MOTOR_FORWARD},
+    };
+
+    for (size_t s = 0; s < count_of(steps); s++) {
+        printf("\n%s (2 s)\n", steps[s].name);
+        motors_set_both_motors(steps[s].direction_a, BASE_SPEED_A,
+                               steps[s].direction_b, BASE_SPEED_B);
+
+        for (int i = 0; i < 2000 / LOOP_INTERVAL_MS; i++) {
+            uint8_t stalled = motors_update(to_ms_since_boot(get_absolute_time()));
+            if (i % 5 == 4) {
+                motor_status_t a = motors_get_status(MOTOR_A);
+                motor_status_t b = motors_get_status(MOTOR_B);
+                printf("  A: PWM=%3d %5.1f RPM %.2f A | B: PWM=%3d %5.1f RPM %.2f A\n",
+                       a.speed, a.rpm, a.current, b.speed, b.rpm, b.current);
+            }
+            if (stalled) {
+                printf("  ¡Atasco detectado en %s%s!\n",
+                       (stalled & 1) ? "A" : "", (stalled & 2) ? "B" : "");
+            }
+            sleep_ms(LOOP_INTERVAL_MS);
+        }
+
+        motors_stop_all();
+        sleep_ms(500);
+    }
+
+    printf("\nChoque contra un bordillo (simulación, PWM subiendo hasta %d)\n", MAX_SPEED);
+    double heat_off, heat_on;
+    simulate_kerb(false, &heat_off);
+    int detected_ms = simulate_kerb(true, &heat_on);
+    printf("  Sin detección: %.1f J en el bobinado durante 3 s\n", heat_off);
+    if (detected_ms >= 0) {
+        printf("  Con detección: recorte a los %d ms, %.1f J\n", detected_ms, heat_on);
+    } else {
+        printf("  Con detección: atasco NO detectado\n");
+    }
+
+    printf("Prueba de motores completada\n");
+}
\ No newline at end of file
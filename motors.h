@@ -0,0 +1,128 @@
+/**
+ * @file motors.h
+ * @brief Header del driver de motores L298N y encoders.
+ *
+ * Controla los dos motores DC con PWM en ENA/ENB y dirección en IN1-IN4,
+ * cuenta los pulsos de los encoders y mide la corriente de cada motor en
+ * las resistencias de SENSE del L298N. Si una rueda se bloquea (corriente
+ * alta sin giro del encoder mientras se le aplica PWM) el motor se recorta
+ * de inmediato y se informa el atasco para que la navegación se detenga.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef MOTORS_H
+#define MOTORS_H
+
+#include "pico/stdlib.h"
+#include <stdint.h>
+
+/// @defgroup MOTOR_STRUCTURES Estructuras de los motores
+/// @{
+
+/**
+ * @brief Motores del robot.
+ */
+typedef enum {
+    MOTOR_A = 0,     ///< Motor A (ENA, IN1, IN2)
+    MOTOR_B,         ///< Motor B (ENB, IN3, IN4)
+    MOTOR_COUNT      ///< Número de motores
+} motor_id_t;
+
+/**
+ * @brief Sentido de giro de un motor.
+ */
+typedef enum {
+    MOTOR_STOP = 0,  ///< Motor libre (sin tensión)
+    MOTOR_FORWARD,   ///< Hacia adelante
+    MOTOR_BACKWARD,  ///< Hacia atrás
+    MOTOR_BRAKE      ///< Freno (ambas entradas en alto)
+} motor_direction_t;
+
+/**
+ * @brief Estado medido de un motor.
+ */
+typedef struct {
+    int speed;           ///< PWM aplicado (0-MAX_SPEED, ya recortado)
+    double current;      ///< Corriente filtrada durante el pulso en A
+    double rpm;          ///< Velocidad de la rueda según el encoder
+    uint32_t pulses;     ///< Pulsos acumulados del encoder
+    uint64_t pulse_time_us; ///< Sello del último pulso en la base de tiempo (0 sin pulsos)
+    bool stalled;        ///< true si el motor quedó recortado por atasco
+} motor_status_t;
+
+/// @}
+
+/// @defgroup MOTOR_FUNCTIONS Funciones de los motores
+/// @{
+
+/**
+ * @brief Inicializa el PWM, los pines de dirección, los encoders y el
+ *        muestreo de corriente.
+ *
+ * El PWM es de fase correcta a MOTOR_PWM_FREQ_HZ: el pulso queda centrado
+ * en el final de cada ciclo, que es cuando se dispara la conversión del ADC.
+ *
+ * @return true si la inicialización fue exitosa
+ */
+bool motors_init(void);
+
+/**
+ * @brief Aplica sentido y velocidad a un motor.
+ *
+ * @param motor Motor
+ * @param direction Sentido de giro
+ * @param speed PWM (0-MAX_SPEED)
+ */
+void motors_set_motor(motor_id_t motor, motor_direction_t direction, int speed);
+
+/**
+ * @brief Aplica sentido y velocidad a los dos motores.
+ *
+ * @param direction_a Sentido del motor A
+ * @param speed_a PWM del motor A (0-MAX_SPEED)
+ * @param direction_b Sentido del motor B
+ * @param speed_b PWM del motor B (0-MAX_SPEED)
+ */
+void motors_set_both_motors(motor_direction_t direction_a, int speed_a,
+                            motor_direction_t direction_b, int speed_b);
+
+/**
+ * @brief Detiene los dos motores y borra los atascos registrados.
+ */
+void motors_stop_all(void);
+
+/**
+ * @brief Actualiza velocidad, corriente y detección de atasco.
+ *
+ * Debe llamarse una vez por iteración del bucle principal. Un motor que
+ * recibe al menos MOTOR_STALL_MIN_PWM, consume más de MOTOR_STALL_CURRENT_A
+ * y gira a menos de MOTOR_STALL_MAX_RPM durante MOTOR_STALL_TIME_MS queda
+ * limitado a MOTOR_STALL_CUTBACK_PWM hasta motors_stop_all().
+ *
+ * @param now_ms Tiempo actual en ms
+ * @return Máscara de motores atascados en esta llamada (bit 0 = A, bit 1 = B)
+ */
+uint8_t motors_update(uint32_t now_ms);
+
+/**
+ * @brief Obtiene el estado medido de un motor.
+ *
+ * @param motor Motor
+ * @return Copia del estado
+ */
+motor_status_t motors_get_status(motor_id_t motor);
+
+/**
+ * @brief Función de prueba de motores y encoders.
+ *
+ * Mueve los motores en ambos sentidos mostrando velocidad y corriente, y
+ * simula el choque contra un bordillo para medir el tiempo de detección.
+ */
+void motors_test(void);
+
+/// @}
+
+#endif // MOTORS_H
\ No newline at end of file
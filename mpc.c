@@ -0,0 +1,324 @@
+/**
+ * @file mpc.c
+ * @brief Implementación del control predictivo de trayectoria.
+ *
+ * Modelo discreto con paso h = MPC_STEP_S, estado x = (ey, ep) y entrada
+ * u = velocidad de giro:
+ *
+ *   ey[k+1] = ey[k] + v * h * ep[k]
+ *   ep[k+1] = ep[k] + h * u[k] - d[k]
+ *
+ * donde d[k] es el cambio de rumbo de la referencia entre los pasos k y
+ * k+1. Costo:
+ *
+ *   J = sum(qy * ey[k]^2 + qp * ep[k]^2)                   k = 1..N
+ *     + sum(r * (u[k] - d[k]/h)^2 + rd * (u[k] - u[k-1])^2)  k = 0..N-1
+ *
+ * con u[-1] = giro aplicado en el ciclo anterior. El gradiente se obtiene
+ * con una pasada hacia adelante (estados) y otra hacia atrás (adjuntos),
+ * O(N) por iteración, sin formar la matriz hessiana. Las restricciones son
+ * cajas por paso: giro máximo y lo alcanzable desde el giro actual con la
+ * aceleración máxima de las ruedas.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "mpc.h"
+#include "config.h"
+#include "pid.h"
+#include "route.h"
+#include "sim.h"
+#include <math.h>
+#include <stdio.h>
+
+/// @brief PWM de corrección por cada rad/s de giro (mismo modelo que el pure pursuit)
+#define PWM_PER_RAD_S ((WHEEL_TRACK_M / 2.0f) * \
+                       ((BASE_SPEED_A + BASE_SPEED_B) / 2.0f) / NOMINAL_SPEED_MPS)
+
+/// @brief Solución del ciclo anterior (arranque en caliente)
+static float solution[MPC_HORIZON];
+
+/// @brief Giro aplicado en el ciclo anterior en rad/s
+static float last_yaw_rate = 0.0f;
+
+/// @brief Estadísticas
+static mpc_stats_t stats;
+
+/// @brief Memoria de trabajo del solucionador
+static float disturbance[MPC_HORIZON];
+static float lower[MPC_HORIZON];
+static float upper[MPC_HORIZON];
+static float u_prev[MPC_HORIZON];
+static float y_point[MPC_HORIZON];
+static float gradient[MPC_HORIZON];
+static float ey[MPC_HORIZON + 1];
+static float ep[MPC_HORIZON + 1];
+
+void mpc_reset(void) {
+    for (int k = 0; k < MPC_HORIZON; k++) solution[k] = 0.0f;
+    last_yaw_rate = 0.0f;
+    stats.max_solve_us = 0;
+}
+
+/**
+ * @brief Simula el horizonte y devuelve el costo.
+ *
+ * @param u Entradas
+ * @param ey0 Error lateral inicial
+ * @param ep0 Error de rumbo inicial en rad
+ * @param vh Velocidad por paso (v * h)
+ */
+static float rollout(const float* u, float ey0, float ep0, float vh) {
+    const float h = MPC_STEP_S;
+    float cost = 0.0f;
+    float previous = last_yaw_rate;
+
+    ey[0] = ey0;
+    ep[0] = ep0;
+
+    for (int k = 0; k < MPC_HORIZON; k++) {
+        ey[k + 1] = ey[k] + vh * ep[k];
+        ep[k + 1] = ep[k] + h * u[k] - disturbance[k];
+
+        float track = u[k] - disturbance[k] / h;
+        float rate = u[k] - previous;
+        cost += MPC_Q_LATERAL * ey[k + 1] * ey[k + 1] + MPC_Q_HEADING * ep[k + 1] * ep[k + 1] +
+                MPC_R_TRACK * track * track + MPC_R_RATE * rate * rate;
+        previous = u[k];
+    }
+
+    return cost;
+}
+
+/**
+ * @brief Calcula el gradiente del costo en u (después de rollout(u)).
+ */
+static void compute_gradient(const float* u, float vh) {
+    const float h = MPC_STEP_S;
+    float lambda_y = 0.0f;
+    float lambda_p = 0.0f;
+
+    for (int k = MPC_HORIZON - 1; k >= 0; k--) {
+        // Adjuntos del estado k+1
+        lambda_y += 2.0f * MPC_Q_LATERAL * ey[k + 1];
+        lambda_p += 2.0f * MPC_Q_HEADING * ep[k + 1];
+
+        float previous = (k > 0) ? u[k - 1] : last_yaw_rate;
+        float g = h * lambda_p + 2.0f * MPC_R_TRACK * (u[k] - disturbance[k] / h) +
+                  2.0f * MPC_R_RATE * (u[k] - previous);
+        if (k < MPC_HORIZON - 1) g -= 2.0f * MPC_R_RATE * (u[k + 1] - u[k]);
+        gradient[k] = g;
+
+        // Propagar al estado k: ey[k+1] depende de ep[k]
+        lambda_p += vh * lambda_y;
+    }
+}
+
+double mpc_compute(double lateral_error, double heading, double speed_mps,
+                   const double* path_headings) {
+    uint32_t start_us = time_us_32();
+    const float h = MPC_STEP_S;
+    const float deg = (float)(M_PI / 180.0);
+
+    float v = (speed_mps > 0.05) ? (float)speed_mps : 0.05f;
+    float vh = v * h;
+    float ey0 = (float)lateral_error;
+    float ep0 = (float)pid_heading_error(heading, path_headings[0]) * deg;
+
+    // Cambios de rumbo de la referencia y cajas de giro alcanzable
+    const float max_rate = MPC_MAX_CORRECTION / PWM_PER_RAD_S;
+    const float accel = 2.0f * MPC_WHEEL_ACCEL_MPS2 / WHEEL_TRACK_M;
+    const float tick = LOOP_INTERVAL_MS / 1000.0f;
+
+    for (int k = 0; k < MPC_HORIZON; k++) {
+        disturbance[k] = (float)pid_heading_error(path_headings[k + 1], path_headings[k]) * deg;
+
+        float reach = accel * (tick + k * h);
+        lower[k] = fmaxf(-max_rate, last_yaw_rate - reach);
+        upper[k] = fminf(max_rate, last_yaw_rate + reach);
+    }
+
+    // Cota de Lipschitz del gradiente (normas de Frobenius de las matrices condensadas)
+    float frob_y = 0.0f, frob_p = 0.0f;
+    for (int k = 1; k <= MPC_HORIZON; k++) {
+        frob_p += k * h * h;
+        for (int m = 1; m < k; m++) frob_y += (vh * h * m) * (vh * h * m);
+    }
+    float lipschitz = 2.0f * (MPC_Q_LATERAL * frob_y + MPC_Q_HEADING * frob_p +
+                              MPC_R_TRACK + 4.0f * MPC_R_RATE);
+    float step = 1.0f / lipschitz;
+
+    // FISTA con arranque en caliente desde la solución anterior
+    for (int k = 0; k < MPC_HORIZON; k++) {
+        float u = solution[k];
+        u = (u < lower[k]) ? lower[k] : (u > upper[k]) ? upper[k] : u;
+        solution[k] = u;
+        u_prev[k] = u;
+        y_point[k] = u;
+    }
+
+    float t = 1.0f;
+    for (int it = 0; it < MPC_ITERATIONS; it++) {
+        rollout(y_point, ey0, ep0, vh);
+        compute_gradient(y_point, vh);
+
+        float t_next = 0.5f * (1.0f + sqrtf(1.0f + 4.0f * t * t));
+        float momentum = (t - 1.0f) / t_next;
+
+        for (int k = 0; k < MPC_HORIZON; k++) {
+            float u = y_point[k] - step * gradient[k];
+            u = (u < lower[k]) ? lower[k] : (u > upper[k]) ? upper[k] : u;
+            y_point[k] = u + momentum * (u - u_prev[k]);
+            u_prev[k] = u;
+        }
+        t = t_next;
+    }
+
+    for (int k = 0; k < MPC_HORIZON; k++) solution[k] = u_prev[k];
+
+    stats.cost = rollout(solution, ey0, ep0, vh);
+    last_yaw_rate = solution[0];
+    stats.yaw_rate = last_yaw_rate;
+
+    // Desplazar la solución para el próximo ciclo
+    float shift = tick / h;
+    for (int k = 0; k < MPC_HORIZON; k++) {
+        float position = k + shift;
+        int index = (int)position;
+        float fraction = position - index;
+        if (index >= MPC_HORIZON - 1) {
+            u_prev[k] = solution[MPC_HORIZON - 1];
+        } else {
+            u_prev[k] = solution[index] + fraction * (solution[index + 1] - solution[index]);
+        }
+    }
+    for (int k = 0; k < MPC_HORIZON; k++) solution[k] = u_prev[k];
+
+    stats.last_solve_us = time_us_32() - start_us;
+    if (stats.last_solve_us > stats.max_solve_us) stats.max_solve_us = stats.last_solve_us;
+
+    return last_yaw_rate * PWM_PER_RAD_S;
+}
+
+mpc_stats_t mpc_get_stats(void) {
+    return stats;
+}
+
+/**
+ * @brief Distancia de un punto a la ruta de prueba (polilínea local).
+ */
+static double distance_to_path(const double (*points)[2], int count, double x, double y) {
+    double best = 1e9;
+
+    for (int i = 0; i < count - 1; i++) {
+        double dx = points[i + 1][0] - points[i][0];
+        double dy = points[i + 1][1] - points[i][1];
+        double t = ((x - points[i][0]) * dx + (y - points[i][1]) * dy) / (dx * dx + dy * dy);
+        t = (t < 0.0) ? 0.0 : (t > 1.0) ? 1.0 : t;
+        double d = hypot(x - points[i][0] - t * dx, y - points[i][1] - t * dy);
+        if (d < best) best = d;
+    }
+
+    return best;
+}
+
+/**
+ * @brief Recorre la ruta de prueba con pure pursuit o con el MPC.
+ */
+static void simulate_route(bool use_mpc) {
+    const double lat0 = 6.267300;
+    const double lng0 = -75.568800;
+    const double meters_per_deg = 6371000 * M_PI / 180.0;
+    const double cos_lat0 = cos(lat0 * M_PI / 180.0);
+    const double dt = LOOP_INTERVAL_MS / 1000.0;
+
+    // Zigzag: 15 m al norte, 10 m al este, 15 m al norte, 10 m al oeste
+    const double points[5][2] = {{0, 0}, {0, 15}, {10, 15}, {10, 30}, {0, 30}};
+
+    route_clear();
+    for (int i = 1; i < 5; i++) {
+        route_add_waypoint(lat0 + points[i][1] / meters_per_deg,
+                           lng0 + points[i][0] / (meters_per_deg * cos_lat0), 0.0);
+    }
+
+    sim_vehicle_t vehicle;
+    sim_init(&vehicle, 0.0, 0.0, 0.0, 7);
+    route_start(lat0, lng0);
+    mpc_reset();
+
+    double headings[MPC_HORIZON + 1];
+    double error_sq = 0.0, error_max = 0.0;
+    double last_target_a = 0.0, last_target_b = 0.0, accel_max = 0.0;
+    uint32_t solve_total = 0;
+    int solves = 0;
+    route_command_t cmd = {0};
+    int step;
+
+    for (step = 0; step < 4000; step++) {
+        double lat = lat0 + vehicle.gps_north / meters_per_deg;
+        double lng = lng0 + vehicle.gps_east / (meters_per_deg * cos_lat0);
+
+        if (!route_update(lat, lng, vehicle.compass, &cmd) || cmd.finished) break;
+
+        double base_a = BASE_SPEED_A * cmd.speed_scale;
+        double base_b = BASE_SPEED_B * cmd.speed_scale;
+        double correction;
+
+        if (use_mpc) {
+            double speed = NOMINAL_SPEED_MPS * cmd.speed_scale;
+            route_preview(speed * MPC_STEP_S, MPC_HORIZON + 1, headings);
+            correction = mpc_compute(cmd.cross_track, vehicle.compass, speed, headings);
+            solve_total += mpc_get_stats().last_solve_us;
+            solves++;
+        } else {
+            correction = cmd.curvature * (WHEEL_TRACK_M / 2.0) * (base_a + base_b) / 2.0;
+        }
+
+        int pwm_a = (int)(base_a - correction);
+        int pwm_b = (int)(base_b + correction);
+        pwm_a = (pwm_a < MIN_SPEED) ? MIN_SPEED : (pwm_a > MAX_SPEED) ? MAX_SPEED : pwm_a;
+        pwm_b = (pwm_b < MIN_SPEED) ? MIN_SPEED : (pwm_b > MAX_SPEED) ? MAX_SPEED : pwm_b;
+
+        // Aceleración pedida a las ruedas (cambio de la velocidad de régimen)
+        double target_a = sim_pwm_to_speed(pwm_a, BASE_SPEED_A);
+        double target_b = sim_pwm_to_speed(pwm_b, BASE_SPEED_B);
+        if (step > 0) {
+            double accel = fmax(fabs(target_a - last_target_a), fabs(target_b - last_target_b)) / dt;
+            if (accel > accel_max) accel_max = accel;
+        }
+        last_target_a = target_a;
+        last_target_b = target_b;
+
+        sim_step(&vehicle, pwm_a, pwm_b, dt);
+
+        double error = distance_to_path(points, 5, vehicle.east, vehicle.north);
+        error_sq += error * error;
+        if (error > error_max) error_max = error;
+    }
+
+    printf("%s\t%s\t%.1f s\t\t%.2f m\t\t%.2f m\t\t%.1f m/s2\n",
+           use_mpc ? "MPC\t" : "Pure pursuit", cmd.finished ? "SI" : "NO", step * dt,
+           sqrt(error_sq / (step ? step : 1)), error_max, accel_max);
+
+    if (use_mpc && solves > 0) {
+        mpc_stats_t s = mpc_get_stats();
+        printf("Cálculo MPC: %lu us promedio, %lu us máximo (ciclo de %d ms)\n",
+               (unsigned long)(solve_total / solves), (unsigned long)s.max_solve_us,
+               LOOP_INTERVAL_MS);
+    }
+}
+
+void mpc_test(void) {
+    printf("=== PRUEBA MPC DE TRAYECTORIA (SIMULACIÓN) ===\n");
+    printf("Ruta en zigzag de 4 tramos, horizonte %d x %.1f s, %d iteraciones\n",
+           MPC_HORIZON, (double)MPC_STEP_S, MPC_ITERATIONS);
+    printf("Control\t\tFin\tTiempo\t\tError RMS\tError máx\tAcel. máx\n");
+
+    simulate_route(false);
+    simulate_route(true);
+
+    route_clear();
+    printf("Prueba MPC completada\n");
+}
\ No newline at end of file
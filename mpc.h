@@ -0,0 +1,84 @@
+/**
+ * @file mpc.h
+ * @brief Header del control predictivo (MPC) de trayectoria.
+ *
+ * Controlador predictivo lineal de horizonte fijo para el robot
+ * diferencial. Usa el modelo de uniciclo linealizado sobre la trayectoria
+ * de referencia (error lateral y error de rumbo) y decide la velocidad de
+ * giro de los próximos MPC_HORIZON pasos, de modo que empieza a girar
+ * antes de una esquina y respeta la aceleración máxima de las ruedas.
+ *
+ * El problema cuadrático condensado se resuelve con un número fijo de
+ * iteraciones de gradiente proyectado acelerado (FISTA) en memoria
+ * estática y aritmética float, así que el tiempo de cálculo es constante.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef MPC_H
+#define MPC_H
+
+#include "pico/stdlib.h"
+#include <stdint.h>
+
+/// @defgroup MPC_STRUCTURES Estructuras del MPC
+/// @{
+
+/**
+ * @brief Estadísticas del último cálculo.
+ */
+typedef struct {
+    uint32_t last_solve_us;  ///< Duración del último cálculo en us
+    uint32_t max_solve_us;   ///< Duración máxima registrada en us
+    float yaw_rate;          ///< Velocidad de giro aplicada en rad/s (positiva = horaria)
+    float cost;              ///< Costo de la solución
+} mpc_stats_t;
+
+/// @}
+
+/// @defgroup MPC_FUNCTIONS Funciones del MPC
+/// @{
+
+/**
+ * @brief Reinicia el estado del controlador (solución previa y giro aplicado).
+ *
+ * Debe llamarse al iniciar una navegación.
+ */
+void mpc_reset(void);
+
+/**
+ * @brief Calcula la corrección diferencial para seguir la trayectoria.
+ *
+ * @param lateral_error Distancia a la trayectoria en metros (positiva a la derecha)
+ * @param heading Rumbo actual en grados
+ * @param speed_mps Velocidad de avance en m/s
+ * @param path_headings Rumbo de la trayectoria en grados en la proyección
+ *        actual y a 1..MPC_HORIZON pasos de MPC_STEP_S a esa velocidad
+ *        (MPC_HORIZON + 1 valores)
+ * @return Corrección en unidades de PWM (se resta en A y se suma en B),
+ *         en la misma escala que la salida del PID de rumbo
+ */
+double mpc_compute(double lateral_error, double heading, double speed_mps,
+                   const double* path_headings);
+
+/**
+ * @brief Obtiene las estadísticas del último cálculo.
+ *
+ * @return Copia de las estadísticas
+ */
+mpc_stats_t mpc_get_stats(void);
+
+/**
+ * @brief Función de prueba del MPC.
+ *
+ * Recorre con el simulador del vehículo una ruta de varios tramos con el
+ * seguidor pure pursuit y con el MPC, compara error lateral, tiempo y
+ * aceleración de las ruedas, y mide el tiempo de cálculo por ciclo.
+ */
+void mpc_test(void);
+
+/// @}
+
+#endif // MPC_H
\ No newline at end of file
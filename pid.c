@@ -13,6 +13,7 @@
 #include "pid.h"
 #include "config.h"
 #include <math.h>
+#include <stdlib.h>
 
 void pid_init(pid_controller_t* pid, double kp, double ki, double kd, 
               double output_min, double output_max) {
@@ -23,18 +24,59 @@ void pid_init(pid_controller_t* pid, double kp, double ki, double kd,
     pid->kd = kd;
     pid->setpoint = 0.0;
     pid->last_input = 0.0;
+    pid->last_setpoint = 0.0;
     pid->integral_sum = 0.0;
     pid->output_min = output_min;
     pid->output_max = output_max;
+    pid->weight_p = 1.0;
+    pid->weight_d = 0.0;
+    pid->d_filter_tau = 0.0;
+    pid->d_filtered = 0.0;
     pid->last_time = time_us_32();
+    pid->angular = false;
+    pid->has_input = false;
     pid->initialized = true;
 }
 
+void pid_init_angular(pid_controller_t* pid, double kp, double ki, double kd, 
+                      double output_min, double output_max) {
+    pid_init(pid, kp, ki, kd, output_min, output_max);
+    if (pid) pid->angular = true;
+}
+
 void pid_set_setpoint(pid_controller_t* pid, double setpoint) {
     if (!pid || !pid->initialized) return;
     pid->setpoint = setpoint;
 }
 
+/**
+ * @brief Diferencia entre dos valores según el modo del controlador.
+ * 
+ * @return a - b, normalizada a [-180, +180] en modo angular
+ */
+static double pid_difference(const pid_controller_t* pid, double a, double b) {
+    return pid->angular ? pid_heading_error(a, b) : a - b;
+}
+
+/**
+ * @brief Entrada del término proporcional (referencia ponderada menos medición).
+ */
+static double proportional_input(const pid_controller_t* pid, double setpoint, double input) {
+    if (pid->angular) return pid_heading_error(setpoint, input);
+    return pid->weight_p * setpoint - input;
+}
+
+/**
+ * @brief Limita el término integral al rango de salida.
+ */
+static void clamp_integral(pid_controller_t* pid) {
+    if (pid->integral_sum > pid->output_max) {
+        pid->integral_sum = pid->output_max;
+    } else if (pid->integral_sum < pid->output_min) {
+        pid->integral_sum = pid->output_min;
+    }
+}
+
 double pid_compute(pid_controller_t* pid, double input) {
     if (!pid || !pid->initialized) return 0.0;
     
@@ -43,46 +85,59 @@ double pid_compute(pid_controller_t* pid, double input) {
     
     if (dt <= 0.0) return 0.0; // Evitar división por cero
     
-    // Calcular error
-    double error = pid->setpoint - input;
+    pid->last_time = current_time;
+    return pid_compute_dt(pid, input, dt);
+}
+
+double pid_compute_dt(pid_controller_t* pid, double input, double dt) {
+    if (!pid || !pid->initialized || dt <= 0.0) return 0.0;
+    
+    // Sin historia tras init/reset no hay derivada
+    if (!pid->has_input) {
+        pid->last_input = input;
+        pid->last_setpoint = pid->setpoint;
+        pid->d_filtered = 0.0;
+        pid->has_input = true;
+    }
     
-    // Término proporcional
-    double proportional = pid->kp * error;
+    // Calcular error (camino corto en modo angular)
+    double error = pid_difference(pid, pid->setpoint, input);
     
-    // Término integral
-    pid->integral_sum += error * dt;
-    double integral = pid->ki * pid->integral_sum;
+    // Término proporcional con peso b sobre la referencia
+    double proportional = pid->kp * proportional_input(pid, pid->setpoint, input);
+    
+    // Término derivativo con peso c sobre la referencia y filtro de primer orden
+    double d_error = pid->weight_d * pid_difference(pid, pid->setpoint, pid->last_setpoint) -
+                     pid_difference(pid, input, pid->last_input);
+    double derivative = pid->kd * d_error / dt;
+    
+    if (pid->d_filter_tau > 0.0) {
+        pid->d_filtered += (derivative - pid->d_filtered) * dt / (pid->d_filter_tau + dt);
+    } else {
+        pid->d_filtered = derivative;
+    }
     
-    // Término derivativo
-    double derivative = pid->kd * (input - pid->last_input) / dt;
+    // Término integral
+    double integral_step = pid->ki * error * dt;
+    pid->integral_sum += integral_step;
+    clamp_integral(pid);
     
     // Calcular salida
-    double output = proportional + integral - derivative;
+    double output = proportional + pid->integral_sum + pid->d_filtered;
     
     // Aplicar límites de saturación
     if (output > pid->output_max) {
         output = pid->output_max;
-        // Anti-windup: limitar integral cuando hay saturación
-        if (pid->ki != 0.0) {
-            double integral_max = (pid->output_max - proportional + derivative) / pid->ki;
-            if (pid->integral_sum > integral_max) {
-                pid->integral_sum = integral_max;
-            }
-        }
+        // Anti-windup: no integrar hacia la saturación
+        if (integral_step > 0.0) pid->integral_sum -= integral_step;
     } else if (output < pid->output_min) {
         output = pid->output_min;
-        // Anti-windup: limitar integral cuando hay saturación
-        if (pid->ki != 0.0) {
-            double integral_min = (pid->output_min - proportional + derivative) / pid->ki;
-            if (pid->integral_sum < integral_min) {
-                pid->integral_sum = integral_min;
-            }
-        }
+        if (integral_step < 0.0) pid->integral_sum -= integral_step;
     }
     
     // Actualizar variables para la próxima iteración
     pid->last_input = input;
-    pid->last_time = current_time;
+    pid->last_setpoint = pid->setpoint;
     
     return output;
 }
@@ -91,19 +146,46 @@ void pid_reset(pid_controller_t* pid) {
     if (!pid || !pid->initialized) return;
     
     pid->integral_sum = 0.0;
-    pid->last_input = 0.0;
+    pid->d_filtered = 0.0;
+    pid->has_input = false;
     pid->last_time = time_us_32();
 }
 
 void pid_tune(pid_controller_t* pid, double kp, double ki, double kd) {
     if (!pid || !pid->initialized) return;
     
+    if (pid->has_input) {
+        // El integral absorbe el cambio del proporcional (transferencia sin saltos).
+        // Con ki = 0 deja de integrar pero conserva su valor como sesgo fijo.
+        double p_input = proportional_input(pid, pid->last_setpoint, pid->last_input);
+        pid->integral_sum += (pid->kp - kp) * p_input;
+        clamp_integral(pid);
+    } else {
+        pid->integral_sum = 0.0;
+    }
+    
+    pid->d_filtered = (pid->kd != 0.0) ? pid->d_filtered * kd / pid->kd : 0.0;
+    
     pid->kp = kp;
     pid->ki = ki;
     pid->kd = kd;
+}
+
+void pid_set_derivative_filter(pid_controller_t* pid, double tau_s) {
+    if (!pid || !pid->initialized) return;
+    pid->d_filter_tau = (tau_s > 0.0) ? tau_s : 0.0;
+}
+
+void pid_set_setpoint_weights(pid_controller_t* pid, double b, double c) {
+    if (!pid || !pid->initialized) return;
     
-    // Reiniciar integral para evitar saltos
-    pid_reset(pid);
+    if (pid->has_input && !pid->angular) {
+        pid->integral_sum += pid->kp * (pid->weight_p - b) * pid->last_setpoint;
+        clamp_integral(pid);
+    }
+    
+    pid->weight_p = b;
+    pid->weight_d = c;
 }
 
 void pid_set_output_limits(pid_controller_t* pid, double output_min, double output_max) {
@@ -113,16 +195,7 @@ void pid_set_output_limits(pid_controller_t* pid, double output_min, double outp
     pid->output_max = output_max;
     
     // Limitar integral acumulada si está fuera de rango
-    if (pid->ki != 0.0) {
-        double max_integral = pid->output_max / pid->ki;
-        double min_integral = pid->output_min / pid->ki;
-        
-        if (pid->integral_sum > max_integral) {
-            pid->integral_sum = max_integral;
-        } else if (pid->integral_sum < min_integral) {
-            pid->integral_sum = min_integral;
-        }
-    }
+    clamp_integral(pid);
 }
 
 double pid_heading_error(double setpoint, double input) {
@@ -139,48 +212,147 @@ double pid_heading_error(double setpoint, double input) {
     return error;
 }
 
+/**
+ * @brief Resultado de una simulación de escalón.
+ */
+typedef struct {
+    double overshoot;     ///< Sobreimpulso en % del escalón
+    double settling_s;    ///< Tiempo hasta quedar dentro del 5%
+    double activity;      ///< Variación total de la salida por segundo
+} step_result_t;
+
+/**
+ * @brief Simula un escalón de rumbo con ruido de brújula.
+ *
+ * Modelo: la corrección produce una velocidad de giro de 0.9 °/s por
+ * unidad con un retardo de primer orden de 0.3 s. La medición lleva un
+ * ruido uniforme de ±2°; las métricas usan el rumbo real.
+ */
+static step_result_t simulate_heading_step(pid_controller_t* pid, double step) {
+    const double dt = LOOP_INTERVAL_MS / 1000.0;
+    const int steps = 200;
+    double heading = 0.0;
+    double yaw_rate = 0.0;
+    double last_output = 0.0;
+    double peak = 0.0;
+    int settle = 0;
+    step_result_t result = {0};
+    
+    srand(1);
+    pid_reset(pid);
+    pid_set_setpoint(pid, 0.0);
+    
+    for (int i = 0; i < steps; i++) {
+        if (i == 10) pid_set_setpoint(pid, step);
+        
+        double noise = 4.0 * rand() / RAND_MAX - 2.0;
+        double output = pid_compute_dt(pid, heading + noise, dt);
+        
+        if (i > 0) result.activity += fabs(output - last_output);
+        last_output = output;
+        
+        yaw_rate += (0.9 * output - yaw_rate) * dt / 0.3;
+        heading += yaw_rate * dt;
+        
+        if (i >= 10) {
+            if (heading > peak) peak = heading;
+            if (fabs(heading - step) > 0.05 * step) settle = i + 1;
+        }
+    }
+    
+    result.overshoot = 100.0 * (peak - step) / step;
+    result.settling_s = (settle - 10) * dt;
+    result.activity /= steps * dt;
+    return result;
+}
+
 void pid_test(void) {
     printf("=== PRUEBA CONTROLADOR PID ===\n");
     
-    // Crear controlador PID para prueba
+    // Respuesta a escalón: PID clásico frente a modo extendido
     pid_controller_t test_pid;
-    pid_init(&test_pid, 2.0, 0.1, 0.2, -100.0, 100.0);
+    pid_init(&test_pid, KP_DIR, KI_DIR, KD_DIR, -50.0, 50.0);
     
     printf("PID inicializado - Kp:%.1f, Ki:%.1f, Kd:%.1f\n", 
            test_pid.kp, test_pid.ki, test_pid.kd);
+    printf("Escalón de 30° con ruido de brújula ±2°:\n");
+    printf("Modo\t\tSobreimpulso\tEstablec.\tActividad salida\n");
     
-    // Simular respuesta a escalón
-    pid_set_setpoint(&test_pid, 90.0); // Objetivo: 90 grados
+    step_result_t basic = simulate_heading_step(&test_pid, 30.0);
+    printf("Clásico\t\t%.1f%%\t\t%.2f s\t\t%.0f /s\n",
+           basic.overshoot, basic.settling_s, basic.activity);
     
-    printf("Setpoint: %.1f grados\n", test_pid.setpoint);
-    printf("Simulando respuesta del sistema:\n");
-    printf("Tiempo(s)\tEntrada\t\tSalida PID\n");
+    pid_set_derivative_filter(&test_pid, PID_DIR_D_FILTER_TAU);
+    pid_set_setpoint_weights(&test_pid, PID_DIR_WEIGHT_P, PID_DIR_WEIGHT_D);
+    step_result_t extended = simulate_heading_step(&test_pid, 30.0);
+    printf("Extendido\t%.1f%%\t\t%.2f s\t\t%.0f /s\n",
+           extended.overshoot, extended.settling_s, extended.activity);
     
-    double simulated_output = 0.0;
-    for (int i = 0; i < 50; i++) {
-        // Simular planta de primer orden simple
-        simulated_output += pid_compute(&test_pid, simulated_output) * 0.01;
-        
-        printf("%.1f\t\t%.2f\t\t%.2f\n", 
-               i * 0.05, simulated_output, pid_compute(&test_pid, simulated_output));
-        
-        sleep_ms(50);
+    // Transferencia sin saltos en reset y cambio de ganancias
+    printf("\n--- Transferencia sin saltos ---\n");
+    const double dt = LOOP_INTERVAL_MS / 1000.0;
+    pid_set_setpoint(&test_pid, 90.0);
+    double output = 0.0;
+    for (int i = 0; i < 20; i++) {
+        output = pid_compute_dt(&test_pid, 80.0 + 0.2 * i, dt);
     }
     
-    // Prueba de control de rumbo
-    printf("\n--- Prueba de control de rumbo ---\n");
-    pid_controller_t heading_pid;
-    pid_init(&heading_pid, KP_DIR, KI_DIR, KD_DIR, -50.0, 50.0);
+    pid_tune(&test_pid, KP_DIR * 0.5, KI_DIR * 2.0, KD_DIR);
+    double after_tune = pid_compute_dt(&test_pid, 84.0, dt);
+    printf("Cambio de ganancias: salida %.2f -> %.2f\n", output, after_tune);
     
-    double test_headings[] = {10, 350, 180, 0, 270};
-    double target = 0;
+    pid_tune(&test_pid, KP_DIR, 0.0, KD_DIR);
+    double after_freeze = pid_compute_dt(&test_pid, 84.0, dt);
+    printf("Cambio a ki=0: salida %.2f -> %.2f (integral congelado)\n", after_tune, after_freeze);
     
-    for (int i = 0; i < 5; i++) {
-        double error = pid_heading_error(target, test_headings[i]);
-        double correction = pid_compute(&heading_pid, test_headings[i]);
-        
-        printf("Rumbo: %.0f°, Error: %.1f°, Corrección: %.1f\n", 
-               test_headings[i], error, correction);
+    pid_reset(&test_pid);
+    double after_reset = pid_compute_dt(&test_pid, 84.0, dt);
+    printf("Primer cálculo tras reset: %.2f (solo término proporcional %.2f)\n",
+           after_reset, test_pid.kp * (test_pid.weight_p * 90.0 - 84.0));
+    
+    // Giros que cruzan 0/360: modo lineal frente a modo angular
+    printf("\n--- Prueba de control de rumbo ---\n");
+    printf("Giro\t\tModo\t\tGiro total\tTiempo\n");
+    
+    double turns[][2] = {{350, 10}, {10, 350}, {300, 60}};
+    for (int i = 0; i < 3; i++) {
+        for (int angular = 0; angular < 2; angular++) {
+            pid_controller_t heading_pid;
+            if (angular) {
+                pid_init_angular(&heading_pid, KP_DIR, KI_DIR, KD_DIR, -50.0, 50.0);
+            } else {
+                pid_init(&heading_pid, KP_DIR, KI_DIR, KD_DIR, -50.0, 50.0);
+            }
+            pid_set_derivative_filter(&heading_pid, PID_DIR_D_FILTER_TAU);
+            pid_set_setpoint(&heading_pid, turns[i][1]);
+            
+            double heading = turns[i][0];
+            double yaw_rate = 0.0;
+            double turned = 0.0;
+            double reached_s = -1.0;
+            
+            for (int k = 0; k < 400 && reached_s < 0.0; k++) {
+                double output = pid_compute_dt(&heading_pid, heading, dt);
+                
+                yaw_rate += (0.9 * output - yaw_rate) * dt / 0.3;
+                heading = fmod(heading + yaw_rate * dt + 360.0, 360.0);
+                turned += fabs(yaw_rate * dt);
+                
+                if (fabs(pid_heading_error(turns[i][1], heading)) < 5.0) {
+                    reached_s = (k + 1) * dt;
+                }
+            }
+            
+            if (reached_s < 0.0) {
+                printf("%.0f° -> %.0f°\t%s\t\t%.0f°\t\tno llega en %.0f s\n",
+                       turns[i][0], turns[i][1], angular ? "angular" : "lineal",
+                       turned, 400 * dt);
+            } else {
+                printf("%.0f° -> %.0f°\t%s\t\t%.0f°\t\t%.2f s\n",
+                       turns[i][0], turns[i][1], angular ? "angular" : "lineal",
+                       turned, reached_s);
+            }
+        }
     }
     
     printf("Prueba PID completada\n");
@@ -4,6 +4,12 @@
  *
  * Define la estructura y funciones para implementar controladores PID
  * tanto para velocidad como para dirección del robot.
+ *
+ * Modo extendido (opcional, se activa con sus funciones de configuración):
+ * filtro de primer orden en el término derivativo y pesos de referencia
+ * b y c para los términos proporcional y derivativo. Con los valores por
+ * defecto (sin filtro, b = 1, c = 0) el comportamiento es el del PID
+ * clásico con derivada sobre la medición.
  * 
  * @author Equipo WALLY-S
  * @date 2025
@@ -27,10 +33,17 @@ typedef struct {
     double kd;              ///< Ganancia derivativa
     double setpoint;        ///< Valor objetivo
     double last_input;      ///< Último valor de entrada
-    double integral_sum;    ///< Suma del término integral
+    double last_setpoint;   ///< Referencia del último cálculo
+    double integral_sum;    ///< Término integral acumulado (ya multiplicado por ki)
     double output_min;      ///< Límite mínimo de salida
     double output_max;      ///< Límite máximo de salida
+    double weight_p;        ///< Peso b de la referencia en el término proporcional
+    double weight_d;        ///< Peso c de la referencia en el término derivativo
+    double d_filter_tau;    ///< Constante de tiempo del filtro derivativo en s (0 = sin filtro)
+    double d_filtered;      ///< Término derivativo filtrado
     uint32_t last_time;     ///< Último tiempo de cálculo en us
+    bool angular;           ///< true si entrada y referencia son ángulos en grados (0-360)
+    bool has_input;         ///< false hasta el primer cálculo tras init/reset
     bool initialized;       ///< true si el PID está inicializado
 } pid_controller_t;
 
@@ -52,6 +65,24 @@ typedef struct {
 void pid_init(pid_controller_t* pid, double kp, double ki, double kd, 
               double output_min, double output_max);
 
+/**
+ * @brief Inicializa un controlador PID para ángulos (control de rumbo).
+ * 
+ * El error se calcula con pid_heading_error(), así que el controlador
+ * siempre gira por el camino corto, y la derivada de la medición se toma
+ * sobre la diferencia angular, sin saltos al cruzar 0/360. En este modo
+ * el peso b de la referencia no se aplica (el proporcional usa el error).
+ * 
+ * @param[out] pid Puntero al controlador PID a inicializar
+ * @param kp Ganancia proporcional
+ * @param ki Ganancia integral
+ * @param kd Ganancia derivativa
+ * @param output_min Límite mínimo de salida
+ * @param output_max Límite máximo de salida
+ */
+void pid_init_angular(pid_controller_t* pid, double kp, double ki, double kd, 
+                      double output_min, double output_max);
+
 /**
  * @brief Establece el punto de referencia (setpoint) del PID.
  * 
@@ -70,144 +101,65 @@ void pid_set_setpoint(pid_controller_t* pid, double setpoint);
 double pid_compute(pid_controller_t* pid, double input);
 
 /**
- * @brief Reinicia el estado interno del controlador PID.
+ * @brief Calcula la salida del controlador PID con un paso de tiempo dado.
  * 
- * Pone a cero la suma integral y actualiza el tiempo base.
+ * Igual que pid_compute() pero sin leer el reloj, para simulaciones y
+ * para bucles que ya miden su propio periodo.
  * 
  * @param pid Puntero al controlador PID
+ * @param input Valor actual de la variable controlada
+ * @param dt Tiempo desde el cálculo anterior en segundos
+ * @return Salida del controlador PID
  */
-void pid_reset(pid_controller_t* pid);
+double pid_compute_dt(pid_controller_t* pid, double input, double dt);
 
 /**
- * @brief Ajusta los parámetros del controlador PID.
+ * @brief Reinicia el estado interno del controlador PID.
  * 
- * @param pid Puntero al controlador PID
- * @param kp Nueva ganancia proporcional
- * @param ki Nueva ganancia integral
- * @param kd Nueva ganancia derivativa
- */
-void pid_tune(pid_controller_t* pid, double kp, double ki, double kd);
-
-/**
- * @brief Establece los límites de salida del controlador.
+ * Pone a cero la suma integral y el derivativo filtrado y actualiza el
+ * tiempo base. El primer cálculo posterior no aplica término derivativo,
+ * así que no hay salto por la entrada anterior.
  * 
  * @param pid Puntero al controlador PID
- * @param output_min Nuevo límite mínimo
- * @param output_max Nuevo límite máximo
- */
-void pid_set_output_limits(pid_controller_t* pid, double output_min, double output_max);
-
-/**
- * @brief Maneja el cruce de 0/360 grados para control de rumbo.
- * 
- * Calcula el error más corto entre el setpoint y la entrada,
- * considerando que 359° y 1° están separados por 2°.
- * 
- * @param setpoint Rumbo objetivo (0-360°)
- * @param input Rumbo actual (0-360°)
- * @return Error con signo (-180° a +180°)
- */
-double pid_heading_error(double setpoint, double input);
-
-/**
- * @brief Función de prueba para el controlador PID.
- * 
- * Ejecuta una simulación del controlador con diferentes setpoints
- * y muestra la respuesta del sistema.
  */
-void pid_test(void);
-
-/// @}
-
-#endif // PID_H/**
- * @file pid.h
- * @brief Header del controlador PID para navegación autónoma.
- *
- * Define la estructura y funciones para implementar controladores PID
- * tanto para velocidad como para dirección del robot.
- * 
- * @author Equipo WALLY-S
- * @date 2025
- * @version 1.0
- */
-
-#ifndef PID_H
-#define PID_H
-
-#include "pico/stdlib.h"
-
-/// @defgroup PID_STRUCTURES Estructuras PID
-/// @{
-
-/**
- * @brief Estructura que contiene los parámetros y estado de un controlador PID.
- */
-typedef struct {
-    double kp;              ///< Ganancia proporcional
-    double ki;              ///< Ganancia integral  
-    double kd;              ///< Ganancia derivativa
-    double setpoint;        ///< Valor objetivo
-    double last_input;      ///< Último valor de entrada
-    double integral_sum;    ///< Suma del término integral
-    double output_min;      ///< Límite mínimo de salida
-    double output_max;      ///< Límite máximo de salida
-    uint32_t last_time;     ///< Último tiempo de cálculo en us
-    bool initialized;       ///< true si el PID está inicializado
-} pid_controller_t;
-
-/// @}
-
-/// @defgroup PID_FUNCTIONS Funciones PID
-/// @{
+void pid_reset(pid_controller_t* pid);
 
 /**
- * @brief Inicializa un controlador PID.
+ * @brief Ajusta los parámetros del controlador PID sin saltos en la salida.
  * 
- * @param[out] pid Puntero al controlador PID a inicializar
- * @param kp Ganancia proporcional
- * @param ki Ganancia integral
- * @param kd Ganancia derivativa
- * @param output_min Límite mínimo de salida
- * @param output_max Límite máximo de salida
- */
-void pid_init(pid_controller_t* pid, double kp, double ki, double kd, 
-              double output_min, double output_max);
-
-/**
- * @brief Establece el punto de referencia (setpoint) del PID.
+ * El término integral absorbe el cambio del término proporcional y el
+ * derivativo filtrado se escala con la nueva kd, de modo que la salida
+ * siguiente continúa desde la anterior. Si la nueva ki es 0 el integral
+ * queda congelado como sesgo; solo se descarta si aún no hubo entrada.
  * 
  * @param pid Puntero al controlador PID
- * @param setpoint Nuevo valor objetivo
+ * @param kp Nueva ganancia proporcional
+ * @param ki Nueva ganancia integral
+ * @param kd Nueva ganancia derivativa
  */
-void pid_set_setpoint(pid_controller_t* pid, double setpoint);
+void pid_tune(pid_controller_t* pid, double kp, double ki, double kd);
 
 /**
- * @brief Calcula la salida del controlador PID.
+ * @brief Configura el filtro de primer orden del término derivativo.
  * 
  * @param pid Puntero al controlador PID
- * @param input Valor actual de la variable controlada
- * @return Salida del controlador PID
+ * @param tau_s Constante de tiempo en segundos (0 desactiva el filtro)
  */
-double pid_compute(pid_controller_t* pid, double input);
+void pid_set_derivative_filter(pid_controller_t* pid, double tau_s);
 
 /**
- * @brief Reinicia el estado interno del controlador PID.
+ * @brief Configura los pesos de la referencia (PID de dos grados de libertad).
  * 
- * Pone a cero la suma integral y actualiza el tiempo base.
+ * P = kp * (b * referencia - entrada), D = kd * d(c * referencia - entrada)/dt.
+ * Con b < 1 un cambio de referencia produce menos sobreimpulso sin cambiar
+ * el rechazo de perturbaciones; c = 0 evita el pico derivativo por cambios
+ * de referencia. El cambio de b es sin saltos.
  * 
  * @param pid Puntero al controlador PID
+ * @param b Peso en el término proporcional (0..1)
+ * @param c Peso en el término derivativo (0..1)
  */
-void pid_reset(pid_controller_t* pid);
-
-/**
- * @brief Ajusta los parámetros del controlador PID.
- * 
- * @param pid Puntero al controlador PID
- * @param kp Nueva ganancia proporcional
- * @param ki Nueva ganancia integral
- * @param kd Nueva ganancia derivativa
- */
-void pid_tune(pid_controller_t* pid, double kp, double ki, double kd);
+void pid_set_setpoint_weights(pid_controller_t* pid, double b, double c);
 
 /**
  * @brief Establece los límites de salida del controlador.
@@ -233,8 +185,11 @@ double pid_heading_error(double setpoint, double input);
 /**
  * @brief Función de prueba para el controlador PID.
  * 
- * Ejecuta una simulación del controlador con diferentes setpoints
- * y muestra la respuesta del sistema.
+ * Simula escalones de rumbo con ruido de medición y compara el PID
+ * clásico con el modo extendido (sobreimpulso, establecimiento y
+ * variación total de la salida). Verifica además que reset y cambio
+ * de ganancias no producen saltos en la salida, y compara el modo
+ * lineal con el angular en giros que cruzan 0/360.
  */
 void pid_test(void);
 
@@ -0,0 +1,365 @@
+/**
+ * @file pool.c
+ * @brief Implementación de los bloques de memoria de tamaño fijo.
+ *
+ * Cada clase es un arreglo estático; los bloques libres forman una pila
+ * enlazada por índice, guardado en los primeros bytes del propio bloque.
+ * Reservar es sacar la cabeza de la pila y liberar es ponerla, así que
+ * las dos operaciones son O(1) y no recorren nada.
+ *
+ * El Cortex-M0+ no tiene LDREX/STREX, así que no hay compare-and-swap
+ * para una pila sin bloqueo entre los dos núcleos. El primitivo atómico
+ * del RP2040 son los spinlocks del SIO: cada clase usa uno, tomado solo
+ * durante las pocas instrucciones que mueven la cabeza y con las
+ * interrupciones deshabilitadas, así que una interrupción no puede quedar
+ * esperando a un bucle que la interrumpió.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "pool.h"
+#include "bluetooth.h"
+#include "config.h"
+#include "hardware/sync.h"
+#include <stdio.h>
+#include <string.h>
+
+/// @brief Fin de la lista de libres
+#define POOL_NONE 0xFFFF
+
+/// @brief Iteraciones de la medición de la prueba
+#define TEST_ITERATIONS 10000
+
+/// @brief Duración de la prueba con interrupciones en ms
+#define TEST_ISR_MS 2000
+
+/// @brief Periodo del temporizador de la prueba en µs
+#define TEST_ISR_PERIOD_US 200
+
+/// @brief Bloques que retiene la interrupción de la prueba
+#define TEST_ISR_HELD 4
+
+_Static_assert(POOL_SMALL_SIZE % 8 == 0 && POOL_MEDIUM_SIZE % 8 == 0 && POOL_LARGE_SIZE % 8 == 0,
+               "Los bloques deben ser múltiplos de 8 bytes");
+_Static_assert(POOL_SMALL_SIZE < POOL_MEDIUM_SIZE && POOL_MEDIUM_SIZE < POOL_LARGE_SIZE,
+               "Las clases deben ir de menor a mayor");
+_Static_assert(POOL_SMALL_COUNT < POOL_NONE && POOL_MEDIUM_COUNT < POOL_NONE && POOL_LARGE_COUNT < POOL_NONE,
+               "Demasiados bloques en una clase");
+
+/// @brief Memoria de cada clase
+static uint64_t small_blocks[POOL_SMALL_COUNT * POOL_SMALL_SIZE / 8];
+static uint64_t medium_blocks[POOL_MEDIUM_COUNT * POOL_MEDIUM_SIZE / 8];
+static uint64_t large_blocks[POOL_LARGE_COUNT * POOL_LARGE_SIZE / 8];
+
+/// @brief Bloques reservados (1) o libres (0), para detectar liberaciones dobles
+static uint8_t small_used[POOL_SMALL_COUNT];
+static uint8_t medium_used[POOL_MEDIUM_COUNT];
+static uint8_t large_used[POOL_LARGE_COUNT];
+
+/**
+ * @brief Una clase de bloques.
+ */
+typedef struct {
+    uint8_t* memory;     ///< Primer bloque
+    uint8_t* used;       ///< Marca de reservado por bloque
+    uint16_t size;       ///< Bytes por bloque
+    uint16_t count;      ///< Número de bloques
+    uint16_t free_head;  ///< Primer bloque libre (POOL_NONE si está agotada)
+    spin_lock_t* lock;   ///< Protege la lista y los contadores
+    pool_stats_t stats;  ///< Uso y contadores
+} pool_t;
+
+/// @brief Clases, de menor a mayor
+static pool_t pools[POOL_CLASS_COUNT] = {
+    [POOL_SMALL] = { (uint8_t*)small_blocks, small_used, POOL_SMALL_SIZE, POOL_SMALL_COUNT },
+    [POOL_MEDIUM] = { (uint8_t*)medium_blocks, medium_used, POOL_MEDIUM_SIZE, POOL_MEDIUM_COUNT },
+    [POOL_LARGE] = { (uint8_t*)large_blocks, large_used, POOL_LARGE_SIZE, POOL_LARGE_COUNT },
+};
+
+/// @brief Estado de inicialización
+static bool initialized = false;
+
+/**
+ * @brief Índice del siguiente libre, guardado en el bloque libre.
+ */
+static inline uint16_t* next_of(pool_t* pool, uint16_t index) {
+    return (uint16_t*)(pool->memory + (size_t)index * pool->size);
+}
+
+/**
+ * @brief Saca un bloque de la clase, o NULL si está agotada.
+ */
+static void* take(pool_t* pool) {
+    uint8_t* block = NULL;
+    uint32_t irq = spin_lock_blocking(pool->lock);
+
+    uint16_t index = pool->free_head;
+    if (index != POOL_NONE) {
+        pool->free_head = *next_of(pool, index);
+        pool->used[index] = 1;
+        block = pool->memory + (size_t)index * pool->size;
+
+        pool->stats.allocs++;
+        if (++pool->stats.in_use > pool->stats.peak) {
+            pool->stats.peak = pool->stats.in_use;
+        }
+    } else {
+        pool->stats.failures++;
+    }
+
+    spin_unlock(pool->lock, irq);
+    return block;
+}
+
+void pool_init(void) {
+    if (initialized) return;
+
+    for (int i = 0; i < POOL_CLASS_COUNT; i++) {
+        pool_t* pool = &pools[i];
+        pool->lock = spin_lock_instance((uint)spin_lock_claim_unused(true));
+
+        // Todos libres, enlazados en orden
+        for (uint16_t index = 0; index < pool->count; index++) {
+            *next_of(pool, index) = (index + 1 < pool->count) ? index + 1 : POOL_NONE;
+            pool->used[index] = 0;
+        }
+        pool->free_head = 0;
+
+        memset(&pool->stats, 0, sizeof(pool->stats));
+        pool->stats.block_size = pool->size;
+        pool->stats.blocks = pool->count;
+    }
+    initialized = true;
+}
+
+void* pool_alloc(size_t size) {
+    if (!initialized || size == 0) return NULL;
+
+    for (int i = 0; i < POOL_CLASS_COUNT; i++) {
+        if (size > pools[i].size) continue;
+        void* block = take(&pools[i]);
+        if (block) return block;
+    }
+    return NULL;
+}
+
+void pool_free(void* block) {
+    if (!initialized || !block) return;
+
+    for (int i = 0; i < POOL_CLASS_COUNT; i++) {
+        pool_t* pool = &pools[i];
+        uint8_t* address = (uint8_t*)block;
+        if (address < pool->memory || address >= pool->memory + (size_t)pool->count * pool->size) {
+            continue;
+        }
+
+        size_t offset = (size_t)(address - pool->memory);
+        uint16_t index = (uint16_t)(offset / pool->size);
+        uint32_t irq = spin_lock_blocking(pool->lock);
+
+        if (offset % pool->size != 0 || !pool->used[index]) {
+            pool->stats.invalid++;
+        } else {
+            pool->used[index] = 0;
+            *next_of(pool, index) = pool->free_head;
+            pool->free_head = index;
+            pool->stats.in_use--;
+        }
+
+        spin_unlock(pool->lock, irq);
+        return;
+    }
+
+    // No es de ninguna clase: se cuenta en la mayor
+    pool_t* pool = &pools[POOL_CLASS_COUNT - 1];
+    uint32_t irq = spin_lock_blocking(pool->lock);
+    pool->stats.invalid++;
+    spin_unlock(pool->lock, irq);
+}
+
+pool_stats_t pool_get_stats(pool_class_t pool) {
+    if (!initialized || pool >= POOL_CLASS_COUNT) return (pool_stats_t){0};
+
+    uint32_t irq = spin_lock_blocking(pools[pool].lock);
+    pool_stats_t copy = pools[pool].stats;
+    spin_unlock(pools[pool].lock, irq);
+    return copy;
+}
+
+bool pool_handle_command(const char* line) {
+    if (!line || strcmp(line, "POOL?") != 0) return false;
+
+    for (int i = 0; i < POOL_CLASS_COUNT; i++) {
+        pool_stats_t stats = pool_get_stats((pool_class_t)i);
+        char reply[80];
+        snprintf(reply, sizeof(reply), "POOL,%u,%u,%u,%u,%lu,%lu\n",
+                 stats.block_size, stats.blocks, stats.in_use, stats.peak,
+                 (unsigned long)stats.failures, (unsigned long)stats.invalid);
+        bluetooth_send_string(reply);
+    }
+    return true;
+}
+
+void pool_print(void) {
+    for (int i = 0; i < POOL_CLASS_COUNT; i++) {
+        pool_stats_t stats = pool_get_stats((pool_class_t)i);
+        printf("  Bloques de %3u B: %2u/%2u en uso (máx %u), %lu reservas, %lu agotada, %lu inválidas\n",
+               stats.block_size, stats.in_use, stats.blocks, stats.peak,
+               (unsigned long)stats.allocs, (unsigned long)stats.failures,
+               (unsigned long)stats.invalid);
+    }
+}
+
+// ==================== PRUEBA ====================
+
+/// @brief Estado de la interrupción de la prueba
+static void* isr_blocks[TEST_ISR_HELD];
+static volatile uint32_t isr_rounds = 0;
+static volatile uint32_t isr_errors = 0;
+static volatile uint32_t isr_empty = 0;
+
+/**
+ * @brief Marca un bloque con un patrón que depende de su dueño.
+ */
+static void fill(void* block, size_t size, uint8_t owner) {
+    memset(block, owner, size);
+}
+
+/**
+ * @brief Verifica que nadie más escribió en el bloque.
+ */
+static bool intact(const void* block, size_t size, uint8_t owner) {
+    const uint8_t* bytes = (const uint8_t*)block;
+    for (size_t i = 0; i < size; i++) {
+        if (bytes[i] != owner) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Interrupción de la prueba: rota TEST_ISR_HELD bloques medianos.
+ */
+static bool isr_churn(repeating_timer_t* timer) {
+    (void)timer;
+    int slot = isr_rounds % TEST_ISR_HELD;
+
+    if (isr_blocks[slot]) {
+        if (!intact(isr_blocks[slot], POOL_MEDIUM_SIZE, 0xA5)) isr_errors++;
+        pool_free(isr_blocks[slot]);
+    }
+    isr_blocks[slot] = pool_alloc(POOL_MEDIUM_SIZE);
+    if (isr_blocks[slot]) {
+        fill(isr_blocks[slot], POOL_MEDIUM_SIZE, 0xA5);
+    } else {
+        isr_empty++;
+    }
+
+    isr_rounds++;
+    return true;
+}
+
+void pool_test(void) {
+    printf("=== PRUEBA BLOQUES DE MEMORIA ===\n");
+
+    pool_init();
+    pool_stats_t before[POOL_CLASS_COUNT];
+    for (int i = 0; i < POOL_CLASS_COUNT; i++) {
+        before[i] = pool_get_stats((pool_class_t)i);
+    }
+
+    // Agotar la clase chica: los pedidos siguientes pasan a la mediana
+    static void* blocks[POOL_SMALL_COUNT + 4];
+    int count = 0;
+    int spilled = 0;
+    for (int i = 0; i < POOL_SMALL_COUNT + 4; i++) {
+        blocks[i] = pool_alloc(POOL_SMALL_SIZE);
+        if (!blocks[i]) continue;
+        count++;
+        uint8_t* address = (uint8_t*)blocks[i];
+        if (address >= (uint8_t*)medium_blocks && address < (uint8_t*)medium_blocks + sizeof(medium_blocks)) {
+            spilled++;
+        }
+    }
+    pool_stats_t small = pool_get_stats(POOL_SMALL);
+    bool ok = count == POOL_SMALL_COUNT + 4 && spilled == 4 &&
+              small.failures - before[POOL_SMALL].failures == 4;
+    printf("Clase de %d B agotada: %d bloques, %d atendidos por la mediana: %s\n",
+           POOL_SMALL_SIZE, count, spilled, ok ? "OK" : "FALLA");
+
+    for (int i = 0; i < POOL_SMALL_COUNT + 4; i++) {
+        pool_free(blocks[i]);
+    }
+
+    // Liberación doble y dirección ajena
+    void* block = pool_alloc(POOL_LARGE_SIZE);
+    pool_free(block);
+    pool_free(block);
+    pool_free((uint8_t*)large_blocks + 1);
+    pool_free(&count);
+    uint32_t invalid = 0;
+    for (int i = 0; i < POOL_CLASS_COUNT; i++) {
+        invalid += pool_get_stats((pool_class_t)i).invalid - before[i].invalid;
+    }
+    bool invalid_ok = block != NULL && invalid == 3;
+    printf("Liberaciones inválidas detectadas: %lu de 3: %s\n",
+           (unsigned long)invalid, invalid_ok ? "OK" : "FALLA");
+
+    // Costo de reservar y liberar
+    uint32_t start_us = time_us_32();
+    for (int i = 0; i < TEST_ITERATIONS; i++) {
+        pool_free(pool_alloc(POOL_MEDIUM_SIZE));
+    }
+    uint32_t elapsed_us = time_us_32() - start_us;
+    printf("Reservar y liberar: %.2f us por par\n", (double)elapsed_us / TEST_ITERATIONS);
+
+    // Bucle e interrupción compitiendo por la clase mediana
+    printf("Reservando desde el bucle y desde una interrupción cada %d us durante %d ms...\n",
+           TEST_ISR_PERIOD_US, TEST_ISR_MS);
+    memset(isr_blocks, 0, sizeof(isr_blocks));
+    isr_rounds = isr_errors = isr_empty = 0;
+
+    repeating_timer_t timer;
+    add_repeating_timer_us(-TEST_ISR_PERIOD_US, isr_churn, NULL, &timer);
+
+    uint32_t loop_rounds = 0;
+    uint32_t loop_errors = 0;
+    uint32_t loop_empty = 0;
+    uint32_t end_ms = to_ms_since_boot(get_absolute_time()) + TEST_ISR_MS;
+    while ((int32_t)(end_ms - to_ms_since_boot(get_absolute_time())) > 0) {
+        void* mine = pool_alloc(POOL_MEDIUM_SIZE);
+        if (!mine) {
+            loop_empty++;
+            continue;
+        }
+        fill(mine, POOL_MEDIUM_SIZE, 0x5A);
+        busy_wait_us(20);
+        if (!intact(mine, POOL_MEDIUM_SIZE, 0x5A)) loop_errors++;
+        pool_free(mine);
+        loop_rounds++;
+    }
+
+    cancel_repeating_timer(&timer);
+    for (int i = 0; i < TEST_ISR_HELD; i++) {
+        pool_free(isr_blocks[i]);
+    }
+
+    bool shared_ok = loop_errors == 0 && isr_errors == 0 && isr_rounds > 0;
+    printf("Bucle: %lu reservas, interrupción: %lu reservas, bloques pisados: %lu: %s\n",
+           (unsigned long)loop_rounds, (unsigned long)isr_rounds,
+           (unsigned long)(loop_errors + isr_errors), shared_ok ? "OK" : "FALLA");
+    if (loop_empty || isr_empty) {
+        printf("  Clase agotada: %lu veces en el bucle, %lu en la interrupción\n",
+               (unsigned long)loop_empty, (unsigned long)isr_empty);
+    }
+
+    bool balanced = true;
+    for (int i = 0; i < POOL_CLASS_COUNT; i++) {
+        balanced = balanced && pool_get_stats((pool_class_t)i).in_use == before[i].in_use;
+    }
+
+    printf("\nUso de las clases:\n");
+    pool_print();
+    printf("\nResultado: %s\n", (ok && invalid_ok && shared_ok && balanced) ? "OK" : "FALLA");
+}
\ No newline at end of file
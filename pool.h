@@ -0,0 +1,124 @@
+/**
+ * @file pool.h
+ * @brief Header de los bloques de memoria de tamaño fijo.
+ *
+ * Alternativa a malloc para datos de tamaño acotado que deban sobrevivir a
+ * la función que los crea (pasar un bloque a otro núcleo o a una
+ * interrupción): cada clase es un arreglo estático de bloques iguales con
+ * una lista de libres. Reservar y liberar cuesta lo mismo siempre y no
+ * fragmenta la RAM. Un pedido va a la clase más chica en la que cabe; si
+ * está agotada se atiende con la siguiente y el agotamiento se cuenta.
+ *
+ * Por ahora es infraestructura sin usuarios en el firmware: los módulos
+ * existentes usan buffers estáticos o en la pila, que no pueden fallar,
+ * y solo pool_test() reserva bloques. Las clases ocupan igual su RAM
+ * (POOL_*_SIZE * POOL_*_COUNT); conviene achicarlas si hace falta memoria
+ * antes de que aparezca el primer usuario.
+ *
+ * Se puede reservar y liberar desde los dos núcleos y desde interrupciones.
+ *
+ * Comandos (App -> Robot):
+ * - "POOL?": responde una línea por clase
+ *   "POOL,<bytes>,<bloques>,<en_uso>,<máximo>,<agotada>,<inválidas>"
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef POOL_H
+#define POOL_H
+
+#include "pico/stdlib.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/// @defgroup POOL_STRUCTURES Estructuras de los bloques
+/// @{
+
+/**
+ * @brief Clases de bloques, de menor a mayor tamaño.
+ */
+typedef enum {
+    POOL_SMALL = 0,      ///< POOL_SMALL_SIZE bytes
+    POOL_MEDIUM,         ///< POOL_MEDIUM_SIZE bytes
+    POOL_LARGE,          ///< POOL_LARGE_SIZE bytes
+    POOL_CLASS_COUNT     ///< Número de clases
+} pool_class_t;
+
+/**
+ * @brief Uso de una clase.
+ */
+typedef struct {
+    uint16_t block_size; ///< Bytes por bloque
+    uint16_t blocks;     ///< Bloques de la clase
+    uint16_t in_use;     ///< Bloques reservados ahora
+    uint16_t peak;       ///< Máximo de bloques reservados a la vez
+    uint32_t allocs;     ///< Reservas atendidas por la clase
+    uint32_t failures;   ///< Pedidos que la encontraron agotada
+    uint32_t invalid;    ///< Liberaciones de bloques ya libres o de direcciones ajenas
+} pool_stats_t;
+
+/// @}
+
+/// @defgroup POOL_FUNCTIONS Funciones de los bloques
+/// @{
+
+/**
+ * @brief Arma las listas de libres y reserva los spinlocks.
+ *
+ * Debe llamarse una vez al inicio de main(), antes de cualquier reserva.
+ */
+void pool_init(void);
+
+/**
+ * @brief Reserva un bloque.
+ *
+ * @param size Bytes necesarios
+ * @return Bloque de la clase más chica con lugar, o NULL si no hay ninguno
+ */
+void* pool_alloc(size_t size);
+
+/**
+ * @brief Devuelve un bloque.
+ *
+ * NULL se ignora. Un bloque ya libre o una dirección que no es de un
+ * bloque no se toca y se cuenta como liberación inválida.
+ *
+ * @param block Bloque entregado por pool_alloc()
+ */
+void pool_free(void* block);
+
+/**
+ * @brief Obtiene el uso de una clase.
+ *
+ * @param pool Clase
+ * @return Tamaño, ocupación y contadores
+ */
+pool_stats_t pool_get_stats(pool_class_t pool);
+
+/**
+ * @brief Procesa el comando POOL?.
+ *
+ * @param line Línea recibida por Bluetooth
+ * @return true si la línea era un comando de los bloques
+ */
+bool pool_handle_command(const char* line);
+
+/**
+ * @brief Muestra el uso de las clases por consola.
+ */
+void pool_print(void);
+
+/**
+ * @brief Función de prueba de los bloques.
+ *
+ * Agota una clase, prueba las liberaciones inválidas, reserva y libera a
+ * la vez desde el bucle y desde una interrupción de temporizador y mide
+ * el costo de cada operación.
+ */
+void pool_test(void);
+
+/// @}
+
+#endif // POOL_H
\ No newline at end of file
@@ -0,0 +1,418 @@
+/**
+ * @file route.c
+ * @brief Implementación del módulo de rutas con seguimiento pure pursuit.
+ *
+ * Este módulo almacena una lista fija de waypoints, la proyecta a un plano
+ * local en metros y calcula en cada ciclo la curvatura necesaria para
+ * alcanzar un punto de anticipación sobre la trayectoria.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "route.h"
+#include "gps.h"
+#include "geofence.h"
+#include "storage.h"
+#include "config.h"
+#include <math.h>
+
+/**
+ * @brief Vértice de la trayectoria en coordenadas locales.
+ */
+typedef struct {
+    double east;         ///< Coordenada Este en metros
+    double north;        ///< Coordenada Norte en metros
+    double speed_limit;  ///< Velocidad máxima hacia el vértice en m/s
+} route_vertex_t;
+
+/// @brief Waypoints recibidos
+static route_waypoint_t waypoints[ROUTE_MAX_WAYPOINTS];
+
+/// @brief Número de waypoints cargados
+static int waypoint_count = 0;
+
+/// @brief Trayectoria local: posición inicial seguida de los waypoints
+static route_vertex_t path[ROUTE_MAX_WAYPOINTS + 1];
+
+/// @brief Número de vértices de la trayectoria
+static int path_length = 0;
+
+/// @brief Origen del plano local
+static double origin_lat = 0.0;
+static double origin_lng = 0.0;
+
+/// @brief Segmento activo (de path[segment] a path[segment + 1])
+static int segment = 0;
+
+/// @brief Proyección del robot en el segmento activo (último route_update)
+static double projection_t = 0.0;
+
+/// @brief true si la ruta está en seguimiento
+static bool active = false;
+
+/// @brief Registros para guardar y cargar la ruta en flash
+static route_record_t records[ROUTE_MAX_WAYPOINTS];
+
+/**
+ * @brief Rumbo de un segmento de la trayectoria.
+ *
+ * @param index Índice del vértice inicial del segmento
+ * @return Rumbo en grados (0-360)
+ */
+static double segment_heading(int index) {
+    double bearing = atan2(path[index + 1].east - path[index].east,
+                           path[index + 1].north - path[index].north) * 180.0 / M_PI;
+    return (bearing < 0.0) ? bearing + 360.0 : bearing;
+}
+
+/**
+ * @brief Proyecta un punto sobre un segmento de la trayectoria.
+ *
+ * @param index Índice del vértice inicial del segmento
+ * @param x Coordenada Este del punto
+ * @param y Coordenada Norte del punto
+ * @return Parámetro t de la proyección (0 = inicio, 1 = fin, sin limitar)
+ */
+static double project_on_segment(int index, double x, double y) {
+    double dx = path[index + 1].east - path[index].east;
+    double dy = path[index + 1].north - path[index].north;
+    double length_sq = dx * dx + dy * dy;
+
+    if (length_sq < 1e-6) return 1.0; // Segmento degenerado
+
+    return ((x - path[index].east) * dx + (y - path[index].north) * dy) / length_sq;
+}
+
+void route_clear(void) {
+    waypoint_count = 0;
+    path_length = 0;
+    segment = 0;
+    active = false;
+}
+
+bool route_add_waypoint(double lat, double lng, double speed_limit) {
+    if (waypoint_count >= ROUTE_MAX_WAYPOINTS) return false;
+    if (lat < -90.0 || lat > 90.0 || lng < -180.0 || lng > 180.0) return false;
+
+    if (speed_limit <= 0.0 || speed_limit > NOMINAL_SPEED_MPS) {
+        speed_limit = NOMINAL_SPEED_MPS;
+    }
+
+    waypoints[waypoint_count].latitude = lat;
+    waypoints[waypoint_count].longitude = lng;
+    waypoints[waypoint_count].speed_limit = speed_limit;
+    waypoint_count++;
+
+    return true;
+}
+
+bool route_within_fence(void) {
+    for (int i = 0; i < waypoint_count; i++) {
+        if (!geofence_contains(waypoints[i].latitude, waypoints[i].longitude)) return false;
+    }
+
+    return true;
+}
+
+int route_get_count(void) {
+    return waypoint_count;
+}
+
+bool route_get_waypoint(int index, route_waypoint_t* waypoint) {
+    if (!waypoint || index < 0 || index >= waypoint_count) return false;
+
+    *waypoint = waypoints[index];
+    return true;
+}
+
+bool route_save(void) {
+    for (int i = 0; i < waypoint_count; i++) {
+        records[i].lat_e7 = (int32_t)lround(waypoints[i].latitude * 1e7);
+        records[i].lng_e7 = (int32_t)lround(waypoints[i].longitude * 1e7);
+        records[i].speed_cms = (uint16_t)lround(waypoints[i].speed_limit * 100.0);
+        records[i].reserved = 0;
+    }
+
+    return storage_write(STORAGE_REGION_ROUTE, records, waypoint_count * sizeof(route_record_t));
+}
+
+/**
+ * @brief Verifica que un registro sea un punto de ruta aceptable.
+ *
+ * Igual que con el comando WP, el punto debe estar dentro de la geocerca.
+ */
+static bool record_valid(const route_record_t* record) {
+    double lat = record->lat_e7 / 1e7;
+    double lng = record->lng_e7 / 1e7;
+
+    return lat >= -90.0 && lat <= 90.0 && lng >= -180.0 && lng <= 180.0 &&
+           geofence_contains(lat, lng);
+}
+
+/**
+ * @brief Lee los registros de una región y los pasa a la ruta actual.
+ *
+ * Todos los registros se validan antes de tocar la ruta actual.
+ *
+ * @param region Región origen
+ * @return true si había una ruta válida con al menos un punto
+ */
+static bool load_records(storage_region_t region) {
+    size_t length = 0;
+    if (!storage_read(region, records, sizeof(records), &length)) return false;
+    if (length == 0 || length % sizeof(route_record_t) != 0) return false;
+
+    size_t count = length / sizeof(route_record_t);
+    for (size_t i = 0; i < count; i++) {
+        if (!record_valid(&records[i])) return false;
+    }
+
+    route_clear();
+
+    for (size_t i = 0; i < count; i++) {
+        route_add_waypoint(records[i].lat_e7 / 1e7, records[i].lng_e7 / 1e7,
+                           records[i].speed_cms / 100.0);
+    }
+
+    return true;
+}
+
+bool route_load(void) {
+    return load_records(STORAGE_REGION_ROUTE);
+}
+
+bool route_install(storage_region_t region) {
+    if (!load_records(region)) return false;
+
+    // records conserva los datos recibidos
+    return storage_write(STORAGE_REGION_ROUTE, records, waypoint_count * sizeof(route_record_t));
+}
+
+bool route_start(double lat, double lng) {
+    if (waypoint_count == 0) return false;
+
+    origin_lat = lat;
+    origin_lng = lng;
+
+    // El primer vértice es la posición actual del robot
+    path[0].east = 0.0;
+    path[0].north = 0.0;
+    path[0].speed_limit = waypoints[0].speed_limit;
+
+    for (int i = 0; i < waypoint_count; i++) {
+        gps_latlng_to_local(origin_lat, origin_lng,
+                            waypoints[i].latitude, waypoints[i].longitude,
+                            &path[i + 1].east, &path[i + 1].north);
+        path[i + 1].speed_limit = waypoints[i].speed_limit;
+    }
+
+    path_length = waypoint_count + 1;
+    segment = 0;
+    active = true;
+
+    return true;
+}
+
+void route_stop(void) {
+    active = false;
+}
+
+bool route_is_active(void) {
+    return active;
+}
+
+bool route_update(double lat, double lng, double heading, route_command_t* command) {
+    if (!active || !command) return false;
+
+    double x, y;
+    gps_latlng_to_local(origin_lat, origin_lng, lat, lng, &x, &y);
+
+    // Radio de llegada según el error actual del fix
+    double radius = gps_get_quality().arrival_radius_m;
+    if (radius < ROUTE_SWITCH_RADIUS_M) radius = ROUTE_SWITCH_RADIUS_M;
+
+    // Cambiar de segmento al pasar el final o entrar en el radio del waypoint
+    while (segment < path_length - 2) {
+        double t = project_on_segment(segment, x, y);
+        double dist_end = hypot(path[segment + 1].east - x, path[segment + 1].north - y);
+
+        if (t < 1.0 && dist_end > radius) break;
+        segment++;
+    }
+
+    const route_vertex_t* last = &path[path_length - 1];
+    double dist_last = hypot(last->east - x, last->north - y);
+
+    // El último waypoint también se da por alcanzado al pasarlo, para no
+    // quedar girando a su alrededor cuando el GPS es impreciso
+    command->segment = segment;
+    command->finished = (segment == path_length - 2 &&
+                         (dist_last < radius || project_on_segment(segment, x, y) >= 1.0));
+
+    if (command->finished) {
+        active = false;
+        command->curvature = 0.0;
+        command->speed_scale = 0.0;
+        command->lookahead_bearing = heading;
+        command->distance_to_end = dist_last;
+        command->cross_track = 0.0;
+        return true;
+    }
+
+    // Punto proyectado sobre el segmento activo
+    double t = project_on_segment(segment, x, y);
+    if (t < 0.0) t = 0.0;
+    if (t > 1.0) t = 1.0;
+    projection_t = t;
+
+    double px = path[segment].east + t * (path[segment + 1].east - path[segment].east);
+    double py = path[segment].north + t * (path[segment + 1].north - path[segment].north);
+
+    // Error lateral: distancia con signo a la recta del segmento (derecha positiva)
+    double seg_dx = path[segment + 1].east - path[segment].east;
+    double seg_dy = path[segment + 1].north - path[segment].north;
+    double seg_length = hypot(seg_dx, seg_dy);
+    command->cross_track = (seg_length > 1e-3)
+        ? ((x - path[segment].east) * seg_dy - (y - path[segment].north) * seg_dx) / seg_length
+        : 0.0;
+
+    // Avanzar ROUTE_LOOKAHEAD_M sobre la trayectoria desde la proyección
+    double remaining = ROUTE_LOOKAHEAD_M;
+    double lx = last->east;
+    double ly = last->north;
+    double path_left = 0.0;
+    bool lookahead_found = false;
+
+    for (int i = segment; i < path_length - 1; i++) {
+        double ex = path[i + 1].east;
+        double ey = path[i + 1].north;
+        double d = hypot(ex - px, ey - py);
+
+        if (!lookahead_found) {
+            if (d >= remaining && d > 0.0) {
+                lx = px + (ex - px) * remaining / d;
+                ly = py + (ey - py) * remaining / d;
+                lookahead_found = true;
+            } else {
+                remaining -= d;
+            }
+        }
+
+        path_left += d;
+        px = ex;
+        py = ey;
+    }
+
+    // Curvatura del arco que une el robot con el punto de anticipación
+    double dx = lx - x;
+    double dy = ly - y;
+    double distance = hypot(dx, dy);
+
+    double bearing = atan2(dx, dy) * 180.0 / M_PI;
+    if (bearing < 0) {
+        bearing += 360;
+    }
+
+    double alpha = bearing - heading;
+    while (alpha > 180.0) alpha -= 360.0;
+    while (alpha < -180.0) alpha += 360.0;
+    alpha *= M_PI / 180.0;
+
+    if (distance < 0.1) distance = 0.1;
+
+    command->curvature = 2.0 * sin(alpha) / distance;
+    command->lookahead_bearing = bearing;
+    command->distance_to_end = path_left;
+    command->speed_scale = path[segment + 1].speed_limit / NOMINAL_SPEED_MPS;
+
+    return true;
+}
+
+bool route_preview(double spacing_m, int count, double* headings) {
+    if (!active || !headings || count <= 0) return false;
+
+    int index = segment;
+    double length = hypot(path[index + 1].east - path[index].east,
+                          path[index + 1].north - path[index].north);
+    double along = projection_t * length;  // Distancia recorrida en el segmento
+
+    for (int k = 0; k < count; k++) {
+        double target = along + k * spacing_m;
+
+        // Avanzar de segmento mientras la muestra quede más allá de su final
+        while (target > length && index < path_length - 2) {
+            target -= length;
+            along -= length;
+            index++;
+            length = hypot(path[index + 1].east - path[index].east,
+                           path[index + 1].north - path[index].north);
+        }
+
+        headings[k] = segment_heading(index);
+    }
+
+    return true;
+}
+
+void route_test(void) {
+    printf("=== PRUEBA RUTA (SIMULACIÓN) ===\n");
+
+    // Origen de referencia: campus Universidad de Antioquia
+    const double lat0 = 6.267300;
+    const double lng0 = -75.568800;
+    const double meters_per_deg = 6371000 * M_PI / 180.0;
+    const double cos_lat0 = cos(lat0 * M_PI / 180.0);
+
+    // Ruta en L: 30 m al norte (lento el segundo tramo) y 20 m al este
+    route_clear();
+    route_add_waypoint(lat0 + 15.0 / meters_per_deg, lng0, 0.0);
+    route_add_waypoint(lat0 + 30.0 / meters_per_deg, lng0, 0.3);
+    route_add_waypoint(lat0 + 30.0 / meters_per_deg, lng0 + 20.0 / (meters_per_deg * cos_lat0), 0.0);
+
+    printf("Waypoints cargados: %d\n", route_get_count());
+
+    // Robot simulado: arranca 2 m al oeste del origen mirando al noreste
+    double x = -2.0, y = 0.0, heading = 45.0;
+    double lat = lat0, lng = lng0 + x / (meters_per_deg * cos_lat0);
+    const double dt = LOOP_INTERVAL_MS / 1000.0;
+
+    route_start(lat, lng);
+
+    printf("Tiempo(s)\tE(m)\tN(m)\tRumbo\tSeg\tCurv\tRestante\n");
+
+    route_command_t cmd = {0};
+    int last_segment = -1;
+    int step;
+
+    for (step = 0; step < 4000; step++) {
+        lat = lat0 + y / meters_per_deg;
+        lng = lng0 + x / (meters_per_deg * cos_lat0);
+
+        if (!route_update(lat, lng, heading, &cmd)) break;
+        if (cmd.finished) break;
+
+        if (cmd.segment != last_segment) {
+            printf("-> Segmento %d\n", cmd.segment);
+            last_segment = cmd.segment;
+        }
+
+        // Modelo cinemático del robot diferencial
+        double v = NOMINAL_SPEED_MPS * cmd.speed_scale;
+        heading += v * cmd.curvature * dt * 180.0 / M_PI;
+        if (heading < 0) heading += 360;
+        if (heading >= 360) heading -= 360;
+        x += v * sin(heading * M_PI / 180.0) * dt;
+        y += v * cos(heading * M_PI / 180.0) * dt;
+
+        if (step % 40 == 0) {
+            printf("%.1f\t\t%.2f\t%.2f\t%.1f\t%d\t%.3f\t%.1f\n",
+                   step * dt, x, y, heading, cmd.segment, cmd.curvature, cmd.distance_to_end);
+        }
+    }
+
+    printf("Ruta %s en %.1f s - Posición final: E=%.2f N=%.2f\n",
+           cmd.finished ? "completada" : "NO completada", step * dt, x, y);
+    printf("Prueba de ruta completada\n");
+}
\ No newline at end of file
@@ -0,0 +1,196 @@
+/**
+ * @file route.h
+ * @brief Header del módulo de rutas con seguimiento pure pursuit.
+ *
+ * Define la lista de puntos de ruta (waypoints) de capacidad fija y las
+ * funciones para recorrerla calculando la curvatura hacia un punto de
+ * anticipación sobre la trayectoria.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef ROUTE_H
+#define ROUTE_H
+
+#include "pico/stdlib.h"
+#include "storage.h"
+#include <stdint.h>
+
+/// @defgroup ROUTE_STRUCTURES Estructuras de ruta
+/// @{
+
+/**
+ * @brief Punto de ruta con límite de velocidad propio.
+ */
+typedef struct {
+    double latitude;     ///< Latitud en grados decimales
+    double longitude;    ///< Longitud en grados decimales
+    double speed_limit;  ///< Velocidad máxima hacia este punto en m/s
+} route_waypoint_t;
+
+/**
+ * @brief Punto de ruta tal como se guarda en flash y se recibe por carga.
+ *
+ * Formato binario little-endian de 12 bytes por punto.
+ */
+typedef struct {
+    int32_t lat_e7;      ///< Latitud en 1e-7 grados
+    int32_t lng_e7;      ///< Longitud en 1e-7 grados
+    uint16_t speed_cms;  ///< Velocidad máxima en cm/s (0 = nominal)
+    uint16_t reserved;   ///< Reservado (0)
+} route_record_t;
+
+/**
+ * @brief Comando de movimiento calculado por el seguidor de ruta.
+ */
+typedef struct {
+    double curvature;          ///< Curvatura en 1/m (positiva = giro horario)
+    double speed_scale;        ///< Fracción de la velocidad base (0.0 - 1.0)
+    double lookahead_bearing;  ///< Rumbo al punto de anticipación (0-360)
+    double distance_to_end;    ///< Distancia restante sobre la ruta en metros
+    double cross_track;        ///< Distancia a la trayectoria en metros (positiva a la derecha)
+    int segment;               ///< Índice del waypoint hacia el que se avanza
+    bool finished;             ///< true si se alcanzó el último waypoint
+} route_command_t;
+
+/// @}
+
+/// @defgroup ROUTE_FUNCTIONS Funciones de ruta
+/// @{
+
+/**
+ * @brief Borra todos los puntos de la ruta y detiene su seguimiento.
+ */
+void route_clear(void);
+
+/**
+ * @brief Agrega un punto al final de la ruta.
+ *
+ * @param lat Latitud en grados decimales
+ * @param lng Longitud en grados decimales
+ * @param speed_limit Velocidad máxima en m/s (<= 0 usa NOMINAL_SPEED_MPS)
+ * @return true si había espacio y el punto es válido
+ */
+bool route_add_waypoint(double lat, double lng, double speed_limit);
+
+/**
+ * @brief Verifica que todos los puntos estén dentro de la geocerca activa.
+ *
+ * La geocerca puede haber cambiado después de cargar la ruta.
+ *
+ * @return true si ningún punto queda fuera de la geocerca
+ */
+bool route_within_fence(void);
+
+/**
+ * @brief Obtiene el número de puntos cargados.
+ *
+ * @return Número de waypoints en la ruta
+ */
+int route_get_count(void);
+
+/**
+ * @brief Obtiene un punto de la ruta.
+ *
+ * @param index Índice del punto (0 a route_get_count() - 1)
+ * @param[out] waypoint Punto leído
+ * @return true si el índice es válido
+ */
+bool route_get_waypoint(int index, route_waypoint_t* waypoint);
+
+/**
+ * @brief Guarda la ruta actual en flash.
+ *
+ * @return true si se guardó y verificó
+ */
+bool route_save(void);
+
+/**
+ * @brief Carga la ruta guardada en flash reemplazando la actual.
+ *
+ * Si algún punto no es válido o queda fuera de la geocerca la ruta actual
+ * no cambia. La geocerca debe estar cargada antes.
+ *
+ * @return true si había una ruta válida con al menos un punto
+ */
+bool route_load(void);
+
+/**
+ * @brief Valida una ruta recibida en otra región y la guarda como ruta.
+ *
+ * La ruta guardada y la actual solo se reemplazan si todos los puntos son
+ * válidos y están dentro de la geocerca.
+ *
+ * @param region Región con los registros recibidos
+ * @return true si la ruta era válida y se guardó
+ */
+bool route_install(storage_region_t region);
+
+/**
+ * @brief Inicia el seguimiento de la ruta desde la posición actual.
+ *
+ * La posición actual se usa como origen del primer segmento y del
+ * plano local en el que se calculan los segmentos.
+ *
+ * @param lat Latitud actual del robot
+ * @param lng Longitud actual del robot
+ * @return true si la ruta tiene al menos un punto
+ */
+bool route_start(double lat, double lng);
+
+/**
+ * @brief Detiene el seguimiento de la ruta sin borrar sus puntos.
+ */
+void route_stop(void);
+
+/**
+ * @brief Verifica si hay una ruta en seguimiento.
+ *
+ * @return true si la ruta está activa
+ */
+bool route_is_active(void);
+
+/**
+ * @brief Calcula el comando pure pursuit para la posición actual.
+ *
+ * Cambia de segmento automáticamente al pasar cada waypoint, busca el
+ * punto de anticipación a ROUTE_LOOKAHEAD_M sobre la trayectoria y
+ * calcula la curvatura del arco que lleva hasta él. Un waypoint se da por
+ * alcanzado dentro del radio de llegada del GPS (gps_get_quality()) o al
+ * pasarlo; la ruta termina igual en el último.
+ *
+ * @param lat Latitud actual
+ * @param lng Longitud actual
+ * @param heading Rumbo actual en grados (0-360)
+ * @param[out] command Comando calculado
+ * @return true si la ruta está activa y se calculó el comando
+ */
+bool route_update(double lat, double lng, double heading, route_command_t* command);
+
+/**
+ * @brief Obtiene el rumbo de la trayectoria por delante del robot.
+ *
+ * Muestrea el rumbo de los segmentos a distancias 0, spacing, 2 * spacing...
+ * desde la proyección del robot calculada en el último route_update().
+ * Pasado el final se repite el rumbo del último segmento.
+ *
+ * @param spacing_m Distancia entre muestras en metros
+ * @param count Número de muestras
+ * @param[out] headings Rumbos en grados (0-360)
+ * @return false si no hay una ruta activa
+ */
+bool route_preview(double spacing_m, int count, double* headings);
+
+/**
+ * @brief Función de prueba del seguidor de ruta.
+ *
+ * Simula un robot diferencial recorriendo una ruta en forma de L
+ * y muestra la posición y los cambios de segmento.
+ */
+void route_test(void);
+
+/// @}
+
+#endif // ROUTE_H
\ No newline at end of file
@@ -0,0 +1,221 @@
+/**
+ * @file schedule.c
+ * @brief Implementación de la programación de ganancias del rumbo.
+ *
+ * La tabla se ajustó con el simulador del vehículo (sim.c): lejos del
+ * objetivo la ganancia proporcional decide la rapidez del giro; cerca,
+ * el ruido del GPS se amplifica en el rumbo al objetivo (error angular
+ * proporcional a 1/distancia) y gana el amortiguamiento. La tabla no tiene
+ * eje de velocidad: la autoridad de giro de un diferencial no depende de
+ * ella y en el simulador ninguna fila por velocidad mejoró el rumbo.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "schedule.h"
+#include "sim.h"
+#include "config.h"
+#include "bluetooth.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+/// @brief Puntos de la tabla en distancia al objetivo (m)
+static const double distance_points[SCHED_DISTANCE_POINTS] = {3.0, 8.0, 15.0};
+
+/// @brief Ganancias por distancia: cerca / medio / lejos
+static const schedule_gains_t gain_table[SCHED_DISTANCE_POINTS] = {
+    {0.5, 0.00, 0.4}, {0.5, 0.03, 0.4}, {1.0, 0.05, 0.1},
+};
+
+/// @brief Controlador programado
+static pid_controller_t* scheduled_pid = NULL;
+static bool enabled = SCHED_DEFAULT_ENABLED;
+
+/**
+ * @brief Ubica un valor entre dos puntos de una tabla.
+ *
+ * @param points Puntos ordenados
+ * @param count Número de puntos
+ * @param value Valor a ubicar
+ * @param[out] fraction Posición entre el punto devuelto y el siguiente (0..1)
+ * @return Índice del punto inferior
+ */
+static int locate(const double* points, int count, double value, double* fraction) {
+    if (value <= points[0]) {
+        *fraction = 0.0;
+        return 0;
+    }
+    for (int i = 0; i < count - 1; i++) {
+        if (value < points[i + 1]) {
+            *fraction = (value - points[i]) / (points[i + 1] - points[i]);
+            return i;
+        }
+    }
+    *fraction = 1.0;
+    return count - 2;
+}
+
+schedule_gains_t schedule_gains(double distance_m) {
+    double fd;
+    int d = locate(distance_points, SCHED_DISTANCE_POINTS, distance_m, &fd);
+
+    const schedule_gains_t* g0 = &gain_table[d];
+    const schedule_gains_t* g1 = &gain_table[d + 1];
+
+    schedule_gains_t gains;
+    gains.kp = g0->kp + fd * (g1->kp - g0->kp);
+    gains.ki = g0->ki + fd * (g1->ki - g0->ki);
+    gains.kd = g0->kd + fd * (g1->kd - g0->kd);
+    return gains;
+}
+
+void schedule_init(pid_controller_t* pid) {
+    scheduled_pid = pid;
+}
+
+void schedule_update(double distance_m) {
+    if (!enabled || !scheduled_pid) return;
+
+    schedule_gains_t gains = schedule_gains(distance_m);
+    pid_tune(scheduled_pid, gains.kp, gains.ki, gains.kd);
+}
+
+void schedule_set_enabled(bool enable) {
+    if (enabled && !enable && scheduled_pid) {
+        pid_tune(scheduled_pid, KP_DIR, KI_DIR, KD_DIR);
+    }
+    enabled = enable;
+}
+
+bool schedule_is_enabled(void) {
+    return enabled;
+}
+
+bool schedule_handle_command(const char* line) {
+    if (!line) return false;
+
+    if (strcmp(line, "SCHED,ON") == 0) {
+        schedule_set_enabled(true);
+    } else if (strcmp(line, "SCHED,OFF") == 0) {
+        schedule_set_enabled(false);
+    } else if (strcmp(line, "SCHED?") != 0) {
+        return false;
+    }
+
+    char reply[64];
+    snprintf(reply, sizeof(reply), "SCHED,%s,%.3f,%.3f,%.3f\n", enabled ? "ON" : "OFF",
+             scheduled_pid ? scheduled_pid->kp : 0.0,
+             scheduled_pid ? scheduled_pid->ki : 0.0,
+             scheduled_pid ? scheduled_pid->kd : 0.0);
+    bluetooth_send_string(reply);
+    return true;
+}
+
+/**
+ * @brief Resultado de un recorrido simulado.
+ */
+typedef struct {
+    double heading_rms;   ///< Error de rumbo RMS respecto al objetivo real (°)
+    double near_rms;      ///< Error de rumbo RMS en los últimos 8 m (°)
+    double activity;      ///< Variación total de la corrección por segundo
+    double time_s;        ///< Tiempo hasta alcanzar el objetivo
+} drive_result_t;
+
+/**
+ * @brief Recorre 30 m hasta un objetivo con el simulador del vehículo.
+ *
+ * El robot arranca mirando a 90° del objetivo y navega con el rumbo
+ * calculado desde el GPS simulado, igual que el bucle principal.
+ */
+static drive_result_t simulate_drive(double speed_scale, bool scheduled, uint32_t seed) {
+    const double dt = LOOP_INTERVAL_MS / 1000.0;
+    const double target_east = 0.0, target_north = 30.0;
+    drive_result_t result = {0};
+
+    sim_vehicle_t vehicle;
+    sim_init(&vehicle, 0.0, 0.0, (seed % 2) ? 90.0 : 270.0, seed);
+
+    pid_controller_t pid;
+    pid_init_angular(&pid, KP_DIR, KI_DIR, KD_DIR, -50.0, 50.0);
+    pid_set_derivative_filter(&pid, PID_DIR_D_FILTER_TAU);
+    schedule_init(&pid);
+    schedule_set_enabled(scheduled);
+
+    double last_output = 0.0;
+    int samples = 0, near_samples = 0;
+    int step;
+
+    for (step = 0; step < 6000; step++) {
+        double distance = sim_gps_distance_to(&vehicle, target_east, target_north);
+        if (distance < 2.0) break;
+
+        schedule_update(distance);
+        pid_set_setpoint(&pid, sim_gps_bearing_to(&vehicle, target_east, target_north));
+        double output = pid_compute_dt(&pid, vehicle.compass, dt);
+
+        if (step > 0) result.activity += fabs(output - last_output);
+        last_output = output;
+
+        int pwm_a = (int)(BASE_SPEED_A * speed_scale - output);
+        int pwm_b = (int)(BASE_SPEED_B * speed_scale + output);
+        pwm_a = (pwm_a < MIN_SPEED) ? MIN_SPEED : (pwm_a > MAX_SPEED) ? MAX_SPEED : pwm_a;
+        pwm_b = (pwm_b < MIN_SPEED) ? MIN_SPEED : (pwm_b > MAX_SPEED) ? MAX_SPEED : pwm_b;
+        sim_step(&vehicle, pwm_a, pwm_b, dt);
+
+        // Error respecto al rumbo real hacia el objetivo
+        double true_bearing = atan2(target_east - vehicle.east,
+                                    target_north - vehicle.north) * 180.0 / M_PI;
+        double error = pid_heading_error(true_bearing, vehicle.heading);
+        result.heading_rms += error * error;
+        samples++;
+
+        if (hypot(target_east - vehicle.east, target_north - vehicle.north) < 8.0) {
+            result.near_rms += error * error;
+            near_samples++;
+        }
+    }
+
+    result.heading_rms = sqrt(result.heading_rms / (samples ? samples : 1));
+    result.near_rms = sqrt(result.near_rms / (near_samples ? near_samples : 1));
+    result.time_s = step * dt;
+    result.activity /= result.time_s;
+    return result;
+}
+
+void schedule_test(void) {
+    printf("=== PRUEBA PROGRAMACIÓN DE GANANCIAS (SIMULACIÓN) ===\n");
+    printf("Recorrido de 30 m arrancando a 90° del objetivo, GPS a 1 Hz (%.1f m)\n",
+           SIM_GPS_NOISE_M);
+    printf("Media de 6 recorridos por caso\n");
+    printf("Veloc.\t\tGanancias\tRumbo RMS\tÚltimos 8 m\tActividad\tTiempo\n");
+
+    const double scales[] = {0.4, 1.0, 1.35};
+    const int runs = 6;
+    bool was_enabled = enabled;
+
+    for (int i = 0; i < 3; i++) {
+        for (int mode = 0; mode < 2; mode++) {
+            drive_result_t sum = {0};
+
+            for (int r = 0; r < runs; r++) {
+                drive_result_t result = simulate_drive(scales[i], mode == 1, r + 1);
+                sum.heading_rms += result.heading_rms / runs;
+                sum.near_rms += result.near_rms / runs;
+                sum.activity += result.activity / runs;
+                sum.time_s += result.time_s / runs;
+            }
+
+            printf("%.2f m/s\t%s\t%.1f°\t\t%.1f°\t\t%.0f /s\t\t%.1f s\n",
+                   sim_pwm_to_speed((int)(BASE_SPEED_A * scales[i]), BASE_SPEED_A),
+                   mode ? "programadas" : "fijas\t", sum.heading_rms, sum.near_rms,
+                   sum.activity, sum.time_s);
+        }
+    }
+
+    schedule_init(NULL);
+    enabled = was_enabled;
+    printf("Prueba de programación de ganancias completada\n");
+}
\ No newline at end of file
@@ -0,0 +1,104 @@
+/**
+ * @file schedule.h
+ * @brief Header de la programación de ganancias del control de rumbo.
+ *
+ * Ajusta las ganancias del PID de rumbo en cada ciclo según la distancia
+ * al objetivo, interpolando en una tabla. Cerca
+ * del objetivo el rumbo calculado con el GPS es más ruidoso y conviene
+ * menos ganancia proporcional y más amortiguamiento; lejos, giros rápidos.
+ * Los cambios se aplican con pid_tune(), que no produce saltos en la salida.
+ *
+ * Comandos (App -> Robot):
+ * - "SCHED,ON" / "SCHED,OFF": activa o desactiva la programación
+ *   (al desactivarla se restauran KP_DIR, KI_DIR y KD_DIR)
+ * - "SCHED?": responde "SCHED,<ON|OFF>,<kp>,<ki>,<kd>" con las ganancias actuales
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+#include "pico/stdlib.h"
+#include "pid.h"
+
+/// @defgroup SCHEDULE_STRUCTURES Estructuras de la programación de ganancias
+/// @{
+
+/**
+ * @brief Juego de ganancias PID.
+ */
+typedef struct {
+    double kp;  ///< Ganancia proporcional
+    double ki;  ///< Ganancia integral
+    double kd;  ///< Ganancia derivativa
+} schedule_gains_t;
+
+/// @}
+
+/// @defgroup SCHEDULE_FUNCTIONS Funciones de la programación de ganancias
+/// @{
+
+/**
+ * @brief Asocia el controlador de rumbo a la programación de ganancias.
+ *
+ * @param pid Controlador de rumbo
+ */
+void schedule_init(pid_controller_t* pid);
+
+/**
+ * @brief Calcula las ganancias para una distancia al objetivo.
+ *
+ * Interpolación lineal en la tabla; fuera de ella se usa el borde.
+ *
+ * @param distance_m Distancia al objetivo en metros
+ * @return Ganancias interpoladas
+ */
+schedule_gains_t schedule_gains(double distance_m);
+
+/**
+ * @brief Aplica al controlador las ganancias del punto de operación actual.
+ *
+ * No hace nada si la programación está desactivada.
+ *
+ * @param distance_m Distancia al objetivo en metros
+ */
+void schedule_update(double distance_m);
+
+/**
+ * @brief Activa o desactiva la programación de ganancias.
+ *
+ * Al desactivarla se restauran las ganancias fijas KP_DIR, KI_DIR y KD_DIR.
+ *
+ * @param enabled true para activarla
+ */
+void schedule_set_enabled(bool enabled);
+
+/**
+ * @brief Verifica si la programación de ganancias está activa.
+ *
+ * @return true si está activa
+ */
+bool schedule_is_enabled(void);
+
+/**
+ * @brief Procesa los comandos SCHED.
+ *
+ * @param line Línea recibida por Bluetooth
+ * @return true si la línea era un comando de programación de ganancias
+ */
+bool schedule_handle_command(const char* line);
+
+/**
+ * @brief Función de prueba de la programación de ganancias.
+ *
+ * Simula recorridos hacia un objetivo a distintas velocidades con el
+ * simulador del vehículo y compara ganancias fijas con programadas.
+ */
+void schedule_test(void);
+
+/// @}
+
+#endif // SCHEDULE_H
\ No newline at end of file
@@ -0,0 +1,40 @@
+/**
+ * @file adc.h
+ * @brief ADC del SDK: conversiones con las tensiones del modelo del vehículo.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef SIL_HARDWARE_ADC_H
+#define SIL_HARDWARE_ADC_H
+
+#include "pico.h"
+
+/**
+ * @brief Registros del ADC que el firmware usa como destino u origen del DMA.
+ */
+typedef struct {
+    volatile uint32_t cs;    ///< Control (START_ONCE dispara una conversión)
+    volatile uint32_t fifo;  ///< Último resultado
+} adc_hw_t;
+
+extern adc_hw_t* const adc_hw;
+
+#define ADC_CS_START_ONCE_BITS 0x00000004u
+
+/// @brief DREQ del FIFO del ADC
+#define DREQ_ADC 36
+
+/// @brief Alias de escritura "set" de un registro (en el SIL, el mismo registro)
+#define hw_set_alias(addr) (addr)
+
+void adc_init(void);
+void adc_gpio_init(uint gpio);
+void adc_select_input(uint input);
+void adc_set_round_robin(uint input_mask);
+void adc_fifo_setup(bool en, bool dreq_en, uint16_t dreq_thresh, bool err_in_fifo, bool byte_shift);
+void adc_fifo_drain(void);
+
+#endif // SIL_HARDWARE_ADC_H
\ No newline at end of file
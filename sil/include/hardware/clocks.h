@@ -0,0 +1,27 @@
+/**
+ * @file clocks.h
+ * @brief Relojes del SDK (sistema a 125 MHz).
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef SIL_HARDWARE_CLOCKS_H
+#define SIL_HARDWARE_CLOCKS_H
+
+#include "pico.h"
+
+enum clock_index {
+    clk_gpout0 = 0,
+    clk_ref = 4,
+    clk_sys = 5,
+    clk_peri = 6,
+    clk_usb = 7,
+    clk_adc = 8,
+    clk_rtc = 9
+};
+
+uint32_t clock_get_hz(enum clock_index clk_index);
+
+#endif // SIL_HARDWARE_CLOCKS_H
\ No newline at end of file
@@ -0,0 +1,60 @@
+/**
+ * @file dma.h
+ * @brief DMA del SDK: canales que el SIL ejecuta al llegar su DREQ.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef SIL_HARDWARE_DMA_H
+#define SIL_HARDWARE_DMA_H
+
+#include "pico.h"
+
+/// @brief Canales del RP2040
+#define NUM_DMA_CHANNELS 12
+
+enum dma_channel_transfer_size {
+    DMA_SIZE_8 = 0,
+    DMA_SIZE_16 = 1,
+    DMA_SIZE_32 = 2
+};
+
+/**
+ * @brief Configuración de un canal.
+ */
+typedef struct {
+    enum dma_channel_transfer_size size; ///< Tamaño de cada transferencia
+    bool read_increment;                 ///< Avanzar la dirección de lectura
+    bool write_increment;                ///< Avanzar la dirección de escritura
+    bool ring_write;                     ///< El anillo se aplica a la escritura
+    uint ring_bits;                      ///< log2 del tamaño del anillo (0 = sin anillo)
+    uint dreq;                           ///< Señal que pide cada transferencia
+} dma_channel_config;
+
+/**
+ * @brief Registros de un canal (direcciones del ancho del host).
+ */
+typedef struct {
+    volatile uintptr_t read_addr;
+    volatile uintptr_t write_addr;
+    volatile uint32_t transfer_count;
+    volatile uint32_t ctrl_trig;
+} dma_channel_hw_t;
+
+int dma_claim_unused_channel(bool required);
+void dma_channel_unclaim(uint channel);
+dma_channel_config dma_channel_get_default_config(uint channel);
+void channel_config_set_transfer_data_size(dma_channel_config* c, enum dma_channel_transfer_size size);
+void channel_config_set_read_increment(dma_channel_config* c, bool incr);
+void channel_config_set_write_increment(dma_channel_config* c, bool incr);
+void channel_config_set_ring(dma_channel_config* c, bool write, uint size_bits);
+void channel_config_set_dreq(dma_channel_config* c, uint dreq);
+void dma_channel_configure(uint channel, const dma_channel_config* config, volatile void* write_addr,
+                           const volatile void* read_addr, uint transfer_count, bool trigger);
+void dma_channel_set_trans_count(uint channel, uint32_t trans_count, bool trigger);
+bool dma_channel_is_busy(uint channel);
+dma_channel_hw_t* dma_channel_hw_addr(uint channel);
+
+#endif // SIL_HARDWARE_DMA_H
\ No newline at end of file
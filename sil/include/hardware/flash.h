@@ -0,0 +1,21 @@
+/**
+ * @file flash.h
+ * @brief Flash del SDK sobre el archivo mapeado en sil_flash.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef SIL_HARDWARE_FLASH_H
+#define SIL_HARDWARE_FLASH_H
+
+#include "pico.h"
+
+#define FLASH_PAGE_SIZE (1u << 8)
+#define FLASH_SECTOR_SIZE (1u << 12)
+
+void flash_range_erase(uint32_t flash_offs, size_t count);
+void flash_range_program(uint32_t flash_offs, const uint8_t* data, size_t count);
+
+#endif // SIL_HARDWARE_FLASH_H
\ No newline at end of file
@@ -0,0 +1,53 @@
+/**
+ * @file gpio.h
+ * @brief GPIO del SDK sobre el modelo de pines del SIL (sil_hal.c).
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef SIL_HARDWARE_GPIO_H
+#define SIL_HARDWARE_GPIO_H
+
+#include "pico.h"
+
+/// @brief Pines del RP2040
+#define NUM_BANK0_GPIOS 30
+
+#define GPIO_OUT 1
+#define GPIO_IN 0
+
+enum gpio_function {
+    GPIO_FUNC_SPI = 1,
+    GPIO_FUNC_UART = 2,
+    GPIO_FUNC_I2C = 3,
+    GPIO_FUNC_PWM = 4,
+    GPIO_FUNC_SIO = 5,
+    GPIO_FUNC_NULL = 0x1f,
+};
+
+enum gpio_irq_level {
+    GPIO_IRQ_LEVEL_LOW = 0x1u,
+    GPIO_IRQ_LEVEL_HIGH = 0x2u,
+    GPIO_IRQ_EDGE_FALL = 0x4u,
+    GPIO_IRQ_EDGE_RISE = 0x8u,
+};
+
+typedef void (*gpio_irq_callback_t)(uint gpio, uint32_t event_mask);
+
+void gpio_init(uint gpio);
+void gpio_set_dir(uint gpio, bool out);
+void gpio_put(uint gpio, bool value);
+bool gpio_get(uint gpio);
+void gpio_set_function(uint gpio, enum gpio_function fn);
+void gpio_pull_up(uint gpio);
+void gpio_pull_down(uint gpio);
+void gpio_set_irq_enabled(uint gpio, uint32_t event_mask, bool enabled);
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled,
+                                        gpio_irq_callback_t callback);
+void gpio_add_raw_irq_handler(uint gpio, void (*handler)(void));
+uint32_t gpio_get_irq_event_mask(uint gpio);
+void gpio_acknowledge_irq(uint gpio, uint32_t event_mask);
+
+#endif // SIL_HARDWARE_GPIO_H
\ No newline at end of file
@@ -0,0 +1,26 @@
+/**
+ * @file i2c.h
+ * @brief I2C del SDK con el QMC5883L simulado (sil_vehicle.c).
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef SIL_HARDWARE_I2C_H
+#define SIL_HARDWARE_I2C_H
+
+#include "pico.h"
+
+typedef struct i2c_inst i2c_inst_t;
+
+extern i2c_inst_t* const sil_i2c0;
+extern i2c_inst_t* const sil_i2c1;
+#define i2c0 sil_i2c0
+#define i2c1 sil_i2c1
+
+uint i2c_init(i2c_inst_t* i2c, uint baudrate);
+int i2c_write_blocking(i2c_inst_t* i2c, uint8_t addr, const uint8_t* src, size_t len, bool nostop);
+int i2c_read_blocking(i2c_inst_t* i2c, uint8_t addr, uint8_t* dst, size_t len, bool nostop);
+
+#endif // SIL_HARDWARE_I2C_H
\ No newline at end of file
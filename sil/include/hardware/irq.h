@@ -0,0 +1,28 @@
+/**
+ * @file irq.h
+ * @brief Interrupciones del SDK: manejadores llamados desde sil_poll().
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef SIL_HARDWARE_IRQ_H
+#define SIL_HARDWARE_IRQ_H
+
+#include "pico.h"
+
+typedef void (*irq_handler_t)(void);
+
+/// @brief Números de interrupción usados por el firmware
+#define IO_IRQ_BANK0 13
+#define PICO_DEFAULT_IRQ_PRIORITY 0x80
+
+/// @brief Interrupciones del RP2040
+#define NUM_IRQS 32
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler);
+void irq_set_enabled(uint num, bool enabled);
+void irq_set_priority(uint num, uint8_t hardware_priority);
+
+#endif // SIL_HARDWARE_IRQ_H
\ No newline at end of file
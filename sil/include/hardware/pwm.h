@@ -0,0 +1,47 @@
+/**
+ * @file pwm.h
+ * @brief PWM del SDK: guarda el nivel de cada pin para el modelo de motores.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef SIL_HARDWARE_PWM_H
+#define SIL_HARDWARE_PWM_H
+
+#include "pico.h"
+
+/**
+ * @brief Configuración de un slice.
+ */
+typedef struct {
+    float clkdiv;        ///< Divisor del reloj del sistema
+    uint16_t wrap;       ///< Valor máximo del contador
+    bool phase_correct;  ///< Cuenta hacia arriba y hacia abajo
+} pwm_config;
+
+/// @brief Primer DREQ de fin de ciclo del PWM (uno por slice)
+#define DREQ_PWM_WRAP0 24
+
+pwm_config pwm_get_default_config(void);
+void pwm_config_set_clkdiv(pwm_config* c, float div);
+void pwm_config_set_wrap(pwm_config* c, uint16_t wrap);
+void pwm_config_set_phase_correct(pwm_config* c, bool phase_correct);
+void pwm_init(uint slice_num, pwm_config* c, bool start);
+void pwm_set_enabled(uint slice_num, bool enabled);
+void pwm_set_gpio_level(uint gpio, uint16_t level);
+
+static inline uint pwm_gpio_to_slice_num(uint gpio) {
+    return (gpio >> 1u) & 7u;
+}
+
+static inline uint pwm_gpio_to_channel(uint gpio) {
+    return gpio & 1u;
+}
+
+static inline uint pwm_get_dreq(uint slice_num) {
+    return DREQ_PWM_WRAP0 + slice_num;
+}
+
+#endif // SIL_HARDWARE_PWM_H
\ No newline at end of file
@@ -0,0 +1,48 @@
+/**
+ * @file sync.h
+ * @brief Sincronización del SDK: un solo hilo, las interrupciones se posponen.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef SIL_HARDWARE_SYNC_H
+#define SIL_HARDWARE_SYNC_H
+
+#include "pico.h"
+
+/**
+ * @brief Deshabilita las interrupciones simuladas (sil_poll() no las atiende).
+ *
+ * @return Estado anterior para restore_interrupts()
+ */
+uint32_t save_and_disable_interrupts(void);
+void restore_interrupts(uint32_t status);
+
+typedef volatile uint32_t spin_lock_t;
+
+/// @brief Spinlocks del RP2040
+#define NUM_SPIN_LOCKS 32
+
+spin_lock_t* spin_lock_instance(uint lock_num);
+int spin_lock_claim_unused(bool required);
+void spin_lock_unclaim(uint lock_num);
+uint32_t spin_lock_blocking(spin_lock_t* lock);
+void spin_unlock(spin_lock_t* lock, uint32_t saved_irq);
+
+static inline uint spin_lock_get_num(spin_lock_t* lock) {
+    return (uint)(lock - spin_lock_instance(0));
+}
+
+static inline void __dmb(void) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+static inline void __sev(void) {
+}
+
+static inline void __wfe(void) {
+}
+
+#endif // SIL_HARDWARE_SYNC_H
\ No newline at end of file
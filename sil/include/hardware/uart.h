@@ -0,0 +1,45 @@
+/**
+ * @file uart.h
+ * @brief UART del SDK sobre pseudoterminales de Linux (sil_uart.c).
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef SIL_HARDWARE_UART_H
+#define SIL_HARDWARE_UART_H
+
+#include "pico.h"
+
+typedef struct uart_inst uart_inst_t;
+
+extern uart_inst_t* const sil_uart0;
+extern uart_inst_t* const sil_uart1;
+#define uart0 sil_uart0
+#define uart1 sil_uart1
+
+typedef enum {
+    UART_PARITY_NONE,
+    UART_PARITY_EVEN,
+    UART_PARITY_ODD
+} uart_parity_t;
+
+/// @brief Números de interrupción (irq.h)
+#define UART0_IRQ 20
+#define UART1_IRQ 21
+
+uint uart_init(uart_inst_t* uart, uint baudrate);
+uint uart_set_baudrate(uart_inst_t* uart, uint baudrate);
+void uart_set_format(uart_inst_t* uart, uint data_bits, uint stop_bits, uart_parity_t parity);
+void uart_set_hw_flow(uart_inst_t* uart, bool cts, bool rts);
+void uart_set_fifo_enabled(uart_inst_t* uart, bool enabled);
+void uart_set_irq_enables(uart_inst_t* uart, bool rx_has_data, bool tx_needs_data);
+uint uart_get_index(uart_inst_t* uart);
+bool uart_is_readable(uart_inst_t* uart);
+char uart_getc(uart_inst_t* uart);
+void uart_putc_raw(uart_inst_t* uart, char c);
+void uart_puts(uart_inst_t* uart, const char* s);
+void uart_write_blocking(uart_inst_t* uart, const uint8_t* src, size_t len);
+
+#endif // SIL_HARDWARE_UART_H
\ No newline at end of file
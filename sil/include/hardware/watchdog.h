@@ -0,0 +1,21 @@
+/**
+ * @file watchdog.h
+ * @brief Watchdog del SDK: al vencer, el SIL se reinicia con exec().
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef SIL_HARDWARE_WATCHDOG_H
+#define SIL_HARDWARE_WATCHDOG_H
+
+#include "pico.h"
+
+void watchdog_enable(uint32_t delay_ms, bool pause_on_debug);
+void watchdog_update(void);
+void watchdog_reboot(uint32_t pc, uint32_t sp, uint32_t delay_ms);
+bool watchdog_caused_reboot(void);
+bool watchdog_enable_caused_reboot(void);
+
+#endif // SIL_HARDWARE_WATCHDOG_H
\ No newline at end of file
@@ -0,0 +1,58 @@
+/**
+ * @file pico.h
+ * @brief Definiciones base del SDK de la Pico para la compilación SIL.
+ *
+ * Solo lo que usa el firmware: tipos, códigos de error, atributos de
+ * sección y el mapa de la flash, que en el SIL es un archivo mapeado en
+ * memoria (sil_hal.c). Las variables __uninitialized_ram van a una sección
+ * propia que sil_hal.c conserva a través de los reinicios del watchdog.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef SIL_PICO_H
+#define SIL_PICO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+typedef unsigned int uint;
+
+/// @brief Códigos de error del SDK
+enum pico_error_codes {
+    PICO_OK = 0,
+    PICO_ERROR_NONE = 0,
+    PICO_ERROR_GENERIC = -1,
+    PICO_ERROR_TIMEOUT = -2,
+    PICO_ERROR_NO_DATA = -3,
+};
+
+#define count_of(a) (sizeof(a) / sizeof((a)[0]))
+
+#ifndef MIN
+#define MIN(a, b) ((b) > (a) ? (a) : (b))
+#endif
+#ifndef MAX
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#endif
+
+/// @brief Atributos de ubicación del enlazador del SDK (sin efecto en el host)
+#define __not_in_flash_func(name) name
+#define __time_critical_func(name) name
+#define __no_inline_not_in_flash_func(name) name
+
+/// @brief RAM que sobrevive al reinicio (sección copiada entre exec())
+#define __uninitialized_ram(name) __attribute__((section("sil_noinit"))) name
+
+/// @brief Flash de la Pico (W25Q16JV)
+#define PICO_FLASH_SIZE_BYTES (2 * 1024 * 1024)
+
+/// @brief Inicio de la flash mapeada (archivo o memoria anónima)
+extern uint8_t* sil_flash;
+#define XIP_BASE ((uintptr_t)sil_flash)
+
+#endif // SIL_PICO_H
\ No newline at end of file
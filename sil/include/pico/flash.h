@@ -0,0 +1,18 @@
+/**
+ * @file flash.h
+ * @brief pico/flash.h de la compilación SIL (un solo núcleo, sin XIP que detener).
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef SIL_PICO_FLASH_H
+#define SIL_PICO_FLASH_H
+
+#include "pico.h"
+
+int flash_safe_execute(void (*func)(void*), void* param, uint32_t enter_exit_timeout_ms);
+bool flash_safe_execute_core_init(void);
+
+#endif // SIL_PICO_FLASH_H
\ No newline at end of file
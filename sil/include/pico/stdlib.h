@@ -0,0 +1,25 @@
+/**
+ * @file stdlib.h
+ * @brief pico/stdlib.h de la compilación SIL.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef SIL_PICO_STDLIB_H
+#define SIL_PICO_STDLIB_H
+
+#include "pico.h"
+#include "pico/time.h"
+#include "hardware/gpio.h"
+#include "hardware/uart.h"
+#include <stdio.h>
+
+/// @brief La salida estándar es la del proceso (consola donde corre el SIL)
+bool stdio_init_all(void);
+
+/// @brief Punto de espera activa: atiende las interrupciones simuladas
+void tight_loop_contents(void);
+
+#endif // SIL_PICO_STDLIB_H
\ No newline at end of file
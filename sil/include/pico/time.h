@@ -0,0 +1,85 @@
+/**
+ * @file time.h
+ * @brief Tiempo y temporizadores del SDK sobre el reloj monotónico del host.
+ *
+ * Las esperas atienden las interrupciones simuladas (sil_poll()), igual
+ * que en la Pico las interrupciones corren mientras main() duerme.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef SIL_PICO_TIME_H
+#define SIL_PICO_TIME_H
+
+#include "pico.h"
+
+typedef uint64_t absolute_time_t;
+
+uint64_t time_us_64(void);
+uint32_t time_us_32(void);
+
+static inline absolute_time_t get_absolute_time(void) {
+    return time_us_64();
+}
+
+static inline uint32_t to_ms_since_boot(absolute_time_t t) {
+    return (uint32_t)(t / 1000);
+}
+
+static inline uint64_t to_us_since_boot(absolute_time_t t) {
+    return t;
+}
+
+static inline absolute_time_t delayed_by_us(absolute_time_t t, uint64_t us) {
+    return t + us;
+}
+
+static inline absolute_time_t delayed_by_ms(absolute_time_t t, uint32_t ms) {
+    return t + (uint64_t)ms * 1000;
+}
+
+static inline absolute_time_t make_timeout_time_us(uint64_t us) {
+    return time_us_64() + us;
+}
+
+static inline absolute_time_t make_timeout_time_ms(uint32_t ms) {
+    return time_us_64() + (uint64_t)ms * 1000;
+}
+
+static inline int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to) {
+    return (int64_t)(to - from);
+}
+
+static inline bool time_reached(absolute_time_t t) {
+    return time_us_64() >= t;
+}
+
+void sleep_until(absolute_time_t t);
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+void busy_wait_us(uint64_t us);
+void busy_wait_ms(uint32_t ms);
+
+typedef struct repeating_timer repeating_timer_t;
+typedef bool (*repeating_timer_callback_t)(repeating_timer_t* rt);
+
+/**
+ * @brief Temporizador repetitivo (atendido en sil_poll()).
+ */
+struct repeating_timer {
+    int64_t delay_us;                    ///< Periodo (negativo: desde el inicio de la llamada)
+    repeating_timer_callback_t callback; ///< Función llamada en cada vencimiento
+    void* user_data;                     ///< Dato del usuario
+    uint64_t next_us;                    ///< Próximo vencimiento
+    struct repeating_timer* next;        ///< Siguiente temporizador activo
+};
+
+bool add_repeating_timer_us(int64_t delay_us, repeating_timer_callback_t callback,
+                            void* user_data, repeating_timer_t* out);
+bool add_repeating_timer_ms(int32_t delay_ms, repeating_timer_callback_t callback,
+                            void* user_data, repeating_timer_t* out);
+bool cancel_repeating_timer(repeating_timer_t* timer);
+
+#endif // SIL_PICO_TIME_H
\ No newline at end of file
@@ -0,0 +1,171 @@
+/**
+ * @file sil.h
+ * @brief Header interno de la compilación software-in-the-loop (SIL).
+ *
+ * El firmware se compila sin cambios para Linux contra los headers de
+ * sil/include. sil_hal.c implementa el SDK (tiempo, interrupciones, GPIO,
+ * PWM, ADC, DMA, flash, watchdog), sil_uart.c convierte las UART en
+ * pseudoterminales y sil_vehicle.c conecta motores, encoders, brújula,
+ * ADC y GPS con el simulador de sim.c.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef SIL_H
+#define SIL_H
+
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+#include <stdint.h>
+
+/// @defgroup SIL_STRUCTURES Estructuras del SIL
+/// @{
+
+/**
+ * @brief Opciones de la línea de comandos.
+ */
+typedef struct {
+    const char* bt_link;       ///< Enlace simbólico del pty del Bluetooth
+    const char* gps_link;      ///< Enlace simbólico del pty del GPS
+    const char* flash_path;    ///< Archivo de la flash (NULL = memoria, se pierde al salir)
+    bool gps_sim;              ///< GPS generado por el simulador (si no, NMEA por el pty)
+    double origin_lat;         ///< Latitud del origen del plano local del simulador
+    double origin_lng;         ///< Longitud del origen del plano local del simulador
+    double heading;            ///< Rumbo inicial del vehículo en grados
+    uint32_t seed;             ///< Semilla del ruido del simulador
+    uint32_t bt_module_baud;   ///< Velocidad configurada en el HC-05 simulado
+    double compass_bias_deg;   ///< Desvío de montaje de la brújula simulada en grados
+} sil_options_t;
+
+/// @}
+
+/// @defgroup SIL_FUNCTIONS Funciones internas del SIL
+/// @{
+
+/// @brief Opciones en uso (sil_main.c)
+extern sil_options_t sil_options;
+
+/**
+ * @brief Atiende los dispositivos y las interrupciones simuladas.
+ *
+ * Se llama desde las esperas y las lecturas del SDK. No hace nada con las
+ * interrupciones deshabilitadas ni dentro de un manejador.
+ */
+void sil_poll(void);
+
+/**
+ * @brief Espera hasta que haya datos en algún pty o venza el plazo.
+ *
+ * @param timeout_us Plazo máximo en microsegundos
+ */
+void sil_wait(uint64_t timeout_us);
+
+/**
+ * @brief Prepara la flash, la RAM conservada y el estado tras un reinicio.
+ *
+ * @param argv Argumentos de main() (se repiten en el exec() del reinicio)
+ */
+void sil_hal_init(char** argv);
+
+/**
+ * @brief Reinicia el proceso como lo haría el watchdog (no retorna).
+ */
+void sil_reboot(void);
+
+/**
+ * @brief Nivel de un pin de salida.
+ */
+bool sil_gpio_level(uint gpio);
+
+/**
+ * @brief Señala flancos en un pin de entrada (interrupción si está habilitada).
+ *
+ * @param gpio Pin
+ * @param events Máscara de GPIO_IRQ_EDGE_* ocurridos
+ */
+void sil_gpio_event(uint gpio, uint32_t events);
+
+/**
+ * @brief Nivel del PWM de un pin (0 a wrap del slice).
+ */
+uint16_t sil_pwm_level(uint gpio);
+
+/**
+ * @brief Crea los pty de las UART y los enlaces simbólicos.
+ *
+ * @return true si se crearon
+ */
+bool sil_uart_init(void);
+
+/**
+ * @brief Deja los pty en el entorno para que los herede el reinicio.
+ */
+void sil_uart_export(void);
+
+/**
+ * @brief Lee los pty y levanta las interrupciones de recepción.
+ */
+void sil_uart_poll(void);
+
+/**
+ * @brief Descriptores de los pty (para sil_wait()).
+ *
+ * @param[out] fds Descriptores (-1 si no hay)
+ * @param max Capacidad de fds
+ * @return Cantidad escrita
+ */
+int sil_uart_fds(int* fds, int max);
+
+/**
+ * @brief Encola bytes como si llegaran por la UART.
+ *
+ * @param uart UART
+ * @param data Bytes
+ * @param length Cantidad
+ */
+void sil_uart_inject(uart_inst_t* uart, const char* data, size_t length);
+
+/**
+ * @brief Indica si la interrupción de recepción de una UART está pendiente.
+ */
+bool sil_uart_irq_pending(uint index);
+
+/**
+ * @brief Inicializa el vehículo simulado.
+ */
+void sil_vehicle_init(void);
+
+/**
+ * @brief Avanza el vehículo hasta el instante actual (encoders, PPS, NMEA).
+ *
+ * @param now_us Tiempo desde el arranque en microsegundos
+ */
+void sil_vehicle_poll(uint64_t now_us);
+
+/**
+ * @brief Instante del próximo flanco que genera el vehículo (PPS).
+ *
+ * @return Tiempo desde el arranque en microsegundos (UINT64_MAX si no hay)
+ */
+uint64_t sil_vehicle_next_event_us(void);
+
+/**
+ * @brief Tensión en una entrada del ADC.
+ *
+ * @param input Entrada (0-4)
+ * @return Tensión en voltios
+ */
+double sil_vehicle_adc_volts(uint input);
+
+/**
+ * @brief Transacción I2C con los dispositivos simulados.
+ *
+ * @return Bytes transferidos o PICO_ERROR_GENERIC si nadie responde
+ */
+int sil_vehicle_i2c(uint8_t addr, const uint8_t* src, uint8_t* dst, size_t length);
+
+/// @}
+
+#endif // SIL_H
\ No newline at end of file
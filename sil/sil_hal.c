@@ -0,0 +1,937 @@
+/**
+ * @file sil_hal.c
+ * @brief SDK de la Pico sobre Linux para la compilación SIL.
+ *
+ * Todo corre en un solo hilo. Las interrupciones se atienden en sil_poll(),
+ * que se llama desde las esperas, las lecturas de la UART y la entrada
+ * estándar: es el punto en que la Pico las atendería mientras main() espera.
+ * El PWM de los motores marca el ritmo del DMA y del ADC como en el
+ * hardware, así analog.c lee su buffer circular sin cambios. La flash es un
+ * archivo mapeado y el reinicio del watchdog es un exec() del mismo
+ * programa que hereda la flash, los pty y la RAM __uninitialized_ram.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "sil.h"
+#include "config.h"
+#include "hardware/adc.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/flash.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "hardware/watchdog.h"
+#include "pico/flash.h"
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+/// @brief Frecuencia del reloj del sistema
+#define SIL_CLK_SYS_HZ 125000000u
+
+/// @brief Ciclos de PWM que se recuperan como máximo en una llamada a sil_poll()
+#define SIL_PWM_MAX_CATCHUP 512
+
+/// @brief Variables de entorno con el estado heredado en un reinicio
+#define SIL_ENV_FLASH "WALLY_SIL_FLASH_FD"
+#define SIL_ENV_NOINIT "WALLY_SIL_NOINIT_FD"
+#define SIL_ENV_RESET "WALLY_SIL_RESET"
+
+/// @brief Causa del último reinicio
+typedef enum {
+    RESET_POWER_ON = 0,   ///< Arranque normal
+    RESET_REBOOT,         ///< watchdog_reboot()
+    RESET_WATCHDOG        ///< El watchdog venció
+} reset_cause_t;
+
+/// @brief Límites de la sección __uninitialized_ram (los genera el enlazador)
+extern char __start_sil_noinit[] __attribute__((weak));
+extern char __stop_sil_noinit[] __attribute__((weak));
+
+/// @brief Captura del HardFault del firmware (fault.c)
+void fault_capture_hardfault(uint32_t* frame);
+
+uint8_t* sil_flash = NULL;
+
+/// @brief Estado general
+static char** saved_argv = NULL;
+static int flash_fd = -1;
+static uint64_t start_ns = 0;
+static reset_cause_t reset_cause = RESET_POWER_ON;
+
+/// @brief Interrupciones
+static bool irq_disabled = false;
+static bool polling = false;
+static irq_handler_t irq_handlers[NUM_IRQS];
+static bool irq_enabled[NUM_IRQS];
+
+/// @brief Temporizadores repetitivos activos
+static repeating_timer_t* timers = NULL;
+
+/// @brief Watchdog
+static bool watchdog_running = false;
+static uint32_t watchdog_delay_ms = 0;
+static uint64_t watchdog_deadline_us = 0;
+
+/// @brief GPIO
+static bool gpio_levels[NUM_BANK0_GPIOS];
+static bool gpio_outputs[NUM_BANK0_GPIOS];
+static uint32_t gpio_irq_mask[NUM_BANK0_GPIOS];
+static uint32_t gpio_irq_pending[NUM_BANK0_GPIOS];
+static void (*gpio_raw_handlers[NUM_BANK0_GPIOS])(void);
+static gpio_irq_callback_t gpio_callback = NULL;
+
+/**
+ * @brief Slice de PWM.
+ */
+typedef struct {
+    pwm_config config;  ///< Configuración
+    bool enabled;       ///< Contando
+    uint64_t next_us;   ///< Próximo fin de ciclo
+    double period_us;   ///< Duración del ciclo
+    double phase_us;    ///< Fracción acumulada de microsegundo
+} pwm_slice_t;
+
+static pwm_slice_t slices[8];
+static uint16_t pwm_levels[NUM_BANK0_GPIOS];
+
+/// @brief ADC
+static adc_hw_t adc_registers;
+adc_hw_t* const adc_hw = &adc_registers;
+static uint adc_input = 0;
+static uint adc_round_robin = 0;
+static bool adc_dreq = false;
+
+/// @brief DMA
+static dma_channel_hw_t dma_registers[NUM_DMA_CHANNELS];
+static dma_channel_config dma_configs[NUM_DMA_CHANNELS];
+static bool dma_claimed[NUM_DMA_CHANNELS];
+static bool dma_busy[NUM_DMA_CHANNELS];
+
+/// @brief Spinlocks
+static spin_lock_t spin_locks[NUM_SPIN_LOCKS];
+static uint32_t spin_locks_claimed = 0;
+
+/// @brief I2C
+struct i2c_inst {
+    uint index;
+};
+static struct i2c_inst i2c_instances[2] = {{0}, {1}};
+i2c_inst_t* const sil_i2c0 = &i2c_instances[0];
+i2c_inst_t* const sil_i2c1 = &i2c_instances[1];
+
+static void dma_request(uint dreq);
+
+// ==================== TIEMPO ====================
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+uint64_t time_us_64(void) {
+    return (monotonic_ns() - start_ns) / 1000u;
+}
+
+uint32_t time_us_32(void) {
+    return (uint32_t)time_us_64();
+}
+
+void sleep_until(absolute_time_t t) {
+    uint64_t now;
+    while ((now = time_us_64()) < t) {
+        if (irq_disabled || polling) {
+            uint64_t wait = t - now;
+            struct timespec ts = { (time_t)(wait / 1000000u), (long)(wait % 1000000u) * 1000 };
+            nanosleep(&ts, NULL);
+            continue;
+        }
+        sil_poll();
+        now = time_us_64();
+        if (now < t) sil_wait(t - now);
+    }
+}
+
+void sleep_us(uint64_t us) {
+    sleep_until(time_us_64() + us);
+}
+
+void sleep_ms(uint32_t ms) {
+    sleep_until(time_us_64() + (uint64_t)ms * 1000u);
+}
+
+void busy_wait_us(uint64_t us) {
+    // Como en la Pico, las interrupciones se atienden durante la espera
+    uint64_t end = time_us_64() + us;
+    while (time_us_64() < end) {
+        sil_poll();
+    }
+}
+
+void busy_wait_ms(uint32_t ms) {
+    busy_wait_us((uint64_t)ms * 1000u);
+}
+
+void tight_loop_contents(void) {
+    sil_poll();
+}
+
+bool add_repeating_timer_us(int64_t delay_us, repeating_timer_callback_t callback,
+                            void* user_data, repeating_timer_t* out) {
+    if (!callback || !out || delay_us == 0) return false;
+
+    out->delay_us = delay_us;
+    out->callback = callback;
+    out->user_data = user_data;
+    out->next_us = time_us_64() + (uint64_t)(delay_us < 0 ? -delay_us : delay_us);
+    out->next = timers;
+    timers = out;
+    return true;
+}
+
+bool add_repeating_timer_ms(int32_t delay_ms, repeating_timer_callback_t callback,
+                            void* user_data, repeating_timer_t* out) {
+    return add_repeating_timer_us((int64_t)delay_ms * 1000, callback, user_data, out);
+}
+
+bool cancel_repeating_timer(repeating_timer_t* timer) {
+    for (repeating_timer_t** link = &timers; *link; link = &(*link)->next) {
+        if (*link == timer) {
+            *link = timer->next;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Ejecuta los temporizadores vencidos.
+ *
+ * Negativo: el periodo cuenta desde el inicio de la llamada anterior;
+ * positivo: desde su fin (como en el SDK).
+ */
+static void run_timers(void) {
+    uint64_t now = time_us_64();
+    repeating_timer_t* timer = timers;
+
+    while (timer) {
+        repeating_timer_t* next = timer->next;
+        if (now >= timer->next_us) {
+            uint64_t started = timer->next_us;
+            if (timer->callback(timer)) {
+                if (timer->delay_us < 0) {
+                    timer->next_us = started + (uint64_t)(-timer->delay_us);
+                    if (timer->next_us <= now) timer->next_us = now + (uint64_t)(-timer->delay_us);
+                } else {
+                    timer->next_us = time_us_64() + (uint64_t)timer->delay_us;
+                }
+            } else {
+                cancel_repeating_timer(timer);
+            }
+        }
+        timer = next;
+    }
+}
+
+// ==================== INTERRUPCIONES ====================
+
+uint32_t save_and_disable_interrupts(void) {
+    uint32_t status = irq_disabled ? 1u : 0u;
+    irq_disabled = true;
+    return status;
+}
+
+void restore_interrupts(uint32_t status) {
+    irq_disabled = (status != 0);
+}
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler) {
+    if (num < NUM_IRQS) irq_handlers[num] = handler;
+}
+
+void irq_set_enabled(uint num, bool enabled) {
+    if (num < NUM_IRQS) irq_enabled[num] = enabled;
+}
+
+void irq_set_priority(uint num, uint8_t hardware_priority) {
+    (void)num;
+    (void)hardware_priority;
+}
+
+spin_lock_t* spin_lock_instance(uint lock_num) {
+    return &spin_locks[lock_num % NUM_SPIN_LOCKS];
+}
+
+int spin_lock_claim_unused(bool required) {
+    for (uint i = 24; i < NUM_SPIN_LOCKS; i++) {
+        if (!(spin_locks_claimed & (1u << i))) {
+            spin_locks_claimed |= 1u << i;
+            return (int)i;
+        }
+    }
+    if (required) {
+        fprintf(stderr, "SIL: no quedan spinlocks libres\n");
+        abort();
+    }
+    return -1;
+}
+
+void spin_lock_unclaim(uint lock_num) {
+    spin_locks_claimed &= ~(1u << lock_num);
+}
+
+uint32_t spin_lock_blocking(spin_lock_t* lock) {
+    uint32_t saved = save_and_disable_interrupts();
+    *lock = 1;
+    return saved;
+}
+
+void spin_unlock(spin_lock_t* lock, uint32_t saved_irq) {
+    *lock = 0;
+    restore_interrupts(saved_irq);
+}
+
+// ==================== GPIO ====================
+
+void gpio_init(uint gpio) {
+    if (gpio >= NUM_BANK0_GPIOS) return;
+    gpio_outputs[gpio] = false;
+    gpio_levels[gpio] = false;
+}
+
+void gpio_set_dir(uint gpio, bool out) {
+    if (gpio < NUM_BANK0_GPIOS) gpio_outputs[gpio] = out;
+}
+
+void gpio_put(uint gpio, bool value) {
+    if (gpio < NUM_BANK0_GPIOS) gpio_levels[gpio] = value;
+}
+
+bool gpio_get(uint gpio) {
+    return gpio < NUM_BANK0_GPIOS && gpio_levels[gpio];
+}
+
+void gpio_set_function(uint gpio, enum gpio_function fn) {
+    (void)gpio;
+    (void)fn;
+}
+
+void gpio_pull_up(uint gpio) {
+    if (gpio < NUM_BANK0_GPIOS && !gpio_outputs[gpio]) gpio_levels[gpio] = true;
+}
+
+void gpio_pull_down(uint gpio) {
+    if (gpio < NUM_BANK0_GPIOS && !gpio_outputs[gpio]) gpio_levels[gpio] = false;
+}
+
+void gpio_set_irq_enabled(uint gpio, uint32_t event_mask, bool enabled) {
+    if (gpio >= NUM_BANK0_GPIOS) return;
+    if (enabled) {
+        gpio_irq_mask[gpio] |= event_mask;
+    } else {
+        gpio_irq_mask[gpio] &= ~event_mask;
+    }
+}
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled,
+                                        gpio_irq_callback_t callback) {
+    gpio_set_irq_enabled(gpio, event_mask, enabled);
+    if (callback) gpio_callback = callback;
+    if (enabled) irq_set_enabled(IO_IRQ_BANK0, true);
+}
+
+void gpio_add_raw_irq_handler(uint gpio, void (*handler)(void)) {
+    if (gpio < NUM_BANK0_GPIOS) gpio_raw_handlers[gpio] = handler;
+}
+
+uint32_t gpio_get_irq_event_mask(uint gpio) {
+    return gpio < NUM_BANK0_GPIOS ? gpio_irq_pending[gpio] : 0;
+}
+
+void gpio_acknowledge_irq(uint gpio, uint32_t event_mask) {
+    if (gpio < NUM_BANK0_GPIOS) gpio_irq_pending[gpio] &= ~event_mask;
+}
+
+/**
+ * @brief Atiende IO_IRQ_BANK0: primero los manejadores crudos y después
+ * la callback compartida, como el despachador del SDK.
+ */
+static void dispatch_gpio(void) {
+    if (!irq_enabled[IO_IRQ_BANK0]) return;
+
+    for (uint gpio = 0; gpio < NUM_BANK0_GPIOS; gpio++) {
+        if (!gpio_irq_pending[gpio]) continue;
+
+        if (gpio_raw_handlers[gpio]) {
+            gpio_raw_handlers[gpio]();
+        }
+        uint32_t events = gpio_irq_pending[gpio];
+        if (events && gpio_callback) {
+            gpio_irq_pending[gpio] = 0;
+            gpio_callback(gpio, events);
+        }
+        gpio_irq_pending[gpio] = 0;
+    }
+}
+
+bool sil_gpio_level(uint gpio) {
+    return gpio_get(gpio);
+}
+
+void sil_gpio_event(uint gpio, uint32_t events) {
+    if (gpio >= NUM_BANK0_GPIOS) return;
+
+    if (events & GPIO_IRQ_EDGE_RISE) gpio_levels[gpio] = true;
+    if (events & GPIO_IRQ_EDGE_FALL) gpio_levels[gpio] = false;
+
+    events &= gpio_irq_mask[gpio];
+    if (!events) return;
+    gpio_irq_pending[gpio] |= events;
+    dispatch_gpio();
+}
+
+// ==================== PWM ====================
+
+pwm_config pwm_get_default_config(void) {
+    pwm_config c = { .clkdiv = 1.0f, .wrap = 0xFFFF, .phase_correct = false };
+    return c;
+}
+
+void pwm_config_set_clkdiv(pwm_config* c, float div) {
+    c->clkdiv = div;
+}
+
+void pwm_config_set_wrap(pwm_config* c, uint16_t wrap) {
+    c->wrap = wrap;
+}
+
+void pwm_config_set_phase_correct(pwm_config* c, bool phase_correct) {
+    c->phase_correct = phase_correct;
+}
+
+void pwm_init(uint slice_num, pwm_config* c, bool start) {
+    pwm_slice_t* slice = &slices[slice_num & 7u];
+    slice->config = *c;
+    slice->period_us = (c->phase_correct ? 2.0 : 1.0) * (c->wrap + 1.0) * c->clkdiv * 1e6 /
+                       SIL_CLK_SYS_HZ;
+    pwm_set_enabled(slice_num, start);
+}
+
+void pwm_set_enabled(uint slice_num, bool enabled) {
+    pwm_slice_t* slice = &slices[slice_num & 7u];
+    if (enabled && !slice->enabled) {
+        slice->next_us = time_us_64();
+        slice->phase_us = 0.0;
+    }
+    slice->enabled = enabled;
+}
+
+void pwm_set_gpio_level(uint gpio, uint16_t level) {
+    if (gpio < NUM_BANK0_GPIOS) pwm_levels[gpio] = level;
+}
+
+uint16_t sil_pwm_level(uint gpio) {
+    if (gpio >= NUM_BANK0_GPIOS) return 0;
+    const pwm_slice_t* slice = &slices[pwm_gpio_to_slice_num(gpio)];
+    if (!slice->enabled) return 0;
+    return pwm_levels[gpio] > slice->config.wrap ? slice->config.wrap : pwm_levels[gpio];
+}
+
+/**
+ * @brief Genera los fines de ciclo transcurridos (DREQ de cada slice).
+ */
+static void run_pwm(void) {
+    uint64_t now = time_us_64();
+
+    for (uint s = 0; s < 8; s++) {
+        pwm_slice_t* slice = &slices[s];
+        if (!slice->enabled || slice->period_us <= 0.0) continue;
+
+        int cycles = 0;
+        while (slice->next_us <= now && cycles < SIL_PWM_MAX_CATCHUP) {
+            dma_request(pwm_get_dreq(s));
+            slice->phase_us += slice->period_us;
+            uint64_t whole = (uint64_t)slice->phase_us;
+            slice->phase_us -= (double)whole;
+            slice->next_us += whole;
+            cycles++;
+        }
+        if (slice->next_us <= now) slice->next_us = now + 1;
+    }
+}
+
+// ==================== ADC ====================
+
+void adc_init(void) {
+    adc_registers.cs = 0;
+    adc_registers.fifo = 0;
+    adc_input = 0;
+    adc_round_robin = 0;
+    adc_dreq = false;
+}
+
+void adc_gpio_init(uint gpio) {
+    gpio_init(gpio);
+}
+
+void adc_select_input(uint input) {
+    adc_input = input % 5u;
+}
+
+void adc_set_round_robin(uint input_mask) {
+    adc_round_robin = input_mask & 0x1Fu;
+}
+
+void adc_fifo_setup(bool en, bool dreq_en, uint16_t dreq_thresh, bool err_in_fifo, bool byte_shift) {
+    (void)en;
+    (void)dreq_thresh;
+    (void)err_in_fifo;
+    (void)byte_shift;
+    adc_dreq = dreq_en;
+}
+
+void adc_fifo_drain(void) {
+    adc_registers.fifo = 0;
+}
+
+/**
+ * @brief Conversión pedida con START_ONCE: resultado al FIFO, avance de la
+ * rueda de entradas y DREQ del ADC.
+ */
+static void adc_convert(void) {
+    adc_registers.cs &= ~ADC_CS_START_ONCE_BITS;
+
+    double volts = sil_vehicle_adc_volts(adc_input);
+    int counts = (int)(volts / ANALOG_VREF * 4096.0 + 0.5);
+    if (counts < 0) counts = 0;
+    if (counts > 4095) counts = 4095;
+    adc_registers.fifo = (uint32_t)counts;
+
+    if (adc_round_robin) {
+        do {
+            adc_input = (adc_input + 1) % 5u;
+        } while (!(adc_round_robin & (1u << adc_input)));
+    }
+
+    if (adc_dreq) dma_request(DREQ_ADC);
+}
+
+// ==================== DMA ====================
+
+int dma_claim_unused_channel(bool required) {
+    for (int i = 0; i < NUM_DMA_CHANNELS; i++) {
+        if (!dma_claimed[i]) {
+            dma_claimed[i] = true;
+            return i;
+        }
+    }
+    if (required) {
+        fprintf(stderr, "SIL: no quedan canales de DMA libres\n");
+        abort();
+    }
+    return -1;
+}
+
+void dma_channel_unclaim(uint channel) {
+    if (channel < NUM_DMA_CHANNELS) {
+        dma_claimed[channel] = false;
+        dma_busy[channel] = false;
+    }
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel) {
+    dma_channel_config c = {
+        .size = DMA_SIZE_32,
+        .read_increment = true,
+        .write_increment = false,
+        .ring_write = false,
+        .ring_bits = 0,
+        .dreq = 0x3F,
+    };
+    (void)channel;
+    return c;
+}
+
+void channel_config_set_transfer_data_size(dma_channel_config* c, enum dma_channel_transfer_size size) {
+    c->size = size;
+}
+
+void channel_config_set_read_increment(dma_channel_config* c, bool incr) {
+    c->read_increment = incr;
+}
+
+void channel_config_set_write_increment(dma_channel_config* c, bool incr) {
+    c->write_increment = incr;
+}
+
+void channel_config_set_ring(dma_channel_config* c, bool write, uint size_bits) {
+    c->ring_write = write;
+    c->ring_bits = size_bits;
+}
+
+void channel_config_set_dreq(dma_channel_config* c, uint dreq) {
+    c->dreq = dreq;
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config* config, volatile void* write_addr,
+                           const volatile void* read_addr, uint transfer_count, bool trigger) {
+    if (channel >= NUM_DMA_CHANNELS) return;
+
+    dma_configs[channel] = *config;
+    dma_registers[channel].write_addr = (uintptr_t)write_addr;
+    dma_registers[channel].read_addr = (uintptr_t)read_addr;
+    dma_registers[channel].transfer_count = transfer_count;
+    dma_busy[channel] = trigger && transfer_count > 0;
+}
+
+void dma_channel_set_trans_count(uint channel, uint32_t trans_count, bool trigger) {
+    if (channel >= NUM_DMA_CHANNELS) return;
+
+    dma_registers[channel].transfer_count = trans_count;
+    if (trigger) dma_busy[channel] = trans_count > 0;
+}
+
+bool dma_channel_is_busy(uint channel) {
+    return channel < NUM_DMA_CHANNELS && dma_busy[channel];
+}
+
+dma_channel_hw_t* dma_channel_hw_addr(uint channel) {
+    return &dma_registers[channel % NUM_DMA_CHANNELS];
+}
+
+/**
+ * @brief Avanza una dirección respetando el anillo.
+ */
+static uintptr_t advance(uintptr_t addr, uint size, uint ring_bits) {
+    if (ring_bits == 0) return addr + size;
+    uintptr_t mask = ((uintptr_t)1 << ring_bits) - 1;
+    return (addr & ~mask) | ((addr + size) & mask);
+}
+
+/**
+ * @brief Una transferencia de cada canal activo que espera este DREQ.
+ */
+static void dma_request(uint dreq) {
+    for (uint ch = 0; ch < NUM_DMA_CHANNELS; ch++) {
+        if (!dma_busy[ch] || dma_configs[ch].dreq != dreq) continue;
+
+        const dma_channel_config* c = &dma_configs[ch];
+        dma_channel_hw_t* hw = &dma_registers[ch];
+        uint size = 1u << c->size;
+
+        memcpy((void*)hw->write_addr, (const void*)hw->read_addr, size);
+        bool starts_adc = hw->write_addr == (uintptr_t)&adc_registers.cs &&
+                          (adc_registers.cs & ADC_CS_START_ONCE_BITS);
+
+        if (c->read_increment) {
+            hw->read_addr = advance(hw->read_addr, size, c->ring_write ? 0 : c->ring_bits);
+        }
+        if (c->write_increment) {
+            hw->write_addr = advance(hw->write_addr, size, c->ring_write ? c->ring_bits : 0);
+        }
+        if (--hw->transfer_count == 0) dma_busy[ch] = false;
+
+        if (starts_adc) adc_convert();
+    }
+}
+
+// ==================== FLASH ====================
+
+void flash_range_erase(uint32_t flash_offs, size_t count) {
+    if (flash_offs + count > PICO_FLASH_SIZE_BYTES) return;
+    memset(sil_flash + flash_offs, 0xFF, count);
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t* data, size_t count) {
+    if (flash_offs + count > PICO_FLASH_SIZE_BYTES) return;
+    // NOR: la programación solo baja bits a 0
+    for (size_t i = 0; i < count; i++) {
+        sil_flash[flash_offs + i] &= data[i];
+    }
+}
+
+int flash_safe_execute(void (*func)(void*), void* param, uint32_t enter_exit_timeout_ms) {
+    (void)enter_exit_timeout_ms;
+    uint32_t irq = save_and_disable_interrupts();
+    func(param);
+    restore_interrupts(irq);
+    if (flash_fd >= 0) msync(sil_flash, PICO_FLASH_SIZE_BYTES, MS_ASYNC);
+    return PICO_OK;
+}
+
+bool flash_safe_execute_core_init(void) {
+    return true;
+}
+
+/**
+ * @brief Abre la flash: heredada, archivo o memoria anónima (borrada a 0xFF).
+ */
+static void open_flash(void) {
+    const char* inherited = getenv(SIL_ENV_FLASH);
+    bool fresh = false;
+
+    if (inherited) {
+        flash_fd = atoi(inherited);
+    } else if (sil_options.flash_path) {
+        flash_fd = open(sil_options.flash_path, O_RDWR | O_CREAT, 0644);
+        if (flash_fd >= 0) fresh = lseek(flash_fd, 0, SEEK_END) < PICO_FLASH_SIZE_BYTES;
+    } else {
+        flash_fd = memfd_create("wally-flash", 0);
+        fresh = true;
+    }
+
+    if (flash_fd < 0 || (fresh && ftruncate(flash_fd, PICO_FLASH_SIZE_BYTES) != 0)) {
+        fprintf(stderr, "SIL: no se pudo abrir la flash: %s\n", strerror(errno));
+        exit(1);
+    }
+
+    sil_flash = mmap(NULL, PICO_FLASH_SIZE_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED, flash_fd, 0);
+    if (sil_flash == MAP_FAILED) {
+        fprintf(stderr, "SIL: no se pudo mapear la flash: %s\n", strerror(errno));
+        exit(1);
+    }
+    if (fresh) memset(sil_flash, 0xFF, PICO_FLASH_SIZE_BYTES);
+}
+
+// ==================== WATCHDOG Y REINICIO ====================
+
+void watchdog_enable(uint32_t delay_ms, bool pause_on_debug) {
+    (void)pause_on_debug;
+    watchdog_delay_ms = delay_ms;
+    watchdog_running = true;
+    watchdog_update();
+}
+
+void watchdog_update(void) {
+    watchdog_deadline_us = time_us_64() + (uint64_t)watchdog_delay_ms * 1000u;
+}
+
+/**
+ * @brief Reinicia con exec() conservando flash, pty y RAM no inicializada.
+ */
+static void reboot(reset_cause_t cause) {
+    char value[16];
+
+    int noinit = memfd_create("wally-noinit", 0);
+    size_t length = (size_t)(__stop_sil_noinit - __start_sil_noinit);
+    if (noinit >= 0 && length > 0 && write(noinit, __start_sil_noinit, length) != (ssize_t)length) {
+        close(noinit);
+        noinit = -1;
+    }
+    if (noinit >= 0) {
+        snprintf(value, sizeof(value), "%d", noinit);
+        setenv(SIL_ENV_NOINIT, value, 1);
+    }
+
+    snprintf(value, sizeof(value), "%d", flash_fd);
+    setenv(SIL_ENV_FLASH, value, 1);
+    snprintf(value, sizeof(value), "%d", (int)cause);
+    setenv(SIL_ENV_RESET, value, 1);
+    sil_uart_export();
+
+    fflush(NULL);
+    fprintf(stderr, "\nSIL: reinicio (%s)\n", cause == RESET_WATCHDOG ? "watchdog" : "watchdog_reboot");
+    execv("/proc/self/exe", saved_argv);
+    fprintf(stderr, "SIL: exec falló: %s\n", strerror(errno));
+    _exit(1);
+}
+
+void watchdog_reboot(uint32_t pc, uint32_t sp, uint32_t delay_ms) {
+    (void)pc;
+    (void)sp;
+    (void)delay_ms;
+    reboot(RESET_REBOOT);
+}
+
+bool watchdog_caused_reboot(void) {
+    return reset_cause != RESET_POWER_ON;
+}
+
+bool watchdog_enable_caused_reboot(void) {
+    return reset_cause == RESET_WATCHDOG;
+}
+
+void sil_reboot(void) {
+    reboot(RESET_REBOOT);
+}
+
+/**
+ * @brief Equivalente de isr_hardfault: un acceso inválido se registra como
+ * HardFault con los registros del host recortados a 32 bits.
+ */
+static void on_fault_signal(int sig, siginfo_t* info, void* context) {
+    (void)sig;
+    (void)info;
+    uint32_t frame[8] = {0};
+
+#if defined(__x86_64__)
+    const greg_t* regs = ((ucontext_t*)context)->uc_mcontext.gregs;
+    frame[0] = (uint32_t)regs[REG_RDI];
+    frame[1] = (uint32_t)regs[REG_RSI];
+    frame[2] = (uint32_t)regs[REG_RDX];
+    frame[3] = (uint32_t)regs[REG_RCX];
+    frame[4] = (uint32_t)regs[REG_R8];
+    frame[6] = (uint32_t)regs[REG_RIP];
+#else
+    (void)context;
+#endif
+    irq_disabled = true;
+    fault_capture_hardfault(frame);
+    _exit(1);
+}
+
+// ==================== ENTRADA Y SALIDA ESTÁNDAR ====================
+
+/**
+ * @brief Lectura de la entrada estándar que atiende las interrupciones
+ * mientras espera, como getchar() en la Pico.
+ *
+ * Al cerrarse la entrada (por ejemplo con un pipe) el firmware sigue
+ * corriendo sin recibir más teclas.
+ */
+static ssize_t stdin_read(void* cookie, char* buffer, size_t size) {
+    (void)cookie;
+    static bool closed = false;
+
+    fflush(stdout);
+    while (true) {
+        sil_poll();
+        struct pollfd fd = { .fd = STDIN_FILENO, .events = POLLIN };
+        if (!closed && poll(&fd, 1, 1) > 0) {
+            ssize_t n = read(STDIN_FILENO, buffer, size);
+            if (n > 0) return n;
+            closed = true;
+        } else if (closed) {
+            sil_wait(1000);
+        }
+    }
+}
+
+bool stdio_init_all(void) {
+    static bool done = false;
+    if (done) return true;
+
+    cookie_io_functions_t io = { .read = stdin_read };
+    FILE* input = fopencookie(NULL, "r", io);
+    if (input) {
+        setvbuf(input, NULL, _IONBF, 0);
+        stdin = input;
+    }
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    done = true;
+    return true;
+}
+
+// ==================== RELOJES E I2C ====================
+
+uint32_t clock_get_hz(enum clock_index clk_index) {
+    return clk_index == clk_usb || clk_index == clk_adc ? 48000000u : SIL_CLK_SYS_HZ;
+}
+
+uint i2c_init(i2c_inst_t* i2c, uint baudrate) {
+    (void)i2c;
+    return baudrate;
+}
+
+int i2c_write_blocking(i2c_inst_t* i2c, uint8_t addr, const uint8_t* src, size_t len, bool nostop) {
+    (void)i2c;
+    (void)nostop;
+    return sil_vehicle_i2c(addr, src, NULL, len);
+}
+
+int i2c_read_blocking(i2c_inst_t* i2c, uint8_t addr, uint8_t* dst, size_t len, bool nostop) {
+    (void)i2c;
+    (void)nostop;
+    return sil_vehicle_i2c(addr, NULL, dst, len);
+}
+
+// ==================== BUCLE DE DISPOSITIVOS ====================
+
+void sil_poll(void) {
+    if (irq_disabled || polling) return;
+    polling = true;
+
+    sil_uart_poll();
+    sil_vehicle_poll(time_us_64());
+    run_pwm();
+
+    for (uint index = 0; index < 2; index++) {
+        uint irq = UART0_IRQ + index;
+        if (irq_enabled[irq] && irq_handlers[irq] && sil_uart_irq_pending(index)) {
+            irq_handlers[irq]();
+        }
+    }
+
+    run_timers();
+
+    if (watchdog_running && time_us_64() > watchdog_deadline_us) {
+        reboot(RESET_WATCHDOG);
+    }
+
+    polling = false;
+}
+
+void sil_wait(uint64_t timeout_us) {
+    struct pollfd fds[4];
+    int uart_fds[4];
+    int count = sil_uart_fds(uart_fds, 4);
+
+    for (int i = 0; i < count; i++) {
+        fds[i].fd = uart_fds[i];
+        fds[i].events = POLLIN;
+        fds[i].revents = 0;
+    }
+
+    // Un milisegundo como máximo: el PWM y los encoders avanzan en sil_poll().
+    // El PPS se despierta a tiempo para que la marca del flanco sea precisa
+    uint64_t now = time_us_64();
+    uint64_t edge = sil_vehicle_next_event_us();
+    if (timeout_us > 1000) timeout_us = 1000;
+    if (edge > now && edge - now < timeout_us) timeout_us = edge - now;
+
+    struct timespec ts = { 0, (long)timeout_us * 1000 };
+    ppoll(fds, (nfds_t)count, &ts, NULL);
+}
+
+void sil_hal_init(char** argv) {
+    saved_argv = argv;
+    start_ns = monotonic_ns();
+
+    const char* cause = getenv(SIL_ENV_RESET);
+    reset_cause = cause ? (reset_cause_t)atoi(cause) : RESET_POWER_ON;
+    unsetenv(SIL_ENV_RESET);
+
+    // RAM no inicializada: se recupera solo en un reinicio
+    const char* noinit = getenv(SIL_ENV_NOINIT);
+    if (noinit) {
+        int fd = atoi(noinit);
+        size_t length = (size_t)(__stop_sil_noinit - __start_sil_noinit);
+        if (length > 0 && pread(fd, __start_sil_noinit, length, 0) != (ssize_t)length) {
+            memset(__start_sil_noinit, 0, length);
+        }
+        close(fd);
+        unsetenv(SIL_ENV_NOINIT);
+    }
+
+    open_flash();
+    unsetenv(SIL_ENV_FLASH);
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = on_fault_signal;
+    action.sa_flags = SA_SIGINFO | SA_NODEFER;
+    sigaction(SIGSEGV, &action, NULL);
+    sigaction(SIGBUS, &action, NULL);
+}
\ No newline at end of file
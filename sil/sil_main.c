@@ -0,0 +1,113 @@
+/**
+ * @file sil_main.c
+ * @brief Punto de entrada de la compilación SIL del firmware.
+ *
+ * Lee las opciones, crea los pty y el vehículo y llama al main() del
+ * firmware (WALLY_S.c se compila con main renombrado a firmware_main).
+ * El menú de pruebas queda en la consola, como por la traza USB.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "sil.h"
+#include "config.h"
+#include <getopt.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/// @brief main() del firmware
+int firmware_main(void);
+
+sil_options_t sil_options = {
+    .bt_link = "/tmp/wally-bt",
+    .gps_link = "/tmp/wally-gps",
+    .flash_path = NULL,
+    .gps_sim = false,
+    .origin_lat = 6.2672,
+    .origin_lng = -75.5689,
+    .heading = 0.0,
+    .seed = 12345,
+    .bt_module_baud = BT_TARGET_BAUD,
+    .compass_bias_deg = 0.0,
+};
+
+/**
+ * @brief Muestra la ayuda de la línea de comandos.
+ */
+static void usage(const char* program) {
+    printf("Uso: %s [opciones]\n", program);
+    printf("  --bt PATH         enlace del pty del Bluetooth (%s)\n", sil_options.bt_link);
+    printf("  --gps PATH        enlace del pty del GPS (%s)\n", sil_options.gps_link);
+    printf("  --gps-sim         GPS generado por el simulador (PPS y NMEA del vehículo)\n");
+    printf("  --origin LAT,LNG  origen del plano local del simulador (%.4f,%.4f)\n",
+           sil_options.origin_lat, sil_options.origin_lng);
+    printf("  --heading GRADOS  rumbo inicial del vehículo (%.0f)\n", sil_options.heading);
+    printf("  --seed N          semilla del ruido del simulador (%lu)\n", (unsigned long)sil_options.seed);
+    printf("  --bt-baud N       velocidad configurada en el HC-05 (%lu)\n",
+           (unsigned long)sil_options.bt_module_baud);
+    printf("  --compass-bias G  desvío de montaje de la brújula en grados (%.1f)\n",
+           sil_options.compass_bias_deg);
+    printf("  --flash ARCHIVO   flash persistente entre ejecuciones (por defecto en memoria)\n");
+}
+
+/**
+ * @brief Ctrl+C: salida normal para que se borren los enlaces de los pty.
+ */
+static void on_interrupt(int sig) {
+    (void)sig;
+    exit(0);
+}
+
+int main(int argc, char** argv) {
+    static const struct option options[] = {
+        { "bt", required_argument, NULL, 'b' },
+        { "gps", required_argument, NULL, 'g' },
+        { "gps-sim", no_argument, NULL, 's' },
+        { "origin", required_argument, NULL, 'o' },
+        { "heading", required_argument, NULL, 'H' },
+        { "seed", required_argument, NULL, 'r' },
+        { "bt-baud", required_argument, NULL, 'B' },
+        { "compass-bias", required_argument, NULL, 'c' },
+        { "flash", required_argument, NULL, 'f' },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+
+    int option;
+    while ((option = getopt_long(argc, argv, "h", options, NULL)) != -1) {
+        switch (option) {
+            case 'b': sil_options.bt_link = optarg; break;
+            case 'g': sil_options.gps_link = optarg; break;
+            case 's': sil_options.gps_sim = true; break;
+            case 'o':
+                if (sscanf(optarg, "%lf,%lf", &sil_options.origin_lat, &sil_options.origin_lng) != 2) {
+                    fprintf(stderr, "--origin espera LAT,LNG\n");
+                    return 2;
+                }
+                break;
+            case 'H': sil_options.heading = atof(optarg); break;
+            case 'r': sil_options.seed = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'B': sil_options.bt_module_baud = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'c': sil_options.compass_bias_deg = atof(optarg); break;
+            case 'f': sil_options.flash_path = optarg; break;
+            case 'h':
+                usage(argv[0]);
+                return 0;
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+
+    sil_hal_init(argv);
+    if (!sil_uart_init()) return 1;
+    sil_vehicle_init();
+
+    signal(SIGINT, on_interrupt);
+    signal(SIGTERM, on_interrupt);
+
+    return firmware_main();
+}
\ No newline at end of file
@@ -0,0 +1,422 @@
+/**
+ * @file sil_uart.c
+ * @brief UART del SDK sobre pseudoterminales de Linux.
+ *
+ * BT_UART_ID y GPS_UART_ID son cada una un pty con un enlace simbólico
+ * fijo (por defecto /tmp/wally-bt y /tmp/wally-gps), así un script, una
+ * terminal serie o una app puente hablan con el firmware igual que por el
+ * HC-05 o el NEO-6M. El lado esclavo queda abierto para que el pty
+ * sobreviva a que el cliente se desconecte.
+ *
+ * El HC-05 se emula: con BT_KEY_PIN en alto responde los comandos AT que
+ * usa bluetooth.c y guarda la velocidad configurada, que se aplica con
+ * AT+RESET. Si la UART no está a la velocidad del módulo los bytes se
+ * pierden, como en el cable real.
+ *
+ * La recepción sigue al RP2040: los bytes llegan de a uno a la velocidad
+ * configurada a una FIFO de 32 bytes (1 con uart_set_fifo_enabled(false)).
+ * Si la FIFO está llena cuando llega un byte, el byte se pierde por
+ * desborde. Con la interrupción de recepción habilitada se supone que el
+ * manejador vacía la FIFO a tiempo, como en la Pico.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "sil.h"
+#include "config.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <termios.h>
+#include <unistd.h>
+
+/// @brief Bytes en camino por la línea de cada UART (aún no llegaron a la FIFO)
+#define SIL_UART_RX_SIZE 4096
+
+/// @brief Profundidad de la FIFO de recepción del RP2040
+#define SIL_UART_FIFO_SIZE 32
+
+/// @brief Variables de entorno con el estado heredado en un reinicio
+#define SIL_ENV_PTY "WALLY_SIL_PTY"
+#define SIL_ENV_HC05 "WALLY_SIL_HC05_BAUD"
+
+/**
+ * @brief Estado de una UART.
+ */
+struct uart_inst {
+    uint index;                        ///< 0 o 1
+    uint baud;                         ///< Velocidad configurada
+    bool rx_irq;                       ///< Interrupción de recepción habilitada
+    int master;                        ///< Lado del firmware del pty
+    int slave;                         ///< Lado del cliente (abierto para conservar el pty)
+    const char* link;                  ///< Enlace simbólico publicado
+    uint8_t rx[SIL_UART_RX_SIZE];      ///< Bytes en camino por la línea
+    size_t rx_head;                    ///< Próxima escritura
+    size_t rx_tail;                    ///< Próxima lectura
+    uint64_t rx_next_us;               ///< Llegada del primer byte en camino
+    uint64_t rx_free_us;               ///< Llegada del último byte en camino
+    bool fifo_enabled;                 ///< FIFO de 32 bytes (false: registro de 1 byte)
+    uint8_t fifo[SIL_UART_FIFO_SIZE];  ///< FIFO de recepción
+    size_t fifo_head;                  ///< Próxima lectura de la FIFO
+    size_t fifo_count;                 ///< Bytes en la FIFO
+    uint32_t overruns;                 ///< Bytes perdidos por FIFO llena
+};
+
+static struct uart_inst uarts[2] = {
+    { .index = 0, .master = -1, .slave = -1 },
+    { .index = 1, .master = -1, .slave = -1 },
+};
+uart_inst_t* const sil_uart0 = &uarts[0];
+uart_inst_t* const sil_uart1 = &uarts[1];
+
+/// @brief HC-05 simulado
+static uint32_t module_baud = BT_TARGET_BAUD;
+static uint32_t module_next_baud = BT_TARGET_BAUD;
+static char at_line[64];
+static size_t at_length = 0;
+static bool baud_warned = false;
+
+// ==================== COLA DE RECEPCIÓN ====================
+
+/**
+ * @brief Duración de un byte en la línea (8N1: 10 bits).
+ */
+static uint64_t byte_us(const uart_inst_t* uart) {
+    return uart->baud ? 10000000ull / uart->baud : 1;
+}
+
+static size_t rx_space(const uart_inst_t* uart) {
+    return SIL_UART_RX_SIZE - 1 - (uart->rx_head + SIL_UART_RX_SIZE - uart->rx_tail) % SIL_UART_RX_SIZE;
+}
+
+/**
+ * @brief Pone bytes en la línea: llegan uno tras otro a la velocidad de la UART.
+ */
+static void rx_push(uart_inst_t* uart, const uint8_t* data, size_t length) {
+    uint64_t now = time_us_64();
+
+    for (size_t i = 0; i < length; i++) {
+        size_t next = (uart->rx_head + 1) % SIL_UART_RX_SIZE;
+        if (next == uart->rx_tail) return; // Línea saturada: el emisor pierde el resto
+
+        if (uart->rx_free_us < now) uart->rx_free_us = now;
+        uart->rx_free_us += byte_us(uart);
+        if (uart->rx_head == uart->rx_tail) uart->rx_next_us = uart->rx_free_us;
+
+        uart->rx[uart->rx_head] = data[i];
+        uart->rx_head = next;
+    }
+}
+
+/**
+ * @brief Pasa a la FIFO los bytes que ya llegaron.
+ *
+ * Con la FIFO llena, si la interrupción de recepción está habilitada se
+ * espera a que el manejador la vacíe; si no, el byte se pierde.
+ */
+static void rx_advance(uart_inst_t* uart) {
+    uint64_t now = time_us_64();
+    size_t depth = uart->fifo_enabled ? SIL_UART_FIFO_SIZE : 1;
+
+    while (uart->rx_head != uart->rx_tail && uart->rx_next_us <= now) {
+        if (uart->fifo_count >= depth) {
+            if (uart->rx_irq) return;
+            if (uart->overruns++ == 0) {
+                fprintf(stderr, "SIL: UART%u: FIFO de recepción llena, se pierden bytes\n", uart->index);
+            }
+        } else {
+            uart->fifo[(uart->fifo_head + uart->fifo_count) % SIL_UART_FIFO_SIZE] = uart->rx[uart->rx_tail];
+            uart->fifo_count++;
+        }
+
+        uart->rx_tail = (uart->rx_tail + 1) % SIL_UART_RX_SIZE;
+        uart->rx_next_us += byte_us(uart);
+    }
+}
+
+void sil_uart_inject(uart_inst_t* uart, const char* data, size_t length) {
+    rx_push(uart, (const uint8_t*)data, length);
+}
+
+bool sil_uart_irq_pending(uint index) {
+    if (index >= 2) return false;
+    rx_advance(&uarts[index]);
+    return uarts[index].rx_irq && uarts[index].fifo_count > 0;
+}
+
+// ==================== HC-05 ====================
+
+/**
+ * @brief El módulo entiende a la UART solo si ambos están a la misma velocidad.
+ */
+static bool module_in_sync(const uart_inst_t* uart) {
+    if (uart->baud == module_baud) return true;
+    if (!baud_warned) {
+        fprintf(stderr, "SIL: UART del Bluetooth a %u baudios y HC-05 a %lu: se pierden los bytes\n",
+                uart->baud, (unsigned long)module_baud);
+        baud_warned = true;
+    }
+    return false;
+}
+
+static void at_reply(uart_inst_t* uart, const char* text) {
+    rx_push(uart, (const uint8_t*)text, strlen(text));
+}
+
+/**
+ * @brief Responde un comando AT completo (sin el terminador).
+ */
+static void at_execute(uart_inst_t* uart, const char* command) {
+    char reply[48];
+
+    if (strcmp(command, "AT") == 0) {
+        at_reply(uart, "OK\r\n");
+    } else if (strncmp(command, "AT+NAME=", 8) == 0 || strncmp(command, "AT+PSWD=", 8) == 0) {
+        at_reply(uart, "OK\r\n");
+    } else if (strcmp(command, "AT+UART?") == 0) {
+        snprintf(reply, sizeof(reply), "+UART:%lu,0,0\r\nOK\r\n", (unsigned long)module_next_baud);
+        at_reply(uart, reply);
+    } else if (strncmp(command, "AT+UART=", 8) == 0) {
+        unsigned long baud = strtoul(command + 8, NULL, 10);
+        if (baud >= 4800 && baud <= 1382400) {
+            module_next_baud = (uint32_t)baud;
+            at_reply(uart, "OK\r\n");
+        } else {
+            at_reply(uart, "ERROR:(1D)\r\n");
+        }
+    } else if (strcmp(command, "AT+RESET") == 0) {
+        at_reply(uart, "OK\r\n");
+        if (module_baud != module_next_baud) {
+            fprintf(stderr, "SIL: HC-05 reconfigurado a %lu baudios\n", (unsigned long)module_next_baud);
+        }
+        module_baud = module_next_baud;
+        baud_warned = false;
+    } else {
+        at_reply(uart, "ERROR:(0)\r\n");
+    }
+}
+
+/**
+ * @brief Bytes del firmware hacia el HC-05 en modo AT.
+ */
+static void at_write(uart_inst_t* uart, const uint8_t* data, size_t length) {
+    if (!module_in_sync(uart)) return;
+
+    for (size_t i = 0; i < length; i++) {
+        char c = (char)data[i];
+        if (c == '\r') continue;
+        if (c == '\n') {
+            at_line[at_length] = '\0';
+            if (at_length > 0) at_execute(uart, at_line);
+            at_length = 0;
+        } else if (at_length < sizeof(at_line) - 1) {
+            at_line[at_length++] = c;
+        }
+    }
+}
+
+/**
+ * @brief Indica si la UART es la del Bluetooth con el módulo en modo AT.
+ */
+static bool in_at_mode(const uart_inst_t* uart) {
+    return uart == BT_UART_ID && sil_gpio_level(BT_KEY_PIN);
+}
+
+// ==================== PSEUDOTERMINALES ====================
+
+/**
+ * @brief Crea el pty de una UART y publica el enlace simbólico.
+ */
+static bool open_pty(uart_inst_t* uart, const char* link) {
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+        fprintf(stderr, "SIL: no se pudo crear el pty: %s\n", strerror(errno));
+        return false;
+    }
+
+    const char* name = ptsname(master);
+    int slave = name ? open(name, O_RDWR | O_NOCTTY) : -1;
+    if (slave < 0) {
+        fprintf(stderr, "SIL: no se pudo abrir %s: %s\n", name ? name : "pty", strerror(errno));
+        close(master);
+        return false;
+    }
+
+    // Sin eco ni traducción de fines de línea: los bytes pasan tal cual
+    struct termios tio;
+    tcgetattr(slave, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(slave, TCSANOW, &tio);
+    fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+
+    // Solo se reemplaza un enlace anterior, nunca un archivo
+    struct stat info;
+    if (lstat(link, &info) == 0 && S_ISLNK(info.st_mode)) unlink(link);
+    if (symlink(name, link) != 0) {
+        fprintf(stderr, "SIL: no se pudo crear %s: %s\n", link, strerror(errno));
+    }
+
+    uart->master = master;
+    uart->slave = slave;
+    uart->link = link;
+    printf("SIL: %s -> %s\n", link, name);
+    return true;
+}
+
+/**
+ * @brief Borra los enlaces al salir (en un reinicio se conservan).
+ */
+static void remove_links(void) {
+    for (int i = 0; i < 2; i++) {
+        if (uarts[i].link) unlink(uarts[i].link);
+    }
+}
+
+bool sil_uart_init(void) {
+    const char* inherited = getenv(SIL_ENV_PTY);
+    if (inherited) {
+        sscanf(inherited, "%d,%d,%d,%d", &uarts[0].master, &uarts[0].slave,
+               &uarts[1].master, &uarts[1].slave);
+        unsetenv(SIL_ENV_PTY);
+    }
+
+    const char* baud = getenv(SIL_ENV_HC05);
+    module_baud = module_next_baud = baud ? (uint32_t)strtoul(baud, NULL, 10) : sil_options.bt_module_baud;
+    unsetenv(SIL_ENV_HC05);
+
+    BT_UART_ID->link = sil_options.bt_link;
+    GPS_UART_ID->link = sil_options.gps_link;
+    atexit(remove_links);
+
+    if (inherited) return true;
+    return open_pty(BT_UART_ID, sil_options.bt_link) && open_pty(GPS_UART_ID, sil_options.gps_link);
+}
+
+void sil_uart_export(void) {
+    char value[64];
+    snprintf(value, sizeof(value), "%d,%d,%d,%d", uarts[0].master, uarts[0].slave,
+             uarts[1].master, uarts[1].slave);
+    setenv(SIL_ENV_PTY, value, 1);
+
+    // El HC-05 es externo: su configuración no cambia con el reinicio de la Pico
+    snprintf(value, sizeof(value), "%lu", (unsigned long)module_baud);
+    setenv(SIL_ENV_HC05, value, 1);
+}
+
+void sil_uart_poll(void) {
+    uint8_t buffer[256];
+
+    for (int i = 0; i < 2; i++) {
+        uart_inst_t* uart = &uarts[i];
+        if (uart->master < 0) continue;
+
+        // Lo que no cabe en la línea queda en el pty (el emisor espera)
+        ssize_t n;
+        size_t space;
+        while ((space = rx_space(uart)) > 0 &&
+               (n = read(uart->master, buffer, space < sizeof(buffer) ? space : sizeof(buffer))) > 0) {
+            if (uart == GPS_UART_ID && sil_options.gps_sim) continue;
+            if (uart == BT_UART_ID && (in_at_mode(uart) || !module_in_sync(uart))) continue;
+            rx_push(uart, buffer, (size_t)n);
+        }
+    }
+}
+
+int sil_uart_fds(int* fds, int max) {
+    int count = 0;
+    for (int i = 0; i < 2 && count < max; i++) {
+        if (uarts[i].master >= 0) fds[count++] = uarts[i].master;
+    }
+    return count;
+}
+
+// ==================== API DEL SDK ====================
+
+uint uart_init(uart_inst_t* uart, uint baudrate) {
+    uart->rx_head = uart->rx_tail = 0;
+    uart->fifo_head = uart->fifo_count = 0;
+    uart->rx_irq = false;
+    uart->fifo_enabled = true;  // Como en el SDK: uart_init() habilita las FIFO
+    return uart_set_baudrate(uart, baudrate);
+}
+
+uint uart_set_baudrate(uart_inst_t* uart, uint baudrate) {
+    uart->baud = baudrate;
+    return baudrate;
+}
+
+void uart_set_format(uart_inst_t* uart, uint data_bits, uint stop_bits, uart_parity_t parity) {
+    (void)uart;
+    (void)data_bits;
+    (void)stop_bits;
+    (void)parity;
+}
+
+void uart_set_hw_flow(uart_inst_t* uart, bool cts, bool rts) {
+    (void)uart;
+    (void)cts;
+    (void)rts;
+}
+
+void uart_set_fifo_enabled(uart_inst_t* uart, bool enabled) {
+    rx_advance(uart);
+    uart->fifo_enabled = enabled;
+}
+
+void uart_set_irq_enables(uart_inst_t* uart, bool rx_has_data, bool tx_needs_data) {
+    (void)tx_needs_data;
+    uart->rx_irq = rx_has_data;
+}
+
+uint uart_get_index(uart_inst_t* uart) {
+    return uart->index;
+}
+
+bool uart_is_readable(uart_inst_t* uart) {
+    rx_advance(uart);
+    if (uart->fifo_count == 0) {
+        sil_poll();
+        rx_advance(uart);
+    }
+    return uart->fifo_count > 0;
+}
+
+char uart_getc(uart_inst_t* uart) {
+    while (!uart_is_readable(uart)) {
+        sil_wait(1000);
+    }
+    char c = (char)uart->fifo[uart->fifo_head];
+    uart->fifo_head = (uart->fifo_head + 1) % SIL_UART_FIFO_SIZE;
+    uart->fifo_count--;
+    return c;
+}
+
+void uart_write_blocking(uart_inst_t* uart, const uint8_t* src, size_t len) {
+    if (in_at_mode(uart)) {
+        at_write(uart, src, len);
+        return;
+    }
+    if (uart == BT_UART_ID && !module_in_sync(uart)) return;
+    if (uart->master < 0) return;
+
+    // Sin cliente conectado el pty se llena: los bytes se pierden como en el aire
+    while (len > 0) {
+        ssize_t n = write(uart->master, src, len);
+        if (n <= 0) return;
+        src += n;
+        len -= (size_t)n;
+    }
+}
+
+void uart_putc_raw(uart_inst_t* uart, char c) {
+    uart_write_blocking(uart, (const uint8_t*)&c, 1);
+}
+
+void uart_puts(uart_inst_t* uart, const char* s) {
+    uart_write_blocking(uart, (const uint8_t*)s, strlen(s));
+}
\ No newline at end of file
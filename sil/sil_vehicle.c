@@ -0,0 +1,265 @@
+/**
+ * @file sil_vehicle.c
+ * @brief Sensores y actuadores del SIL respaldados por el simulador.
+ *
+ * Los motores leen el PWM y los pines de dirección que escribe motors.c;
+ * el vehículo de sim.c avanza en pasos de hasta 10 ms con el tiempo real.
+ * De su estado salen los pulsos de los encoders (interrupciones en
+ * ENCODER_A_PIN y ENCODER_B_PIN), el campo del QMC5883L por I2C, las
+ * tensiones del ADC (batería, corriente de los motores, VSYS) y, con
+ * --gps-sim, el PPS y las sentencias GPGGA, GPGSA y GPRMC del NEO-6M.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "sil.h"
+#include "config.h"
+#include "sim.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/// @brief Paso máximo de integración en segundos
+#define SIL_STEP_S 0.01
+
+/// @brief Atraso máximo que se recupera (una pausa larga del firmware no teletransporta el carro)
+#define SIL_MAX_CATCHUP_US 1000000u
+
+/// @brief Declinación con la que magnetometer.c arranca (el campo simulado la descuenta)
+#define SIL_MAG_DECLINATION_DEG (0.0404 * 180.0 / M_PI)
+
+/// @brief Campo horizontal en cuentas del QMC5883L (0.3 G a 3000 LSB/G) y vertical
+#define SIL_MAG_FIELD_LSB 900.0
+#define SIL_MAG_VERTICAL_LSB (-1200)
+
+/// @brief Retardo de las sentencias NMEA respecto al PPS en microsegundos
+#define SIL_NMEA_DELAY_US 100000u
+
+/// @brief Radio de la Tierra en metros
+#define SIL_EARTH_RADIUS_M 6371000.0
+
+/// @brief Estado del vehículo
+static sim_vehicle_t vehicle;
+static uint64_t last_us = 0;
+static double encoder_a = 0.0;
+static double encoder_b = 0.0;
+static double current_a = 0.0;
+static double current_b = 0.0;
+
+/// @brief Registros del QMC5883L
+static uint8_t mag_registers[16];
+static uint8_t mag_pointer = 0;
+
+/// @brief GPS simulado
+static uint64_t next_pps_us = 0;
+static uint64_t next_nmea_us = 0;
+static time_t utc_at_boot = 0;
+static uint32_t gps_second = 0;
+
+/**
+ * @brief PWM con signo de un motor según los pines de dirección del L298N.
+ */
+static int signed_pwm(uint en_pin, uint in1_pin, uint in2_pin) {
+    bool forward = sil_gpio_level(in1_pin);
+    bool backward = sil_gpio_level(in2_pin);
+    if (forward == backward) return 0; // Libre o frenado
+    int level = sil_pwm_level(en_pin);
+    return forward ? level : -level;
+}
+
+/**
+ * @brief Corriente de un motor: sin carga a velocidad de régimen y de
+ * bloqueo (proporcional al ciclo útil) cuando la rueda no alcanza esa
+ * velocidad.
+ */
+static double motor_current(int pwm, int base_pwm, double speed) {
+    if (pwm == 0) return 0.0;
+
+    double stall = SIM_MOTOR_STALL_A * abs(pwm) / (double)MAX_SPEED;
+    double free_speed = fabs(sim_pwm_to_speed(pwm, base_pwm));
+    if (free_speed <= 0.0) return stall;
+
+    double slip = 1.0 - fabs(speed) / free_speed;
+    if (slip < 0.0) slip = 0.0;
+    return SIM_MOTOR_NOLOAD_A + (stall - SIM_MOTOR_NOLOAD_A) * slip;
+}
+
+/**
+ * @brief Acumula la distancia recorrida por una rueda y genera sus pulsos.
+ */
+static void advance_encoder(double* accumulator, double speed, double dt, uint pin) {
+    *accumulator += fabs(speed) * dt * PULSES_PER_REV / (M_PI * SIM_WHEEL_DIAMETER_M);
+    while (*accumulator >= 1.0) {
+        *accumulator -= 1.0;
+        sil_gpio_event(pin, GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL);
+    }
+}
+
+// ==================== NMEA ====================
+
+/**
+ * @brief Agrega "*CS\r\n" a una sentencia que empieza con '$'.
+ */
+static size_t finish_sentence(char* sentence, size_t size) {
+    uint8_t checksum = 0;
+    size_t length = strlen(sentence);
+    for (size_t i = 1; i < length; i++) {
+        checksum ^= (uint8_t)sentence[i];
+    }
+    snprintf(sentence + length, size - length, "*%02X\r\n", checksum);
+    return strlen(sentence);
+}
+
+/**
+ * @brief Coordenada en formato NMEA (grados y minutos).
+ */
+static void format_coordinate(char* out, size_t size, double degrees, int degree_digits,
+                              char positive, char negative) {
+    char hemisphere = degrees >= 0.0 ? positive : negative;
+    degrees = fabs(degrees);
+    int whole = (int)degrees;
+    double minutes = (degrees - whole) * 60.0;
+    snprintf(out, size, "%0*d%07.4f,%c", degree_digits, whole, minutes, hemisphere);
+}
+
+/**
+ * @brief Envía el fix del segundo actual por la UART del GPS.
+ */
+static void send_nmea(void) {
+    double lat = sil_options.origin_lat + vehicle.gps_north / SIL_EARTH_RADIUS_M * 180.0 / M_PI;
+    double lng = sil_options.origin_lng + vehicle.gps_east /
+                 (SIL_EARTH_RADIUS_M * cos(sil_options.origin_lat * M_PI / 180.0)) * 180.0 / M_PI;
+
+    time_t utc = utc_at_boot + gps_second;
+    struct tm t;
+    gmtime_r(&utc, &t);
+
+    char lat_text[20], lng_text[20], sentence[128];
+    format_coordinate(lat_text, sizeof(lat_text), lat, 2, 'N', 'S');
+    format_coordinate(lng_text, sizeof(lng_text), lng, 3, 'E', 'W');
+
+    snprintf(sentence, sizeof(sentence), "$GPGGA,%02d%02d%02d.00,%s,%s,1,09,0.9,1495.0,M,0.0,M,,",
+             t.tm_hour, t.tm_min, t.tm_sec, lat_text, lng_text);
+    sil_uart_inject(GPS_UART_ID, sentence, finish_sentence(sentence, sizeof(sentence)));
+
+    snprintf(sentence, sizeof(sentence), "$GPGSA,A,3,02,05,07,09,13,16,20,27,30,,,,1.6,0.9,1.3");
+    sil_uart_inject(GPS_UART_ID, sentence, finish_sentence(sentence, sizeof(sentence)));
+
+    double speed = fabs(sim_forward_speed(&vehicle));
+    snprintf(sentence, sizeof(sentence), "$GPRMC,%02d%02d%02d.00,A,%s,%s,%.2f,%.1f,%02d%02d%02d,,,A",
+             t.tm_hour, t.tm_min, t.tm_sec, lat_text, lng_text, speed / 0.514444,
+             vehicle.heading, t.tm_mday, t.tm_mon + 1, t.tm_year % 100);
+    sil_uart_inject(GPS_UART_ID, sentence, finish_sentence(sentence, sizeof(sentence)));
+}
+
+// ==================== API INTERNA ====================
+
+void sil_vehicle_init(void) {
+    sim_init(&vehicle, 0.0, 0.0, sil_options.heading, sil_options.seed);
+    last_us = 0;
+    encoder_a = encoder_b = 0.0;
+
+    // El PPS marca el inicio de cada segundo UTC desde el arranque
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    utc_at_boot = now.tv_sec;
+    gps_second = 0;
+    next_pps_us = 1000000u - (uint64_t)now.tv_nsec / 1000u;
+    next_nmea_us = 0;
+}
+
+void sil_vehicle_poll(uint64_t now_us) {
+    if (now_us - last_us > SIL_MAX_CATCHUP_US) {
+        last_us = now_us - SIL_MAX_CATCHUP_US;
+    }
+
+    int pwm_a = signed_pwm(MOTOR_ENA_PIN, MOTOR_IN1_PIN, MOTOR_IN2_PIN);
+    int pwm_b = signed_pwm(MOTOR_ENB_PIN, MOTOR_IN3_PIN, MOTOR_IN4_PIN);
+
+    while (now_us > last_us) {
+        double dt = (now_us - last_us) / 1e6;
+        if (dt < 0.001) break;
+        if (dt > SIL_STEP_S) dt = SIL_STEP_S;
+
+        sim_step(&vehicle, pwm_a, pwm_b, dt);
+        last_us += (uint64_t)(dt * 1e6);
+
+        advance_encoder(&encoder_a, vehicle.speed_a, dt, ENCODER_A_PIN);
+        advance_encoder(&encoder_b, vehicle.speed_b, dt, ENCODER_B_PIN);
+    }
+
+    current_a = motor_current(pwm_a, BASE_SPEED_A, vehicle.speed_a);
+    current_b = motor_current(pwm_b, BASE_SPEED_B, vehicle.speed_b);
+
+    if (!sil_options.gps_sim) return;
+
+    if (now_us >= next_pps_us) {
+        gps_second = (uint32_t)((now_us - next_pps_us) / 1000000u) + gps_second + 1;
+        next_nmea_us = next_pps_us + SIL_NMEA_DELAY_US;
+        next_pps_us += ((now_us - next_pps_us) / 1000000u + 1) * 1000000u;
+        sil_gpio_event(TIMEBASE_PPS_PIN, GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL);
+    }
+    if (next_nmea_us && now_us >= next_nmea_us) {
+        next_nmea_us = 0;
+        send_nmea();
+    }
+}
+
+uint64_t sil_vehicle_next_event_us(void) {
+    return sil_options.gps_sim ? next_pps_us : UINT64_MAX;
+}
+
+double sil_vehicle_adc_volts(uint input) {
+    switch (input) {
+        case BATTERY_ADC_INPUT:
+            return (SIM_BATTERY_V - BATTERY_INTERNAL_RESISTANCE *
+                    (BATTERY_IDLE_CURRENT_A + current_a + current_b)) / BATTERY_DIVIDER_RATIO;
+        case MOTOR_SENSE_A_INPUT:
+            return current_a * MOTOR_SENSE_RESISTOR_OHM;
+        case MOTOR_SENSE_B_INPUT:
+            return current_b * MOTOR_SENSE_RESISTOR_OHM;
+        case 3:
+            return 5.0 / 3.0; // VSYS/3 alimentado por USB
+        default:
+            return 0.706;     // Sensor de temperatura a 27 °C
+    }
+}
+
+int sil_vehicle_i2c(uint8_t addr, const uint8_t* src, uint8_t* dst, size_t length) {
+    if (addr != QMC5883L_ADDR || length == 0) return PICO_ERROR_GENERIC;
+
+    if (src) {
+        // Primer byte: registro; los siguientes se escriben desde ahí
+        mag_pointer = src[0] & 0x0F;
+        for (size_t i = 1; i < length; i++) {
+            mag_registers[mag_pointer] = src[i];
+            mag_pointer = (mag_pointer + 1) & 0x0F;
+        }
+        return (int)length;
+    }
+
+    // Rumbo magnético medido: el firmware le suma la declinación y resta el desvío aprendido
+    double angle = (vehicle.compass + sil_options.compass_bias_deg - SIL_MAG_DECLINATION_DEG) *
+                   M_PI / 180.0;
+    int16_t x = (int16_t)lround(SIL_MAG_FIELD_LSB * cos(angle));
+    int16_t y = (int16_t)lround(SIL_MAG_FIELD_LSB * sin(angle));
+    int16_t z = SIL_MAG_VERTICAL_LSB;
+
+    mag_registers[0] = (uint8_t)x;
+    mag_registers[1] = (uint8_t)((uint16_t)x >> 8);
+    mag_registers[2] = (uint8_t)y;
+    mag_registers[3] = (uint8_t)((uint16_t)y >> 8);
+    mag_registers[4] = (uint8_t)z;
+    mag_registers[5] = (uint8_t)((uint16_t)z >> 8);
+    mag_registers[6] = 0x01; // DRDY
+
+    for (size_t i = 0; i < length; i++) {
+        dst[i] = mag_registers[mag_pointer];
+        mag_pointer = (mag_pointer + 1) & 0x0F;
+    }
+    return (int)length;
+}
\ No newline at end of file
@@ -0,0 +1,100 @@
+/**
+ * @file sim.c
+ * @brief Implementación del simulador del vehículo.
+ *
+ * Cinemática de robot diferencial con trocha WHEEL_TRACK_M. Cada motor
+ * tiene zona muerta y una velocidad proporcional al PWM por encima de
+ * ella, calibrada para que los PWM base den NOMINAL_SPEED_MPS. El ruido
+ * usa un generador propio para que las pruebas sean repetibles.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "sim.h"
+#include "config.h"
+#include <math.h>
+
+/**
+ * @brief Ruido aproximadamente gaussiano de media 0 y desviación 1.
+ */
+static double sim_noise(sim_vehicle_t* vehicle) {
+    double sum = 0.0;
+    for (int i = 0; i < 4; i++) {
+        vehicle->seed = vehicle->seed * 1664525u + 1013904223u;
+        sum += (vehicle->seed >> 8) / 16777216.0;
+    }
+    // Suma de 4 uniformes: media 2, varianza 1/3
+    return (sum - 2.0) * 1.7320508;
+}
+
+/**
+ * @brief Toma una medición GPS con ruido.
+ */
+static void sim_sample_gps(sim_vehicle_t* vehicle) {
+    vehicle->gps_east = vehicle->east + SIM_GPS_NOISE_M * sim_noise(vehicle);
+    vehicle->gps_north = vehicle->north + SIM_GPS_NOISE_M * sim_noise(vehicle);
+    vehicle->next_gps_ms = vehicle->time_ms + SIM_GPS_PERIOD_MS;
+}
+
+void sim_init(sim_vehicle_t* vehicle, double east, double north, double heading, uint32_t seed) {
+    if (!vehicle) return;
+
+    vehicle->east = east;
+    vehicle->north = north;
+    vehicle->heading = heading;
+    vehicle->speed_a = 0.0;
+    vehicle->speed_b = 0.0;
+    vehicle->compass = heading;
+    vehicle->time_ms = 0;
+    vehicle->seed = seed;
+    sim_sample_gps(vehicle);
+}
+
+double sim_pwm_to_speed(int pwm, int base_pwm) {
+    if (pwm < 0) return -sim_pwm_to_speed(-pwm, base_pwm);
+    if (pwm <= SIM_PWM_DEADBAND) return 0.0;
+    if (pwm > MAX_SPEED) pwm = MAX_SPEED;
+    return NOMINAL_SPEED_MPS * (pwm - SIM_PWM_DEADBAND) / (double)(base_pwm - SIM_PWM_DEADBAND);
+}
+
+void sim_step(sim_vehicle_t* vehicle, int pwm_a, int pwm_b, double dt) {
+    if (!vehicle || dt <= 0.0) return;
+
+    // Motores: retardo de primer orden hacia la velocidad de régimen
+    double alpha = dt / (SIM_MOTOR_TAU_S + dt);
+    vehicle->speed_a += (sim_pwm_to_speed(pwm_a, BASE_SPEED_A) - vehicle->speed_a) * alpha;
+    vehicle->speed_b += (sim_pwm_to_speed(pwm_b, BASE_SPEED_B) - vehicle->speed_b) * alpha;
+
+    // Cinemática diferencial: B a la izquierda, B más rápida gira a la derecha
+    double v = (vehicle->speed_a + vehicle->speed_b) / 2.0;
+    double yaw_rate = (vehicle->speed_b - vehicle->speed_a) / WHEEL_TRACK_M * 180.0 / M_PI;
+
+    vehicle->heading = fmod(vehicle->heading + yaw_rate * dt + 360.0, 360.0);
+    vehicle->east += v * sin(vehicle->heading * M_PI / 180.0) * dt;
+    vehicle->north += v * cos(vehicle->heading * M_PI / 180.0) * dt;
+    vehicle->time_ms += (uint32_t)(dt * 1000.0 + 0.5);
+
+    // Brújula: filtro de primer orden sobre la medición ruidosa
+    double measured = vehicle->heading + SIM_COMPASS_NOISE_DEG * sim_noise(vehicle);
+    double error = fmod(measured - vehicle->compass + 540.0, 360.0) - 180.0;
+    vehicle->compass = fmod(vehicle->compass + error * dt / (SIM_COMPASS_TAU_S + dt) + 360.0, 360.0);
+
+    if ((int32_t)(vehicle->time_ms - vehicle->next_gps_ms) >= 0) {
+        sim_sample_gps(vehicle);
+    }
+}
+
+double sim_forward_speed(const sim_vehicle_t* vehicle) {
+    return vehicle ? (vehicle->speed_a + vehicle->speed_b) / 2.0 : 0.0;
+}
+
+double sim_gps_bearing_to(const sim_vehicle_t* vehicle, double east, double north) {
+    double bearing = atan2(east - vehicle->gps_east, north - vehicle->gps_north) * 180.0 / M_PI;
+    return (bearing < 0.0) ? bearing + 360.0 : bearing;
+}
+
+double sim_gps_distance_to(const sim_vehicle_t* vehicle, double east, double north) {
+    return hypot(east - vehicle->gps_east, north - vehicle->gps_north);
+}
\ No newline at end of file
@@ -0,0 +1,106 @@
+/**
+ * @file sim.h
+ * @brief Header del simulador del vehículo para pruebas de control.
+ *
+ * Modelo de robot diferencial usado por las funciones de prueba: motores
+ * con zona muerta y retardo de primer orden, brújula con ruido y retardo
+ * y GPS con ruido a baja frecuencia. Las posiciones se expresan en un
+ * plano local (Este, Norte) en metros.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef SIM_H
+#define SIM_H
+
+#include "pico/stdlib.h"
+#include <stdint.h>
+
+/// @defgroup SIM_STRUCTURES Estructuras del simulador
+/// @{
+
+/**
+ * @brief Estado del vehículo simulado.
+ */
+typedef struct {
+    double east;          ///< Posición real Este en metros
+    double north;         ///< Posición real Norte en metros
+    double heading;       ///< Rumbo real en grados (0-360)
+    double speed_a;       ///< Velocidad de la rueda A en m/s
+    double speed_b;       ///< Velocidad de la rueda B en m/s
+    double compass;       ///< Rumbo medido por la brújula (filtrado, con ruido)
+    double gps_east;      ///< Última posición GPS Este en metros
+    double gps_north;     ///< Última posición GPS Norte en metros
+    uint32_t time_ms;     ///< Tiempo simulado en ms
+    uint32_t next_gps_ms; ///< Tiempo de la próxima medición GPS
+    uint32_t seed;        ///< Estado del generador de ruido
+} sim_vehicle_t;
+
+/// @}
+
+/// @defgroup SIM_FUNCTIONS Funciones del simulador
+/// @{
+
+/**
+ * @brief Inicializa el vehículo detenido en una posición y rumbo.
+ *
+ * @param[out] vehicle Vehículo a inicializar
+ * @param east Posición Este en metros
+ * @param north Posición Norte en metros
+ * @param heading Rumbo en grados
+ * @param seed Semilla del ruido (misma semilla, mismo recorrido)
+ */
+void sim_init(sim_vehicle_t* vehicle, double east, double north, double heading, uint32_t seed);
+
+/**
+ * @brief Avanza la simulación un paso con los PWM dados.
+ *
+ * @param vehicle Vehículo
+ * @param pwm_a PWM del motor A (-255 a 255, negativo hacia atrás)
+ * @param pwm_b PWM del motor B (-255 a 255, negativo hacia atrás)
+ * @param dt Paso de tiempo en segundos
+ */
+void sim_step(sim_vehicle_t* vehicle, int pwm_a, int pwm_b, double dt);
+
+/**
+ * @brief Velocidad en régimen de una rueda para un PWM.
+ *
+ * @param pwm PWM aplicado (negativo hacia atrás)
+ * @param base_pwm PWM base de ese motor (BASE_SPEED_A o BASE_SPEED_B)
+ * @return Velocidad en m/s con el signo del PWM (0 dentro de la zona muerta)
+ */
+double sim_pwm_to_speed(int pwm, int base_pwm);
+
+/**
+ * @brief Velocidad de avance actual del vehículo.
+ *
+ * @param vehicle Vehículo
+ * @return Media de las velocidades de las ruedas en m/s
+ */
+double sim_forward_speed(const sim_vehicle_t* vehicle);
+
+/**
+ * @brief Rumbo desde la última posición GPS hacia un punto.
+ *
+ * @param vehicle Vehículo
+ * @param east Punto Este en metros
+ * @param north Punto Norte en metros
+ * @return Rumbo en grados (0-360)
+ */
+double sim_gps_bearing_to(const sim_vehicle_t* vehicle, double east, double north);
+
+/**
+ * @brief Distancia desde la última posición GPS hasta un punto.
+ *
+ * @param vehicle Vehículo
+ * @param east Punto Este en metros
+ * @param north Punto Norte en metros
+ * @return Distancia en metros
+ */
+double sim_gps_distance_to(const sim_vehicle_t* vehicle, double east, double north);
+
+/// @}
+
+#endif // SIM_H
\ No newline at end of file
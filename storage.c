@@ -0,0 +1,209 @@
+/**
+ * @file storage.c
+ * @brief Implementación del almacenamiento persistente en flash.
+ *
+ * Este módulo reserva sectores al final de la flash para datos de
+ * configuración (geocerca, rutas, etc.), los protege con una cabecera
+ * con CRC32 y los lee directamente desde el espacio XIP.
+ *
+ * Borrar o programar la flash corta el XIP: las operaciones pasan por
+ * flash_safe_execute(), que además de deshabilitar las interrupciones
+ * detiene el núcleo 1 (USB de trace.c) si está en marcha.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "storage.h"
+#include "config.h"
+#include "hardware/flash.h"
+#include "pico/flash.h"
+#include <string.h>
+
+/// @brief Firma que identifica una región con datos válidos ("WLYS")
+#define STORAGE_MAGIC 0x53594C57u
+
+/**
+ * @brief Cabecera al inicio de cada región.
+ */
+typedef struct {
+    uint32_t magic;     ///< Firma STORAGE_MAGIC
+    uint32_t length;    ///< Longitud de los datos en bytes
+    uint32_t crc;       ///< CRC32 de los datos
+    uint32_t reserved;  ///< Reservado (alineación)
+} storage_header_t;
+
+/**
+ * @brief Ubicación de una región dentro de la flash.
+ */
+typedef struct {
+    uint32_t offset;  ///< Desplazamiento desde el inicio de la flash
+    uint32_t size;    ///< Tamaño en bytes (múltiplo de FLASH_SECTOR_SIZE)
+} storage_layout_t;
+
+/// @brief Tabla de regiones (contadas desde el final de la flash)
+static const storage_layout_t layout[STORAGE_REGION_COUNT] = {
+    [STORAGE_REGION_GEOFENCE] = { PICO_FLASH_SIZE_BYTES - 1 * FLASH_SECTOR_SIZE, FLASH_SECTOR_SIZE },
+    [STORAGE_REGION_ROUTE]    = { PICO_FLASH_SIZE_BYTES - 2 * FLASH_SECTOR_SIZE, FLASH_SECTOR_SIZE },
+    [STORAGE_REGION_FAULT]    = { PICO_FLASH_SIZE_BYTES - 3 * FLASH_SECTOR_SIZE, FLASH_SECTOR_SIZE },
+    [STORAGE_REGION_GPS_AID]  = { PICO_FLASH_SIZE_BYTES - 5 * FLASH_SECTOR_SIZE, 2 * FLASH_SECTOR_SIZE },
+    [STORAGE_REGION_COMPASS]  = { PICO_FLASH_SIZE_BYTES - 6 * FLASH_SECTOR_SIZE, FLASH_SECTOR_SIZE },
+    [STORAGE_REGION_STAGING]  = { PICO_FLASH_SIZE_BYTES - 7 * FLASH_SECTOR_SIZE, FLASH_SECTOR_SIZE },
+};
+
+/// @brief Buffer de página para programar la flash
+static uint8_t page_buffer[FLASH_PAGE_SIZE];
+
+/**
+ * @brief Operación de flash ejecutada con el XIP detenido.
+ */
+typedef struct {
+    uint32_t offset;       ///< Desplazamiento desde el inicio de la flash
+    const uint8_t* data;   ///< Página a programar (NULL para borrar)
+    size_t length;         ///< Bytes a borrar o programar
+} flash_op_t;
+
+/**
+ * @brief Borra o programa según la operación (corre sin XIP).
+ */
+static void run_flash_op(void* param) {
+    const flash_op_t* op = (const flash_op_t*)param;
+    if (op->data) {
+        flash_range_program(op->offset, op->data, op->length);
+    } else {
+        flash_range_erase(op->offset, op->length);
+    }
+}
+
+/**
+ * @brief Ejecuta una operación de flash con el otro núcleo y las interrupciones detenidos.
+ *
+ * @return true si la operación se ejecutó
+ */
+static bool flash_op(uint32_t offset, const uint8_t* data, size_t length) {
+    flash_op_t op = { .offset = offset, .data = data, .length = length };
+    return flash_safe_execute(run_flash_op, &op, STORAGE_FLASH_TIMEOUT_MS) == PICO_OK;
+}
+
+uint32_t storage_crc32(const void* data, size_t length) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    uint32_t crc = 0xFFFFFFFFu;
+
+    for (size_t i = 0; i < length; i++) {
+        crc ^= bytes[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+
+    return ~crc;
+}
+
+/**
+ * @brief Programa bytes arbitrarios de una región ya borrada.
+ *
+ * Cada página afectada se programa con 0xFF fuera del rango pedido;
+ * en flash NOR eso deja intactos los bytes ya programados.
+ *
+ * @param area Región
+ * @param position Posición desde el inicio de la región (incluye cabecera)
+ * @param bytes Datos
+ * @param length Número de bytes
+ * @return true si se programaron todas las páginas
+ */
+static bool program_range(const storage_layout_t* area, size_t position,
+                          const uint8_t* bytes, size_t length) {
+    size_t end = position + length;
+
+    for (size_t page = position / FLASH_PAGE_SIZE * FLASH_PAGE_SIZE; page < end;
+         page += FLASH_PAGE_SIZE) {
+        memset(page_buffer, 0xFF, sizeof(page_buffer));
+
+        for (size_t i = 0; i < FLASH_PAGE_SIZE; i++) {
+            size_t pos = page + i;
+            if (pos >= position && pos < end) {
+                page_buffer[i] = bytes[pos - position];
+            }
+        }
+
+        if (!flash_op(area->offset + page, page_buffer, FLASH_PAGE_SIZE)) return false;
+    }
+
+    return true;
+}
+
+bool storage_begin(storage_region_t region, size_t length) {
+    if (region >= STORAGE_REGION_COUNT) return false;
+
+    const storage_layout_t* area = &layout[region];
+    if (length > area->size - sizeof(storage_header_t)) return false;
+
+    size_t total = sizeof(storage_header_t) + length;
+    size_t erase_size = (total + FLASH_SECTOR_SIZE - 1) / FLASH_SECTOR_SIZE * FLASH_SECTOR_SIZE;
+
+    return flash_op(area->offset, NULL, erase_size);
+}
+
+bool storage_program(storage_region_t region, size_t offset, const void* data, size_t length) {
+    if (region >= STORAGE_REGION_COUNT || (!data && length > 0)) return false;
+
+    const storage_layout_t* area = &layout[region];
+    if (offset + length > area->size - sizeof(storage_header_t)) return false;
+
+    return program_range(area, sizeof(storage_header_t) + offset, (const uint8_t*)data, length);
+}
+
+bool storage_commit(storage_region_t region, size_t length, uint32_t crc) {
+    if (region >= STORAGE_REGION_COUNT) return false;
+
+    const storage_layout_t* area = &layout[region];
+    if (length > area->size - sizeof(storage_header_t)) return false;
+
+    // Verificar los datos programados antes de marcarlos como válidos
+    const uint8_t* flash = (const uint8_t*)(XIP_BASE + area->offset);
+    if (storage_crc32(flash + sizeof(storage_header_t), length) != crc) return false;
+
+    storage_header_t header = {
+        .magic = STORAGE_MAGIC,
+        .length = length,
+        .crc = crc,
+        .reserved = 0
+    };
+
+    if (!program_range(area, 0, (const uint8_t*)&header, sizeof(header))) return false;
+
+    // Verificar leyendo desde XIP
+    return storage_read(region, NULL, 0, NULL);
+}
+
+bool storage_write(storage_region_t region, const void* data, size_t length) {
+    if (!data && length > 0) return false;
+
+    return storage_begin(region, length) &&
+           storage_program(region, 0, data, length) &&
+           storage_commit(region, length, storage_crc32(data, length));
+}
+
+bool storage_read(storage_region_t region, void* data, size_t max_length, size_t* length) {
+    if (region >= STORAGE_REGION_COUNT) return false;
+
+    const storage_layout_t* area = &layout[region];
+    const uint8_t* flash = (const uint8_t*)(XIP_BASE + area->offset);
+    const storage_header_t* header = (const storage_header_t*)flash;
+
+    if (header->magic != STORAGE_MAGIC) return false;
+    if (header->length > area->size - sizeof(storage_header_t)) return false;
+    if (storage_crc32(flash + sizeof(storage_header_t), header->length) != header->crc) return false;
+
+    if (data) {
+        if (header->length > max_length) return false;
+        memcpy(data, flash + sizeof(storage_header_t), header->length);
+    }
+
+    if (length) {
+        *length = header->length;
+    }
+
+    return true;
+}
\ No newline at end of file
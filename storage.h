@@ -0,0 +1,118 @@
+/**
+ * @file storage.h
+ * @brief Header del módulo de almacenamiento persistente en flash.
+ *
+ * Define las regiones reservadas al final de la memoria flash y las
+ * funciones para guardar y recuperar bloques de datos protegidos con CRC.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef STORAGE_H
+#define STORAGE_H
+
+#include "pico/stdlib.h"
+#include <stdint.h>
+
+/// @defgroup STORAGE_STRUCTURES Estructuras de almacenamiento
+/// @{
+
+/**
+ * @brief Regiones de flash disponibles para datos persistentes.
+ */
+typedef enum {
+    STORAGE_REGION_GEOFENCE = 0,  ///< Polígonos de la geocerca
+    STORAGE_REGION_ROUTE,         ///< Ruta guardada (registros route_record_t)
+    STORAGE_REGION_FAULT,         ///< Registro de la última falla (fault_record_t)
+    STORAGE_REGION_GPS_AID,       ///< Asistencia de arranque del GPS (dos sectores)
+    STORAGE_REGION_COMPASS,       ///< Desvío aprendido de la brújula
+    STORAGE_REGION_STAGING,       ///< Preparación de cargas por Bluetooth (upload.c)
+    STORAGE_REGION_COUNT          ///< Número de regiones
+} storage_region_t;
+
+/// @}
+
+/// @defgroup STORAGE_FUNCTIONS Funciones de almacenamiento
+/// @{
+
+/**
+ * @brief Guarda un bloque de datos en una región de flash.
+ *
+ * Borra la región y escribe una cabecera (firma, longitud y CRC32)
+ * seguida de los datos. Deshabilita interrupciones durante cada
+ * operación de borrado y programación: un sector de 4 KB tarda ~45 ms en
+ * borrarse y los bytes que lleguen por las UART en ese tiempo se pierden.
+ *
+ * @param region Región destino
+ * @param data Datos a guardar
+ * @param length Número de bytes
+ * @return true si los datos caben en la región y se verificaron
+ */
+bool storage_write(storage_region_t region, const void* data, size_t length);
+
+/**
+ * @brief Inicia una escritura incremental en una región.
+ *
+ * Borra los sectores necesarios para length bytes. La región queda
+ * inválida hasta llamar a storage_commit().
+ *
+ * @param region Región destino
+ * @param length Número total de bytes que se escribirán
+ * @return true si los datos caben en la región
+ */
+bool storage_begin(storage_region_t region, size_t length);
+
+/**
+ * @brief Programa un fragmento de datos en una región ya borrada.
+ *
+ * Los fragmentos pueden llegar en cualquier orden y no necesitan estar
+ * alineados a páginas; los bytes de la página fuera del fragmento se
+ * programan con 0xFF y no se alteran.
+ *
+ * @param region Región destino
+ * @param offset Posición del fragmento dentro de los datos
+ * @param data Datos del fragmento
+ * @param length Número de bytes
+ * @return true si el fragmento cabe en la región
+ */
+bool storage_program(storage_region_t region, size_t offset, const void* data, size_t length);
+
+/**
+ * @brief Completa una escritura incremental escribiendo la cabecera.
+ *
+ * Calcula el CRC32 de los datos ya programados y solo escribe la
+ * cabecera si coincide con el esperado, de modo que una transferencia
+ * incompleta nunca queda marcada como válida.
+ *
+ * @param region Región destino
+ * @param length Número total de bytes escritos
+ * @param crc CRC32 esperado de los datos
+ * @return true si el CRC coincide y la región quedó válida
+ */
+bool storage_commit(storage_region_t region, size_t length, uint32_t crc);
+
+/**
+ * @brief Lee un bloque de datos guardado en una región de flash.
+ *
+ * @param region Región origen
+ * @param[out] data Buffer destino
+ * @param max_length Tamaño del buffer destino
+ * @param[out] length Número de bytes leídos (puede ser NULL)
+ * @return true si la región contiene datos válidos (firma y CRC correctos)
+ */
+bool storage_read(storage_region_t region, void* data, size_t max_length, size_t* length);
+
+/**
+ * @brief Calcula el CRC32 (polinomio IEEE 802.3) de un bloque.
+ *
+ * @param data Datos
+ * @param length Número de bytes
+ * @return CRC32 calculado
+ */
+uint32_t storage_crc32(const void* data, size_t length);
+
+/// @}
+
+#endif // STORAGE_H
\ No newline at end of file
@@ -0,0 +1,487 @@
+/**
+ * @file telemetry.c
+ * @brief Implementación de la telemetría por suscripción.
+ *
+ * Cada canal tiene su periodo y recuerda la última línea enviada para
+ * suprimir repeticiones. La pose se cuantiza (1e-6 grados, 0.1 grados de
+ * rumbo) y se envía como diferencias respecto al último cuadro clave, no
+ * respecto a la muestra anterior, para que una línea perdida no acumule
+ * error en la app.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "telemetry.h"
+#include "bluetooth.h"
+#include "bus.h"
+#include "config.h"
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+
+/// @brief Longitud máxima de una línea de telemetría
+#define LINE_SIZE 96
+
+/**
+ * @brief Estado de un canal de telemetría.
+ */
+typedef struct {
+    uint32_t period_ms;        ///< Periodo de envío (0 = apagado)
+    uint32_t last_ms;          ///< Última vez que se evaluó el canal
+    uint32_t last_sent_ms;     ///< Última vez que se envió una línea
+    char last_line[LINE_SIZE]; ///< Última línea enviada
+} telemetry_state_t;
+
+/**
+ * @brief Pose cuantizada.
+ */
+typedef struct {
+    int32_t lat_e6;   ///< Latitud en 1e-6 grados
+    int32_t lng_e6;   ///< Longitud en 1e-6 grados
+    int32_t hdg_d10;  ///< Rumbo en décimas de grado (0-3599)
+    bool fix;         ///< Fix GPS válido
+    int satellites;   ///< Satélites en uso
+} telemetry_pose_t;
+
+/// @brief Nombres de los canales en los comandos
+static const char* const channel_names[TELEM_CHANNEL_COUNT] = {
+    "POSE", "NAV", "MOT", "PERF", "EV", "BAT"
+};
+
+/// @brief Estado de los canales
+static telemetry_state_t channels[TELEM_CHANNEL_COUNT];
+
+/// @brief Pose actual, cuadro clave y última pose enviada
+static telemetry_pose_t pose;
+static telemetry_pose_t key_pose;
+static telemetry_pose_t sent_pose;
+static bool pose_valid = false;
+static bool key_valid = false;
+static uint32_t key_seq = 0;
+static uint32_t key_time_ms = 0;
+
+/// @brief Datos de navegación actuales
+static bool nav_has_target = false;
+static double nav_target_lat = 0.0;
+static double nav_target_lng = 0.0;
+static double nav_distance = 0.0;
+static double nav_bearing = 0.0;
+static double pose_lat = 0.0;
+static double pose_lng = 0.0;
+static double pose_heading = 0.0;
+
+/// @brief Velocidades de los motores
+static int motor_a = 0;
+static int motor_b = 0;
+
+/// @brief Estado de la batería
+static bool battery_valid = false;
+static double battery_voltage = 0.0;
+static double battery_soc = 0.0;
+static double battery_runtime_min = 0.0;
+
+/// @brief Estadísticas del bucle desde el último PERF
+static uint32_t loop_count = 0;
+static uint64_t loop_total_us = 0;
+static uint32_t loop_max_us = 0;
+static uint32_t loop_overruns = 0;
+
+/// @brief Bytes enviados desde el último PERF
+static uint32_t tx_bytes = 0;
+static uint32_t tx_window_ms = 0;
+
+/// @brief Lector de la cola de eventos (tópico BUS_EVENT)
+static bus_subscriber_t event_subscriber;
+
+/// @brief Tiempo de la última actualización (sello de los eventos)
+static uint32_t last_update_ms = 0;
+
+/**
+ * @brief Envía una línea y la contabiliza.
+ */
+static int send_line(const char* line) {
+    int length = strlen(line);
+    bluetooth_send_string(line);
+    tx_bytes += length;
+    return length;
+}
+
+/**
+ * @brief Envía la línea de un canal salvo que repita la anterior.
+ *
+ * Las líneas repetidas se reenvían igual cada TELEM_KEYFRAME_INTERVAL_MS
+ * para que una app recién conectada reciba el estado.
+ */
+static int send_if_changed(telemetry_state_t* channel, const char* line, uint32_t now_ms) {
+    if (strcmp(line, channel->last_line) == 0 &&
+        now_ms - channel->last_sent_ms < TELEM_KEYFRAME_INTERVAL_MS) {
+        return 0;
+    }
+
+    strncpy(channel->last_line, line, LINE_SIZE - 1);
+    channel->last_line[LINE_SIZE - 1] = '\0';
+    channel->last_sent_ms = now_ms;
+    return send_line(line);
+}
+
+/**
+ * @brief Diferencia de rumbo en décimas de grado en [-1800, 1799].
+ */
+static int32_t heading_delta(int32_t to, int32_t from) {
+    int32_t delta = (to - from) % 3600;
+    if (delta < -1800) delta += 3600;
+    if (delta >= 1800) delta -= 3600;
+    return delta;
+}
+
+/**
+ * @brief Envía la pose como cuadro clave o como diferencia.
+ */
+static int send_pose(uint32_t now_ms) {
+    if (!pose_valid) return 0;
+
+    char line[LINE_SIZE];
+    int32_t dlat = pose.lat_e6 - key_pose.lat_e6;
+    int32_t dlng = pose.lng_e6 - key_pose.lng_e6;
+
+    bool need_key = !key_valid ||
+                    now_ms - key_time_ms >= TELEM_KEYFRAME_INTERVAL_MS ||
+                    pose.fix != key_pose.fix ||
+                    pose.satellites != key_pose.satellites ||
+                    abs(dlat) > TELEM_MAX_DELTA || abs(dlng) > TELEM_MAX_DELTA;
+
+    if (need_key) {
+        key_pose = pose;
+        key_valid = true;
+        key_seq++;
+        key_time_ms = now_ms;
+
+        snprintf(line, sizeof(line), "PK,%lu,%lu,%ld,%ld,%ld,%d,%d\n",
+                 (unsigned long)key_seq, (unsigned long)now_ms,
+                 (long)pose.lat_e6, (long)pose.lng_e6, (long)pose.hdg_d10,
+                 pose.fix ? 1 : 0, pose.satellites);
+    } else {
+        // Sin cambios desde la última línea: nada que enviar
+        if (pose.lat_e6 == sent_pose.lat_e6 && pose.lng_e6 == sent_pose.lng_e6 &&
+            pose.hdg_d10 == sent_pose.hdg_d10) {
+            return 0;
+        }
+
+        snprintf(line, sizeof(line), "PD,%lu,%lu,%ld,%ld,%ld\n",
+                 (unsigned long)key_seq, (unsigned long)(now_ms - key_time_ms),
+                 (long)dlat, (long)dlng,
+                 (long)heading_delta(pose.hdg_d10, key_pose.hdg_d10));
+    }
+
+    sent_pose = pose;
+    channels[TELEM_POSE].last_sent_ms = now_ms;
+    return send_line(line);
+}
+
+/**
+ * @brief Envía la información de navegación (o STATUS sin objetivo).
+ */
+static int send_nav(uint32_t now_ms) {
+    char line[LINE_SIZE];
+
+    if (nav_has_target && pose.fix) {
+        snprintf(line, sizeof(line), "NAV,%.6f,%.6f,%.6f,%.6f,%.1f,%.1f\n",
+                 pose_lat, pose_lng, nav_target_lat, nav_target_lng,
+                 nav_distance, nav_bearing);
+    } else {
+        snprintf(line, sizeof(line), "STATUS,%.1f,0.0,0.0,%d\n",
+                 pose_heading, pose.fix ? 1 : 0);
+    }
+
+    return send_if_changed(&channels[TELEM_NAV], line, now_ms);
+}
+
+/**
+ * @brief Envía las velocidades de los motores.
+ */
+static int send_motors(uint32_t now_ms) {
+    char line[LINE_SIZE];
+    snprintf(line, sizeof(line), "MOT,%d,%d\n", motor_a, motor_b);
+    return send_if_changed(&channels[TELEM_MOTORS], line, now_ms);
+}
+
+/**
+ * @brief Envía la tensión, carga y tiempo restante de la batería.
+ */
+static int send_battery(uint32_t now_ms) {
+    char line[LINE_SIZE];
+    snprintf(line, sizeof(line), "BAT,%ld,%d,%ld\n",
+             lround(battery_voltage * 1000.0),
+             battery_valid ? (int)lround(battery_soc) : -1,
+             battery_valid ? lround(battery_runtime_min) : 0L);
+    return send_if_changed(&channels[TELEM_BATTERY], line, now_ms);
+}
+
+/**
+ * @brief Envía las estadísticas del bucle y reinicia la ventana.
+ */
+static int send_perf(uint32_t now_ms) {
+    char line[LINE_SIZE];
+    uint32_t elapsed = now_ms - tx_window_ms;
+    uint32_t bytes_per_s = elapsed > 0 ? (uint32_t)((uint64_t)tx_bytes * 1000 / elapsed) : 0;
+    uint32_t average = loop_count > 0 ? (uint32_t)(loop_total_us / loop_count) : 0;
+
+    snprintf(line, sizeof(line), "PERF,%lu,%lu,%lu,%lu\n",
+             (unsigned long)average, (unsigned long)loop_max_us,
+             (unsigned long)loop_overruns, (unsigned long)bytes_per_s);
+
+    loop_count = 0;
+    loop_total_us = 0;
+    loop_max_us = 0;
+    loop_overruns = 0;
+    tx_bytes = 0;
+    tx_window_ms = now_ms;
+
+    return send_if_changed(&channels[TELEM_PERF], line, now_ms);
+}
+
+/**
+ * @brief Envía el evento más antiguo de la cola.
+ */
+static int send_event(void) {
+    const telemetry_event_t* event = bus_read_event(&event_subscriber);
+    if (!event) return 0;
+
+    char line[LINE_SIZE];
+    snprintf(line, sizeof(line), "EV,%lu,%s\n", (unsigned long)event->time_ms, event->text);
+    bus_release(&event_subscriber);
+    return send_line(line);
+}
+
+void telemetry_init(void) {
+    memset(channels, 0, sizeof(channels));
+    pose_valid = false;
+    key_valid = false;
+    bus_subscribe(&event_subscriber, BUS_EVENT); // Descarta los eventos pendientes
+    loop_count = 0;
+    loop_total_us = 0;
+    loop_max_us = 0;
+    loop_overruns = 0;
+    tx_bytes = 0;
+    tx_window_ms = 0;
+    nav_has_target = false;
+    motor_a = 0;
+    motor_b = 0;
+    battery_valid = false;
+
+    telemetry_subscribe(TELEM_NAV, TELEM_DEFAULT_NAV_HZ);
+    telemetry_subscribe(TELEM_EVENTS, TELEM_DEFAULT_EVENTS_HZ);
+}
+
+void telemetry_subscribe(telemetry_channel_t channel, double rate_hz) {
+    if (channel >= TELEM_CHANNEL_COUNT) return;
+
+    if (rate_hz <= 0.0) {
+        channels[channel].period_ms = 0;
+        return;
+    }
+
+    if (rate_hz > TELEM_MAX_RATE_HZ) {
+        rate_hz = TELEM_MAX_RATE_HZ;
+    }
+
+    channels[channel].period_ms = (uint32_t)(1000.0 / rate_hz + 0.5);
+    channels[channel].last_line[0] = '\0'; // Reenviar el estado completo
+
+    if (channel == TELEM_POSE) {
+        key_valid = false;
+    }
+}
+
+bool telemetry_handle_command(const char* line) {
+    if (!line) return false;
+
+    char reply[LINE_SIZE];
+
+    if (strcmp(line, "SUB?") == 0) {
+        int length = snprintf(reply, sizeof(reply), "SUBS");
+        for (int i = 0; i < TELEM_CHANNEL_COUNT; i++) {
+            double hz = channels[i].period_ms ? 1000.0 / channels[i].period_ms : 0.0;
+            length += snprintf(reply + length, sizeof(reply) - length, ",%s=%.1f",
+                               channel_names[i], hz);
+        }
+        snprintf(reply + length, sizeof(reply) - length, "\n");
+        send_line(reply);
+        return true;
+    }
+
+    if (strncmp(line, "SUB,", 4) != 0) return false;
+
+    const char* name = line + 4;
+    const char* comma = strchr(name, ',');
+    if (!comma) {
+        send_line("Formato inválido. Usar: SUB,CANAL,HZ\n");
+        return true;
+    }
+
+    for (int i = 0; i < TELEM_CHANNEL_COUNT; i++) {
+        size_t length = strlen(channel_names[i]);
+        if ((size_t)(comma - name) == length && strncmp(name, channel_names[i], length) == 0) {
+            telemetry_subscribe((telemetry_channel_t)i, atof(comma + 1));
+
+            double hz = channels[i].period_ms ? 1000.0 / channels[i].period_ms : 0.0;
+            snprintf(reply, sizeof(reply), "SUB,%s,%.1f\n", channel_names[i], hz);
+            send_line(reply);
+            return true;
+        }
+    }
+
+    send_line("Canal desconocido. Usar: POSE, NAV, MOT, PERF, EV, BAT\n");
+    return true;
+}
+
+void telemetry_set_pose(double lat, double lng, double heading, bool fix, int satellites) {
+    pose_lat = lat;
+    pose_lng = lng;
+    pose_heading = heading;
+
+    pose.lat_e6 = (int32_t)lround(lat * 1e6);
+    pose.lng_e6 = (int32_t)lround(lng * 1e6);
+    pose.hdg_d10 = (int32_t)lround(heading * 10.0) % 3600;
+    if (pose.hdg_d10 < 0) pose.hdg_d10 += 3600;
+    pose.fix = fix;
+    pose.satellites = satellites;
+    pose_valid = true;
+}
+
+void telemetry_set_nav(bool has_target, double target_lat, double target_lng,
+                       double distance, double bearing) {
+    nav_has_target = has_target;
+    nav_target_lat = target_lat;
+    nav_target_lng = target_lng;
+    nav_distance = distance;
+    nav_bearing = bearing;
+}
+
+void telemetry_set_motors(int speed_a, int speed_b) {
+    motor_a = speed_a;
+    motor_b = speed_b;
+}
+
+void telemetry_set_battery(bool valid, double voltage, double soc, double runtime_min) {
+    battery_valid = valid;
+    battery_voltage = voltage;
+    battery_soc = soc;
+    battery_runtime_min = runtime_min;
+}
+
+void telemetry_record_loop(uint32_t work_us) {
+    loop_count++;
+    loop_total_us += work_us;
+    if (work_us > loop_max_us) loop_max_us = work_us;
+    if (work_us > LOOP_INTERVAL_MS * 1000) loop_overruns++;
+}
+
+bool telemetry_event(const char* text) {
+    if (!text || channels[TELEM_EVENTS].period_ms == 0) return false;
+
+    telemetry_event_t* event = bus_claim_event();
+    if (!event) return false;
+
+    event->time_ms = last_update_ms;
+    strncpy(event->text, text, TELEM_EVENT_TEXT_SIZE - 1);
+    event->text[TELEM_EVENT_TEXT_SIZE - 1] = '\0';
+    event->text[strcspn(event->text, "\r\n")] = '\0';
+    bus_publish(BUS_EVENT);
+    return true;
+}
+
+int telemetry_update(uint32_t now_ms) {
+    int sent = 0;
+    last_update_ms = now_ms;
+
+    for (int i = 0; i < TELEM_CHANNEL_COUNT; i++) {
+        telemetry_state_t* channel = &channels[i];
+        if (channel->period_ms == 0 || now_ms - channel->last_ms < channel->period_ms) {
+            continue;
+        }
+        channel->last_ms = now_ms;
+
+        switch ((telemetry_channel_t)i) {
+            case TELEM_POSE:    sent += send_pose(now_ms); break;
+            case TELEM_NAV:     sent += send_nav(now_ms); break;
+            case TELEM_MOTORS:  sent += send_motors(now_ms); break;
+            case TELEM_PERF:    sent += send_perf(now_ms); break;
+            case TELEM_EVENTS:  sent += send_event(); break;
+            case TELEM_BATTERY: sent += send_battery(now_ms); break;
+            default: break;
+        }
+    }
+
+    return sent;
+}
+
+void telemetry_test(void) {
+    printf("=== PRUEBA TELEMETRÍA (SIMULACIÓN) ===\n");
+
+    const double lat0 = 6.267300;
+    const double lng0 = -75.568800;
+    const double meters_per_deg = 6371000 * M_PI / 180.0;
+
+    telemetry_init();
+    telemetry_handle_command("SUB,POSE,10");
+    telemetry_handle_command("SUB,MOT,2");
+    telemetry_handle_command("SUB,PERF,0.2");
+
+    uint32_t delta_bytes = 0;
+    uint32_t full_bytes = 0;
+    uint32_t stopped_bytes = 0;
+    double x = 0.0, y = 0.0, fix_x = 0.0, fix_y = 0.0;
+
+    // 30 s avanzando a 0.5 m/s girando suavemente y 30 s detenido
+    for (uint32_t t = 0; t < 60000; t += LOOP_INTERVAL_MS) {
+        bool moving = t < 30000;
+        double heading = fmod(90.0 + t / 1000.0 * 3.0 * (moving ? 1.0 : 0.0) + 360.0, 360.0);
+
+        if (moving) {
+            x += 0.5 * sin(heading * M_PI / 180.0) * LOOP_INTERVAL_MS / 1000.0;
+            y += 0.5 * cos(heading * M_PI / 180.0) * LOOP_INTERVAL_MS / 1000.0;
+        }
+
+        // El GPS entrega una posición por segundo
+        if (t % 1000 == 0) {
+            fix_x = x;
+            fix_y = y;
+        }
+
+        double lat = lat0 + fix_y / meters_per_deg;
+        double lng = lng0 + fix_x / (meters_per_deg * cos(lat0 * M_PI / 180.0));
+        telemetry_set_pose(lat, lng, heading, true, 8);
+        telemetry_set_nav(true, lat0, lng0 + 0.001, 100.0 - x, 90.0);
+        telemetry_set_motors(moving ? 180 : 0, moving ? 190 : 0);
+        telemetry_record_loop(1200 + (t % 700));
+
+        if (t == 30000) {
+            telemetry_event("Objetivo alcanzado");
+        }
+
+        uint32_t bytes = telemetry_update(t);
+        delta_bytes += bytes;
+        if (!moving) stopped_bytes += bytes;
+
+        // Referencia: línea completa de pose a 10 Hz
+        if (t % 100 == 0) {
+            char line[LINE_SIZE];
+            full_bytes += snprintf(line, sizeof(line), "POSE,%.6f,%.6f,%.1f,1,8\n",
+                                   lat, lng, heading);
+        }
+    }
+
+    printf("Pose 10 Hz + NAV 1 Hz + MOT 2 Hz + PERF 0.2 Hz durante 60 s\n");
+    printf("  Con deltas y supresión: %lu B (%.0f B/s)\n",
+           (unsigned long)delta_bytes, delta_bytes / 60.0);
+    printf("  Detenido (30 s): %.0f B/s\n", stopped_bytes / 30.0);
+    printf("  Solo pose en líneas completas: %lu B (%.0f B/s)\n",
+           (unsigned long)full_bytes, full_bytes / 60.0);
+    printf("  Capacidad a %d baudios: %d B/s\n", BT_BAUD_RATE, BT_BAUD_RATE / 10);
+
+    telemetry_init();
+    printf("Prueba de telemetría completada\n");
+}
\ No newline at end of file
@@ -0,0 +1,165 @@
+/**
+ * @file telemetry.h
+ * @brief Header de la telemetría por suscripción.
+ *
+ * La app se suscribe a canales (pose, nav, motores, rendimiento y eventos)
+ * cada uno con su propia frecuencia. Los valores sin cambios no se envían
+ * y la pose se codifica como diferencias respecto al último cuadro clave.
+ *
+ * Comandos (App -> Robot):
+ * - "SUB,<canal>,<hz>": suscribe un canal (POSE, NAV, MOT, PERF, EV, BAT); 0 lo apaga
+ * - "SUB?": responde "SUBS,POSE=<hz>,NAV=<hz>,..."
+ *
+ * Mensajes (Robot -> App):
+ * - "PK,<k>,<t_ms>,<lat_e6>,<lng_e6>,<rumbo_d10>,<fix>,<sats>": cuadro clave k
+ * - "PD,<k>,<dt_ms>,<dlat>,<dlng>,<drumbo>": diferencia respecto al cuadro k
+ * - "NAV,<lat>,<lng>,<lat_obj>,<lng_obj>,<dist>,<rumbo>" o
+ *   "STATUS,<rumbo>,0,0,<fix>" sin objetivo
+ * - "MOT,<vel_a>,<vel_b>"
+ * - "PERF,<bucle_prom_us>,<bucle_max_us>,<excesos>,<tx_bytes_s>"
+ * - "EV,<t_ms>,<texto>"
+ * - "BAT,<tension_mv>,<carga_pct>,<restante_min>" (carga -1 sin batería)
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "pico/stdlib.h"
+#include <stdint.h>
+
+/// @defgroup TELEMETRY_STRUCTURES Estructuras de telemetría
+/// @{
+
+/**
+ * @brief Canales de telemetría.
+ */
+typedef enum {
+    TELEM_POSE = 0,      ///< Posición y rumbo (delta desde cuadro clave)
+    TELEM_NAV,           ///< Objetivo, distancia y rumbo de navegación
+    TELEM_MOTORS,        ///< Velocidades aplicadas a los motores
+    TELEM_PERF,          ///< Tiempos del bucle principal y ancho de banda
+    TELEM_EVENTS,        ///< Eventos (cambios de estado, llegadas, alarmas)
+    TELEM_BATTERY,       ///< Tensión, carga y tiempo restante de la batería
+    TELEM_CHANNEL_COUNT  ///< Número de canales
+} telemetry_channel_t;
+
+/// @brief Texto de un evento con su terminador
+#define TELEM_EVENT_TEXT_SIZE 41
+
+/**
+ * @brief Evento encolado (mensaje del tópico BUS_EVENT).
+ */
+typedef struct {
+    uint32_t time_ms;                    ///< Momento en que ocurrió
+    char text[TELEM_EVENT_TEXT_SIZE];    ///< Texto del evento
+} telemetry_event_t;
+
+/// @}
+
+/// @defgroup TELEMETRY_FUNCTIONS Funciones de telemetría
+/// @{
+
+/**
+ * @brief Reinicia las suscripciones a sus valores por defecto.
+ *
+ * Por defecto solo están activos NAV (TELEM_DEFAULT_NAV_HZ) y eventos.
+ */
+void telemetry_init(void);
+
+/**
+ * @brief Procesa los comandos de suscripción.
+ *
+ * @param line Línea recibida por Bluetooth
+ * @return true si la línea era un comando de telemetría
+ */
+bool telemetry_handle_command(const char* line);
+
+/**
+ * @brief Cambia la frecuencia de un canal.
+ *
+ * @param channel Canal
+ * @param rate_hz Frecuencia en Hz (0 apaga el canal)
+ */
+void telemetry_subscribe(telemetry_channel_t channel, double rate_hz);
+
+/**
+ * @brief Actualiza la pose actual del robot.
+ *
+ * @param lat Latitud
+ * @param lng Longitud
+ * @param heading Rumbo en grados
+ * @param fix true si el fix GPS es válido
+ * @param satellites Número de satélites
+ */
+void telemetry_set_pose(double lat, double lng, double heading, bool fix, int satellites);
+
+/**
+ * @brief Actualiza los datos de navegación.
+ *
+ * @param has_target true si hay un objetivo activo
+ * @param target_lat Latitud del objetivo
+ * @param target_lng Longitud del objetivo
+ * @param distance Distancia al objetivo en metros
+ * @param bearing Rumbo al objetivo en grados
+ */
+void telemetry_set_nav(bool has_target, double target_lat, double target_lng,
+                       double distance, double bearing);
+
+/**
+ * @brief Actualiza las velocidades aplicadas a los motores.
+ *
+ * @param speed_a Velocidad del motor A (0 si detenido)
+ * @param speed_b Velocidad del motor B (0 si detenido)
+ */
+void telemetry_set_motors(int speed_a, int speed_b);
+
+/**
+ * @brief Actualiza el estado de la batería.
+ *
+ * @param valid true si hay batería medida
+ * @param voltage Tensión del paquete en V
+ * @param soc Estado de carga en %
+ * @param runtime_min Minutos restantes estimados
+ */
+void telemetry_set_battery(bool valid, double voltage, double soc, double runtime_min);
+
+/**
+ * @brief Registra la duración de una iteración del bucle principal.
+ *
+ * @param work_us Tiempo de trabajo de la iteración en microsegundos
+ */
+void telemetry_record_loop(uint32_t work_us);
+
+/**
+ * @brief Encola un evento para el canal EV.
+ *
+ * @param text Texto del evento (se trunca a 40 caracteres)
+ * @return false si la cola está llena o el canal está apagado
+ */
+bool telemetry_event(const char* text);
+
+/**
+ * @brief Envía los mensajes de los canales cuyo periodo se cumplió.
+ *
+ * Debe llamarse una vez por iteración del bucle principal.
+ *
+ * @param now_ms Tiempo actual en ms
+ * @return Número de bytes enviados
+ */
+int telemetry_update(uint32_t now_ms);
+
+/**
+ * @brief Función de prueba de la telemetría.
+ *
+ * Simula un recorrido con pose a 10 Hz y compara los bytes por segundo
+ * con la codificación delta frente a líneas completas.
+ */
+void telemetry_test(void);
+
+/// @}
+
+#endif // TELEMETRY_H
\ No newline at end of file
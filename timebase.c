@@ -0,0 +1,284 @@
+/**
+ * @file timebase.c
+ * @brief Implementación de la base de tiempo disciplinada por el PPS del GPS.
+ *
+ * La base de tiempo es una recta sobre time_us_64(): un ancla (última
+ * captura local de un flanco PPS y su valor disciplinado) y un error de
+ * frecuencia en partes por mil millones. Cada flanco aceptado avanza el
+ * ancla un número entero de segundos; el desvío entre la predicción y ese
+ * número corrige el error de frecuencia con una ganancia pequeña, de modo
+ * que un flanco ruidoso no mueve el reloj más de unos microsegundos.
+ *
+ * Los flancos que no caen cerca de un segundo entero se descartan. Tras
+ * TIMEBASE_LOCK_PULSES descartes seguidos se asume que el ancla era un
+ * flanco falso y se vuelve a anclar sin salto en el reloj.
+ *
+ * El ancla es de 64 bits y la actualiza la interrupción del PPS en el
+ * núcleo 0, mientras trace.c sella registros en el núcleo 1. Deshabilitar
+ * las interrupciones solo protege al núcleo propio, así que la recta se
+ * lee y se escribe con un spinlock del RP2040.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "timebase.h"
+#include "gps.h"
+#include "config.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/// @brief Microsegundos por segundo
+#define US_PER_S 1000000LL
+
+/// @brief Milisegundos por día
+#define MS_PER_DAY 86400000LL
+
+/// @brief Estado de inicialización
+static bool initialized = false;
+
+/// @brief Spinlock del ancla, la frecuencia y los contadores (NULL antes de timebase_init())
+static spin_lock_t* volatile lock = NULL;
+
+/// @brief Ancla de la recta: captura local del último flanco y su valor disciplinado
+static volatile uint64_t anchor_local = 0;
+static volatile uint64_t anchor_time = 0;
+
+/// @brief Error de frecuencia estimado en partes por mil millones (+ = el cristal adelanta)
+static volatile int32_t rate_ppb = 0;
+
+/// @brief Contadores de la disciplina
+static volatile bool anchored = false;
+static volatile uint32_t consecutive = 0;
+static volatile uint32_t misses = 0;
+static volatile uint32_t pulses = 0;
+static volatile uint32_t rejected = 0;
+static volatile int32_t residual_us = 0;
+
+/// @brief Asociación entre un flanco y el segundo UTC de su sentencia GPS
+static bool utc_valid = false;
+static uint32_t utc_second = 0;
+static uint64_t utc_stamp = 0;
+
+/**
+ * @brief Excluye a la interrupción del PPS y al otro núcleo mientras se usa la recta.
+ *
+ * Antes de timebase_init() no hay interrupción del PPS que mueva el ancla:
+ * basta con deshabilitar las interrupciones.
+ *
+ * @param[out] irq_state Estado de las interrupciones a restaurar
+ * @return Spinlock tomado (NULL si todavía no hay)
+ */
+static spin_lock_t* lock_anchor(uint32_t* irq_state) {
+    spin_lock_t* held = lock;
+    *irq_state = held ? spin_lock_blocking(held) : save_and_disable_interrupts();
+    return held;
+}
+
+/**
+ * @brief Libera lo tomado por lock_anchor().
+ */
+static void unlock_anchor(spin_lock_t* held, uint32_t irq_state) {
+    if (held) {
+        spin_unlock(held, irq_state);
+    } else {
+        restore_interrupts(irq_state);
+    }
+}
+
+/**
+ * @brief Aplica la recta a una captura local (llamar con la recta tomada).
+ */
+static uint64_t convert(uint64_t local_us) {
+    int64_t dt = (int64_t)(local_us - anchor_local);
+    return anchor_time + dt - dt * rate_ppb / 1000000000LL;
+}
+
+/**
+ * @brief Indica si el PPS está enganchado (llamar con la recta tomada).
+ */
+static bool is_locked(uint64_t local_us) {
+    return anchored && consecutive >= TIMEBASE_LOCK_PULSES &&
+           local_us - anchor_local < (uint64_t)TIMEBASE_LOCK_TIMEOUT_MS * 1000;
+}
+
+/**
+ * @brief Interrupción del flanco de subida del PPS.
+ */
+static void on_pps(void) {
+    if (!(gpio_get_irq_event_mask(TIMEBASE_PPS_PIN) & GPIO_IRQ_EDGE_RISE)) return;
+    gpio_acknowledge_irq(TIMEBASE_PPS_PIN, GPIO_IRQ_EDGE_RISE);
+
+    uint64_t local = time_us_64();
+    uint32_t irq_state = spin_lock_blocking(lock);
+    uint64_t predicted = convert(local);
+
+    if (!anchored || misses >= TIMEBASE_LOCK_PULSES) {
+        // Primer flanco (o ancla falsa): continuar el reloj desde aquí
+        anchor_time = predicted;
+        anchor_local = local;
+        anchored = true;
+        consecutive = 1;
+        misses = 0;
+        pulses++;
+        spin_unlock(lock, irq_state);
+        return;
+    }
+
+    int64_t elapsed = (int64_t)(predicted - anchor_time);
+    int64_t seconds = (elapsed + US_PER_S / 2) / US_PER_S;
+    int64_t residual = elapsed - seconds * US_PER_S;
+
+    if (seconds < 1 || llabs(residual) > seconds * TIMEBASE_MAX_PPM) {
+        rejected++;
+        misses++;
+        spin_unlock(lock, irq_state);
+        return;
+    }
+
+    // Corrección del error de frecuencia (residual en µs por cada segundo)
+    rate_ppb += (int32_t)(residual * 1000 / seconds / TIMEBASE_RATE_GAIN);
+    if (rate_ppb > TIMEBASE_MAX_PPM * 1000) rate_ppb = TIMEBASE_MAX_PPM * 1000;
+    if (rate_ppb < -TIMEBASE_MAX_PPM * 1000) rate_ppb = -TIMEBASE_MAX_PPM * 1000;
+
+    anchor_time += seconds * US_PER_S;
+    anchor_local = local;
+    residual_us = (int32_t)residual;
+    consecutive = (seconds > TIMEBASE_REANCHOR_S) ? 1 : consecutive + 1;
+    misses = 0;
+    pulses++;
+    spin_unlock(lock, irq_state);
+}
+
+void timebase_init(void) {
+    if (initialized) return;
+
+    gpio_init(TIMEBASE_PPS_PIN);
+    gpio_set_dir(TIMEBASE_PPS_PIN, GPIO_IN);
+    gpio_pull_down(TIMEBASE_PPS_PIN);
+
+    // Antes de habilitar el PPS: la interrupción siempre encuentra el spinlock
+    lock = spin_lock_instance((uint)spin_lock_claim_unused(true));
+
+    // Manejador propio del pin: la devolución de llamada GPIO es de los encoders
+    gpio_add_raw_irq_handler(TIMEBASE_PPS_PIN, on_pps);
+    gpio_set_irq_enabled(TIMEBASE_PPS_PIN, GPIO_IRQ_EDGE_RISE, true);
+    irq_set_enabled(IO_IRQ_BANK0, true);
+
+    initialized = true;
+}
+
+uint64_t timebase_from_local(uint64_t local_us) {
+    uint32_t irq_state;
+    spin_lock_t* held = lock_anchor(&irq_state);
+    uint64_t time = convert(local_us);
+    unlock_anchor(held, irq_state);
+    return time;
+}
+
+uint64_t timebase_now_us(void) {
+    return timebase_from_local(time_us_64());
+}
+
+uint64_t timebase_gps_epoch(uint32_t utc_second_of_day, uint64_t arrival_us) {
+    uint32_t irq_state;
+    spin_lock_t* held = lock_anchor(&irq_state);
+    bool locked = is_locked(time_us_64());
+    uint64_t edge = anchor_time;
+    unlock_anchor(held, irq_state);
+
+    // La sentencia llega entre 100 y 500 ms después del flanco de su segundo
+    if (!locked || arrival_us < edge || arrival_us - edge >= US_PER_S) {
+        return arrival_us;
+    }
+
+    utc_second = utc_second_of_day;
+    utc_stamp = edge;
+    utc_valid = true;
+    return edge;
+}
+
+bool timebase_utc_ms(uint64_t stamp_us, uint32_t* ms_of_day) {
+    if (!utc_valid || !ms_of_day) return false;
+
+    int64_t offset_ms = (int64_t)(stamp_us - utc_stamp);
+    offset_ms = (offset_ms >= 0) ? offset_ms / 1000 : -((999 - offset_ms) / 1000);
+
+    int64_t ms = ((int64_t)utc_second * 1000 + offset_ms) % MS_PER_DAY;
+    if (ms < 0) ms += MS_PER_DAY;
+    *ms_of_day = (uint32_t)ms;
+    return true;
+}
+
+timebase_status_t timebase_get_status(void) {
+    timebase_status_t status = {0};
+
+    uint32_t irq_state;
+    spin_lock_t* held = lock_anchor(&irq_state);
+    uint64_t local = time_us_64();
+    status.locked = is_locked(local);
+    status.pulses = pulses;
+    status.rejected = rejected;
+    status.rate_ppm = rate_ppb / 1000.0;
+    status.residual_us = residual_us;
+    status.since_pps_ms = anchored ? (uint32_t)((local - anchor_local) / 1000) : UINT32_MAX;
+    unlock_anchor(held, irq_state);
+
+    return status;
+}
+
+void timebase_test(void) {
+    printf("=== PRUEBA BASE DE TIEMPO ===\n");
+    printf("PPS del NEO-6M en GPIO %d (el LED del módulo parpadea con fix)\n", TIMEBASE_PPS_PIN);
+
+    if (!gps_init()) {
+        printf("ERROR: No se pudo inicializar el GPS\n");
+        return;
+    }
+    timebase_init();
+
+    uint32_t last_pulses = 0;
+    uint64_t last_epoch = 0;
+    uint32_t last_report_ms = 0;
+
+    while (true) {
+        gps_update();
+        gps_data_t data = gps_get_data();
+
+        // Latencia de la sentencia: llegada (ahora) menos la época del fix
+        if (data.timestamp_us != last_epoch) {
+            last_epoch = data.timestamp_us;
+            uint32_t utc_ms = 0;
+            int32_t latency_ms = (int32_t)((int64_t)(timebase_now_us() - data.timestamp_us) / 1000);
+            if (timebase_utc_ms(data.timestamp_us, &utc_ms)) {
+                printf("GGA %s: época %02lu:%02lu:%02lu.%03lu UTC, llegó %ld ms después\n",
+                       data.time, (unsigned long)(utc_ms / 3600000), (unsigned long)(utc_ms / 60000 % 60),
+                       (unsigned long)(utc_ms / 1000 % 60), (unsigned long)(utc_ms % 1000), (long)latency_ms);
+            } else {
+                printf("GGA %s: sin PPS, sellada a la llegada\n", data.time);
+            }
+        }
+
+        uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+        if (now_ms - last_report_ms >= 1000) {
+            last_report_ms = now_ms;
+            timebase_status_t status = timebase_get_status();
+            if (status.pulses == last_pulses && status.since_pps_ms > TIMEBASE_LOCK_TIMEOUT_MS) {
+                printf("Sin PPS (%lu flancos aceptados, %lu descartados)\n",
+                       (unsigned long)status.pulses, (unsigned long)status.rejected);
+            } else {
+                printf("PPS %s: flancos=%lu descartados=%lu error=%+.2f ppm desvío=%+ld µs\n",
+                       status.locked ? "enganchado" : "adquiriendo",
+                       (unsigned long)status.pulses, (unsigned long)status.rejected,
+                       status.rate_ppm, (long)status.residual_us);
+            }
+            last_pulses = status.pulses;
+        }
+
+        sleep_ms(10);
+    }
+}
\ No newline at end of file
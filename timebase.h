@@ -0,0 +1,116 @@
+/**
+ * @file timebase.h
+ * @brief Header de la base de tiempo común disciplinada por el PPS del GPS.
+ *
+ * Todas las muestras (GPS, brújula, encoders, comandos Bluetooth) se sellan
+ * en el momento de su captura con un reloj de microsegundos común. El reloj
+ * es el temporizador del RP2040 corregido con el pulso por segundo (PPS)
+ * del NEO-6M: cada flanco marca el inicio exacto de un segundo GPS, de modo
+ * que se estima y se compensa el error de frecuencia del cristal y los
+ * flancos quedan separados exactamente 1 000 000 µs en la base de tiempo.
+ *
+ * Sin PPS el reloj sigue al temporizador (en retención con el último error
+ * de frecuencia estimado). Las interrupciones guardan time_us_64() y lo
+ * convierten después con timebase_from_local().
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef TIMEBASE_H
+#define TIMEBASE_H
+
+#include "pico/stdlib.h"
+#include <stdint.h>
+
+/// @defgroup TIMEBASE_STRUCTURES Estructuras de la base de tiempo
+/// @{
+
+/**
+ * @brief Estado de la disciplina por PPS.
+ */
+typedef struct {
+    bool locked;              ///< PPS presente y estable
+    uint32_t pulses;          ///< Flancos aceptados
+    uint32_t rejected;        ///< Flancos descartados (ruido o saltos)
+    double rate_ppm;          ///< Error de frecuencia del cristal estimado (+ = adelanta)
+    int32_t residual_us;      ///< Desvío del último flanco respecto a la predicción
+    uint32_t since_pps_ms;    ///< Tiempo desde el último flanco aceptado
+} timebase_status_t;
+
+/// @}
+
+/// @defgroup TIMEBASE_FUNCTIONS Funciones de la base de tiempo
+/// @{
+
+/**
+ * @brief Configura la interrupción del pin PPS.
+ *
+ * Usa un manejador propio del pin, así que convive con la interrupción de
+ * los encoders. Reserva un spinlock del RP2040 para la recta. Llamadas
+ * repetidas no hacen nada.
+ */
+void timebase_init(void);
+
+/**
+ * @brief Tiempo actual en la base de tiempo.
+ *
+ * Se puede llamar desde los dos núcleos.
+ *
+ * @return Microsegundos disciplinados
+ */
+uint64_t timebase_now_us(void);
+
+/**
+ * @brief Convierte una captura de time_us_64() a la base de tiempo.
+ *
+ * Pensada para sellos tomados en interrupciones; válida para capturas
+ * recientes (la corrección usa el último flanco PPS).
+ *
+ * @param local_us Valor de time_us_64() en la captura
+ * @return Microsegundos disciplinados
+ */
+uint64_t timebase_from_local(uint64_t local_us);
+
+/**
+ * @brief Sello de la época de un fix GPS.
+ *
+ * La posición de una sentencia corresponde al segundo marcado por el
+ * último flanco PPS, no al momento en que llegó por la UART. Con PPS
+ * enganchado devuelve ese flanco y asocia el segundo UTC para
+ * timebase_utc_ms(); sin PPS devuelve el momento de llegada.
+ *
+ * @param utc_second_of_day Segundo UTC del día indicado en la sentencia
+ * @param arrival_us Sello de la llegada de la sentencia
+ * @return Sello de la época del fix
+ */
+uint64_t timebase_gps_epoch(uint32_t utc_second_of_day, uint64_t arrival_us);
+
+/**
+ * @brief Convierte un sello a milisegundos UTC del día.
+ *
+ * @param stamp_us Sello en la base de tiempo
+ * @param[out] ms_of_day Milisegundos desde las 00:00 UTC
+ * @return true si ya hay una asociación PPS-UTC
+ */
+bool timebase_utc_ms(uint64_t stamp_us, uint32_t* ms_of_day);
+
+/**
+ * @brief Obtiene el estado de la disciplina.
+ *
+ * @return Copia del estado
+ */
+timebase_status_t timebase_get_status(void);
+
+/**
+ * @brief Función de prueba de la base de tiempo.
+ *
+ * Muestra el enganche al PPS, el error de frecuencia, el desvío de cada
+ * flanco y la latencia de las sentencias GPS respecto a su época.
+ */
+void timebase_test(void);
+
+/// @}
+
+#endif // TIMEBASE_H
\ No newline at end of file
@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+"""
+Latencia de punta a punta del enlace Bluetooth de WALLY-S.
+
+Envía PING,<seq>,<t_ms> por el puerto serie y mide el tiempo hasta el
+PONG del robot (link.c lo devuelve desde el bucle de integración, así que
+el RTT incluye la UART, la interrupción de recepción y la iteración del
+bucle). También contesta los PING del robot para que la supervisión del
+enlace no lo dé por perdido.
+
+Sirve con el pty de la compilación SIL (sil/) o con el puerto del HC-05
+emparejado (/dev/rfcomm0). El robot debe estar en la integración completa
+(opción 6 del menú).
+
+Uso:
+  bt_latency.py                                 (/tmp/wally-bt, 10 Hz, 30 s)
+  bt_latency.py --port /dev/rfcomm0 --rate 20 --duration 60
+  bt_latency.py --target 6.2675,-75.5689        (además fija un objetivo)
+"""
+
+import argparse
+import os
+import select
+import sys
+import termios
+import time
+import tty
+
+
+def open_serial(path, baud):
+    """Abre el puerto en modo crudo (también sirve para un pty)."""
+    fd = os.open(path, os.O_RDWR | os.O_NOCTTY | os.O_NONBLOCK)
+    tty.setraw(fd)
+    attrs = termios.tcgetattr(fd)
+    speed = getattr(termios, "B%d" % baud, None)
+    if speed is not None:
+        attrs[4] = attrs[5] = speed
+        termios.tcsetattr(fd, termios.TCSANOW, attrs)
+    return fd
+
+
+def percentile(values, fraction):
+    """Percentil por el rango más cercano (values ordenados)."""
+    if not values:
+        return float("nan")
+    index = min(len(values) - 1, max(0, int(round(fraction * len(values) + 0.5)) - 1))
+    return values[index]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", default="/tmp/wally-bt", help="puerto serie o pty del robot")
+    parser.add_argument("--baud", type=int, default=115200, help="velocidad (BT_TARGET_BAUD)")
+    parser.add_argument("--rate", type=float, default=10.0, help="PING por segundo")
+    parser.add_argument("--duration", type=float, default=30.0, help="duración en segundos")
+    parser.add_argument("--timeout", type=float, default=2.0, help="PING sin PONG tras N s = perdido")
+    parser.add_argument("--target", help="LAT,LNG enviado al inicio como objetivo")
+    parser.add_argument("--verbose", action="store_true", help="muestra las demás líneas del robot")
+    args = parser.parse_args()
+
+    fd = open_serial(args.port, args.baud)
+    start = time.monotonic()
+
+    def now_ms():
+        return int((time.monotonic() - start) * 1000)
+
+    if args.target:
+        os.write(fd, (args.target + "\n").encode())
+
+    pending = {}      # seq -> instante de envío
+    rtts = []
+    lost = 0
+    answered = 0
+    sequence = 0
+    buffer = b""
+    period = 1.0 / args.rate
+    next_ping = time.monotonic()
+    end = start + args.duration
+
+    while time.monotonic() < end:
+        now = time.monotonic()
+        if now >= next_ping:
+            sequence += 1
+            pending[sequence] = now
+            os.write(fd, ("PING,%d,%d\n" % (sequence, now_ms())).encode())
+            next_ping += period
+
+        ready, _, _ = select.select([fd], [], [], max(0.0, min(next_ping, end) - time.monotonic()))
+        if ready:
+            try:
+                buffer += os.read(fd, 4096)
+            except BlockingIOError:
+                pass
+
+        while b"\n" in buffer:
+            raw, buffer = buffer.split(b"\n", 1)
+            line = raw.decode(errors="replace").strip()
+            fields = line.split(",")
+
+            if fields[0] == "PONG" and len(fields) >= 2 and fields[1].isdigit():
+                sent = pending.pop(int(fields[1]), None)
+                if sent is not None:
+                    rtts.append((time.monotonic() - sent) * 1000.0)
+            elif fields[0] == "PING" and len(fields) >= 2:
+                # Supervisión del robot: se devuelve tal cual
+                os.write(fd, ("PONG," + ",".join(fields[1:]) + "\n").encode())
+                answered += 1
+            elif args.verbose and line:
+                print("<<", line)
+
+        expired = [seq for seq, sent in pending.items() if time.monotonic() - sent > args.timeout]
+        for seq in expired:
+            del pending[seq]
+            lost += 1
+
+    lost += len(pending)
+    os.close(fd)
+
+    rtts.sort()
+    print("PING enviados: %d, PONG: %d, perdidos: %d (%.1f%%)" %
+          (sequence, len(rtts), lost, 100.0 * lost / max(1, sequence)))
+    print("PING del robot contestados: %d" % answered)
+    if rtts:
+        print("RTT ms: min %.2f  p50 %.2f  p90 %.2f  p99 %.2f  max %.2f  media %.2f" %
+              (rtts[0], percentile(rtts, 0.5), percentile(rtts, 0.9), percentile(rtts, 0.99),
+               rtts[-1], sum(rtts) / len(rtts)))
+    return 0 if rtts else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
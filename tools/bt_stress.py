@@ -0,0 +1,372 @@
+#!/usr/bin/env python3
+"""
+Prueba de carga del enlace Bluetooth de WALLY-S: hace de app del teléfono.
+
+Envía a un ritmo configurable, en ráfagas, una mezcla de objetivos
+(LAT,LNG) y posiciones del modo Follow Me (F,LAT,LNG,T_MS) alrededor de
+un origen, con una fracción de líneas malformadas que el firmware debe
+rechazar. Mide:
+
+- Latencia de confirmación: de cada objetivo a su "Objetivo establecido"
+  (o "Formato inválido" si era malformado) y de los PING de sondeo a su
+  PONG. Las respuestas llegan en orden, así que se emparejan en cola.
+- Comandos perdidos: respuestas que no llegan y, con la consulta BT? al
+  principio y al final, líneas enviadas que bluetooth_read_line() nunca
+  entregó (incluye las F, que no tienen respuesta) y bytes descartados
+  con el buffer de recepción lleno.
+- Tiempo del bucle: suscripción a PERF, en reposo y con carga (media,
+  máximo y ciclos que superan LOOP_INTERVAL_MS).
+
+Cada objetivo apaga el Follow Me: con --follow 1 solo se envían F y se
+mide follow_feed(). Al terminar se envía STOP.
+
+Sirve con el pty de la compilación SIL (sil/) o con el puerto del HC-05
+emparejado (/dev/rfcomm0). El robot debe estar en la integración completa
+(opción 6 del menú).
+
+Uso:
+  bt_stress.py                                  (/tmp/wally-bt, 50 líneas/s, 30 s)
+  bt_stress.py --rate 400 --burst 20 --malformed 0.2
+  bt_stress.py --follow 1 --rate 20 --port /dev/rfcomm0
+"""
+
+import argparse
+import collections
+import math
+import os
+import random
+import select
+import sys
+import termios
+import time
+import tty
+
+# Respuestas del bucle de integración a un objetivo
+TARGET_ACKS = ("Objetivo establecido", "Objetivo fuera de la geocerca")
+MALFORMED_ACKS = ("Formato inválido. Usar: LAT,LNG",)
+ACK_LINES = set(TARGET_ACKS + MALFORMED_ACKS +
+                ("Follow Me activado", "Navegación detenida"))
+
+EARTH_RADIUS_M = 6371000.0
+
+
+def open_serial(path, baud):
+    """Abre el puerto en modo crudo (también sirve para un pty)."""
+    fd = os.open(path, os.O_RDWR | os.O_NOCTTY | os.O_NONBLOCK)
+    tty.setraw(fd)
+    attrs = termios.tcgetattr(fd)
+    speed = getattr(termios, "B%d" % baud, None)
+    if speed is not None:
+        attrs[4] = attrs[5] = speed
+        termios.tcsetattr(fd, termios.TCSANOW, attrs)
+    return fd
+
+
+def percentile(values, fraction):
+    """Percentil por el rango más cercano (values ordenados)."""
+    if not values:
+        return float("nan")
+    index = min(len(values) - 1, max(0, int(round(fraction * len(values) + 0.5)) - 1))
+    return values[index]
+
+
+def latency_text(values):
+    """Resumen de latencias en ms."""
+    if not values:
+        return "sin datos"
+    values = sorted(values)
+    return "p50 %.2f  p90 %.2f  p99 %.2f  max %.2f ms" % (
+        percentile(values, 0.5), percentile(values, 0.9), percentile(values, 0.99), values[-1])
+
+
+def random_point(rng, origin, radius_m):
+    """Punto uniforme en un círculo de radius_m alrededor del origen."""
+    distance = radius_m * math.sqrt(rng.random())
+    angle = rng.random() * 2.0 * math.pi
+    lat = origin[0] + math.degrees(distance * math.cos(angle) / EARTH_RADIUS_M)
+    lng = origin[1] + math.degrees(distance * math.sin(angle) /
+                                   (EARTH_RADIUS_M * math.cos(math.radians(origin[0]))))
+    return lat, lng
+
+
+def malformed_coordinates(rng, lat, lng):
+    """Coordenadas que bluetooth_parse_coordinates() debe rechazar."""
+    kind = rng.randrange(4)
+    if kind == 0:
+        return "%.6f;%.6f" % (lat, lng)                  # Sin coma
+    if kind == 1:
+        return "%.6f,%.6f" % (90.0 + rng.uniform(0.1, 90.0), lng)
+    if kind == 2:
+        return "%.6f,%.6f" % (lat, -180.0 - rng.uniform(0.1, 180.0))
+    return "%.38f,%.6f" % (lat, lng)                     # Latitud de más de 31 caracteres
+
+
+class Link:
+    """Puerto con cola de salida: las escrituras no bloquean el bucle."""
+
+    def __init__(self, fd):
+        self.fd = fd
+        self.output = b""
+        self.input = b""
+        self.lines_sent = 0
+        self.max_backlog = 0
+
+    def send(self, text):
+        self.output += text.encode()
+        self.lines_sent += text.count("\n")
+        self.max_backlog = max(self.max_backlog, len(self.output))
+
+    def poll(self, timeout):
+        """Escribe lo pendiente y devuelve las líneas completas recibidas."""
+        wants_write = [self.fd] if self.output else []
+        readable, writable, _ = select.select([self.fd], wants_write, [], max(0.0, timeout))
+        if writable:
+            try:
+                written = os.write(self.fd, self.output)
+                self.output = self.output[written:]
+            except BlockingIOError:
+                pass
+        if readable:
+            try:
+                self.input += os.read(self.fd, 65536)
+            except BlockingIOError:
+                pass
+
+        lines = []
+        while b"\n" in self.input:
+            raw, self.input = self.input.split(b"\n", 1)
+            lines.append(raw.decode(errors="replace").strip())
+        return lines
+
+
+class Stress:
+    """Estado de la prueba: envíos pendientes de respuesta y mediciones."""
+
+    def __init__(self, link, args):
+        self.link = link
+        self.args = args
+        self.start = time.monotonic()
+        self.phase = "reposo"
+        self.pending = collections.deque()   # (instante, tipo, respuestas válidas)
+        self.pings = {}                      # seq -> instante de envío
+        self.ping_seq = 0
+        self.sent = collections.Counter()
+        self.acked = collections.Counter()
+        self.lost = collections.Counter()
+        self.latency = collections.defaultdict(list)
+        self.unexpected = 0
+        self.robot_pings = 0
+        self.perf = {"reposo": [], "carga": []}
+        self.bt_marks = []                   # líneas enviadas hasta cada BT?, inclusive
+        self.bt = []
+
+    def now_ms(self):
+        return int((time.monotonic() - self.start) * 1000) & 0xFFFFFFFF
+
+    def send_command(self, text, kind, acks):
+        self.sent[kind] += 1
+        if acks:
+            self.pending.append((time.monotonic(), kind, acks))
+        self.link.send(text + "\n")
+
+    def query_counters(self):
+        self.link.send("BT?\n")
+        self.bt_marks.append(self.link.lines_sent)
+
+    def send_ping(self):
+        self.ping_seq += 1
+        self.sent["PING"] += 1
+        self.pings[self.ping_seq] = time.monotonic()
+        self.link.send("PING,%d,%d\n" % (self.ping_seq, self.now_ms()))
+
+    def handle(self, line):
+        fields = line.split(",")
+        if line in ACK_LINES:
+            self.match_ack(line)
+        elif fields[0] == "PONG" and len(fields) >= 2 and fields[1].isdigit():
+            sent = self.pings.pop(int(fields[1]), None)
+            if sent is not None:
+                self.acked["PING"] += 1
+                self.latency["PING"].append((time.monotonic() - sent) * 1000.0)
+        elif fields[0] == "PING" and len(fields) >= 2:
+            # Supervisión del robot: se devuelve tal cual
+            self.link.send("PONG," + ",".join(fields[1:]) + "\n")
+            self.robot_pings += 1
+        elif fields[0] == "PERF" and len(fields) >= 4:
+            self.perf[self.phase].append(tuple(int(value) for value in fields[1:4]))
+        elif fields[0] == "BT" and len(fields) >= 4:
+            self.bt.append(tuple(int(value) for value in fields[1:4]))
+        elif self.args.verbose and line:
+            print("<<", line)
+
+    def match_ack(self, line):
+        """Empareja la respuesta con el envío más antiguo que la admite."""
+        for index, (sent, kind, acks) in enumerate(self.pending):
+            if line in acks:
+                for _ in range(index):
+                    self.lost[self.pending.popleft()[1]] += 1
+                self.pending.popleft()
+                self.acked[kind] += 1
+                self.latency[kind].append((time.monotonic() - sent) * 1000.0)
+                return
+        self.unexpected += 1
+
+    def expire(self):
+        now = time.monotonic()
+        while self.pending and now - self.pending[0][0] > self.args.timeout:
+            self.lost[self.pending.popleft()[1]] += 1
+        for seq in [seq for seq, sent in self.pings.items() if now - sent > self.args.timeout]:
+            del self.pings[seq]
+            self.lost["PING"] += 1
+
+    def run_until(self, end, load):
+        """Atiende el puerto hasta end; con load envía la carga."""
+        args = self.args
+        rng = random.Random(args.seed)
+        burst_period = args.burst / args.rate
+        next_burst = time.monotonic()
+        next_ping = time.monotonic()
+
+        while time.monotonic() < end:
+            now = time.monotonic()
+            if load and now >= next_burst:
+                for _ in range(args.burst):
+                    self.send_load(rng)
+                next_burst += burst_period
+            if args.ping_rate > 0 and now >= next_ping:
+                self.send_ping()
+                next_ping += 1.0 / args.ping_rate
+
+            deadline = min(end, next_ping if args.ping_rate > 0 else end)
+            if load:
+                deadline = min(deadline, next_burst)
+            for line in self.link.poll(deadline - time.monotonic()):
+                self.handle(line)
+            self.expire()
+
+    def send_load(self, rng):
+        args = self.args
+        lat, lng = random_point(rng, args.origin, args.radius)
+        follow = rng.random() < args.follow
+        malformed = rng.random() < args.malformed
+        coordinates = (malformed_coordinates(rng, lat, lng) if malformed
+                       else "%.6f,%.6f" % (lat, lng))
+
+        if follow:
+            # Las F no tienen respuesta: solo cuentan en BT?
+            kind = "F malformada" if malformed else "F"
+            self.send_command("F,%s,%d" % (coordinates, self.now_ms()), kind, None)
+        elif malformed:
+            self.send_command(coordinates, "malformado", MALFORMED_ACKS)
+        else:
+            self.send_command(coordinates, "objetivo", TARGET_ACKS)
+
+    def drain(self, seconds):
+        """Espera las respuestas que faltan (sin carga ni sondeo)."""
+        end = time.monotonic() + seconds
+        while time.monotonic() < end and (self.pending or self.pings or self.link.output):
+            for line in self.link.poll(0.05):
+                self.handle(line)
+            self.expire()
+
+
+def perf_text(samples):
+    if not samples:
+        return "sin PERF"
+    averages = [sample[0] for sample in samples]
+    return "media %d us  máx %d us  ciclos excedidos %d (%d reportes)" % (
+        sum(averages) / len(averages), max(sample[1] for sample in samples),
+        sum(sample[2] for sample in samples), len(samples))
+
+
+def report(stress, args, load_seconds):
+    total = sum(stress.sent[kind] for kind in ("objetivo", "malformado", "F", "F malformada"))
+    print("Carga: %d líneas en %.1f s (%.1f/s, ráfagas de %d), F %.0f%%, malformadas %.0f%%" %
+          (total, load_seconds, total / max(load_seconds, 1e-9), args.burst,
+           100.0 * args.follow, 100.0 * args.malformed))
+
+    failed = False
+    for kind in ("objetivo", "malformado", "PING"):
+        if not stress.sent[kind]:
+            continue
+        lost = stress.lost[kind]
+        failed |= lost > 0
+        print("%-12s enviados %6d  respondidos %6d  sin respuesta %5d  %s" %
+              (kind, stress.sent[kind], stress.acked[kind], lost, latency_text(stress.latency[kind])))
+    for kind in ("F", "F malformada"):
+        if stress.sent[kind]:
+            print("%-12s enviados %6d  (sin respuesta esperada)" % (kind, stress.sent[kind]))
+    if stress.unexpected:
+        print("Respuestas sin envío que las explique: %d" % stress.unexpected)
+    print("PING del robot contestados: %d, cola de salida máxima: %d bytes" %
+          (stress.robot_pings, stress.link.max_backlog))
+
+    if len(stress.bt) >= 2:
+        first, last = stress.bt[0], stress.bt[-1]
+        sent = stress.bt_marks[-1] - stress.bt_marks[0]
+        received = last[0] - first[0]
+        failed |= received != sent or last[2] != first[2]
+        print("Firmware (BT?): %d de %d líneas recibidas (perdidas %d), cortadas %d, "
+              "bytes descartados %d" % (received, sent, sent - received,
+                                         last[1] - first[1], last[2] - first[2]))
+    else:
+        print("Firmware (BT?): sin respuesta, no se cuentan las líneas perdidas")
+
+    print("Bucle en reposo:   %s" % perf_text(stress.perf["reposo"]))
+    print("Bucle con carga:   %s" % perf_text(stress.perf["carga"]))
+    return 1 if failed else 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", default="/tmp/wally-bt", help="puerto serie o pty del robot")
+    parser.add_argument("--baud", type=int, default=115200, help="velocidad (BT_TARGET_BAUD)")
+    parser.add_argument("--rate", type=float, default=50.0, help="líneas de carga por segundo")
+    parser.add_argument("--burst", type=int, default=1, help="líneas por escritura")
+    parser.add_argument("--follow", type=float, default=0.5, help="fracción de líneas F (0-1)")
+    parser.add_argument("--malformed", type=float, default=0.1, help="fracción de líneas malformadas (0-1)")
+    parser.add_argument("--ping-rate", type=float, default=5.0, help="PING de sondeo por segundo")
+    parser.add_argument("--duration", type=float, default=30.0, help="duración de la carga en segundos")
+    parser.add_argument("--idle", type=float, default=3.0, help="segundos en reposo antes de la carga")
+    parser.add_argument("--perf-hz", type=float, default=1.0, help="frecuencia de PERF")
+    parser.add_argument("--timeout", type=float, default=2.0, help="envío sin respuesta tras N s = perdido")
+    parser.add_argument("--origin", default="6.2672,-75.5689", help="LAT,LNG del centro de los puntos")
+    parser.add_argument("--radius", type=float, default=20.0, help="radio de los puntos en metros")
+    parser.add_argument("--seed", type=int, default=1, help="semilla de la carga")
+    parser.add_argument("--verbose", action="store_true", help="muestra las demás líneas del robot")
+    args = parser.parse_args()
+
+    args.origin = tuple(float(value) for value in args.origin.split(","))
+    if args.rate <= 0 or args.burst < 1:
+        parser.error("--rate debe ser positivo y --burst al menos 1")
+
+    stress = Stress(Link(open_serial(args.port, args.baud)), args)
+    stress.link.send("SUB,PERF,%g\n" % args.perf_hz)
+    stress.query_counters()
+    stress.run_until(time.monotonic() + args.idle, load=False)
+
+    stress.phase = "carga"
+    if args.follow > 0:
+        stress.send_command("FOLLOW_ON", "control", ("Follow Me activado",))
+    load_start = time.monotonic()
+    stress.run_until(load_start + args.duration, load=True)
+    load_seconds = time.monotonic() - load_start
+
+    stress.send_command("STOP", "control", ("Navegación detenida",))
+    stress.drain(args.timeout + 1.0)
+    stress.query_counters()
+    stress.link.send("SUB,PERF,0\n")
+    stress.drain(args.timeout)
+    # El último PERF puede llegar tras la consulta
+    end = time.monotonic() + 0.5
+    while time.monotonic() < end:
+        for line in stress.link.poll(end - time.monotonic()):
+            stress.handle(line)
+    os.close(stress.link.fd)
+
+    return report(stress, args, load_seconds)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
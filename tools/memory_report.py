@@ -0,0 +1,346 @@
+#!/usr/bin/env python3
+"""
+Resumen de memoria de WALLY-S por módulo.
+
+Combina tres salidas de la compilación:
+  - *.su  (-fstack-usage): pila propia de cada función
+  - *.ci  (-fcallgraph-info=su): grafo de llamadas, para el peor camino de pila
+  - mapa del enlazador (-Wl,-Map): flash y RAM que aporta cada objeto
+
+Las funciones de bibliotecas precompiladas (printf, funciones de coma
+flotante...) no tienen datos de pila: el peor camino no las incluye y se
+listan aparte. La marca de agua en tiempo de ejecución (comando MEM?) sí
+las cubre.
+
+Uso:
+  memory_report.py --objects build/CMakeFiles/WALLY_S.dir --map build/WALLY_S.elf.map
+"""
+
+import argparse
+import os
+import re
+import sys
+
+# Tamaños por defecto del RP2040 y del SDK
+SRAM_BYTES = 264 * 1024
+STACK_BYTES = 0x800
+
+# Marcas de pila dinámica en los archivos .su
+DYNAMIC = "dynamic"
+
+
+def module_of(path):
+    """Nombre del módulo a partir de la ruta de un fuente u objeto."""
+    name = os.path.basename(path)
+    for suffix in (".obj", ".o", ".c"):
+        if name.endswith(suffix):
+            name = name[: -len(suffix)]
+    return name
+
+
+def function_name(title):
+    """Las funciones static llevan la ruta del fuente delante ("ruta:nombre")."""
+    return title.rsplit(":", 1)[-1]
+
+
+def find_files(root, extension):
+    for folder, _, names in os.walk(root):
+        for name in names:
+            if name.endswith(extension):
+                yield os.path.join(folder, name)
+
+
+def is_project(path, objects):
+    """Los fuentes del proyecto están directamente en el directorio de objetos."""
+    return os.path.dirname(os.path.abspath(path)) == os.path.abspath(objects)
+
+
+# ---------------------------------------------------------------------------
+# Pila: -fstack-usage y grafo de llamadas
+# ---------------------------------------------------------------------------
+
+class Function:
+    def __init__(self, name, module, frame, dynamic, project):
+        self.name = name
+        self.module = module
+        self.project = project
+        self.frame = frame
+        self.dynamic = dynamic
+        self.callees = []
+        self.indirect = False
+
+
+def read_stack_usage(objects):
+    """Lee los .su: {(módulo, función): (bytes, dinámica, del proyecto)}."""
+    frames = {}
+    for path in find_files(objects, ".su"):
+        project = is_project(path, objects)
+        for line in open(path, encoding="utf-8", errors="replace"):
+            fields = line.rstrip("\n").split("\t")
+            if len(fields) < 3:
+                continue
+            location, size, kind = fields[0], fields[1], fields[2]
+            source, _, function = location.rpartition(":")
+            source = source.rsplit(":", 2)[0]
+            frames[(module_of(source), function)] = (int(size), DYNAMIC in kind, project)
+    return frames
+
+
+NODE = re.compile(r'node:\s*\{\s*title:\s*"([^"]+)"\s*label:\s*"([^"]*)"')
+EDGE = re.compile(r'edge:\s*\{\s*sourcename:\s*"([^"]+)"\s*targetname:\s*"([^"]+)"')
+
+
+def read_callgraph(objects, frames):
+    """Arma las funciones con su pila propia y sus llamadas."""
+    functions = {}
+    pending = []
+
+    for path in find_files(objects, ".ci"):
+        text = open(path, encoding="utf-8", errors="replace").read()
+        project = is_project(path, objects)
+        defined = {}
+        for title, label in NODE.findall(text):
+            parts = label.split("\\n")
+            if len(parts) < 3 or "bytes" not in parts[2]:
+                continue
+            module = module_of(parts[1].rsplit(":", 2)[0])
+            name = function_name(title)
+            size, dynamic, _ = frames.get((module, name), (0, False, project))
+            if (module, name) not in frames:
+                size = int(parts[2].split()[0])
+                dynamic = DYNAMIC in parts[2]
+            function = Function(name, module, size, dynamic, project)
+            functions[(module, title)] = function
+            defined[title] = function
+        for source, target in EDGE.findall(text):
+            if source in defined:
+                pending.append((defined[source], target, defined))
+
+    # Las llamadas se resuelven primero dentro del mismo módulo (funciones static)
+    by_name = {}
+    for (_, title), function in functions.items():
+        by_name.setdefault(title, []).append(function)
+
+    unresolved = {}
+    for caller, target, local in pending:
+        if target == "__indirect_call":
+            caller.indirect = True
+        elif target in local:
+            caller.callees.append(local[target])
+        elif target in by_name:
+            caller.callees.append(max(by_name[target], key=lambda f: f.frame))
+        else:
+            unresolved[target] = unresolved.get(target, 0) + 1
+
+    return functions, unresolved
+
+
+def worst_paths(functions):
+    """Peor camino de pila desde cada función: {función: (bytes, camino, recursiva)}."""
+    result = {}
+    visiting = set()
+
+    def visit(function):
+        if function in result:
+            return result[function]
+        if function in visiting:
+            return (0, [], True)
+        visiting.add(function)
+        best = (0, [], False)
+        recursive = False
+        for callee in function.callees:
+            depth, path, loop = visit(callee)
+            recursive = recursive or loop
+            if depth > best[0]:
+                best = (depth, path, loop)
+        visiting.discard(function)
+        entry = (function.frame + best[0], [function] + best[1], recursive)
+        result[function] = entry
+        return entry
+
+    for function in functions.values():
+        visit(function)
+    return result
+
+
+# ---------------------------------------------------------------------------
+# Mapa del enlazador
+# ---------------------------------------------------------------------------
+
+ENTRY = re.compile(r"^ (\S+)?\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+ARCHIVE = re.compile(r"([^/\\]+\.a)\(")
+
+SKIP = (".debug", ".comment", ".ARM.attributes", ".stack", ".heap")
+RAM_ONLY = (".bss", "COMMON", ".uninitialized_data", ".ram_vector_table")
+COPIED = (".data", ".time_critical", ".scratch_x", ".scratch_y")
+
+
+def map_owner(path, objects):
+    """Módulo dueño de una entrada del mapa: fuente del proyecto, biblioteca o SDK."""
+    archive = ARCHIVE.search(path)
+    if archive:
+        return "[" + archive.group(1) + "]"
+    # El mapa usa rutas relativas al directorio de compilación
+    folder = os.path.basename(os.path.dirname(path))
+    if objects and folder == os.path.basename(os.path.normpath(objects)):
+        return module_of(path)
+    return "[pico-sdk]"
+
+
+def read_map(path, objects):
+    """Suma flash, .data y .bss por módulo: {módulo: [text, data, bss]}."""
+    usage = {}
+    started = False
+    section = None
+
+    for line in open(path, encoding="utf-8", errors="replace"):
+        line = line.rstrip("\r\n")
+        if not started:
+            started = line.startswith("Linker script and memory map")
+            continue
+
+        # Nombre de sección largo: la dirección viene en la línea siguiente
+        if re.match(r"^ \S+$", line):
+            section = line.strip()
+            continue
+
+        match = ENTRY.match(line)
+        if not match:
+            section = None
+            continue
+
+        name = match.group(1) or section
+        section = None
+        size = int(match.group(3), 16)
+        if not name or size == 0 or name.startswith(SKIP):
+            continue
+
+        owner = map_owner(match.group(4).strip(), objects)
+        totals = usage.setdefault(owner, [0, 0, 0])
+        if name.startswith(RAM_ONLY):
+            totals[2] += size
+        elif name.startswith(COPIED):
+            totals[1] += size
+        else:
+            totals[0] += size
+
+    return usage
+
+
+# ---------------------------------------------------------------------------
+# Informe
+# ---------------------------------------------------------------------------
+
+def path_text(path, limit=6):
+    names = [f.name for f in path]
+    if len(names) > limit:
+        names = names[:limit] + ["..."]
+    return " > ".join(names)
+
+
+def report(args):
+    lines = []
+    out = lines.append
+
+    frames = read_stack_usage(args.objects)
+    functions, unresolved = read_callgraph(args.objects, frames)
+    if not functions:
+        # Sin grafo de llamadas: solo la pila propia
+        for (module, name), (size, dynamic, project) in frames.items():
+            functions[(module, name)] = Function(name, module, size, dynamic, project)
+    paths = worst_paths(functions)
+
+    usage = read_map(args.map, args.objects) if args.map else {}
+    modules = sorted({f.module for f in functions.values() if f.project} |
+                     {m for m in usage if not m.startswith("[")})
+
+    out("=== Memoria por módulo ===")
+    out("%-14s %8s %7s %7s  %-30s %s" %
+        ("Módulo", "Flash", "Datos", "BSS", "Mayor marco", "Peor camino"))
+    totals = [0, 0, 0]
+    for module in modules:
+        own = [f for f in functions.values() if f.module == module and f.project]
+        text, data, bss = usage.get(module, [0, 0, 0])
+        totals = [totals[0] + text, totals[1] + data, totals[2] + bss]
+
+        frame = "-"
+        worst = "-"
+        if own:
+            biggest = max(own, key=lambda f: f.frame)
+            frame = "%s %d%s" % (biggest.name, biggest.frame, "*" if biggest.dynamic else "")
+            deepest = max(own, key=lambda f: paths[f][0])
+            worst = "%d (%s)" % (paths[deepest][0], deepest.name)
+        out("%-14s %8d %7d %7d  %-30s %s" % (module, text, data, bss, frame, worst))
+    out("%-14s %8d %7d %7d" % ("Proyecto", totals[0], totals[1], totals[2]))
+    out("(* marco con pila dinámica: alloca o arreglos de tamaño variable)")
+
+    others = sorted(m for m in usage if m.startswith("["))
+    for module in others:
+        text, data, bss = usage[module]
+        out("%-14s %8d %7d %7d" % (module, text, data, bss))
+
+    if usage:
+        ram = sum(u[1] + u[2] for u in usage.values())
+        flash = sum(u[0] + u[1] for u in usage.values())
+        out("")
+        out("RAM estática total: %d bytes (%.1f%% de %d KB)" %
+            (ram, 100.0 * ram / SRAM_BYTES, SRAM_BYTES // 1024))
+        out("Flash total: %d bytes" % flash)
+
+    out("")
+    out("=== Peores caminos de pila ===")
+    ranked = sorted(paths.items(), key=lambda item: item[1][0], reverse=True)
+    for function, (depth, path, recursive) in ranked[:args.top]:
+        marks = ""
+        if recursive:
+            marks += " [recursiva]"
+        if any(f.indirect for f in path):
+            marks += " [llamada indirecta]"
+        if any(f.dynamic for f in path):
+            marks += " [pila dinámica]"
+        out("%6d  %s%s" % (depth, path_text(path), marks))
+
+    main = [f for f in functions.values() if f.name == "main"]
+    if main:
+        depth = paths[main[0]][0]
+        margin = args.stack_size - depth
+        out("")
+        out("main: %d de %d bytes de pila del núcleo 0 (margen %d)%s" %
+            (depth, args.stack_size, margin, "  ✗ EXCEDE" if margin < 0 else ""))
+
+    if unresolved:
+        names = sorted(unresolved, key=lambda n: unresolved[n], reverse=True)
+        out("")
+        out("Sin datos de pila (bibliotecas): " + ", ".join(names[:12]) +
+            (" y %d más" % (len(names) - 12) if len(names) > 12 else ""))
+
+    text = "\n".join(lines) + "\n"
+    sys.stdout.write(text)
+    if args.output:
+        with open(args.output, "w", encoding="utf-8") as handle:
+            handle.write(text)
+
+    return 1 if main and args.stack_size < paths[main[0]][0] and args.strict else 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--objects", required=True,
+                        help="directorio con los objetos y los .su/.ci del ejecutable")
+    parser.add_argument("--map", help="mapa del enlazador")
+    parser.add_argument("--output", help="copia del informe en un archivo")
+    parser.add_argument("--stack-size", type=int, default=STACK_BYTES,
+                        help="pila del núcleo 0 en bytes (PICO_STACK_SIZE)")
+    parser.add_argument("--top", type=int, default=10,
+                        help="peores caminos a mostrar")
+    parser.add_argument("--strict", action="store_true",
+                        help="falla si el peor camino desde main excede la pila")
+    args = parser.parse_args()
+
+    if args.map and not os.path.exists(args.map):
+        args.map = None
+    return report(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+"""
+Reproduce un registro NMEA por el puerto del GPS de WALLY-S.
+
+Lee un archivo con sentencias NMEA (por ejemplo una captura del NEO-6M
+con cat /dev/ttyUSB0 > vuelta.nmea) y lo escribe al ritmo original: cada
+grupo de sentencias con la misma hora UTC sale un segundo después del
+anterior. Pensado para el pty de la compilación SIL (sil/, sin --gps-sim),
+también sirve con un adaptador USB-serie conectado a la UART del GPS.
+
+Uso:
+  nmea_replay.py vuelta.nmea                     (/tmp/wally-gps, tiempo real)
+  nmea_replay.py vuelta.nmea --speed 4 --loop    (4 veces más rápido, en bucle)
+"""
+
+import argparse
+import os
+import sys
+import termios
+import time
+import tty
+
+# Sentencias con la hora UTC en el primer campo (marcan el inicio de cada época)
+TIMED = ("GGA", "RMC", "GLL", "ZDA")
+
+
+def open_serial(path, baud):
+    """Abre el puerto en modo crudo (también sirve para un pty)."""
+    fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+    tty.setraw(fd)
+    attrs = termios.tcgetattr(fd)
+    speed = getattr(termios, "B%d" % baud, None)
+    if speed is not None:
+        attrs[4] = attrs[5] = speed
+        termios.tcsetattr(fd, termios.TCSANOW, attrs)
+    return fd
+
+
+def checksum_ok(sentence):
+    """Verifica el *CS final; las sentencias sin checksum se aceptan."""
+    if "*" not in sentence:
+        return True
+    body, _, given = sentence[1:].partition("*")
+    value = 0
+    for c in body:
+        value ^= ord(c)
+    return given[:2].upper() == "%02X" % value
+
+
+def load_epochs(path):
+    """Agrupa las sentencias por hora UTC: [(segundos del día, [líneas])]."""
+    epochs = []
+    current_time = None
+    lines = []
+    skipped = 0
+
+    with open(path, errors="replace") as source:
+        for raw in source:
+            sentence = raw.strip()
+            start = sentence.find("$")
+            if start < 0:
+                continue
+            sentence = sentence[start:]
+            if not checksum_ok(sentence):
+                skipped += 1
+                continue
+
+            fields = sentence.split(",")
+            if sentence[3:6] in TIMED and len(fields) > 1 and len(fields[1]) >= 6:
+                try:
+                    hhmmss = fields[1]
+                    stamp = int(hhmmss[0:2]) * 3600 + int(hhmmss[2:4]) * 60 + float(hhmmss[4:])
+                except ValueError:
+                    stamp = None
+                if stamp is not None and stamp != current_time:
+                    if lines:
+                        epochs.append((current_time, lines))
+                    current_time = stamp
+                    lines = []
+            lines.append(sentence)
+
+    if lines:
+        epochs.append((current_time, lines))
+    return epochs, skipped
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("file", help="archivo con sentencias NMEA")
+    parser.add_argument("--port", default="/tmp/wally-gps", help="puerto serie o pty del GPS")
+    parser.add_argument("--baud", type=int, default=9600, help="velocidad (GPS_BAUD_RATE)")
+    parser.add_argument("--speed", type=float, default=1.0, help="factor de velocidad de reproducción")
+    parser.add_argument("--loop", action="store_true", help="repetir el archivo sin fin")
+    args = parser.parse_args()
+
+    epochs, skipped = load_epochs(args.file)
+    if not epochs:
+        print("Sin sentencias NMEA en %s" % args.file)
+        return 1
+    print("%d épocas, %d sentencias descartadas por checksum" % (len(epochs), skipped))
+
+    fd = open_serial(args.port, args.baud)
+    try:
+        while True:
+            next_time = time.monotonic()
+            previous = None
+            for stamp, lines in epochs:
+                # Hueco real entre épocas (1 s si no hay hora), con el cambio de día
+                if previous is not None and stamp is not None:
+                    gap = (stamp - previous) % 86400
+                    next_time += min(gap if gap > 0 else 1.0, 10.0) / args.speed
+                elif previous is not None:
+                    next_time += 1.0 / args.speed
+                previous = stamp if stamp is not None else previous
+
+                delay = next_time - time.monotonic()
+                if delay > 0:
+                    time.sleep(delay)
+                os.write(fd, "".join(line + "\r\n" for line in lines).encode())
+            if not args.loop:
+                break
+    except KeyboardInterrupt:
+        pass
+    finally:
+        os.close(fd)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,420 @@
+#!/usr/bin/env python3
+"""
+Receptor de la traza binaria de WALLY-S por USB.
+
+Abre la interfaz vendor del robot (pyusb, libusb), pide la traza y guarda
+cada tipo de registro en su propio archivo. El formato de cada tipo llega
+en los registros de esquema, así que el receptor no necesita cambiar
+cuando el firmware agrega campos.
+
+Salidas en el directorio --output:
+  - csv (por defecto): loop.csv, motors.csv, stats.csv...
+  - columnar: un .bin por columna (little endian) y schema.json con los tipos
+  - parquet: un .parquet por tipo (requiere pyarrow)
+  - log.txt: texto de printf (también se muestra en pantalla)
+
+Cada fila empieza con time_us (base de tiempo del robot, disciplinada por
+el PPS si hay fix) y sequence. Los saltos de secuencia son registros
+descartados por el robot o perdidos en el camino y se cuentan al final.
+
+Uso:
+  trace_receiver.py --output vuelta1 --duration 60
+  trace_receiver.py --console              (menú del robot por la misma conexión)
+  trace_receiver.py --raw captura.bin      (guarda además los bytes crudos)
+  trace_receiver.py --input captura.bin --format parquet
+"""
+
+import argparse
+import json
+import os
+import struct
+import sys
+import threading
+import time
+
+# Identificación del dispositivo (config.h: TRACE_USB_VID y TRACE_USB_PID)
+USB_VID = 0xCAFE
+USB_PID = 0x5753
+USB_INTERFACE = 0
+USB_EP_IN = 0x81
+USB_EP_OUT = 0x01
+USB_REQUEST_TRACE = 1
+USB_READ_SIZE = 16384
+USB_TIMEOUT_MS = 100
+
+# Registros (trace.h)
+SYNC = 0xA5
+HEADER = struct.Struct("<BBHIQ")
+TRACE_SCHEMA = 0
+TRACE_TEXT = 1
+MAX_PAYLOAD = 4096
+
+# Registros guardados por tipo mientras no llega su esquema
+MAX_PENDING = 10000
+
+# Tipos de columna (formato de struct -> Arrow y numpy) para columnar y Parquet
+DTYPES = {
+    "b": ("int8", "<i1"), "B": ("uint8", "<u1"), "h": ("int16", "<i2"), "H": ("uint16", "<u2"),
+    "i": ("int32", "<i4"), "I": ("uint32", "<u4"), "q": ("int64", "<i8"), "Q": ("uint64", "<u8"),
+    "f": ("float32", "<f4"), "d": ("float64", "<f8"), "?": ("bool", "|b1"),
+}
+
+# Columnas que preceden a los campos de cada tipo
+COLUMNS = [("time_us", "Q"), ("sequence", "I")]
+
+
+class Schema:
+    """Descripción de un tipo de registro."""
+
+    def __init__(self, type_id, name, fmt, fields):
+        self.type_id = type_id
+        self.name = name
+        self.format = fmt
+        self.struct = struct.Struct(fmt)
+        self.fields = fields.split(",") if fields else []
+        codes = [c for c in fmt if c not in "<>=!@ " and not c.isdigit()]
+        if len(codes) != len(self.fields):
+            raise ValueError("%s: %d campos para el formato %s" % (name, len(self.fields), fmt))
+        self.codes = codes
+
+    @staticmethod
+    def parse(payload):
+        """Decodifica un registro TRACE_SCHEMA: tipo, nombre, formato y campos."""
+        parts = payload[1:].rstrip(b"\0").split(b"\0")
+        if len(parts) != 3:
+            raise ValueError("esquema mal formado")
+        name, fmt, fields = (part.decode("ascii") for part in parts)
+        return Schema(payload[0], name, fmt, fields)
+
+
+class Decoder:
+    """Separa los registros del flujo de bytes, resincronizando con SYNC."""
+
+    def __init__(self):
+        self.buffer = bytearray()
+        self.skipped = 0
+
+    def feed(self, data):
+        self.buffer += data
+        records = []
+        while True:
+            start = self.buffer.find(bytes([SYNC]))
+            if start < 0:
+                self.skipped += len(self.buffer)
+                self.buffer.clear()
+                break
+            if start > 0:
+                self.skipped += start
+                del self.buffer[:start]
+            if len(self.buffer) < HEADER.size:
+                break
+            _, type_id, length, sequence, time_us = HEADER.unpack_from(self.buffer)
+            if length > MAX_PAYLOAD:
+                # Falso SYNC: buscar el siguiente
+                self.skipped += 1
+                del self.buffer[:1]
+                continue
+            end = HEADER.size + length
+            if len(self.buffer) < end:
+                break
+            records.append((type_id, sequence, time_us, bytes(self.buffer[HEADER.size:end])))
+            del self.buffer[:end]
+        return records
+
+
+class CsvSink:
+    """Un archivo CSV por tipo."""
+
+    def __init__(self, directory):
+        self.directory = directory
+        self.files = {}
+
+    def write(self, schema, time_us, sequence, values):
+        handle = self.files.get(schema.type_id)
+        if handle is None:
+            handle = open(os.path.join(self.directory, schema.name + ".csv"), "w", encoding="utf-8")
+            handle.write(",".join(["time_us", "sequence"] + schema.fields) + "\n")
+            self.files[schema.type_id] = handle
+        row = [str(time_us), str(sequence)]
+        row += ["%.6g" % v if isinstance(v, float) else str(v) for v in values]
+        handle.write(",".join(row) + "\n")
+
+    def close(self):
+        for handle in self.files.values():
+            handle.close()
+
+
+class ColumnarSink:
+    """Un archivo binario por columna y schema.json para leerlos (numpy.fromfile)."""
+
+    def __init__(self, directory):
+        self.directory = directory
+        self.columns = {}
+        self.counts = {}
+        self.schemas = {}
+
+    def write(self, schema, time_us, sequence, values):
+        columns = self.columns.get(schema.type_id)
+        if columns is None:
+            columns = []
+            for field, code in COLUMNS + list(zip(schema.fields, schema.codes)):
+                path = os.path.join(self.directory, "%s.%s.bin" % (schema.name, field))
+                columns.append((open(path, "wb"), struct.Struct("<" + code)))
+            self.columns[schema.type_id] = columns
+            self.counts[schema.type_id] = 0
+            self.schemas[schema.type_id] = schema
+        for (handle, packer), value in zip(columns, [time_us, sequence] + list(values)):
+            handle.write(packer.pack(value))
+        self.counts[schema.type_id] += 1
+
+    def close(self):
+        description = {}
+        for type_id, columns in self.columns.items():
+            for handle, _ in columns:
+                handle.close()
+            schema = self.schemas[type_id]
+            description[schema.name] = {
+                "rows": self.counts[type_id],
+                "columns": {
+                    field: {"file": "%s.%s.bin" % (schema.name, field), "dtype": DTYPES[code][1]}
+                    for field, code in COLUMNS + list(zip(schema.fields, schema.codes))
+                },
+            }
+        with open(os.path.join(self.directory, "schema.json"), "w", encoding="utf-8") as handle:
+            json.dump(description, handle, indent=2)
+
+
+class ParquetSink:
+    """Un archivo Parquet por tipo, escrito por lotes."""
+
+    BATCH_ROWS = 50000
+
+    def __init__(self, directory):
+        try:
+            import pyarrow
+            import pyarrow.parquet
+        except ImportError:
+            sys.exit("ERROR: --format parquet requiere pyarrow (pip install pyarrow)")
+        self.pa = pyarrow
+        self.pq = pyarrow.parquet
+        self.directory = directory
+        self.rows = {}
+        self.writers = {}
+        self.schemas = {}
+
+    def write(self, schema, time_us, sequence, values):
+        rows = self.rows.setdefault(schema.type_id, [])
+        self.schemas[schema.type_id] = schema
+        rows.append((time_us, sequence) + tuple(values))
+        if len(rows) >= self.BATCH_ROWS:
+            self.flush(schema.type_id)
+
+    def flush(self, type_id):
+        rows = self.rows.get(type_id)
+        if not rows:
+            return
+        schema = self.schemas[type_id]
+        columns = COLUMNS + list(zip(schema.fields, schema.codes))
+        names = [name for name, _ in columns]
+        types = [DTYPES[code][0] for _, code in columns]
+        arrow_schema = self.pa.schema([(n, self.pa.type_for_alias(t)) for n, t in zip(names, types)])
+        table = self.pa.Table.from_arrays(
+            [self.pa.array(column, type=arrow_schema.field(i).type) for i, column in enumerate(zip(*rows))],
+            schema=arrow_schema)
+        writer = self.writers.get(type_id)
+        if writer is None:
+            path = os.path.join(self.directory, schema.name + ".parquet")
+            writer = self.pq.ParquetWriter(path, arrow_schema)
+            self.writers[type_id] = writer
+        writer.write_table(table)
+        rows.clear()
+
+    def close(self):
+        for type_id in list(self.rows):
+            self.flush(type_id)
+        for writer in self.writers.values():
+            writer.close()
+
+
+SINKS = {"csv": CsvSink, "columnar": ColumnarSink, "parquet": ParquetSink}
+
+
+class Receiver:
+    """Decodifica los registros y los reparte entre la salida y el log de texto."""
+
+    def __init__(self, sink, log):
+        self.sink = sink
+        self.log = log
+        self.decoder = Decoder()
+        self.schemas = {}
+        self.pending = {}
+        self.expected = None
+        self.records = 0
+        self.lost = 0
+        self.unknown = 0
+        self.last_stats = None
+
+    def feed(self, data):
+        for type_id, sequence, time_us, payload in self.decoder.feed(data):
+            self.count(sequence)
+            self.handle(type_id, sequence, time_us, payload)
+
+    def count(self, sequence):
+        if self.expected is not None:
+            self.lost += (sequence - self.expected) & 0xFFFFFFFF
+        self.expected = (sequence + 1) & 0xFFFFFFFF
+        self.records += 1
+
+    def handle(self, type_id, sequence, time_us, payload):
+        if type_id == TRACE_SCHEMA:
+            try:
+                schema = Schema.parse(payload)
+            except ValueError as error:
+                print("Esquema descartado: %s" % error, file=sys.stderr)
+                return
+            known = self.schemas.get(schema.type_id)
+            if known is None or known.format != schema.format or known.fields != schema.fields:
+                self.schemas[schema.type_id] = schema
+                for record in self.pending.pop(schema.type_id, []):
+                    self.store(schema, *record)
+        elif type_id == TRACE_TEXT:
+            text = payload.decode("utf-8", errors="replace")
+            sys.stdout.write(text)
+            sys.stdout.flush()
+            self.log.write(text)
+        elif type_id in self.schemas:
+            self.store(self.schemas[type_id], sequence, time_us, payload)
+        else:
+            pending = self.pending.setdefault(type_id, [])
+            if len(pending) < MAX_PENDING:
+                pending.append((sequence, time_us, payload))
+            else:
+                self.unknown += 1
+
+    def store(self, schema, sequence, time_us, payload):
+        if len(payload) != schema.struct.size:
+            self.unknown += 1
+            return
+        values = schema.struct.unpack(payload)
+        if schema.name == "stats":
+            self.last_stats = dict(zip(schema.fields, values))
+        self.sink.write(schema, time_us, sequence, values)
+
+    def summary(self):
+        lines = ["Registros: %d, perdidos: %d, bytes descartados: %d" %
+                 (self.records, self.lost, self.decoder.skipped)]
+        without_schema = sum(len(p) for p in self.pending.values()) + self.unknown
+        if without_schema:
+            lines.append("Registros sin esquema o con tamaño incorrecto: %d" % without_schema)
+        if self.last_stats:
+            lines.append("Robot: %(records)d escritos, %(dropped)d descartados, %(bytes)d bytes" %
+                         self.last_stats)
+        return "\n".join(lines)
+
+
+def open_device(serial):
+    """Busca el robot por VID/PID (y número de serie) y reclama la interfaz."""
+    try:
+        import usb.core
+        import usb.util
+    except ImportError:
+        sys.exit("ERROR: se requiere pyusb (pip install pyusb) y libusb")
+
+    def matches(device):
+        return serial is None or usb.util.get_string(device, device.iSerialNumber) == serial
+
+    device = usb.core.find(idVendor=USB_VID, idProduct=USB_PID, custom_match=matches)
+    if device is None:
+        sys.exit("ERROR: no se encontró WALLY-S (%04x:%04x)" % (USB_VID, USB_PID))
+    try:
+        if device.is_kernel_driver_active(USB_INTERFACE):
+            device.detach_kernel_driver(USB_INTERFACE)
+    except (NotImplementedError, usb.core.USBError):
+        pass
+    device.set_configuration()
+    usb.util.claim_interface(device, USB_INTERFACE)
+    return device
+
+
+def forward_console(device, stop):
+    """Envía cada línea de la entrada estándar al menú del robot."""
+    for line in sys.stdin:
+        if stop.is_set():
+            break
+        device.write(USB_EP_OUT, line.encode("utf-8"))
+
+
+def run_usb(args, receiver, raw):
+    import usb.core
+
+    device = open_device(args.serial)
+    # bmRequestType 0x40: vendor, dispositivo, del host al robot
+    device.ctrl_transfer(0x40, USB_REQUEST_TRACE, 1, 0)
+    stop = threading.Event()
+    if args.console:
+        threading.Thread(target=forward_console, args=(device, stop), daemon=True).start()
+
+    start = time.monotonic()
+    try:
+        while args.duration is None or time.monotonic() - start < args.duration:
+            try:
+                data = bytes(device.read(USB_EP_IN, USB_READ_SIZE, USB_TIMEOUT_MS))
+            except usb.core.USBTimeoutError:
+                continue
+            if raw:
+                raw.write(data)
+            receiver.feed(data)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        stop.set()
+        try:
+            device.ctrl_transfer(0x40, USB_REQUEST_TRACE, 0, 0)
+        except usb.core.USBError:
+            pass
+
+
+def run_file(args, receiver):
+    with open(args.input, "rb") as handle:
+        while True:
+            data = handle.read(1 << 16)
+            if not data:
+                break
+            receiver.feed(data)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--output", default=time.strftime("trace_%Y%m%d_%H%M%S"),
+                        help="directorio de salida")
+    parser.add_argument("--format", choices=sorted(SINKS), default="csv",
+                        help="formato de las tablas")
+    parser.add_argument("--input", help="decodifica una captura cruda en lugar del USB")
+    parser.add_argument("--raw", help="guarda además los bytes recibidos")
+    parser.add_argument("--serial", help="número de serie del robot si hay varios")
+    parser.add_argument("--duration", type=float, help="segundos de captura (por defecto hasta Ctrl+C)")
+    parser.add_argument("--console", action="store_true",
+                        help="reenvía la entrada estándar al robot (menú de pruebas)")
+    args = parser.parse_args()
+
+    os.makedirs(args.output, exist_ok=True)
+    sink = SINKS[args.format](args.output)
+    with open(os.path.join(args.output, "log.txt"), "w", encoding="utf-8") as log:
+        receiver = Receiver(sink, log)
+        if args.input:
+            run_file(args, receiver)
+        else:
+            raw = open(args.raw, "wb") if args.raw else None
+            try:
+                run_usb(args, receiver, raw)
+            finally:
+                if raw:
+                    raw.close()
+    sink.close()
+
+    print("\n" + receiver.summary(), file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,413 @@
+/**
+ * @file trace.c
+ * @brief Implementación de la traza binaria por USB.
+ *
+ * El USB (TinyUSB, interfaz vendor) corre entero en el núcleo 1: su
+ * interrupción, tud_task() y el envío. Los productores del núcleo 0 solo
+ * copian el registro en el buffer de llenado dentro de una sección crítica.
+ * Cuando el buffer de envío queda vacío el núcleo 1 intercambia los dos y
+ * entrega el completo al FIFO del endpoint por trozos, sin que el bucle de
+ * control espere nunca al host.
+ *
+ * El USB del RP2040 no usa DMA (la FIFO del endpoint se copia por software
+ * en la interrupción), por eso el doble buffer hace ese papel: el bucle
+ * escribe en uno mientras el otro se vacía en paralelo en el otro núcleo.
+ *
+ * La traza empieza cuando el receptor envía la petición vendor
+ * USB_REQUEST_TRACE y se detiene al desconectar el cable.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "trace.h"
+#include "timebase.h"
+#include "motors.h"
+#include "config.h"
+#include <stdio.h>
+#include <string.h>
+
+/// @brief Sin la opción WALLY_USB_TRACE de CMake la traza no hace nada
+#ifndef WALLY_USB_TRACE
+#define WALLY_USB_TRACE 0
+#endif
+
+#if WALLY_USB_TRACE
+#include "tusb.h"
+#include "usb_descriptors.h"
+#include "pico/multicore.h"
+#include "pico/flash.h"
+#include "pico/sync.h"
+#include "pico/stdio/driver.h"
+#endif
+
+// El receptor decodifica con estos tamaños: cambiar una estructura obliga a cambiar su esquema
+_Static_assert(sizeof(trace_header_t) == 16, "trace_header_t debe ocupar 16 bytes");
+_Static_assert(sizeof(trace_loop_t) == 32, "trace_loop_t no coincide con su esquema");
+_Static_assert(sizeof(trace_motors_t) == 28, "trace_motors_t no coincide con su esquema");
+_Static_assert(sizeof(trace_stats_t) == 12, "trace_stats_t no coincide con su esquema");
+
+/// @brief Duración de la prueba en segundos
+#define TEST_DURATION_S 10
+
+/// @brief Espera máxima por un receptor en la prueba en segundos
+#define TEST_WAIT_S 30
+
+#if WALLY_USB_TRACE
+
+/**
+ * @brief Descripción de un tipo de registro para el receptor.
+ */
+typedef struct {
+    trace_type_t type;   ///< Tipo descrito
+    const char* name;    ///< Nombre (archivo de salida del receptor)
+    const char* format;  ///< Formato del módulo struct de Python
+    const char* fields;  ///< Nombres de los campos separados por comas
+} trace_schema_t;
+
+/// @brief Esquemas que se repiten cada TRACE_SCHEMA_INTERVAL_MS
+static const trace_schema_t schemas[] = {
+    { TRACE_STATS, "stats", "<III", "records,dropped,bytes" },
+    { TRACE_LOOP, "loop", "<ffhhiifBBBBI",
+      "heading,setpoint,speed_a,speed_b,lat_e7,lng_e7,hdop,fix,satellites,mode,flags,work_us" },
+    { TRACE_MOTORS, "motors", "<ffffhhII",
+      "rpm_a,rpm_b,current_a,current_b,pwm_a,pwm_b,pulses_a,pulses_b" },
+};
+
+/// @brief Estado de inicialización
+static bool initialized = false;
+
+/// @brief Protege el buffer de llenado, la secuencia y las estadísticas
+static critical_section_t lock;
+
+/// @brief Par de buffers: uno se llena mientras el otro se envía
+static uint8_t buffers[2][TRACE_BUFFER_SIZE];
+static uint8_t fill_index = 0;
+static uint32_t fill_length = 0;
+
+/// @brief Buffer en envío (solo núcleo 1)
+static uint8_t send_index = 1;
+static uint32_t send_length = 0;
+static uint32_t send_offset = 0;
+
+/// @brief Traza pedida por el receptor
+static volatile bool streaming = false;
+
+/// @brief Número del próximo registro
+static uint32_t sequence = 0;
+
+/// @brief Estadísticas acumuladas
+static trace_stats_t stats = {0};
+
+/// @brief Entrada estándar: cola de un productor (núcleo 1) y un consumidor (núcleo 0)
+static uint8_t rx_buffer[TRACE_RX_BUFFER_SIZE];
+static volatile uint32_t rx_head = 0;
+static volatile uint32_t rx_tail = 0;
+
+/**
+ * @brief Inicia o detiene la traza (núcleo 1).
+ *
+ * Al detenerla se descarta lo pendiente: el próximo receptor empieza en
+ * un límite de registro.
+ */
+static void set_streaming(bool enabled) {
+    critical_section_enter_blocking(&lock);
+    streaming = enabled;
+    fill_length = 0;
+    send_length = send_offset = 0;
+    critical_section_exit(&lock);
+}
+
+/**
+ * @brief Envía los esquemas de todos los tipos.
+ */
+static void write_schemas(void) {
+    for (size_t i = 0; i < sizeof(schemas) / sizeof(schemas[0]); i++) {
+        char payload[160];
+        int length = snprintf(payload, sizeof(payload), "%c%s%c%s%c%s",
+                              (char)schemas[i].type, schemas[i].name, '\0',
+                              schemas[i].format, '\0', schemas[i].fields);
+        if (length > 0 && length < (int)sizeof(payload)) {
+            trace_write(TRACE_SCHEMA, payload, (uint16_t)(length + 1));
+        }
+    }
+}
+
+/**
+ * @brief Pasa los bytes recibidos del host a la entrada estándar.
+ *
+ * Si la cola está llena los bytes quedan en el FIFO del endpoint y el
+ * host espera.
+ */
+static void receive(void) {
+    while (tud_vendor_available()) {
+        uint32_t next = (rx_head + 1) % TRACE_RX_BUFFER_SIZE;
+        uint8_t byte;
+        if (next == rx_tail || tud_vendor_read(&byte, 1) != 1) break;
+        rx_buffer[rx_head] = byte;
+        rx_head = next;
+    }
+}
+
+/**
+ * @brief Entrega el buffer de envío al endpoint y lo intercambia al vaciarse.
+ */
+static void pump(void) {
+    if (send_offset == send_length) {
+        critical_section_enter_blocking(&lock);
+        if (fill_length > 0) {
+            send_index = fill_index;
+            send_length = fill_length;
+            send_offset = 0;
+            fill_index ^= 1;
+            fill_length = 0;
+        }
+        critical_section_exit(&lock);
+    }
+
+    uint32_t sent = 0;
+    while (send_offset < send_length) {
+        uint32_t space = tud_vendor_write_available();
+        if (space == 0) break;
+        uint32_t chunk = send_length - send_offset;
+        if (chunk > space) chunk = space;
+        uint32_t written = tud_vendor_write(&buffers[send_index][send_offset], chunk);
+        if (written == 0) break;
+        send_offset += written;
+        sent += written;
+    }
+
+    if (sent > 0) {
+        tud_vendor_write_flush();
+        critical_section_enter_blocking(&lock);
+        stats.bytes += sent;
+        critical_section_exit(&lock);
+    }
+}
+
+/**
+ * @brief Bucle del núcleo 1: pila USB, entrada estándar y envío.
+ */
+static void core1_main(void) {
+    // Permite que storage.c pause este núcleo mientras escribe la flash
+    flash_safe_execute_core_init();
+    tusb_init();
+
+    bool was_streaming = false;
+    uint32_t last_schema_ms = 0;
+    uint32_t last_stats_ms = 0;
+
+    while (true) {
+        tud_task();
+        receive();
+
+        uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+        if (streaming) {
+            // Esquemas al iniciar y periódicamente, por si el receptor se pierde alguno
+            if (!was_streaming || now_ms - last_schema_ms >= TRACE_SCHEMA_INTERVAL_MS) {
+                last_schema_ms = now_ms;
+                write_schemas();
+            }
+            if (now_ms - last_stats_ms >= TRACE_STATS_INTERVAL_MS) {
+                last_stats_ms = now_ms;
+                trace_stats_t snapshot = trace_get_stats();
+                trace_write(TRACE_STATS, &snapshot, sizeof(snapshot));
+            }
+            pump();
+        }
+        was_streaming = streaming;
+    }
+}
+
+/**
+ * @brief Salida estándar: cada escritura de printf es un registro de texto.
+ */
+static void stdio_trace_out_chars(const char* buf, int length) {
+    while (length > 0) {
+        int chunk = (length > TRACE_TEXT_MAX) ? TRACE_TEXT_MAX : length;
+        trace_write(TRACE_TEXT, buf, (uint16_t)chunk);
+        buf += chunk;
+        length -= chunk;
+    }
+}
+
+/**
+ * @brief Entrada estándar: bytes recibidos por el endpoint bulk OUT.
+ */
+static int stdio_trace_in_chars(char* buf, int length) {
+    int count = 0;
+    while (count < length && rx_tail != rx_head) {
+        buf[count++] = (char)rx_buffer[rx_tail];
+        rx_tail = (rx_tail + 1) % TRACE_RX_BUFFER_SIZE;
+    }
+    return count ? count : PICO_ERROR_NO_DATA;
+}
+
+/// @brief Driver de stdio sobre la traza
+static stdio_driver_t stdio_trace = {
+    .out_chars = stdio_trace_out_chars,
+    .in_chars = stdio_trace_in_chars,
+#if PICO_STDIO_ENABLE_CRLF_SUPPORT
+    .crlf_enabled = PICO_STDIO_DEFAULT_CRLF
+#endif
+};
+
+bool tud_vendor_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_request_t const* request) {
+    if (stage != CONTROL_STAGE_SETUP) return true;
+    if (request->bmRequestType_bit.type != TUSB_REQ_TYPE_VENDOR) return false;
+
+    switch (request->bRequest) {
+        case USB_REQUEST_TRACE:
+            set_streaming(request->wValue != 0);
+            return tud_control_status(rhport, request);
+
+        case USB_REQUEST_MICROSOFT:
+            // wIndex 7: conjunto de descriptores MS OS 2.0
+            if (request->wIndex != 7) return false;
+            return tud_control_xfer(rhport, request, (void*)(uintptr_t)usb_desc_ms_os_20,
+                                    USB_MS_OS_20_DESC_LEN);
+
+        default:
+            return false;
+    }
+}
+
+void tud_umount_cb(void) {
+    set_streaming(false);
+}
+
+void tud_suspend_cb(bool remote_wakeup_en) {
+    (void)remote_wakeup_en;
+    set_streaming(false);
+}
+
+void trace_init(void) {
+    if (initialized) return;
+
+    critical_section_init(&lock);
+    initialized = true;
+    multicore_launch_core1(core1_main);
+    stdio_set_driver_enabled(&stdio_trace, true);
+}
+
+bool trace_connected(void) {
+    return initialized && streaming;
+}
+
+bool trace_write(trace_type_t type, const void* payload, uint16_t length) {
+    if (!initialized || !streaming) return false;
+
+    trace_header_t header = {
+        .sync = TRACE_SYNC,
+        .type = (uint8_t)type,
+        .length = length,
+        .time_us = timebase_now_us()
+    };
+    uint32_t size = sizeof(header) + length;
+
+    critical_section_enter_blocking(&lock);
+    header.sequence = sequence++;
+    bool stored = streaming && fill_length + size <= TRACE_BUFFER_SIZE;
+    if (stored) {
+        uint8_t* dest = &buffers[fill_index][fill_length];
+        memcpy(dest, &header, sizeof(header));
+        memcpy(dest + sizeof(header), payload, length);
+        fill_length += size;
+        stats.records++;
+    } else {
+        stats.dropped++;
+    }
+    critical_section_exit(&lock);
+
+    return stored;
+}
+
+trace_stats_t trace_get_stats(void) {
+    if (!initialized) return (trace_stats_t){0};
+
+    critical_section_enter_blocking(&lock);
+    trace_stats_t copy = stats;
+    critical_section_exit(&lock);
+    return copy;
+}
+
+#else
+
+void trace_init(void) {
+}
+
+bool trace_connected(void) {
+    return false;
+}
+
+bool trace_write(trace_type_t type, const void* payload, uint16_t length) {
+    (void)type;
+    (void)payload;
+    (void)length;
+    return false;
+}
+
+trace_stats_t trace_get_stats(void) {
+    return (trace_stats_t){0};
+}
+
+#endif // WALLY_USB_TRACE
+
+void trace_test(void) {
+    printf("=== PRUEBA TRAZA USB ===\n");
+
+    if (!WALLY_USB_TRACE) {
+        printf("Compilado sin WALLY_USB_TRACE: la traza está deshabilitada\n");
+        return;
+    }
+
+    trace_init();
+    if (!motors_init()) {
+        printf("ERROR: No se pudieron inicializar los motores\n");
+        return;
+    }
+
+    // La salida de esta prueba también viaja por la traza: hace falta el receptor
+    uint32_t start_ms = to_ms_since_boot(get_absolute_time());
+    while (!trace_connected()) {
+        if (to_ms_since_boot(get_absolute_time()) - start_ms >= TEST_WAIT_S * 1000) return;
+        sleep_ms(100);
+    }
+
+    printf("Registros de motores a 1 kHz durante %d s (tools/trace_receiver.py)\n", TEST_DURATION_S);
+    sleep_ms(100);
+
+    trace_stats_t before = trace_get_stats();
+    absolute_time_t next = get_absolute_time();
+
+    for (int i = 0; i < TEST_DURATION_S * 1000 && trace_connected(); i++) {
+        motor_status_t a = motors_get_status(MOTOR_A);
+        motor_status_t b = motors_get_status(MOTOR_B);
+        trace_motors_t record = {
+            .rpm_a = (float)a.rpm,
+            .rpm_b = (float)b.rpm,
+            .current_a = (float)a.current,
+            .current_b = (float)b.current,
+            .pwm_a = (int16_t)a.speed,
+            .pwm_b = (int16_t)b.speed,
+            .pulses_a = a.pulses,
+            .pulses_b = b.pulses
+        };
+        trace_write(TRACE_MOTORS, &record, sizeof(record));
+
+        next = delayed_by_us(next, 1000);
+        sleep_until(next);
+    }
+
+    // Dar tiempo al núcleo 1 para vaciar los buffers antes de medir
+    sleep_ms(100);
+    trace_stats_t after = trace_get_stats();
+    uint32_t records = after.records - before.records;
+    uint32_t dropped = after.dropped - before.dropped;
+
+    printf("Registros: %lu escritos, %lu descartados (%.2f%%)\n",
+           (unsigned long)records, (unsigned long)dropped,
+           (records + dropped) ? 100.0 * dropped / (records + dropped) : 0.0);
+    printf("Caudal: %.1f KB/s\n", (after.bytes - before.bytes) / 1024.0 / TEST_DURATION_S);
+}
\ No newline at end of file
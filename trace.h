@@ -0,0 +1,161 @@
+/**
+ * @file trace.h
+ * @brief Header de la traza binaria por USB (interfaz vendor de TinyUSB).
+ *
+ * Los registros (bucle de control, motores, texto de printf) se escriben
+ * en un par de buffers alternados: el bucle llena uno mientras el núcleo 1
+ * entrega el otro completo al endpoint bulk IN. Escribir un registro es
+ * una copia de pocos bytes; si el buffer está lleno o no hay un receptor
+ * conectado el registro se descarta y el bucle nunca espera al USB.
+ *
+ * La salida estándar (printf) y la entrada (scanf del menú) también van
+ * por esta interfaz. El receptor es tools/trace_receiver.py.
+ *
+ * Formato (little endian): cada registro empieza con trace_header_t y
+ * sigue con su contenido. Los registros TRACE_SCHEMA describen el resto
+ * de los tipos (nombre, formato del módulo struct de Python y nombres de
+ * los campos) y se repiten periódicamente, así el receptor puede decodificar
+ * aunque se conecte con la traza en marcha.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "pico/stdlib.h"
+#include <stdint.h>
+
+/// @defgroup TRACE_STRUCTURES Estructuras de la traza
+/// @{
+
+/// @brief Primer byte de cada registro (resincronización)
+#define TRACE_SYNC 0xA5
+
+/**
+ * @brief Tipos de registro.
+ */
+typedef enum {
+    TRACE_SCHEMA = 0,    ///< Descripción de un tipo: tipo, nombre, formato y campos (separados por '\0')
+    TRACE_TEXT,          ///< Texto de printf
+    TRACE_STATS,         ///< Estadísticas de la traza (trace_stats_t)
+    TRACE_LOOP,          ///< Iteración del bucle de control (trace_loop_t)
+    TRACE_MOTORS,        ///< Estado de los motores (trace_motors_t)
+    TRACE_TYPE_COUNT     ///< Número de tipos
+} trace_type_t;
+
+/**
+ * @brief Cabecera de un registro.
+ */
+typedef struct {
+    uint8_t sync;        ///< TRACE_SYNC
+    uint8_t type;        ///< Tipo de registro (trace_type_t)
+    uint16_t length;     ///< Bytes de contenido tras la cabecera
+    uint32_t sequence;   ///< Número de registro (los descartados también cuentan)
+    uint64_t time_us;    ///< Momento de la escritura en la base de tiempo (timebase.h)
+} trace_header_t;
+
+/**
+ * @brief Iteración del bucle de control.
+ */
+typedef struct {
+    float heading;       ///< Rumbo medido en grados
+    float setpoint;      ///< Rumbo pedido al PID en grados
+    int16_t speed_a;     ///< PWM pedido al motor A
+    int16_t speed_b;     ///< PWM pedido al motor B
+    int32_t lat_e7;      ///< Latitud en 1e-7 grados
+    int32_t lng_e7;      ///< Longitud en 1e-7 grados
+    float hdop;          ///< HDOP del último fix
+    uint8_t fix;         ///< 1 si el fix es válido
+    uint8_t satellites;  ///< Satélites en uso
+    uint8_t mode;        ///< Modo de navegación (trace_mode_t)
+    uint8_t flags;       ///< Bit 0: PPS enganchado, bit 1: navegación en espera por GPS
+    uint32_t work_us;    ///< Duración del trabajo de la iteración en µs
+} trace_loop_t;
+
+/**
+ * @brief Modo de navegación de trace_loop_t.
+ */
+typedef enum {
+    TRACE_MODE_IDLE = 0, ///< Sin navegación
+    TRACE_MODE_TARGET,   ///< Objetivo único
+    TRACE_MODE_ROUTE,    ///< Ruta
+    TRACE_MODE_FOLLOW,   ///< Follow Me
+    TRACE_MODE_STEP      ///< Prueba de escalón del PID
+} trace_mode_t;
+
+/**
+ * @brief Estado de los dos motores.
+ */
+typedef struct {
+    float rpm_a;         ///< Velocidad de la rueda A
+    float rpm_b;         ///< Velocidad de la rueda B
+    float current_a;     ///< Corriente del motor A en A
+    float current_b;     ///< Corriente del motor B en A
+    int16_t pwm_a;       ///< PWM aplicado al motor A
+    int16_t pwm_b;       ///< PWM aplicado al motor B
+    uint32_t pulses_a;   ///< Pulsos acumulados del encoder A
+    uint32_t pulses_b;   ///< Pulsos acumulados del encoder B
+} trace_motors_t;
+
+/**
+ * @brief Estadísticas de la traza.
+ */
+typedef struct {
+    uint32_t records;    ///< Registros escritos
+    uint32_t dropped;    ///< Registros descartados por buffer lleno
+    uint32_t bytes;      ///< Bytes entregados al USB
+} trace_stats_t;
+
+/// @}
+
+/// @defgroup TRACE_FUNCTIONS Funciones de la traza
+/// @{
+
+/**
+ * @brief Inicia el USB en el núcleo 1 y redirige la salida estándar.
+ *
+ * Debe llamarse después de memory_init() (que pinta la pila del núcleo 1).
+ * Sin WALLY_USB_TRACE en la compilación no hace nada.
+ */
+void trace_init(void);
+
+/**
+ * @brief Indica si hay un receptor conectado.
+ *
+ * @return true si un receptor pidió la traza y el cable sigue conectado
+ */
+bool trace_connected(void);
+
+/**
+ * @brief Escribe un registro.
+ *
+ * Puede llamarse desde cualquier núcleo o interrupción. No bloquea.
+ *
+ * @param type Tipo de registro
+ * @param payload Contenido
+ * @param length Bytes de contenido
+ * @return true si el registro quedó en el buffer
+ */
+bool trace_write(trace_type_t type, const void* payload, uint16_t length);
+
+/**
+ * @brief Obtiene las estadísticas de la traza.
+ *
+ * @return Copia de las estadísticas
+ */
+trace_stats_t trace_get_stats(void);
+
+/**
+ * @brief Función de prueba de la traza.
+ *
+ * Escribe registros de motores a 1 kHz durante 10 s y muestra el caudal
+ * entregado y los descartes.
+ */
+void trace_test(void);
+
+/// @}
+
+#endif // TRACE_H
\ No newline at end of file
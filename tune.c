@@ -0,0 +1,331 @@
+/**
+ * @file tune.c
+ * @brief Implementación del ajuste de controladores PID en vivo.
+ *
+ * Los controladores se registran por nombre. La prueba de escalón la
+ * ejecuta el bucle principal: pide la referencia a este módulo, calcula
+ * el PID y devuelve la muestra. Al terminar, los datos se envían en
+ * porciones pequeñas: bluetooth_send_data() espera a la UART, así que cada
+ * iteración del bucle solo le cede unos pocos milisegundos.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "tune.h"
+#include "bluetooth.h"
+#include "storage.h"
+#include "config.h"
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+
+/**
+ * @brief Controlador registrado.
+ */
+typedef struct {
+    char name[8];            ///< Nombre usado en los comandos
+    pid_controller_t* pid;   ///< Controlador
+} tune_entry_t;
+
+/// @brief Controladores registrados
+static tune_entry_t entries[TUNE_MAX_CONTROLLERS];
+static int entry_count = 0;
+
+/// @brief Estado de la prueba de escalón
+static bool step_active = false;
+static int step_entry = 0;
+static double step_amplitude = 0.0;
+static double step_baseline = 0.0;
+static bool baseline_set = false;
+static int step_target = 0;
+static uint32_t first_us = 0;
+static uint32_t last_us = 0;
+
+/// @brief Muestras capturadas
+static tune_sample_t samples[TUNE_MAX_SAMPLES];
+static int sample_count = 0;
+
+/// @brief Profundidad de la FIFO de transmisión de la UART del RP2040
+#define UART_TX_FIFO_BYTES 32
+
+/// @brief Envío de las muestras en curso
+static bool streaming = false;
+static size_t stream_offset = 0;
+static size_t stream_length = 0;
+
+/**
+ * @brief Busca un controlador por nombre.
+ *
+ * @return Índice o -1 si no existe
+ */
+static int find_entry(const char* name) {
+    for (int i = 0; i < entry_count; i++) {
+        if (strcmp(entries[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+/**
+ * @brief Termina la prueba y envía la cabecera de los datos.
+ */
+static void finish_step(void) {
+    step_active = false;
+
+    uint32_t period_us = (sample_count > 1) ? (last_us - first_us) / (sample_count - 1) : 0;
+    stream_length = sample_count * sizeof(tune_sample_t);
+    stream_offset = 0;
+    streaming = true;
+
+    char header[80];
+    snprintf(header, sizeof(header), "STEPDATA,%s,%d,%lu,%lu,%08lx\n",
+             entries[step_entry].name, sample_count, (unsigned long)period_us,
+             (unsigned long)stream_length,
+             (unsigned long)storage_crc32(samples, stream_length));
+    bluetooth_send_string(header);
+}
+
+bool tune_register(const char* name, pid_controller_t* pid) {
+    if (!name || !pid) return false;
+
+    int index = find_entry(name);
+    if (index < 0) {
+        if (entry_count >= TUNE_MAX_CONTROLLERS) return false;
+        index = entry_count++;
+    }
+
+    strncpy(entries[index].name, name, sizeof(entries[index].name) - 1);
+    entries[index].name[sizeof(entries[index].name) - 1] = '\0';
+    entries[index].pid = pid;
+    return true;
+}
+
+void tune_unregister(const char* name) {
+    int index = name ? find_entry(name) : -1;
+    if (index < 0) return;
+
+    // Una prueba de escalón en curso no puede seguir sin su controlador
+    if (step_active && step_entry == index) {
+        step_active = false;
+    } else if (step_entry > index) {
+        step_entry--;
+    }
+
+    for (int i = index; i < entry_count - 1; i++) {
+        entries[i] = entries[i + 1];
+    }
+    entry_count--;
+}
+
+bool tune_handle_command(const char* line) {
+    if (!line) return false;
+
+    char reply[96];
+    char name[8];
+
+    if (strcmp(line, "TUNE?") == 0) {
+        for (int i = 0; i < entry_count; i++) {
+            pid_controller_t* pid = entries[i].pid;
+            snprintf(reply, sizeof(reply), "GAINS,%s,%.4f,%.4f,%.4f,%.1f,%.1f\n",
+                     entries[i].name, pid->kp, pid->ki, pid->kd,
+                     pid->output_min, pid->output_max);
+            bluetooth_send_string(reply);
+        }
+        return true;
+    }
+
+    if (strcmp(line, "STEPABORT") == 0) {
+        tune_step_abort();
+        bluetooth_send_string("STEPERR,CANCELADA\n");
+        return true;
+    }
+
+    if (strncmp(line, "TUNE,", 5) == 0) {
+        double a, b, c;
+        int index;
+
+        if (sscanf(line + 5, "%7[^,],LIM,%lf,%lf", name, &a, &b) == 3 &&
+            (index = find_entry(name)) >= 0 && a < b) {
+            pid_set_output_limits(entries[index].pid, a, b);
+            snprintf(reply, sizeof(reply), "TUNED,%s,LIM,%.1f,%.1f\n", name, a, b);
+        } else if (sscanf(line + 5, "%7[^,],%lf,%lf,%lf", name, &a, &b, &c) == 4 &&
+                   (index = find_entry(name)) >= 0 && a >= 0.0 && b >= 0.0 && c >= 0.0) {
+            pid_tune(entries[index].pid, a, b, c);
+            snprintf(reply, sizeof(reply), "TUNED,%s,%.4f,%.4f,%.4f\n", name, a, b, c);
+        } else {
+            snprintf(reply, sizeof(reply), "TUNEERR,FORMATO\n");
+        }
+
+        bluetooth_send_string(reply);
+        return true;
+    }
+
+    if (strncmp(line, "STEP,", 5) == 0) {
+        double amplitude;
+        unsigned long duration_ms;
+        int index;
+
+        if (sscanf(line + 5, "%7[^,],%lf,%lu", name, &amplitude, &duration_ms) != 3 ||
+            (index = find_entry(name)) < 0) {
+            bluetooth_send_string("STEPERR,FORMATO\n");
+            return true;
+        }
+        if (step_active || streaming) {
+            bluetooth_send_string("STEPERR,OCUPADO\n");
+            return true;
+        }
+
+        step_target = (int)(duration_ms / LOOP_INTERVAL_MS) + TUNE_PRETRIGGER_SAMPLES;
+        if (step_target > TUNE_MAX_SAMPLES) step_target = TUNE_MAX_SAMPLES;
+
+        step_entry = index;
+        step_amplitude = amplitude;
+        baseline_set = false;
+        sample_count = 0;
+        step_active = true;
+        pid_reset(entries[index].pid);
+
+        snprintf(reply, sizeof(reply), "STEPOK,%s,%d\n", name, step_target);
+        bluetooth_send_string(reply);
+        return true;
+    }
+
+    return false;
+}
+
+pid_controller_t* tune_step_controller(void) {
+    return step_active ? entries[step_entry].pid : NULL;
+}
+
+double tune_step_setpoint(double input) {
+    if (!baseline_set) {
+        step_baseline = input;
+        baseline_set = true;
+    }
+
+    return (sample_count < TUNE_PRETRIGGER_SAMPLES) ? step_baseline
+                                                    : step_baseline + step_amplitude;
+}
+
+bool tune_step_record(double setpoint, double input, double output, uint32_t now_us) {
+    if (!step_active) return false;
+
+    if (sample_count == 0) first_us = now_us;
+    last_us = now_us;
+
+    samples[sample_count].setpoint = (float)setpoint;
+    samples[sample_count].input = (float)input;
+    samples[sample_count].output = (float)output;
+    sample_count++;
+
+    if (sample_count >= step_target) {
+        finish_step();
+        return false;
+    }
+
+    return true;
+}
+
+void tune_step_abort(void) {
+    step_active = false;
+    streaming = false;
+}
+
+void tune_update(void) {
+    if (!streaming) return;
+
+    // La FIFO toma sus bytes sin esperar; el resto bloquea a lo sumo TUNE_STREAM_BLOCK_US
+    size_t budget = UART_TX_FIFO_BYTES +
+                    (size_t)((uint64_t)bluetooth_get_baud() / 10 * TUNE_STREAM_BLOCK_US / 1000000);
+
+    size_t remaining = stream_length - stream_offset;
+    size_t length = (remaining < budget) ? remaining : budget;
+
+    bluetooth_send_data((const uint8_t*)samples + stream_offset, length);
+    stream_offset += length;
+
+    if (stream_offset >= stream_length) {
+        streaming = false;
+    }
+}
+
+const tune_sample_t* tune_get_samples(int* count) {
+    if (count) *count = sample_count;
+    return samples;
+}
+
+/**
+ * @brief Ejecuta una prueba de escalón sobre un modelo del rumbo.
+ *
+ * Modelo: la corrección diferencial produce una velocidad de giro de
+ * 0.9 °/s por unidad con un retardo de primer orden de 0.3 s.
+ */
+static void simulate_step(pid_controller_t* pid) {
+    const double dt = LOOP_INTERVAL_MS / 1000.0;
+    double heading = 90.0;
+    double yaw_rate = 0.0;
+    uint32_t now_us = 0;
+
+    tune_handle_command("STEP,SIM,30,5000");
+
+    while (tune_step_controller() == pid) {
+        double setpoint = tune_step_setpoint(heading);
+        pid_set_setpoint(pid, setpoint);
+        double output = pid_compute_dt(pid, heading, dt);
+
+        tune_step_record(setpoint, heading, output, now_us);
+
+        yaw_rate += (0.9 * output - yaw_rate) * dt / 0.3;
+        heading += yaw_rate * dt;
+        now_us += LOOP_INTERVAL_MS * 1000;
+    }
+
+    // Métricas desde la muestra del escalón
+    int count;
+    const tune_sample_t* data = tune_get_samples(&count);
+    if (count <= TUNE_PRETRIGGER_SAMPLES) {
+        printf("  Kp=%.2f Ki=%.2f Kd=%.2f -> escalón sin muestras\n", pid->kp, pid->ki, pid->kd);
+        tune_step_abort();
+        return;
+    }
+    double target = data[count - 1].setpoint;
+    double start = data[0].input;
+    double peak = start;
+    int settle = TUNE_PRETRIGGER_SAMPLES;
+
+    for (int i = TUNE_PRETRIGGER_SAMPLES; i < count; i++) {
+        if (data[i].input > peak) peak = data[i].input;
+        if (fabs(data[i].input - target) > 0.05 * fabs(target - start)) settle = i + 1;
+    }
+
+    printf("  Kp=%.2f Ki=%.2f Kd=%.2f -> sobreimpulso %.1f%%, establecimiento %.2f s, %d muestras\n",
+           pid->kp, pid->ki, pid->kd, 100.0 * (peak - target) / (target - start),
+           (settle - TUNE_PRETRIGGER_SAMPLES) * LOOP_INTERVAL_MS / 1000.0, count);
+
+    while (streaming) {
+        tune_update();
+    }
+}
+
+void tune_test(void) {
+    printf("=== PRUEBA AJUSTE PID EN VIVO (SIMULACIÓN) ===\n");
+
+    pid_controller_t pid;
+    pid_init_angular(&pid, KP_DIR, KI_DIR, KD_DIR, -50.0, 50.0);
+    tune_register("SIM", &pid);
+
+    printf("Escalón de 30° en el rumbo:\n");
+    simulate_step(&pid);
+
+    tune_handle_command("TUNE,SIM,1.2,0.05,0.3");
+    simulate_step(&pid);
+
+    tune_handle_command("TUNE,SIM,1.5,0.0,0.4");
+    simulate_step(&pid);
+
+    // pid vive en esta pila: no debe quedar accesible por TUNE ni STEP
+    tune_unregister("SIM");
+
+    printf("Prueba de ajuste completada\n");
+}
\ No newline at end of file
@@ -0,0 +1,140 @@
+/**
+ * @file tune.h
+ * @brief Header del ajuste de controladores PID en vivo.
+ *
+ * Permite cambiar ganancias y límites de los PID registrados desde la app
+ * y lanzar pruebas de escalón que registran referencia, entrada y salida
+ * a la frecuencia de control y las devuelven en binario.
+ *
+ * Protocolo:
+ * - "TUNE,<pid>,<kp>,<ki>,<kd>": cambia las ganancias -> "TUNED,<pid>,<kp>,<ki>,<kd>"
+ * - "TUNE,<pid>,LIM,<min>,<max>": cambia los límites de salida
+ * - "TUNE?": responde "GAINS,<pid>,<kp>,<ki>,<kd>,<min>,<max>" por cada PID
+ * - "STEP,<pid>,<amplitud>,<duracion_ms>": inicia una prueba de escalón
+ * - "STEPABORT": cancela la prueba
+ * - Al terminar: "STEPDATA,<pid>,<muestras>,<periodo_us>,<bytes>,<crc32_hex>"
+ *   seguido de <bytes> bytes binarios: por muestra tres float32 little-endian
+ *   (referencia, entrada, salida)
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef TUNE_H
+#define TUNE_H
+
+#include "pico/stdlib.h"
+#include "pid.h"
+#include <stdint.h>
+
+/// @defgroup TUNE_STRUCTURES Estructuras del ajuste
+/// @{
+
+/**
+ * @brief Muestra de una prueba de escalón.
+ */
+typedef struct {
+    float setpoint;  ///< Referencia
+    float input;     ///< Variable medida
+    float output;    ///< Salida del controlador
+} tune_sample_t;
+
+/// @}
+
+/// @defgroup TUNE_FUNCTIONS Funciones del ajuste
+/// @{
+
+/**
+ * @brief Registra un controlador para que se pueda ajustar por nombre.
+ *
+ * @param name Nombre corto usado en los comandos (ej. "HDG")
+ * @param pid Controlador
+ * @return false si no quedan espacios
+ */
+bool tune_register(const char* name, pid_controller_t* pid);
+
+/**
+ * @brief Quita un controlador registrado.
+ *
+ * Debe llamarse antes de que el controlador deje de existir. Si estaba en
+ * una prueba de escalón, la prueba se cancela.
+ *
+ * @param name Nombre con el que se registró
+ */
+void tune_unregister(const char* name);
+
+/**
+ * @brief Procesa los comandos TUNE, TUNE?, STEP y STEPABORT.
+ *
+ * @param line Línea recibida
+ * @return true si la línea era un comando de ajuste
+ */
+bool tune_handle_command(const char* line);
+
+/**
+ * @brief Obtiene el controlador bajo prueba de escalón.
+ *
+ * @return Controlador en prueba o NULL si no hay prueba activa
+ */
+pid_controller_t* tune_step_controller(void);
+
+/**
+ * @brief Obtiene la referencia de la prueba de escalón para esta iteración.
+ *
+ * La primera llamada fija la línea base con la entrada actual. Durante
+ * las primeras TUNE_PRETRIGGER_SAMPLES muestras devuelve la línea base y
+ * después la línea base más la amplitud.
+ *
+ * @param input Valor medido actual
+ * @return Referencia a aplicar
+ */
+double tune_step_setpoint(double input);
+
+/**
+ * @brief Registra una muestra de la prueba de escalón.
+ *
+ * Al completar la duración pedida la prueba termina y comienza el envío
+ * de los datos.
+ *
+ * @param setpoint Referencia aplicada
+ * @param input Valor medido
+ * @param output Salida del controlador
+ * @param now_us Tiempo de la muestra en us
+ * @return true si la prueba sigue activa
+ */
+bool tune_step_record(double setpoint, double input, double output, uint32_t now_us);
+
+/**
+ * @brief Cancela la prueba de escalón en curso.
+ */
+void tune_step_abort(void);
+
+/**
+ * @brief Envía una porción de los datos capturados.
+ *
+ * Envía lo que cabe en la FIFO de la UART más lo que el enlace transmite
+ * en TUNE_STREAM_BLOCK_US, para que el envío no ocupe el ciclo de control.
+ */
+void tune_update(void);
+
+/**
+ * @brief Obtiene las muestras de la última prueba.
+ *
+ * @param[out] count Número de muestras
+ * @return Puntero a las muestras
+ */
+const tune_sample_t* tune_get_samples(int* count);
+
+/**
+ * @brief Función de prueba del ajuste en vivo.
+ *
+ * Simula la respuesta del rumbo a escalones de 30° con dos juegos de
+ * ganancias enviados como comandos y muestra sobreimpulso y tiempo de
+ * establecimiento de cada uno.
+ */
+void tune_test(void);
+
+/// @}
+
+#endif // TUNE_H
\ No newline at end of file
@@ -0,0 +1,36 @@
+/**
+ * @file tusb_config.h
+ * @brief Configuración de TinyUSB para la traza binaria (trace.c).
+ *
+ * Dispositivo con una sola interfaz vendor: endpoint bulk IN para los
+ * registros y bulk OUT para la entrada estándar. CFG_TUSB_MCU y
+ * CFG_TUSB_OS los define el SDK de la Pico.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef TUSB_CONFIG_H
+#define TUSB_CONFIG_H
+
+/// @brief Puerto USB en modo dispositivo
+#define CFG_TUSB_RHPORT0_MODE OPT_MODE_DEVICE
+
+/// @brief Tamaño del endpoint de control
+#define CFG_TUD_ENDPOINT0_SIZE 64
+
+/// @brief Clases habilitadas: solo vendor
+#define CFG_TUD_CDC 0
+#define CFG_TUD_MSC 0
+#define CFG_TUD_HID 0
+#define CFG_TUD_MIDI 0
+#define CFG_TUD_VENDOR 1
+
+/// @brief FIFO de recepción (entrada estándar desde el host)
+#define CFG_TUD_VENDOR_RX_BUFSIZE 64
+
+/// @brief FIFO de transmisión (se llena desde el buffer que entrega trace.c)
+#define CFG_TUD_VENDOR_TX_BUFSIZE 1024
+
+#endif // TUSB_CONFIG_H
\ No newline at end of file
@@ -0,0 +1,509 @@
+/**
+ * @file upload.c
+ * @brief Implementación de la carga confiable de rutas y geocercas.
+ *
+ * El receptor acepta fragmentos en cualquier orden dentro de una ventana
+ * de UPLOAD_WINDOW fragmentos, verifica el CRC16 de cada uno y lo programa
+ * en flash en su posición. Una sola confirmación selectiva por iteración
+ * del bucle informa al emisor qué huecos debe retransmitir.
+ *
+ * Los fragmentos se programan en la región de preparación. La ruta o la
+ * geocerca guardada solo se reemplaza cuando el CRC32 del total coincide y
+ * los datos son válidos; una carga cancelada, vencida o corrupta deja los
+ * datos anteriores intactos.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "upload.h"
+#include "bluetooth.h"
+#include "storage.h"
+#include "route.h"
+#include "geofence.h"
+#include "config.h"
+#include <string.h>
+#include <stdlib.h>
+
+/// @brief Nombres de los tipos de carga
+static const char* const type_names[] = { "ROUTE", "FENCE" };
+
+/// @brief true si hay una carga en curso
+static bool active = false;
+
+/// @brief Tipo de la carga en curso (índice en type_names)
+static int upload_type = 0;
+
+/// @brief Tamaño total y CRC32 esperados
+static uint32_t total_bytes = 0;
+static uint32_t total_crc = 0;
+
+/// @brief Número de fragmentos y primer fragmento pendiente
+static uint32_t chunk_count = 0;
+static uint32_t base = 0;
+
+/// @brief Fragmentos recibidos
+static bool received[UPLOAD_MAX_CHUNKS];
+
+/// @brief true si hay que enviar un ACK en la próxima actualización
+static bool ack_pending = false;
+
+/// @brief Tiempo del último fragmento recibido
+static uint32_t last_chunk_ms = 0;
+
+/// @brief Estadísticas de la carga
+static upload_stats_t stats;
+
+/// @brief Última respuesta enviada y contador (para la simulación)
+static char last_reply[48];
+static uint32_t reply_count = 0;
+
+/// @brief true durante la simulación: la carga se verifica pero no se instala
+static bool dry_run = false;
+
+/**
+ * @brief Envía una respuesta a la app.
+ */
+static void send_reply(const char* reply) {
+    strncpy(last_reply, reply, sizeof(last_reply) - 1);
+    last_reply[sizeof(last_reply) - 1] = '\0';
+    reply_count++;
+    bluetooth_send_string(reply);
+}
+
+/**
+ * @brief Calcula el CRC16-CCITT (polinomio 0x1021, valor inicial 0xFFFF).
+ */
+static uint16_t crc16(const uint8_t* data, size_t length) {
+    uint16_t crc = 0xFFFF;
+
+    for (size_t i = 0; i < length; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+/**
+ * @brief Valor de un carácter base64, -1 si no es válido.
+ */
+static int base64_value(char c) {
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if (c >= '0' && c <= '9') return c - '0' + 52;
+    if (c == '+') return 62;
+    if (c == '/') return 63;
+    return -1;
+}
+
+/**
+ * @brief Decodifica base64 (con o sin relleno '=').
+ *
+ * @return Bytes decodificados, -1 si hay caracteres inválidos o no caben
+ */
+static int base64_decode(const char* text, size_t length, uint8_t* out, size_t max_out) {
+    uint32_t accumulator = 0;
+    int bits = 0;
+    size_t count = 0;
+
+    for (size_t i = 0; i < length && text[i] != '='; i++) {
+        int value = base64_value(text[i]);
+        if (value < 0) return -1;
+
+        accumulator = (accumulator << 6) | (uint32_t)value;
+        bits += 6;
+
+        if (bits >= 8) {
+            bits -= 8;
+            if (count >= max_out) return -1;
+            out[count++] = (uint8_t)(accumulator >> bits);
+        }
+    }
+
+    return (int)count;
+}
+
+/**
+ * @brief Codifica en base64 con relleno (usado por la simulación del emisor).
+ */
+static void base64_encode(const uint8_t* data, size_t length, char* out) {
+    static const char alphabet[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    size_t o = 0;
+
+    for (size_t i = 0; i < length; i += 3) {
+        uint32_t block = (uint32_t)data[i] << 16;
+        if (i + 1 < length) block |= (uint32_t)data[i + 1] << 8;
+        if (i + 2 < length) block |= data[i + 2];
+
+        out[o++] = alphabet[(block >> 18) & 0x3F];
+        out[o++] = alphabet[(block >> 12) & 0x3F];
+        out[o++] = (i + 1 < length) ? alphabet[(block >> 6) & 0x3F] : '=';
+        out[o++] = (i + 2 < length) ? alphabet[block & 0x3F] : '=';
+    }
+    out[o] = '\0';
+}
+
+/**
+ * @brief Inicia una carga a partir del comando UPLOAD.
+ */
+static void begin_upload(const char* args, uint32_t now_ms) {
+    char reply[48];
+    char type[8];
+    unsigned long bytes = 0, crc = 0;
+
+    if (sscanf(args, "%7[A-Z],%lu,%lx", type, &bytes, &crc) != 3) {
+        send_reply("UPERR,FORMATO\n");
+        return;
+    }
+
+    int index = -1;
+    for (int i = 0; i < 2; i++) {
+        if (strcmp(type, type_names[i]) == 0) index = i;
+    }
+
+    uint32_t chunks = (bytes + UPLOAD_CHUNK_SIZE - 1) / UPLOAD_CHUNK_SIZE;
+
+    if (index < 0) {
+        send_reply("UPERR,TIPO\n");
+        return;
+    }
+    if (bytes == 0 || chunks > UPLOAD_MAX_CHUNKS) {
+        send_reply("UPERR,TAMANO\n");
+        return;
+    }
+    if (index == 0 && !dry_run && route_is_active()) {
+        send_reply("UPERR,OCUPADO\n");
+        return;
+    }
+    if (!storage_begin(STORAGE_REGION_STAGING, bytes)) {
+        send_reply("UPERR,TAMANO\n");
+        return;
+    }
+
+    active = true;
+    upload_type = index;
+    total_bytes = bytes;
+    total_crc = crc;
+    chunk_count = chunks;
+    base = 0;
+    memset(received, 0, sizeof(received));
+    memset(&stats, 0, sizeof(stats));
+    ack_pending = false;
+    last_chunk_ms = now_ms;
+
+    snprintf(reply, sizeof(reply), "UPOK,%lu,%d,%d\n",
+             (unsigned long)chunk_count, UPLOAD_WINDOW, UPLOAD_CHUNK_SIZE);
+    send_reply(reply);
+}
+
+/**
+ * @brief Verifica el total y entrega los datos preparados al módulo destino.
+ */
+static void finish_upload(void) {
+    char reply[48];
+    active = false;
+
+    if (!storage_commit(STORAGE_REGION_STAGING, total_bytes, total_crc)) {
+        send_reply("UPERR,CRC\n");
+        return;
+    }
+
+    bool valid = dry_run || (upload_type == 0 ? route_install(STORAGE_REGION_STAGING)
+                                              : geofence_install(STORAGE_REGION_STAGING));
+    if (!valid) {
+        send_reply("UPERR,DATOS\n");
+        return;
+    }
+
+    snprintf(reply, sizeof(reply), "UPDONE,%s,%lu\n",
+             type_names[upload_type], (unsigned long)total_bytes);
+    send_reply(reply);
+}
+
+/**
+ * @brief Procesa un fragmento "D,<seq>,<base64>,<crc16>".
+ */
+static void handle_chunk(const char* args, uint32_t now_ms) {
+    char* end;
+    uint32_t seq = (uint32_t)strtoul(args, &end, 10);
+    if (*end != ',') {
+        stats.crc_errors++;
+        return;
+    }
+
+    const char* data = end + 1;
+    const char* comma = strchr(data, ',');
+    if (!comma) {
+        stats.crc_errors++;
+        return;
+    }
+
+    last_chunk_ms = now_ms;
+    ack_pending = true;
+
+    if (seq < base || (seq < chunk_count && received[seq])) {
+        stats.duplicates++;
+        return;
+    }
+    if (seq >= chunk_count || seq >= base + UPLOAD_WINDOW) {
+        stats.out_of_window++;
+        return;
+    }
+
+    uint8_t payload[UPLOAD_CHUNK_SIZE];
+    uint32_t expected = (seq + 1 == chunk_count) ? total_bytes - seq * UPLOAD_CHUNK_SIZE
+                                                 : UPLOAD_CHUNK_SIZE;
+    int length = base64_decode(data, comma - data, payload, sizeof(payload));
+
+    if (length != (int)expected ||
+        crc16(payload, length) != (uint16_t)strtoul(comma + 1, NULL, 16)) {
+        stats.crc_errors++;
+        return;
+    }
+
+    // Sin el fragmento en flash la carga no puede completarse: cancelar ya
+    if (!storage_program(STORAGE_REGION_STAGING, seq * UPLOAD_CHUNK_SIZE, payload, length)) {
+        active = false;
+        ack_pending = false;
+        send_reply("UPERR,FLASH\n");
+        return;
+    }
+
+    received[seq] = true;
+    stats.chunks_ok++;
+
+    while (base < chunk_count && received[base]) {
+        base++;
+    }
+}
+
+bool upload_handle_line(const char* line, uint32_t now_ms) {
+    if (!line) return false;
+
+    if (strncmp(line, "UPLOAD,", 7) == 0) {
+        begin_upload(line + 7, now_ms);
+        return true;
+    }
+
+    if (strcmp(line, "UPABORT") == 0) {
+        active = false;
+        send_reply("UPERR,CANCELADO\n");
+        return true;
+    }
+
+    if (strncmp(line, "D,", 2) == 0) {
+        if (active) {
+            handle_chunk(line + 2, now_ms);
+        }
+        return true;
+    }
+
+    return false;
+}
+
+void upload_update(uint32_t now_ms) {
+    if (!active) return;
+
+    if (ack_pending) {
+        // Máscara de los fragmentos recibidos por encima de base
+        uint32_t mask = 0;
+        for (uint32_t i = 0; i < 32 && base + 1 + i < chunk_count; i++) {
+            if (received[base + 1 + i]) mask |= 1u << i;
+        }
+
+        char reply[32];
+        snprintf(reply, sizeof(reply), "ACK,%lu,%lx\n", (unsigned long)base, (unsigned long)mask);
+        send_reply(reply);
+        stats.acks_sent++;
+        ack_pending = false;
+
+        if (base == chunk_count) {
+            finish_upload();
+        }
+        return;
+    }
+
+    if (now_ms - last_chunk_ms > UPLOAD_TIMEOUT_MS) {
+        active = false;
+        send_reply("UPERR,TIEMPO\n");
+    }
+}
+
+bool upload_is_active(void) {
+    return active;
+}
+
+upload_stats_t upload_get_stats(void) {
+    return stats;
+}
+
+/**
+ * @brief Línea en tránsito en el enlace simulado.
+ */
+typedef struct {
+    uint32_t arrival_ms;  ///< Momento de llegada
+    char text[BT_LINE_MAX];
+} sim_line_t;
+
+void upload_test(void) {
+    printf("=== PRUEBA CARGA CONFIABLE (SIMULACIÓN) ===\n");
+
+    // Enlace: 115200 baudios (11.52 bytes/ms), 30 ms de latencia por sentido
+    const double bytes_per_ms = 11.52;
+    const uint32_t latency_ms = 30;
+    const uint32_t rto_ms = 400;
+    const int points = 200;
+
+    static route_record_t route_data[200];
+    for (int i = 0; i < points; i++) {
+        route_data[i].lat_e7 = 62673000 + i * 90;
+        route_data[i].lng_e7 = -755688000 + (i % 20) * 90;
+        route_data[i].speed_cms = 40;
+        route_data[i].reserved = 0;
+    }
+    const uint8_t* data = (const uint8_t*)route_data;
+    uint32_t length = points * sizeof(route_record_t);
+    uint32_t chunks = (length + UPLOAD_CHUNK_SIZE - 1) / UPLOAD_CHUNK_SIZE;
+
+    // Estado del emisor
+    static bool acked[UPLOAD_MAX_CHUNKS];
+    static uint32_t sent_ms[UPLOAD_MAX_CHUNKS];
+    static bool lost[UPLOAD_MAX_CHUNKS];
+    memset(acked, 0, sizeof(acked));
+    memset(lost, 0, sizeof(lost));
+    memset(sent_ms, 0, sizeof(sent_ms));
+    uint32_t sender_base = 0;
+    uint32_t transmissions = 0;
+    uint32_t sent_bytes = 0;
+
+    static sim_line_t to_robot[64];
+    static sim_line_t to_app[16];
+    int robot_pending = 0, app_pending = 0;
+    double link_free_ms = 0.0;
+    uint32_t seed = 1234;
+    uint32_t seen_replies = reply_count;
+    bool started = false, done = false;
+    uint32_t done_ms = 0;
+
+    // La ruta guardada no se toca: la carga termina en la región de preparación
+    dry_run = true;
+
+    char line[BT_LINE_MAX];
+    snprintf(line, sizeof(line), "UPLOAD,ROUTE,%lu,%08lx",
+             (unsigned long)length, (unsigned long)storage_crc32(data, length));
+    upload_handle_line(line, 0);
+
+    for (uint32_t t = 0; t < 30000 && !done; t++) {
+        // Entregar al emisor las respuestas del robot
+        for (int i = 0; i < app_pending; i++) {
+            if (to_app[i].arrival_ms > t) continue;
+
+            unsigned long ack_base, mask;
+            if (strncmp(to_app[i].text, "UPOK", 4) == 0) {
+                started = true;
+            } else if (sscanf(to_app[i].text, "ACK,%lu,%lx", &ack_base, &mask) == 2) {
+                for (uint32_t s = 0; s < ack_base; s++) acked[s] = true;
+                uint32_t highest = ack_base;
+                for (uint32_t b = 0; b < 32; b++) {
+                    if (mask & (1ul << b)) {
+                        acked[ack_base + 1 + b] = true;
+                        highest = ack_base + 1 + b;
+                    }
+                }
+                // Huecos enviados antes que el mayor confirmado: perdidos
+                for (uint32_t s = ack_base; s < highest; s++) {
+                    if (!acked[s] && sent_ms[s] < sent_ms[highest]) lost[s] = true;
+                }
+                while (sender_base < chunks && acked[sender_base]) sender_base++;
+            } else if (strncmp(to_app[i].text, "UPDONE", 6) == 0) {
+                done = true;
+                done_ms = t;
+            }
+            to_app[i--] = to_app[--app_pending];
+        }
+
+        // Emisor: un fragmento cada vez que el enlace queda libre
+        if (started && link_free_ms <= t && robot_pending < 64) {
+            for (uint32_t s = sender_base; s < chunks && s < sender_base + UPLOAD_WINDOW; s++) {
+                bool never_sent = (sent_ms[s] == 0);
+                if (acked[s] || !(never_sent || lost[s] || t - sent_ms[s] > rto_ms)) continue;
+
+                uint32_t chunk_len = (s + 1 == chunks) ? length - s * UPLOAD_CHUNK_SIZE
+                                                       : UPLOAD_CHUNK_SIZE;
+                char encoded[UPLOAD_CHUNK_SIZE * 4 / 3 + 4];
+                base64_encode(data + s * UPLOAD_CHUNK_SIZE, chunk_len, encoded);
+                int n = snprintf(to_robot[robot_pending].text, BT_LINE_MAX, "D,%lu,%s,%04x",
+                                 (unsigned long)s, encoded,
+                                 crc16(data + s * UPLOAD_CHUNK_SIZE, chunk_len));
+
+                link_free_ms = t + (n + 1) / bytes_per_ms;
+                sent_ms[s] = t ? t : 1;
+                lost[s] = false;
+                transmissions++;
+                sent_bytes += n + 1;
+
+                // 5% de líneas perdidas y 2% con un carácter alterado
+                seed = seed * 1103515245u + 12345u;
+                uint32_t roll = (seed >> 16) % 100;
+                if (roll < 5) break;
+                if (roll < 7) to_robot[robot_pending].text[10] ^= 0x01;
+
+                to_robot[robot_pending].arrival_ms = (uint32_t)link_free_ms + latency_ms;
+                robot_pending++;
+                break;
+            }
+        }
+
+        // Robot: bucle de LOOP_INTERVAL_MS con hasta BT_MAX_LINES_PER_LOOP líneas
+        if (t % LOOP_INTERVAL_MS == 0) {
+            int processed = 0;
+            for (int i = 0; i < robot_pending && processed < BT_MAX_LINES_PER_LOOP; i++) {
+                if (to_robot[i].arrival_ms > t) continue;
+                upload_handle_line(to_robot[i].text, t);
+                processed++;
+                to_robot[i--] = to_robot[--robot_pending];
+            }
+            upload_update(t);
+        }
+
+        if (reply_count != seen_replies && app_pending < 16) {
+            seen_replies = reply_count;
+            strncpy(to_app[app_pending].text, last_reply, BT_LINE_MAX - 1);
+            to_app[app_pending].text[BT_LINE_MAX - 1] = '\0';
+            to_app[app_pending].arrival_ms = t + latency_ms + 2;
+            app_pending++;
+        }
+    }
+
+    dry_run = false;
+
+    // Parada y espera: cada fragmento espera su ACK (envío + ida y vuelta + bucle)
+    double chunk_ms = (sent_bytes / (double)transmissions) / bytes_per_ms;
+    double stop_wait_ms = chunks * (chunk_ms + 2 * latency_ms + LOOP_INTERVAL_MS / 2.0);
+
+    printf("Ruta de %d puntos: %lu bytes en %lu fragmentos\n",
+           points, (unsigned long)length, (unsigned long)chunks);
+    printf("Enviados %lu fragmentos (%lu retransmisiones), %lu errores CRC, %lu ACK\n",
+           (unsigned long)transmissions, (unsigned long)(transmissions - chunks),
+           (unsigned long)stats.crc_errors, (unsigned long)stats.acks_sent);
+
+    if (!done) {
+        printf("ERROR: la carga no terminó (%s)\n", last_reply);
+        return;
+    }
+
+    printf("Ventana deslizante: %lu ms (%.0f B/s de datos)\n",
+           (unsigned long)done_ms, length * 1000.0 / done_ms);
+    printf("Parada y espera estimada: %.0f ms (%.0f B/s)\n",
+           stop_wait_ms, length * 1000.0 / stop_wait_ms);
+    size_t staged = 0;
+    storage_read(STORAGE_REGION_STAGING, NULL, 0, &staged);
+    printf("Ruta verificada en flash: %lu puntos (ruta guardada sin cambios)\n",
+           (unsigned long)(staged / sizeof(route_record_t)));
+    printf("Prueba de carga completada\n");
+}
\ No newline at end of file
@@ -0,0 +1,113 @@
+/**
+ * @file upload.h
+ * @brief Header de la carga confiable de rutas y geocercas por Bluetooth.
+ *
+ * Define un protocolo de fragmentos con ventana deslizante, confirmaciones
+ * selectivas y CRC por fragmento. Cada fragmento se programa directamente
+ * en una región de flash de preparación, así que la velocidad queda
+ * limitada por el enlace y no por el tiempo de ida y vuelta. Los datos
+ * guardados solo se reemplazan al completar y verificar la carga.
+ *
+ * Protocolo (texto, una línea por mensaje):
+ * - App -> Robot: "UPLOAD,<ROUTE|FENCE>,<bytes>,<crc32_hex>"
+ * - Robot -> App: "UPOK,<fragmentos>,<ventana>,<bytes_fragmento>" o "UPERR,<motivo>"
+ * - App -> Robot: "D,<seq>,<datos_base64>,<crc16_hex>" con seq desde 0
+ * - Robot -> App: "ACK,<base>,<mascara_hex>": recibidos todos los fragmentos
+ *   menores que base y, en el bit i de la máscara, el fragmento base + 1 + i
+ * - Robot -> App: "UPDONE,<tipo>,<bytes>" al verificar el CRC32 total
+ * - App -> Robot: "UPABORT" para cancelar
+ *
+ * Formato de los datos (enteros little-endian, double IEEE 754 de 8 bytes):
+ * - ROUTE: registros route_record_t consecutivos
+ * - FENCE: bloque de la geocerca:
+ *   - offset 0: double latitud del origen ENU (grados)
+ *   - offset 8: double longitud del origen ENU (grados)
+ *   - offset 16: uint32 número de polígonos (máximo GEOFENCE_MAX_POLYGONS)
+ *   - offset 20: uint32 número total de vértices (máximo GEOFENCE_MAX_VERTICES)
+ *   - offset 24: GEOFENCE_MAX_POLYGONS polígonos de 8 bytes: uint16 índice
+ *     del primer vértice, uint16 número de vértices (3 o más), uint8 1 si es
+ *     zona prohibida y 3 bytes de relleno
+ *   - offset 24 + 8 * GEOFENCE_MAX_POLYGONS: vértices de 8 bytes: int32
+ *     Este e int32 Norte en decímetros respecto al origen, cada uno dentro
+ *     de ±GEOFENCE_MAX_EXTENT_DM
+ *   Se puede omitir la cola de vértices sin usar; lo que falta se toma
+ *   como cero. La caja de cada polígono no puede superar
+ *   GEOFENCE_MAX_EXTENT_DM por lado. Un bloque inválido se rechaza con
+ *   "UPERR,DATOS" y la geocerca guardada no cambia.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef UPLOAD_H
+#define UPLOAD_H
+
+#include "pico/stdlib.h"
+#include <stdint.h>
+
+/// @defgroup UPLOAD_STRUCTURES Estructuras de la carga
+/// @{
+
+/**
+ * @brief Estadísticas de la última carga.
+ */
+typedef struct {
+    uint32_t chunks_ok;       ///< Fragmentos aceptados
+    uint32_t duplicates;      ///< Fragmentos repetidos (ya recibidos)
+    uint32_t crc_errors;      ///< Fragmentos descartados por CRC o formato
+    uint32_t out_of_window;   ///< Fragmentos fuera de la ventana
+    uint32_t acks_sent;       ///< Confirmaciones enviadas
+} upload_stats_t;
+
+/// @}
+
+/// @defgroup UPLOAD_FUNCTIONS Funciones de la carga
+/// @{
+
+/**
+ * @brief Procesa una línea del protocolo de carga.
+ *
+ * @param line Línea recibida por Bluetooth
+ * @param now_ms Tiempo actual en ms
+ * @return true si la línea pertenecía al protocolo de carga
+ */
+bool upload_handle_line(const char* line, uint32_t now_ms);
+
+/**
+ * @brief Envía la confirmación acumulada y vigila el tiempo de espera.
+ *
+ * Debe llamarse una vez por iteración del bucle principal, después de
+ * procesar las líneas recibidas, para enviar un solo ACK por iteración.
+ *
+ * @param now_ms Tiempo actual en ms
+ */
+void upload_update(uint32_t now_ms);
+
+/**
+ * @brief Verifica si hay una carga en curso.
+ *
+ * @return true si se están recibiendo fragmentos
+ */
+bool upload_is_active(void);
+
+/**
+ * @brief Obtiene las estadísticas de la última carga.
+ *
+ * @return Copia de las estadísticas
+ */
+upload_stats_t upload_get_stats(void);
+
+/**
+ * @brief Función de prueba de la carga.
+ *
+ * Simula un enlace a 115200 baudios con pérdidas y errores, carga una
+ * ruta de 200 puntos con ventana deslizante y compara el tiempo con el
+ * de un protocolo de parada y espera. La carga se verifica en la región
+ * de preparación y no reemplaza la ruta guardada.
+ */
+void upload_test(void);
+
+/// @}
+
+#endif // UPLOAD_H
\ No newline at end of file
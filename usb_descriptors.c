@@ -0,0 +1,154 @@
+/**
+ * @file usb_descriptors.c
+ * @brief Descriptores USB de la traza binaria (TinyUSB).
+ *
+ * Una configuración con una interfaz vendor (bulk IN y OUT de 64 bytes).
+ * El descriptor BOS anuncia MS OS 2.0 para que Windows asigne WinUSB sin
+ * instalar drivers; en Linux y macOS libusb accede directamente. El número
+ * de serie es el identificador único de la flash, así el receptor puede
+ * elegir un robot cuando hay varios conectados.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "tusb.h"
+#include "usb_descriptors.h"
+#include "config.h"
+#include "pico/unique_id.h"
+#include <string.h>
+
+/// @brief Interfaces de la configuración
+enum {
+    ITF_NUM_VENDOR = 0,
+    ITF_NUM_TOTAL
+};
+
+/// @brief Endpoints de la interfaz vendor
+#define EPNUM_VENDOR_OUT 0x01
+#define EPNUM_VENDOR_IN 0x81
+
+/// @brief Longitud total de la configuración
+#define CONFIG_TOTAL_LEN (TUD_CONFIG_DESC_LEN + TUD_VENDOR_DESC_LEN)
+
+/// @brief Longitud total del descriptor BOS
+#define BOS_TOTAL_LEN (TUD_BOS_DESC_LEN + TUD_BOS_MICROSOFT_OS_DESC_LEN)
+
+/// @brief Índices de las cadenas
+enum {
+    STRID_LANGID = 0,
+    STRID_MANUFACTURER,
+    STRID_PRODUCT,
+    STRID_SERIAL,
+    STRID_INTERFACE
+};
+
+/// @brief Descriptor del dispositivo (USB 2.1 para el descriptor BOS)
+static tusb_desc_device_t const desc_device = {
+    .bLength = sizeof(tusb_desc_device_t),
+    .bDescriptorType = TUSB_DESC_DEVICE,
+    .bcdUSB = 0x0210,
+    .bDeviceClass = 0x00,
+    .bDeviceSubClass = 0x00,
+    .bDeviceProtocol = 0x00,
+    .bMaxPacketSize0 = CFG_TUD_ENDPOINT0_SIZE,
+    .idVendor = TRACE_USB_VID,
+    .idProduct = TRACE_USB_PID,
+    .bcdDevice = 0x0100,
+    .iManufacturer = STRID_MANUFACTURER,
+    .iProduct = STRID_PRODUCT,
+    .iSerialNumber = STRID_SERIAL,
+    .bNumConfigurations = 1
+};
+
+/// @brief Descriptor de la configuración
+static uint8_t const desc_configuration[] = {
+    TUD_CONFIG_DESCRIPTOR(1, ITF_NUM_TOTAL, 0, CONFIG_TOTAL_LEN, 0x00, 100),
+    TUD_VENDOR_DESCRIPTOR(ITF_NUM_VENDOR, STRID_INTERFACE, EPNUM_VENDOR_OUT, EPNUM_VENDOR_IN, 64)
+};
+
+/// @brief Descriptor BOS con la capacidad MS OS 2.0
+static uint8_t const desc_bos[] = {
+    TUD_BOS_DESCRIPTOR(BOS_TOTAL_LEN, 1),
+    TUD_BOS_MS_OS_20_DESCRIPTOR(USB_MS_OS_20_DESC_LEN, USB_REQUEST_MICROSOFT)
+};
+
+uint8_t const usb_desc_ms_os_20[USB_MS_OS_20_DESC_LEN] = {
+    // Cabecera del conjunto: longitud, tipo, versión de Windows (8.1+), longitud total
+    U16_TO_U8S_LE(0x000A), U16_TO_U8S_LE(MS_OS_20_SET_HEADER_DESCRIPTOR),
+    U32_TO_U8S_LE(0x06030000), U16_TO_U8S_LE(USB_MS_OS_20_DESC_LEN),
+
+    // Identificador compatible: WINUSB
+    U16_TO_U8S_LE(0x0014), U16_TO_U8S_LE(MS_OS_20_FEATURE_COMPATBLE_ID),
+    'W', 'I', 'N', 'U', 'S', 'B', 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+
+    // Propiedad del registro: DeviceInterfaceGUIDs (REG_MULTI_SZ)
+    U16_TO_U8S_LE(0x0084), U16_TO_U8S_LE(MS_OS_20_FEATURE_REG_PROPERTY),
+    U16_TO_U8S_LE(0x0007), U16_TO_U8S_LE(0x002A),
+    'D', 0x00, 'e', 0x00, 'v', 0x00, 'i', 0x00, 'c', 0x00, 'e', 0x00, 'I', 0x00, 'n', 0x00,
+    't', 0x00, 'e', 0x00, 'r', 0x00, 'f', 0x00, 'a', 0x00, 'c', 0x00, 'e', 0x00, 'G', 0x00,
+    'U', 0x00, 'I', 0x00, 'D', 0x00, 's', 0x00, 0x00, 0x00,
+    U16_TO_U8S_LE(0x0050),
+    '{', 0x00, '6', 0x00, 'F', 0x00, '1', 0x00, 'A', 0x00, '3', 0x00, 'B', 0x00, '5', 0x00,
+    '2', 0x00, '-', 0x00, '9', 0x00, 'C', 0x00, '4', 0x00, 'E', 0x00, '-', 0x00, '4', 0x00,
+    'B', 0x00, '8', 0x00, 'D', 0x00, '-', 0x00, 'A', 0x00, '1', 0x00, 'E', 0x00, '7', 0x00,
+    '-', 0x00, '3', 0x00, 'D', 0x00, '5', 0x00, 'C', 0x00, '2', 0x00, 'B', 0x00, '9', 0x00,
+    'F', 0x00, '0', 0x00, 'A', 0x00, '1', 0x00, '4', 0x00, '}', 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+TU_VERIFY_STATIC(sizeof(usb_desc_ms_os_20) == USB_MS_OS_20_DESC_LEN, "Longitud del descriptor MS OS 2.0");
+
+/// @brief Cadenas (el número de serie se arma aparte)
+static char const* const strings[] = {
+    [STRID_MANUFACTURER] = "Equipo WALLY-S",
+    [STRID_PRODUCT] = "WALLY-S",
+    [STRID_INTERFACE] = "WALLY-S Trace",
+};
+
+/// @brief Cadena UTF-16 devuelta al host (cabecera y hasta 32 caracteres)
+static uint16_t desc_string[33];
+
+uint8_t const* tud_descriptor_device_cb(void) {
+    return (uint8_t const*)&desc_device;
+}
+
+uint8_t const* tud_descriptor_configuration_cb(uint8_t index) {
+    (void)index;
+    return desc_configuration;
+}
+
+uint8_t const* tud_descriptor_bos_cb(void) {
+    return desc_bos;
+}
+
+uint16_t const* tud_descriptor_string_cb(uint8_t index, uint16_t langid) {
+    (void)langid;
+    size_t count;
+
+    if (index == STRID_LANGID) {
+        desc_string[1] = 0x0409; // Inglés (EE. UU.), el único que piden los hosts
+        count = 1;
+    } else {
+        char serial[2 * PICO_UNIQUE_BOARD_ID_SIZE_BYTES + 1];
+        const char* text = NULL;
+
+        if (index == STRID_SERIAL) {
+            pico_get_unique_board_id_string(serial, sizeof(serial));
+            text = serial;
+        } else if (index < TU_ARRAY_SIZE(strings)) {
+            text = strings[index];
+        }
+        if (!text) return NULL;
+
+        count = strlen(text);
+        if (count > TU_ARRAY_SIZE(desc_string) - 1) count = TU_ARRAY_SIZE(desc_string) - 1;
+        for (size_t i = 0; i < count; i++) {
+            desc_string[1 + i] = (uint8_t)text[i];
+        }
+    }
+
+    desc_string[0] = (uint16_t)((TUSB_DESC_STRING << 8) | (2 * count + 2));
+    return desc_string;
+}
\ No newline at end of file
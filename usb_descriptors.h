@@ -0,0 +1,34 @@
+/**
+ * @file usb_descriptors.h
+ * @brief Header de los descriptores USB de la traza binaria.
+ *
+ * @author Equipo WALLY-S
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef USB_DESCRIPTORS_H
+#define USB_DESCRIPTORS_H
+
+#include <stdint.h>
+
+/// @defgroup USB_DESCRIPTORS Descriptores USB
+/// @{
+
+/**
+ * @brief Peticiones vendor del dispositivo.
+ */
+typedef enum {
+    USB_REQUEST_TRACE = 1,       ///< wValue 1 inicia la traza, 0 la detiene
+    USB_REQUEST_MICROSOFT = 2    ///< Descriptor MS OS 2.0 (Windows asigna WinUSB sin instalar drivers)
+} usb_vendor_request_t;
+
+/// @brief Longitud del descriptor MS OS 2.0
+#define USB_MS_OS_20_DESC_LEN 0xA2
+
+/// @brief Conjunto de descriptores MS OS 2.0 (WinUSB)
+extern uint8_t const usb_desc_ms_os_20[USB_MS_OS_20_DESC_LEN];
+
+/// @}
+
+#endif // USB_DESCRIPTORS_H
\ No newline at end of file